@@ -27,11 +27,10 @@
 #include "../global.h"
 #include "../SimStateHandler.h"
 #include "../mod_landscape/crrc_scenery.h"
+#include "../mod_landscape/scenery_loader.h"
 #include "crrc_gui_main.h"
 #include "crrc_location.h"
 #include "../crrc_main.h"
-#include "../mod_mode/F3F/handlerF3F.h"
-#include "../mod_windfield/windfield.h"
 #include "../mod_misc/filesystools.h"
 #include "util.h"
 #include "../global_video.h"
@@ -420,29 +419,10 @@ bool CGUILocationDialog::saveSelection() const
   if ((newLocname != curLocName) || (newSkyVariant != curSkyVariant))
   {
     cfg->setLocation(filename.c_str(), newSkyVariant, cfgfile);
-      
-    Scenery* new_scenery = loadScenery(FileSysTools::getDataPath(filename).c_str(),
-                                       newSkyVariant);
-    if (new_scenery)
-    {
-      clear_wind_field();
-      delete Global::scenery;
-      Global::scenery = new_scenery;
-      //reinitialise game mode
-      if (Global::gameHandler)
-      {
-        delete Global::gameHandler;
-      }
-      if (cfgfile->getInt("game.f3f.enabled",0))
-        Global::gameHandler = new HandlerF3F();
-      else
-        Global::gameHandler= new T_GameHandler();
-    }
-    cfg->read(cfgfile);
-    Video::setWindowTitleString();
-    player_pos = Global::scenery->getPlayerPosition();
-    Init_mod_windfield();
-    Global::Simulation->reset();
+
+    // The current scenery is used until the new one has been loaded,
+    // the main loop swaps it in then.
+    SceneryLoader::start(FileSysTools::getDataPath(filename), newSkyVariant);
   }
   return true;
 }
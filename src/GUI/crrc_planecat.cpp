@@ -0,0 +1,481 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+// implementation of class CRRC_PlaneCatalogue
+
+#include "crrc_planecat.h"
+
+#include "../config.h"
+#include "../mod_misc/filesystools.h"
+#include "../mod_misc/SimpleXMLTransfer.h"
+#include "../mod_fdm/xmlmodelfile.h"
+#include "util.h"
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+//#define DEBUG_PLANECAT
+
+namespace
+{
+  /**
+   * A model and the state of its file when it was read
+   */
+  struct Entry
+  {
+    CRRC_PlaneCatalogue::Model model;
+    long                       mtime;
+    long                       size;
+  };
+
+  typedef std::map<std::string, Entry> EntryMap;   ///< by file name
+
+  /**
+   * One model directory
+   */
+  struct Dir
+  {
+    std::string path;
+    std::string homeFile;   ///< where to store the catalogue if path isn't writable
+    EntryMap    entries;
+  };
+
+  const int         VERSION  = 1;
+  const char* const CAT_FILE = ".catalogue";
+
+  /// @name Written by the main thread before the scan starts
+  //@{
+  std::vector<Dir> dirs;
+  bool             fStarted    = false;
+  bool             fIncomplete = false;  ///< a directory had no stored catalogue
+  //@}
+
+  SDL_Thread*   thread   = NULL;
+  SDL_mutex*    mutex    = NULL;   ///< guards dirs[].entries and fScanning
+  SDL_cond*     done     = NULL;
+  bool          fScanning = false;
+  volatile bool fQuit    = false;
+
+  /**
+   * Gets modification time and size of a file. Returns false if it
+   * doesn't exist.
+   */
+  bool getFileState(std::string path, long& mtime, long& size)
+  {
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0)
+      return(false);
+    mtime = (long)st.st_mtime;
+    size  = (long)st.st_size;
+    return(true);
+  }
+
+  /**
+   * Name of a model derived from its file name
+   */
+  std::string nameFromPath(std::string path)
+  {
+    std::string::size_type dot_index;
+    std::string::size_type slash_index;
+
+    dot_index = path.find_last_of('.');
+    if (dot_index == std::string::npos)
+      dot_index = path.length();
+
+    slash_index = path.find_last_of('/');
+    if (slash_index == std::string::npos || slash_index >= dot_index)
+      return(path);
+
+    return(path.substr(slash_index + 1, dot_index - slash_index - 1));
+  }
+
+  void addStrings(SimpleXMLTransfer* xml, std::string name,
+                  std::string attr, std::vector<std::string> const& list)
+  {
+    for (unsigned int n = 0; n < list.size(); n++)
+    {
+      SimpleXMLTransfer* e = new SimpleXMLTransfer();
+      e->setName(name);
+      e->addAttribute(attr, list[n]);
+      xml->addChild(e);
+    }
+  }
+
+  /**
+   * Reads the stored catalogue of <code>dir</code>. Returns false if
+   * there is none (or it can't be used).
+   */
+  bool load(Dir& dir)
+  {
+    std::string file = dir.path + "/" + CAT_FILE;
+    long        mtime, size;
+
+    if (!getFileState(file, mtime, size))
+    {
+      file = dir.homeFile;
+      if (!getFileState(file, mtime, size))
+        return(false);
+    }
+
+    try
+    {
+      SimpleXMLTransfer cat(file);
+
+      if (cat.attributeAsInt("version", 0) != VERSION)
+        return(false);
+
+      for (int i = 0; i < cat.getChildCount(); i++)
+      {
+        SimpleXMLTransfer* m = cat.getChildAt(i);
+        std::string        fname = m->attribute("file");
+        Entry&             e = dir.entries[fname];
+
+        e.mtime = atol(m->attribute("mtime", "0").c_str());
+        e.size  = atol(m->attribute("size", "0").c_str());
+        e.model.file        = dir.path + "/" + fname;
+        e.model.name        = m->attribute("name");
+        e.model.description = m->attribute("description", "");
+        e.model.fLaunch     = (m->attributeAsInt("launch", 0) != 0);
+        e.model.fOptions    = (m->attributeAsInt("options", 0) != 0);
+        for (int k = 0; k < m->getChildCount(); k++)
+        {
+          SimpleXMLTransfer* c    = m->getChildAt(k);
+          std::string        name = c->getName();
+
+          if (name == "category")
+            e.model.categories.push_back(c->attribute("name"));
+          else if (name == "graphics")
+            e.model.graphics.push_back(c->attribute("descr"));
+          else if (name == "config")
+            e.model.configs.push_back(c->attribute("descr"));
+          else if (name == "preview")
+            e.model.previews.push_back(c->attribute("model"));
+        }
+      }
+    }
+    catch (XMLException e)
+    {
+      fprintf(stderr, "Ignoring catalogue %s: %s\n", file.c_str(), e.what());
+      dir.entries.clear();
+      return(false);
+    }
+    return(true);
+  }
+
+  /**
+   * Writes the catalogue of <code>dir</code>, into the directory itself
+   * if possible.
+   */
+  void save(Dir const& dir)
+  {
+    SimpleXMLTransfer cat;
+
+    cat.setName("catalogue");
+    cat.addAttribute("version", VERSION);
+    for (EntryMap::const_iterator it = dir.entries.begin(); it != dir.entries.end(); it++)
+    {
+      Entry const&       e = it->second;
+      SimpleXMLTransfer* m = new SimpleXMLTransfer();
+
+      m->setName("model");
+      m->addAttribute("file",        it->first);
+      m->addAttribute("mtime",       e.mtime);
+      m->addAttribute("size",        e.size);
+      m->addAttribute("name",        e.model.name);
+      m->addAttribute("description", e.model.description);
+      m->addAttribute("launch",      e.model.fLaunch ? 1 : 0);
+      m->addAttribute("options",     e.model.fOptions ? 1 : 0);
+      addStrings(m, "category", "name",  e.model.categories);
+      addStrings(m, "graphics", "descr", e.model.graphics);
+      addStrings(m, "config",   "descr", e.model.configs);
+      addStrings(m, "preview",  "model", e.model.previews);
+      cat.addChild(m);
+    }
+
+    std::ofstream out;
+    std::string   file = dir.path + "/" + CAT_FILE;
+
+    out.open(file.c_str());
+    if (!out)
+    {
+      file = dir.homeFile;
+      FileSysTools::makeSurePathExists(file.substr(0, file.rfind('/')));
+      out.clear();
+      out.open(file.c_str());
+      if (!out)
+      {
+        fprintf(stderr, "Unable to write catalogue %s\n", file.c_str());
+        return;
+      }
+    }
+    cat.print(out);
+    out.close();
+  }
+
+  /**
+   * Checks all model files in <code>dir</code>, reads those which have
+   * changed and writes the catalogue if anything did. Returns false if
+   * interrupted.
+   */
+  bool scan(Dir& dir)
+  {
+    DIR*           d;
+    struct dirent* ent;
+    EntryMap       entries;
+    bool           fChanged = false;
+
+    if ((d = opendir(dir.path.c_str())) == NULL)
+      return(true);
+
+    while ((ent = readdir(d)) != NULL && !fQuit)
+    {
+      std::string fname = ent->d_name;
+      std::string path  = dir.path + "/" + fname;
+      Entry       e;
+
+      if (!T_GUI_Util::checkExtension(fname, "xml") &&
+          !T_GUI_Util::checkExtension(fname, "air"))
+        continue;
+      if (!getFileState(path, e.mtime, e.size))
+        continue;
+
+      EntryMap::const_iterator old = dir.entries.find(fname);
+      if (old != dir.entries.end() &&
+          old->second.mtime == e.mtime && old->second.size == e.size)
+      {
+        entries[fname] = old->second;
+      }
+      else
+      {
+#ifdef DEBUG_PLANECAT
+        printf("Catalogue: reading %s\n", path.c_str());
+#endif
+        CRRC_PlaneCatalogue::readModel(path, e.model);
+        entries[fname] = e;
+        fChanged = true;
+      }
+    }
+    closedir(d);
+
+    if (fQuit)
+      return(false);
+
+    // something removed?
+    if (entries.size() != dir.entries.size())
+      fChanged = true;
+
+    SDL_mutexP(mutex);
+    dir.entries.swap(entries);
+    SDL_mutexV(mutex);
+
+    if (fChanged)
+      save(dir);
+    return(true);
+  }
+
+  int ThreadFunc(void*)
+  {
+    for (unsigned int n = 0; n < dirs.size(); n++)
+    {
+      if (!scan(dirs[n]))
+        break;
+    }
+
+    SDL_mutexP(mutex);
+    fScanning = false;
+    SDL_CondBroadcast(done);
+    SDL_mutexV(mutex);
+    return(0);
+  }
+}
+
+
+void CRRC_PlaneCatalogue::startScan()
+{
+  std::vector<std::string> paths;
+
+  if (fStarted)
+    return;
+  fStarted = true;
+
+  T_Config::getModelDirs(paths);
+  for (unsigned int i = 0; i < paths.size(); i++)
+  {
+    Dir         dir;
+    std::string mangled = paths[i];
+
+    for (unsigned int n = 0; n < mangled.length(); n++)
+    {
+      if (mangled[n] == '/' || mangled[n] == '\\' || mangled[n] == ':')
+        mangled[n] = '_';
+    }
+    dir.path     = paths[i];
+    dir.homeFile = FileSysTools::getHomePath() + "/catalogue/" + mangled;
+    dirs.push_back(dir);
+
+    if (!load(dirs.back()))
+      fIncomplete = true;
+  }
+
+  mutex     = SDL_CreateMutex();
+  done      = SDL_CreateCond();
+  fScanning = true;
+  fQuit     = false;
+  thread    = SDL_CreateThread(ThreadFunc, NULL);
+  if (thread == NULL)
+  {
+    // no thread, do it right now
+    ThreadFunc(NULL);
+  }
+}
+
+void CRRC_PlaneCatalogue::stopScan()
+{
+  if (thread == NULL)
+    return;
+
+  fQuit = true;
+  SDL_WaitThread(thread, NULL);
+  thread = NULL;
+}
+
+static bool compareNames(CRRC_PlaneCatalogue::Model const& a,
+                         CRRC_PlaneCatalogue::Model const& b)
+{
+  return(a.name < b.name);
+}
+
+void CRRC_PlaneCatalogue::getModels(std::vector<Model>& models)
+{
+  startScan();
+
+  models.clear();
+
+  SDL_mutexP(mutex);
+  while (fScanning && fIncomplete)
+    SDL_CondWait(done, mutex);
+  for (unsigned int n = 0; n < dirs.size(); n++)
+  {
+    for (EntryMap::const_iterator it = dirs[n].entries.begin(); it != dirs[n].entries.end(); it++)
+      models.push_back(it->second.model);
+  }
+  SDL_mutexV(mutex);
+
+  std::stable_sort(models.begin(), models.end(), compareNames);
+}
+
+void CRRC_PlaneCatalogue::readModel(std::string path, Model& model)
+{
+  model.file        = path;
+  model.name        = "";
+  model.description = "";
+  model.fLaunch     = false;
+  model.fOptions    = false;
+  model.categories.clear();
+  model.graphics.clear();
+  model.configs.clear();
+  model.previews.clear();
+
+  SimpleXMLTransfer* xml = NULL;
+  try
+  {
+    xml = new SimpleXMLTransfer(path);
+  }
+  catch (XMLException e)
+  {
+    // not XML (.air files are converted when loading them)
+  }
+
+  if (xml != NULL)
+  {
+    // Like in the dialog before, a missing child only drops what
+    // depends on it.
+    try
+    {
+      model.name = xml->getChild("name.en")->getContentString();
+    }
+    catch (XMLException e)
+    {
+    }
+
+    try
+    {
+      model.description = xml->getChild("description.en")->getContentString();
+    }
+    catch (XMLException e)
+    {
+    }
+
+    try
+    {
+      SimpleXMLTransfer* xmlcateg = xml->getChild("categories");
+      for (int k = 0; k < xmlcateg->getChildCount(); k++)
+        model.categories.push_back(xmlcateg->getChildAt(k)->getContentString());
+    }
+    catch (XMLException e)
+    {
+    }
+
+    // The test for a "launch" child shouldn't throw an exception,
+    // so we let it create the child if the test fails and then
+    // test for its children to see if it was a real "launch" tag
+    model.fLaunch = (xml->getChild("launch", true)->getChildCount() > 0);
+
+    for (int i = 0; i < xml->getChildCount(); i++)
+    {
+      SimpleXMLTransfer* child = xml->getChildAt(i);
+      if (child->getName() == "graphics")
+        model.previews.push_back(child->getString("model", ""));
+    }
+
+    try
+    {
+      if (XMLModelFile::ListOptions(xml))
+      {
+        SimpleXMLTransfer* grp = xml->getChild("options.graphics");
+        SimpleXMLTransfer* cfg = xml->getChild("options.config");
+
+        for (int i = 0; i < grp->getChildCount(); i++)
+          model.graphics.push_back(grp->getChildAt(i)->getContentString());
+        for (int i = 0; i < cfg->getChildCount(); i++)
+          model.configs.push_back(cfg->getChildAt(i)->getContentString());
+        model.fOptions = true;
+      }
+    }
+    catch (XMLException e)
+    {
+      model.graphics.clear();
+      model.configs.clear();
+    }
+
+    delete xml;
+  }
+
+  // name still empty? then we had no luck with the XML file...
+  if (model.name == "")
+    model.name = nameFromPath(path);
+}
@@ -0,0 +1,91 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+// crrc_planecat.h - Catalogue of the airplane models
+
+#ifndef CRRC_PLANECAT_H
+#define CRRC_PLANECAT_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Keeps what the airplane selection dialog shows about each model file,
+ * so the dialog doesn't have to parse all of them.
+ *
+ * For every model directory, the catalogue is stored in a file named
+ * <code>.catalogue</code> in this directory. If the directory isn't
+ * writable, the file goes to <code>catalogue/</code> in the user's
+ * home directory instead. Each entry records the modification time and
+ * size of its model file; only files which have been changed, added or
+ * removed since are parsed again.
+ *
+ * startScan() loads the stored catalogues and checks the model files on a
+ * thread of its own, which writes back the catalogues which have changed.
+ * Until it has finished, getModels() returns the stored entries.
+ */
+class CRRC_PlaneCatalogue
+{
+  public:
+    /**
+     * What is known about one model file
+     */
+    struct Model
+    {
+      std::string              file;         ///< full path
+      std::string              name;         ///< name.en or derived from the file name
+      std::string              description;  ///< description.en
+      std::vector<std::string> categories;
+      bool                     fLaunch;      ///< has launch presets
+      bool                     fOptions;     ///< more than one graphics or config to choose from
+      std::vector<std::string> graphics;     ///< descr_short.en of each graphics, if fOptions
+      std::vector<std::string> configs;      ///< descr_short.en of each config, if fOptions
+      std::vector<std::string> previews;     ///< 3D model file of each graphics
+    };
+
+    /**
+     * Loads the stored catalogue of every model directory and starts
+     * checking the model files in the background. Does nothing if it has
+     * been started before.
+     */
+    static void startScan();
+
+    /**
+     * Stops checking, if it is still running. Catalogues of directories
+     * which haven't been checked completely are not written.
+     */
+    static void stopScan();
+
+    /**
+     * Copies all models, sorted by name, to <code>models</code>. Starts
+     * the scan if that hasn't been done yet.
+     *
+     * Only waits for the scan to finish if a directory didn't have a
+     * stored catalogue.
+     */
+    static void getModels(std::vector<Model>& models);
+
+    /**
+     * Reads a model file. If it can't be parsed, only the name (taken
+     * from the file name) is filled in.
+     */
+    static void readModel(std::string path, Model& model);
+};
+
+#endif // CRRC_PLANECAT_H
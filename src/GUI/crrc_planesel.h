@@ -34,7 +34,7 @@
 #include "crrc_dialog.h"
 #include "puaScrListBox.h"
 #include "puaGLPreview.h"
-#include "../mod_misc/SimpleXMLTransfer.h"
+#include "crrc_planecat.h"
 
 
 class CGUIPlaneSelectDialog;
@@ -73,19 +73,18 @@ class CGUIPlaneSelectDialog : public CRRCDialog
     puaScrListBox *planes;
     char          **planeList;              ///< names of the planes
     int           planeListSize;
-    std::vector<std::string> plane_paths;   ///< full paths of model files, same order as planeList
+    std::vector<CRRC_PlaneCatalogue::Model> models;  ///< all models, sorted by name
+    std::vector<unsigned int> plane_index;  ///< index into models, same order as planeList
 
     puaGLPreview  *preview;                 ///< GL preview of the selected plane
 
     puaComboBox    *gbox;
     char**        optsGraphics;
     int           nOptsGraphics;
-    SimpleXMLTransfer* optsGrpGraphics;
 
     puaComboBox    *cbox;
     char**        optsConfig;
     int           nOptsConfig;
-    SimpleXMLTransfer* optsGrpConfig;
   
     puText        *location_label;
     std::string   location_label_string;
@@ -95,18 +94,9 @@ class CGUIPlaneSelectDialog : public CRRCDialog
     
     puButton      *check_usedefault;
   
-    /// Fill the mfiles vector with the paths of all model files
-    void  createMFileList(std::vector<std::string>& filelist);
-    
     /// Assign a list of categories to the catList
     void  updateCategories();
     
-    /// Get all planes of one category
-    void  getPlanesByCategory(std::vector<std::string>& planes, std::string category);
-    
-    /// Get the name of a model
-    std::string getModelName(std::string path);
-    
     /// Clean up config boxes
     void cleanUpConfigAndGraphics();
     
@@ -45,6 +45,7 @@
  */
 
 #include "puaGLPreview.h"
+#include "../mod_video/ssg_loader.h"
 
 // graphics parameters for the preview
 //
@@ -244,8 +245,8 @@ bool puaGLPreview::loadGeometry( const char * modelPath, const char * texturePat
     geometry = NULL;
   }
 
-  ssgTexturePath(texturePath);    // load the model and textures via ssg
-  geometry = ssgLoad(modelPath);
+  // load the model and textures via ssg
+  geometry = SSGUtil::loadModel(modelPath, texturePath);
 
   // if the geometry load fails, we will setup the legend to indicate "huston, we have a problem."  otherwise, add
   // the geometry to the scene graph (as a child of the initial transform).  the initial transform is set to
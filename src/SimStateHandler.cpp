@@ -44,7 +44,9 @@
 #include "mod_windfield/windfield.h"
 #include "robots.h"
 #include "record.h"
+#include "crrc_fdmthread.h"
 #include "mod_misc/lib_conversions.h"
+#include "mod_misc/profiler.h"
 
 /// \todo current_time may be provided by the caller as a parameter
 void idle(TSimInputs* inputs)
@@ -76,12 +78,32 @@ void idle(TSimInputs* inputs)
   // compute ticks since last execution of this code (considering pauses):
   nDeltaTicks = current_time - time_after_last_integration;
   time_after_last_integration = current_time;
-  // The flight model should be calculated every dt seconds.
-  multiloop=(int)(nDeltaTicks/1000.0/Global::dt - dDeltaT + 0.5);
-  dDeltaT += multiloop*Global::dt - nDeltaTicks/1000.0;
-  update_thermals(Global::dt * multiloop);
+  if (Global::fdmThread != NULL)
+  {
+    // The flight model runs on its own thread. Everything else catches
+    // up with the steps it did since the last frame.
+    Global::fdmThread->RaiseEvents();
+    Global::fdmThread->SetInputs(inputs);
+    multiloop = Global::fdmThread->TakeSteps();
+    update_thermals(Global::dt * multiloop);
+  }
+  else
+  {
+    if (Global::fixed_multiloop > 0)
+    {
+      // Deterministic mode: simulated time doesn't depend on the wall clock.
+      multiloop = Global::fixed_multiloop;
+    }
+    else
+    {
+      // The flight model should be calculated every dt seconds.
+      multiloop=(int)(nDeltaTicks/1000.0/Global::dt - dDeltaT + 0.5);
+      dDeltaT += multiloop*Global::dt - nDeltaTicks/1000.0;
+    }
+    update_thermals(Global::dt * multiloop);
 
-  Global::aircraft->getFDMInterface()->update(inputs, Global::dt, multiloop);
+    Global::aircraft->getFDMInterface()->update(inputs, Global::dt, multiloop);
+  }
   Global::Simulation->incSimSteps(multiloop);
   
   if (nAircraftOutsideWindfieldSim)
@@ -91,11 +113,20 @@ void idle(TSimInputs* inputs)
   double Y_cg_rwy =    Global::aircraft->getPos().r[1];
   double H_cg_rwy = -1*Global::aircraft->getPos().r[2];
 
-  Global::gameHandler->update(X_cg_rwy,Y_cg_rwy,H_cg_rwy, Global::recorder, Global::robots);
+  {
+    CRRC_PROFILE("game");
+    Global::gameHandler->update(X_cg_rwy,Y_cg_rwy,H_cg_rwy, Global::recorder, Global::robots);
+  }
   
-  Global::recorder->AirplanePosition(Global::dt, multiloop, Global::aircraft->getFDMInterface()->fdm);
+  {
+    CRRC_PROFILE("recorder");
+    Global::recorder->AirplanePosition(Global::dt, multiloop, Global::aircraft->getFDMInterface()->fdm, inputs);
+  }
 
-  Global::robots->Update(Global::dt, multiloop);  
+  {
+    CRRC_PROFILE("robots");
+    Global::robots->Update(Global::dt, multiloop);  
+  }
   
   if(! Global::testmode.test_mode)//the camera is still on test_mode
         Video::UpdateCamera(Global::dt * multiloop);
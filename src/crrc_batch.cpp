@@ -0,0 +1,326 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_batch.cpp
+ *
+ *  Headless batch runner (crrcsim_batch).
+ *
+ *  Loads scenery, windfield and one airplane exactly like crrcsim does,
+ *  but without video, sound, GUI or input devices. Control inputs are
+ *  read from a scripted timeline, the flight model is stepped with a
+ *  fixed timestep as fast as possible and the trajectory is written to
+ *  a text file.
+ *
+ *  For the format of the input timeline see BatchInputScript.
+ *
+ *  With one or more -p options, a parameter sweep is run instead (see
+ *  CRRC_Sweep): every combination of parameter values is simulated, on
+ *  as many threads as given by -j, and one summary line per case is
+ *  written.
+ *
+ *  The functions and variables crrc_main.cpp usually exports to the rest
+ *  of the program are provided by crrc_headless.cpp.
+ */
+
+#include <crrc_config.h>
+#include "global.h"
+#include "defines.h"
+#include "crrc_main.h"
+#include "crrc_headless.h"
+#include "crrc_fdm.h"
+#include "crrc_sweep.h"
+#include "aircraft.h"
+#include "config.h"
+#include "record.h"
+#include "robots.h"
+#include "SimStateHandler.h"
+#include "mod_landscape/crrc_scenery.h"
+#include "mod_windfield/windfield.h"
+#include "mod_misc/SimpleXMLTransfer.h"
+#include "mod_misc/filesystools.h"
+#include "mod_misc/lib_conversions.h"
+#include "mod_misc/crrc_rand.h"
+#include "mod_mode/T_GameHandler.h"
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+
+extern char   *optarg;
+extern int    optind;
+
+#define OPTION_STRING "a:cd:g:hi:j:l:m:o:p:r:s:t:vw:"
+
+/*****************************************************************************/
+
+static void batch_usage(char *progname)
+{
+  fprintf(stderr,"\nUsage  : %s [options]\n",progname);
+  fprintf(stderr,  "Options:\n");
+  fprintf(stderr,  "         -h             : display this message\n");
+  fprintf(stderr,  "         -g <string>    : specify config file\n");
+  fprintf(stderr,  "         -l <string>    : location/scenery file with path (e.g. scenery/davis-orig.xml)\n");
+  fprintf(stderr,  "         -a <string>    : airplane file with path (e.g. models/allegro.xml)\n");
+  fprintf(stderr,  "         -c             : only precalculate the scenery's height data and wind grid\n");
+  fprintf(stderr,  "         -i <string>    : input script (time aileron elevator rudder throttle ...)\n");
+  fprintf(stderr,  "         -o <string>    : trajectory output file (default: stdout)\n");
+  fprintf(stderr,  "         -t <value>     : simulated time in s (default: 60)\n");
+  fprintf(stderr,  "         -s <value>     : FDM timestep in s (default: simulation.flightModel.dt)\n");
+  fprintf(stderr,  "         -m <value>     : FDM steps per output sample (default: 6)\n");
+  fprintf(stderr,  "         -d <value>     : wind direction in deg (0-360)\n");
+  fprintf(stderr,  "         -w <value>     : wind velocity in ft/sec\n");
+  fprintf(stderr,  "         -p <name=v,..> : sweep a parameter (velocity_rel, wind_dir, wind_vel, dt, cg\n");
+  fprintf(stderr,  "                          or an attribute path in the airplane file)\n");
+  fprintf(stderr,  "         -j <value>     : number of threads for a sweep (default: 1)\n");
+  fprintf(stderr,  "         -r <value>     : seed for random numbers (default: 1)\n");
+  fprintf(stderr,  "         -v             : increase verbosity\n");
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+  std::string airplane_file;
+  std::string location_file;
+  std::string input_file;
+  std::string output_file;
+  double      duration  = 60;
+  double      dt        = 0;
+  int         multiloop = 6;
+  int         nThreads  = 1;
+  bool        fPrepare  = false;
+  unsigned int uSeed    = 1;
+  std::vector<std::string> sweep_params;
+  int         c;
+
+  // the config file has to be known before T_Config is created
+  for (int i = 1; i < argc - 1; i++)
+  {
+    if (!strcmp(argv[i], "-g"))
+      T_Config::putConfigFilePath(argv[i+1]);
+  }
+
+  FileSysTools::SetAppname("crrcsim");
+  SDL_Init(0);
+
+  try
+  {
+    cfg = new T_Config(cfgfile);
+    cfg->read(cfgfile);
+    cfgfile->setAttributeOverwrite("video.enabled", "0");
+    cfgfile->setAttributeOverwrite("sound.enabled", "0");
+
+    while ((c = getopt(argc, argv, OPTION_STRING)) != -1)
+    {
+      switch (c)
+      {
+        case 'a':
+          airplane_file = optarg;
+          break;
+        case 'c':
+          fPrepare = true;
+          break;
+        case 'd':
+          cfg->wind->setDirection((float)atof(optarg), cfg);
+          break;
+        case 'g':
+          // handled above
+          break;
+        case 'i':
+          input_file = optarg;
+          break;
+        case 'j':
+          nThreads = atoi(optarg);
+          break;
+        case 'l':
+          location_file = optarg;
+          break;
+        case 'm':
+          multiloop = atoi(optarg);
+          break;
+        case 'o':
+          output_file = optarg;
+          break;
+        case 'p':
+          sweep_params.push_back(optarg);
+          break;
+        case 'r':
+          uSeed = strtoul(optarg, NULL, 0);
+          break;
+        case 's':
+          dt = atof(optarg);
+          break;
+        case 't':
+          duration = atof(optarg);
+          break;
+        case 'v':
+          Global::nVerbosity++;
+          break;
+        case 'w':
+          cfg->wind->setVelocity((float)atof(optarg));
+          break;
+        default:
+          batch_usage(argv[0]);
+          return(CRRC_EXIT_FAILURE);
+      }
+    }
+    if (multiloop < 1)
+      multiloop = 1;
+
+    // identical options and inputs lead to identical results
+    CRRC_Random::setSeed(uSeed);
+
+    if (location_file.length())
+      cfg->setLocation(location_file.c_str(), cfgfile);
+    if (airplane_file.length())
+      cfgfile->setAttributeOverwrite("airplane.file", FileSysTools::getDataPath(airplane_file));
+
+    Global::wind_mode = cfgfile->getInt("wind_mode.fUse", 2);
+    Global::dt        = (dt > 0) ? dt : cfgfile->getDouble("simulation.flightModel.dt", 0.002777);
+
+    Global::Simulation  = new SimStateHandler();
+    Global::aircraft    = new Aircraft();
+    Global::gameHandler = new T_GameHandler();
+    headless_fdmenv = new CRRC_FDM_Env(cfgfile);
+
+    Global::scenery = loadScenery(FileSysTools::getDataPath(cfg->getLocationName()).c_str(),
+                                  cfg->getSkyVariant());
+    if (Global::scenery == NULL)
+      crrc_exit(CRRC_EXIT_FAILURE, "Unable to load scenery");
+    if (fPrepare)
+    {
+      // loading the scenery has written its cache files
+      delete Global::scenery;
+      SDL_Quit();
+      return(CRRC_EXIT_SUCCESS);
+    }
+    cfg->wind->read(cfgfile, cfg);
+    player_pos = Global::scenery->getPlayerPosition();
+    Init_mod_windfield();
+
+    if (sweep_params.size() == 0)
+    {
+      loadAirplane();
+      initialize_flight_model();
+    }
+  }
+  catch (XMLException e)
+  {
+    std::string s = "XMLException: ";
+    s += e.what();
+    crrc_exit(CRRC_EXIT_FAILURE, s.c_str());
+  }
+  catch (std::runtime_error& e)
+  {
+    crrc_exit(CRRC_EXIT_FAILURE, e.what());
+  }
+
+  BatchInputScript* script = NULL;
+  try
+  {
+    script = new BatchInputScript(input_file);
+  }
+  catch (std::runtime_error& e)
+  {
+    crrc_exit(CRRC_EXIT_FAILURE, e.what());
+  }
+
+  FILE* out = stdout;
+  if (output_file.length())
+  {
+    out = fopen(output_file.c_str(), "w");
+    if (out == NULL)
+      crrc_exit(CRRC_EXIT_FAILURE, ("Unable to open " + output_file).c_str());
+  }
+
+  if (sweep_params.size())
+  {
+    int nFailed = 0;
+    try
+    {
+      CRRC_Sweep sweep(cfgfile, *script, duration, Global::dt, multiloop);
+      for (unsigned int i=0; i<sweep_params.size(); i++)
+        sweep.addParameter(sweep_params[i]);
+      nFailed = sweep.run(nThreads, out);
+    }
+    catch (XMLException e)
+    {
+      std::string s = "XMLException: ";
+      s += e.what();
+      crrc_exit(CRRC_EXIT_FAILURE, s.c_str());
+    }
+    catch (std::runtime_error& e)
+    {
+      crrc_exit(CRRC_EXIT_FAILURE, e.what());
+    }
+
+    if (out != stdout)
+      fclose(out);
+    delete script;
+    SDL_Quit();
+    return(nFailed ? CRRC_EXIT_FAILURE : CRRC_EXIT_SUCCESS);
+  }
+
+  ModFDMInterface* fdmi = Global::aircraft->getFDMInterface();
+  FDMBase*         fdm  = Global::aircraft->getFDM();
+  TSimInputs       inputs;
+  double           t     = 0;
+  long             steps = 0;
+
+  fprintf(out, "# t X Y Z phi theta psi v_north v_east v_down p q r V_rel_airmass\n");
+
+  clock_t start = clock();
+  while (t < duration)
+  {
+    script->getInputs(t, &inputs);
+
+    update_thermals(Global::dt * multiloop);
+    fdmi->update(&inputs, Global::dt, multiloop);
+    inputs.ClearKeys();
+    t     += Global::dt * multiloop;
+    steps += multiloop;
+
+    CRRCMath::Vector3 pos = fdm->getPos();
+    CRRCMath::Vector3 vel = fdm->getVel();
+    CRRCMath::Vector3 pqr = fdm->getPQR();
+    fprintf(out, "%.4f %.3f %.3f %.3f %.5f %.5f %.5f %.3f %.3f %.3f %.5f %.5f %.5f %.3f\n",
+            t, pos.r[0], pos.r[1], pos.r[2],
+            fdm->getPhi(), fdm->getTheta(), fdm->getPsi(),
+            vel.r[0], vel.r[1], vel.r[2],
+            pqr.r[0], pqr.r[1], pqr.r[2],
+            fdm->getVRelAirmass());
+  }
+  double wall = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (out != stdout)
+    fclose(out);
+
+  fprintf(stderr, "%ld steps, %.2f s simulated in %.2f s (%.1f x realtime)\n",
+          steps, t, wall, (wall > 0) ? t/wall : 0.0);
+
+  delete script;
+  delete Global::aircraft;
+  SDL_Quit();
+  return(CRRC_EXIT_SUCCESS);
+}
@@ -0,0 +1,1175 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_bench.cpp
+ *
+ *  Microbenchmarks for the code the flight model runs in every step
+ *  (crrcsim_bench).
+ *
+ *  Every scenery in scenery/ is loaded like crrcsim_batch does; the wind
+ *  functions and the terrain height lookup (the scenery's own and, for
+ *  model based sceneries, every HeightData implementation, point by
+ *  point and batched) are timed at a fixed set of positions around the
+ *  pilot. Then every airplane in models/ is loaded into that scenery and
+ *  the parts of its flight model are timed one by one: the equations of
+ *  motion (EOM01::ls_step(), ls_aux(), ls_accel()), aerodynamics, gear
+ *  and power system. For CRRC_AirplaneSim_Larcsim the wind samples its
+ *  wind patch takes per frame are counted (the patch is switched on for
+ *  this if it is off); they have to be less than the seven
+ *  CalculateWind() calls per frame made without it. Finally the whole
+ *  substep (FDMBase::update() including the controllers) is timed with a
+ *  key held down, and the heap allocations it makes are counted. There
+ *  must not be any; if there are, the program fails.
+ *
+ *  Before each benchmark the airplane is launched again, so every one of
+ *  them starts from the same state. Each benchmark is run several times,
+ *  the fastest run is reported.
+ *
+ *  The results are written as JSON, one benchmark per line and always in
+ *  the same order, so two result files can be compared with diff.
+ *
+ *  Optionally (-i), every integrator of EOM01 is compared at several
+ *  timesteps: the airplane flies for some seconds with fixed inputs and
+ *  without turbulence, the largest distance to a reference flight
+ *  (RK4 with a quarter of the timestep) is reported together with the
+ *  time it took per simulated second. Each of these flights is done in
+ *  the geocentric and in the flat frame of EOM01; if the two differ by
+ *  more than the geocentric frame's distortion explains, the program
+ *  fails.
+ */
+
+#include <crrc_config.h>
+#include "global.h"
+#include "defines.h"
+#include "crrc_main.h"
+#include "crrc_headless.h"
+#include "crrc_fdm.h"
+#include "aircraft.h"
+#include "config.h"
+#include "SimStateHandler.h"
+#include "mod_fdm/fdm.h"
+#include "mod_fdm/fdm_larcsim/fdm_larcsim.h"
+#include "mod_fdm/fdm_heli01/fdm_heli01.h"
+#include "mod_fdm/fdm_mcopter01/fdm_mcopter01.h"
+#include "mod_landscape/crrc_scenery.h"
+#include "mod_landscape/model_based_scenery.h"
+#include "mod_landscape/hd_ssgLOSterrain.h"
+#include "mod_landscape/hd_tabulatedterrain.h"
+#include "mod_landscape/hd_tilingterrain.h"
+#include "mod_windfield/windfield.h"
+#include "mod_misc/SimpleXMLTransfer.h"
+#include "mod_misc/filesystools.h"
+#include "mod_misc/ls_constants.h"
+#include "mod_misc/crrc_rand.h"
+#include "mod_misc/profiler.h"
+#include "mod_mode/T_GameHandler.h"
+
+#include <unistd.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <stdexcept>
+#include <new>
+
+extern char   *optarg;
+extern int    optind;
+
+#define OPTION_STRING "a:g:hi:l:n:o:r:s:v"
+
+/// @name Equivalence of EOM01::FRAME_FLAT and FRAME_GEOCENTRIC
+/// How far a flight in the flat frame may get from the same flight in the
+/// geocentric one. The geocentric frame stretches distances to the north
+/// by about the eccentricity squared of the earth (0.7%), so the allowed
+/// difference grows with the distance from the first sample.
+//@{
+#define FRAME_DIFF_REL 0.01
+#define FRAME_DIFF_FT  1.0
+//@}
+
+/**
+ * FDMEnviroment::CalculateWind() calls per frame without the wind patch
+ * (wind_patch_age < 0): one for the velocity, six for the gradient.
+ */
+#define WIND_STENCIL_SAMPLES 7
+
+/**
+ * Maximum sample age [s] the wind patch is measured with, unless
+ * simulation.flightModel.wind_patch_age is set. The patch is off by
+ * default.
+ */
+#define WIND_PATCH_AGE 0.05
+
+#if __cplusplus >= 201103L
+# define BENCH_THROW_BAD_ALLOC
+# define BENCH_THROW_NOTHING   noexcept
+#else
+# define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+# define BENCH_THROW_NOTHING   throw()
+#endif
+
+/// @name Heap allocation counter
+/// The global operator new is replaced to count the allocations the main
+/// thread makes while fCountAllocs is set.
+//@{
+static volatile bool fCountAllocs = false;
+static Uint32        count_thread = 0;
+static long          nAllocs      = 0;
+
+static void* countedAlloc(size_t size)
+{
+  if (fCountAllocs && SDL_ThreadID() == count_thread)
+    nAllocs++;
+
+  void* p = malloc(size ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return(p);
+}
+
+void* operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+  return(countedAlloc(size));
+}
+
+void* operator new[](size_t size) BENCH_THROW_BAD_ALLOC
+{
+  return(countedAlloc(size));
+}
+
+void operator delete(void* p) BENCH_THROW_NOTHING
+{
+  free(p);
+}
+
+void operator delete[](void* p) BENCH_THROW_NOTHING
+{
+  free(p);
+}
+
+static void startCountingAllocs()
+{
+  count_thread = SDL_ThreadID();
+  nAllocs      = 0;
+  fCountAllocs = true;
+}
+
+/**
+ * Returns the number of allocations since startCountingAllocs().
+ */
+static long stopCountingAllocs()
+{
+  fCountAllocs = false;
+  return(nAllocs);
+}
+//@}
+
+/**
+ * Runs the benchmarks and writes the results.
+ *
+ * This is a friend of the flight models and of ModelBasedScenery, as it
+ * calls parts of them which are private.
+ */
+class CRRC_Bench
+{
+  public:
+    /**
+     * \param out         results are written to this file
+     * \param iterations  calls per run of a benchmark
+     * \param runs        runs per benchmark, the fastest one is reported
+     */
+    CRRC_Bench(FILE* out, long iterations, int runs);
+
+    /**
+     * Writes the end of the results.
+     */
+    ~CRRC_Bench();
+
+    /**
+     * Wind and terrain benchmarks in the current scenery
+     * (Global::scenery), which has been loaded from <code>scenery</code>.
+     */
+    void runScenery(std::string scenery);
+
+    /**
+     * Flight model benchmarks for the current airplane (Global::aircraft),
+     * which has been loaded from <code>model</code>.
+     */
+    void runAirplane(std::string scenery, std::string model);
+
+    /**
+     * Accuracy and cost of the integrators for <code>model</code> in the
+     * current scenery, flying for <code>duration</code> seconds. Every
+     * flight is done in both frames of EOM01; if they differ more than
+     * FRAME_DIFF_REL and FRAME_DIFF_FT allow, the program fails.
+     */
+    void runAccuracy(std::string scenery, std::string model, double duration);
+
+    /**
+     * Number of benchmarks which allocated memory where they must not.
+     */
+    int getFailures() const { return(nFailures); };
+
+  private:
+    /**
+     * Positions the wind and terrain benchmarks are run at.
+     */
+    enum { NUM_POINTS = 1024 };
+
+    /**
+     * Points per call of the batched terrain lookup, about as many as an
+     * airplane has hardpoints.
+     */
+    enum { HEIGHT_BATCH = 8 };
+
+    /**
+     * Measures the time of <code>iterations</code> calls of something.
+     */
+    class Timer
+    {
+      public:
+        Timer() : best(-1) {};
+        void start() { t0 = CRRC_Profiler::now(); };
+
+        /**
+         * Ends one run of <code>n</code> calls.
+         */
+        void stop(long n)
+        {
+          double ns = (CRRC_Profiler::now() - t0) * 1000.0 / n;
+          if (best < 0 || ns < best)
+            best = ns;
+        };
+
+        double best;   ///< fastest run [ns per call]
+
+      private:
+        unsigned long long t0;
+    };
+
+    template <class FDM> void runEOM(FDM* fdm);
+    template <class FDM> void runWheels(FDM* fdm);
+    template <class FDM> void runPower(FDM* fdm, Power::Power* power);
+    void runSubstep();
+
+    /**
+     * Counts the wind samples the wind patch takes per frame of 1/60 s.
+     * If it isn't less than WIND_STENCIL_SAMPLES, the program fails.
+     */
+    void runWindPatch(CRRC_AirplaneSim_Larcsim* fdm);
+    void runAero(CRRC_AirplaneSim_Larcsim* fdm);
+    void runAero(CRRC_AirplaneSim_Heli01* fdm);
+
+    /**
+     * Times getHeightAndPlane() of <code>hd</code> point by point and
+     * getHeights() for HEIGHT_BATCH points at once, both per point.
+     */
+    void runHeightData(const char* name, HeightData* hd);
+
+    /**
+     * Flies a fresh instance of <code>model</code> for
+     * <code>duration</code> seconds with the integrator, frame and
+     * timestep given.
+     * The position is recorded every <code>sample_dt</code> seconds.
+     * Returns the time it took [ns per simulated second] or a negative
+     * value if the flight model doesn't use EOM01.
+     */
+    double fly(std::string model, EOM01::Integrator intgr, EOM01::Frame frame,
+               double dt, double duration, double sample_dt,
+               std::vector<CRRCMath::Vector3>& track);
+
+    /**
+     * Launches the airplane again and does one step, so every benchmark
+     * starts from the same state.
+     */
+    void reset();
+
+    /**
+     * Writes one result. The number of heap allocations per run is
+     * written too, unless <code>allocs</code> is negative.
+     */
+    void put(const char* name, double ns, long allocs = -1);
+
+    /**
+     * Writes a number of wind samples per frame.
+     */
+    void putSamples(const char* name, double samples);
+
+    /**
+     * Writes the result of one integrator in one frame at one timestep.
+     * The largest difference to the same flight in the geocentric frame
+     * is written too, unless <code>frame_diff_ft</code> is negative.
+     */
+    void putAccuracy(EOM01::Integrator intgr, EOM01::Frame frame, double dt,
+                     double err_ft, double ns, double frame_diff_ft = -1);
+
+    FILE*             out;
+    long              iterations;
+    int               runs;
+    bool              fFirst;
+    int               nFailures;
+    std::string       scenery;
+    std::string       model;
+    TSimInputs        inputs;
+
+    /// @name Positions around the pilot (north, east, down) [ft]
+    //@{
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    //@}
+
+    /**
+     * Results are summed up here, so the compiler can't drop the calls.
+     */
+    volatile double   sink;
+};
+
+CRRC_Bench::CRRC_Bench(FILE* out, long iterations, int runs)
+  : out(out), iterations(iterations), runs(runs), fFirst(true), nFailures(0), sink(0)
+{
+  inputs.aileron      = 0.1;
+  inputs.elevator     = -0.1;
+  inputs.rudder       = 0.05;
+  inputs.throttle     = 0.5;
+  inputs.flap         = 0;
+  inputs.spoiler      = 0;
+  inputs.retract      = 0;
+  inputs.pitch        = 0.2;
+  inputs.heli_fixed_z = EOM01_FIXED_Z_OFF;
+  for (int i=0; i<TSimInputs::NUM_AUX_INPUTS; i++)
+    inputs.aux[i] = 0;
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"iterations\": %ld,\n", iterations);
+  fprintf(out, "  \"runs\": %d,\n", runs);
+  fprintf(out, "  \"dt\": %g,\n", Global::dt);
+  fprintf(out, "  \"unit\": \"ns\",\n");
+  fprintf(out, "  \"results\": [\n");
+}
+
+CRRC_Bench::~CRRC_Bench()
+{
+  fprintf(out, "\n  ]\n}\n");
+}
+
+void CRRC_Bench::put(const char* name, double ns, long allocs)
+{
+  fprintf(out, "%s    {\"benchmark\": \"%s\", \"scenery\": \"%s\", \"model\": \"%s\", \"ns\": %.1f",
+          fFirst ? "" : ",\n", name, scenery.c_str(), model.c_str(), ns);
+  if (allocs >= 0)
+    fprintf(out, ", \"allocs\": %ld", allocs);
+  fprintf(out, "}");
+  fFirst = false;
+  fflush(out);
+
+  if (Global::nVerbosity)
+    fprintf(stderr, "%-40s %-28s %-24s %10.1f ns\n",
+            name, scenery.c_str(), model.c_str(), ns);
+}
+
+void CRRC_Bench::putSamples(const char* name, double samples)
+{
+  fprintf(out, "%s    {\"benchmark\": \"%s\", \"scenery\": \"%s\", \"model\": \"%s\", "
+          "\"samples_per_frame\": %.3f, \"stencil\": %d}",
+          fFirst ? "" : ",\n", name, scenery.c_str(), model.c_str(),
+          samples, WIND_STENCIL_SAMPLES);
+  fFirst = false;
+  fflush(out);
+
+  if (Global::nVerbosity)
+    fprintf(stderr, "%-40s %-28s %-24s %10.3f samples/frame\n",
+            name, scenery.c_str(), model.c_str(), samples);
+}
+
+void CRRC_Bench::putAccuracy(EOM01::Integrator intgr, EOM01::Frame frame, double dt,
+                             double err_ft, double ns, double frame_diff_ft)
+{
+  fprintf(out, "%s    {\"benchmark\": \"accuracy\", \"scenery\": \"%s\", \"model\": \"%s\", "
+          "\"integrator\": \"%s\", \"frame\": \"%s\", \"dt\": %g, \"err_ft\": %.6g, \"ns\": %.1f",
+          fFirst ? "" : ",\n", scenery.c_str(), model.c_str(),
+          EOM01::getIntegratorName(intgr), EOM01::getFrameName(frame), dt, err_ft, ns);
+  if (frame_diff_ft >= 0)
+    fprintf(out, ", \"frame_diff_ft\": %.6g", frame_diff_ft);
+  fprintf(out, "}");
+  fFirst = false;
+  fflush(out);
+
+  if (Global::nVerbosity)
+    fprintf(stderr, "accuracy %-10s %-10s dt=%-10g %-24s %12.6g ft %14.1f ns/s\n",
+            EOM01::getIntegratorName(intgr), EOM01::getFrameName(frame),
+            dt, model.c_str(), err_ft, ns);
+}
+
+void CRRC_Bench::runScenery(std::string scenery)
+{
+  this->scenery = scenery;
+  this->model   = "";
+
+  // positions within 600 ft of the pilot, 3 to 300 ft above ground
+  x.resize(NUM_POINTS);
+  y.resize(NUM_POINTS);
+  z.resize(NUM_POINTS);
+  srand(1);
+  for (int n=0; n<NUM_POINTS; n++)
+  {
+    x[n] = -player_pos.r[2] + 1200.0 * (rand() / (RAND_MAX + 1.0) - 0.5);
+    y[n] =  player_pos.r[0] + 1200.0 * (rand() / (RAND_MAX + 1.0) - 0.5);
+    z[n] = -Global::scenery->getHeight(x[n], y[n])
+           - 3 - 297.0 * rand() / (RAND_MAX + 1.0);
+  }
+
+  {
+    Timer  t;
+    double vn, ve, vd;
+    for (int r=0; r<runs; r++)
+    {
+      t.start();
+      for (long i=0; i<iterations; i++)
+      {
+        int n = i & (NUM_POINTS-1);
+        calculate_wind(x[n], y[n], z[n], vn, ve, vd);
+        sink += vd;
+      }
+      t.stop(iterations);
+    }
+    put("calculate_wind", t.best);
+  }
+
+  {
+    Timer              t;
+    CRRCMath::Matrix33 grad;
+    for (int r=0; r<runs; r++)
+    {
+      t.start();
+      for (long i=0; i<iterations; i++)
+      {
+        int n = i & (NUM_POINTS-1);
+        calculate_wind_grad(x[n], y[n], z[n], 2.0, grad);
+        sink += grad.v[2][2];
+      }
+      t.stop(iterations);
+    }
+    put("calculate_wind_grad", t.best);
+  }
+
+  {
+    Timer              t;
+    CRRCMath::Vector3  v_V_gust_body, v_R_omega_gust_body;
+    CRRCMath::Vector3  v_V_local_airmass(10, 5, 0);
+    CRRCMath::Matrix33 LocalToBody;
+    LocalToBody.v[0][0] = LocalToBody.v[1][1] = LocalToBody.v[2][2] = 1;
+
+    initialize_gust();
+    for (int r=0; r<runs; r++)
+    {
+      t.start();
+      for (long i=0; i<iterations; i++)
+      {
+        int n = i & (NUM_POINTS-1);
+        calculate_gust(Global::dt, -z[n], 40, 6, v_V_local_airmass, LocalToBody,
+                       v_V_gust_body, v_R_omega_gust_body);
+        sink += v_V_gust_body.r[0];
+      }
+      t.stop(iterations);
+    }
+    put("calculate_gust", t.best);
+  }
+
+  {
+    Timer t;
+    float tplane[4];
+    for (int r=0; r<runs; r++)
+    {
+      t.start();
+      for (long i=0; i<iterations; i++)
+      {
+        int n = i & (NUM_POINTS-1);
+        sink += Global::scenery->getHeightAndPlane(x[n], y[n], tplane);
+      }
+      t.stop(iterations);
+    }
+    put("Scenery::getHeightAndPlane", t.best);
+  }
+
+  // Every HeightData implementation on the scene graph of a model based
+  // scenery (built-in sceneries calculate their height themselves).
+  ModelBasedScenery* mbs = dynamic_cast<ModelBasedScenery*>(Global::scenery);
+  if (mbs != NULL)
+  {
+    HeightData* hd;
+
+    hd = new HD_SsgLOSTerrain(mbs->SceneGraph);
+    runHeightData("HD_SsgLOSTerrain", hd);
+    delete hd;
+
+    hd = new HD_TabulatedTerrain(mbs->SceneGraph);
+    runHeightData("HD_TabulatedTerrain", hd);
+    delete hd;
+
+    hd = new HD_TilingTerrain(mbs->SceneGraph);
+    runHeightData("HD_TilingTerrain", hd);
+    delete hd;
+  }
+}
+
+void CRRC_Bench::runHeightData(const char* name, HeightData* hd)
+{
+  {
+    Timer t;
+    float tplane[4];
+
+    for (int r=0; r<runs; r++)
+    {
+      t.start();
+      for (long i=0; i<iterations; i++)
+      {
+        int n = i & (NUM_POINTS-1);
+        sink += hd->getHeightAndPlane(x[n], y[n], tplane);
+      }
+      t.stop(iterations);
+    }
+    put((std::string(name) + "::getHeightAndPlane").c_str(), t.best);
+  }
+
+  {
+    Timer              t;
+    float              heights[HEIGHT_BATCH];
+    long               batches = iterations / HEIGHT_BATCH;
+    std::vector<float> xf(x.begin(), x.end());
+    std::vector<float> yf(y.begin(), y.end());
+
+    for (int r=0; r<runs; r++)
+    {
+      t.start();
+      for (long i=0; i<batches; i++)
+      {
+        int n = (i*HEIGHT_BATCH) & (NUM_POINTS-1);
+        hd->getHeights(&xf[n], &yf[n], heights, HEIGHT_BATCH);
+        sink += heights[0];
+      }
+      t.stop(batches*HEIGHT_BATCH);
+    }
+    put((std::string(name) + "::getHeights").c_str(), t.best);
+  }
+}
+
+void CRRC_Bench::reset()
+{
+  TSimInputs in = inputs;
+
+  initialize_flight_model();
+  Global::aircraft->getFDMInterface()->update(&in, Global::dt, 1);
+}
+
+void CRRC_Bench::runAirplane(std::string scenery, std::string model)
+{
+  this->scenery = scenery;
+  this->model   = model;
+
+  FDMBase* fdm = Global::aircraft->getFDM();
+
+  CRRC_AirplaneSim_Larcsim*   larcsim = dynamic_cast<CRRC_AirplaneSim_Larcsim*>(fdm);
+  CRRC_AirplaneSim_Heli01*    heli    = dynamic_cast<CRRC_AirplaneSim_Heli01*>(fdm);
+  CRRC_AirplaneSim_MCopter01* mcopter = dynamic_cast<CRRC_AirplaneSim_MCopter01*>(fdm);
+
+  if (larcsim != NULL)
+  {
+    runEOM(larcsim);
+    runAero(larcsim);
+    runWheels(larcsim);
+    runPower(larcsim, larcsim->power);
+    runWindPatch(larcsim);
+  }
+  else if (heli != NULL)
+  {
+    runEOM(heli);
+    runAero(heli);
+    runWheels(heli);
+    runPower(heli, heli->power);
+  }
+  else if (mcopter != NULL)
+  {
+    runEOM(mcopter);
+    runWheels(mcopter);
+    if (mcopter->power.size())
+      runPower(mcopter, mcopter->power[0]);
+  }
+  else
+    fprintf(stderr, "%s: no benchmarks for this flight model\n", model.c_str());
+
+  runSubstep();
+}
+
+void CRRC_Bench::runSubstep()
+{
+  Timer             t;
+  long              allocs = 0;
+  ModFDMInterface*  fdm    = Global::aircraft->getFDMInterface();
+
+  for (int r=0; r<runs; r++)
+  {
+    TSimInputs in = inputs;
+
+    reset();
+    startCountingAllocs();
+    t.start();
+    for (long i=0; i<iterations; i++)
+    {
+      // a key held down, the main loop adds it in every frame
+      in.AddKey(' ');
+      fdm->update(&in, Global::dt, 1);
+    }
+    t.stop(iterations);
+    allocs += stopCountingAllocs();
+    sink += Global::aircraft->getFDM()->getPos().r[2];
+  }
+  put("FDMBase::update", t.best, allocs / runs);
+
+  if (allocs)
+  {
+    fprintf(stderr, "%s: the substep loop allocated memory %ld times\n",
+            model.c_str(), allocs);
+    nFailures++;
+  }
+}
+
+void CRRC_Bench::runWindPatch(CRRC_AirplaneSim_Larcsim* fdm)
+{
+  TSimInputs in        = inputs;
+  int        multiloop = (int)floor(1.0/60 / Global::dt + 0.5);
+
+  if (multiloop < 1)
+    multiloop = 1;
+  long frames = iterations / multiloop;
+  if (frames < 1)
+    frames = 1;
+
+  // reset() initialises the patch with this age
+  double age = fdm->windpatchAge;
+  if (age < 0)
+    fdm->windpatchAge = WIND_PATCH_AGE;
+
+  reset();
+  unsigned long n0 = fdm->windpatch.getNumSamples();
+  for (long i=0; i<frames; i++)
+    fdm->update(&in, Global::dt, multiloop);
+  sink += fdm->v_P_CG_Rwy.r[2];
+
+  fdm->windpatchAge = age;
+  reset();
+
+  double samples = (double)(fdm->windpatch.getNumSamples() - n0) / frames;
+  putSamples("WindPatch::update", samples);
+
+  if (samples >= WIND_STENCIL_SAMPLES)
+  {
+    fprintf(stderr, "%s: the wind patch took %g samples per frame, not less than %d\n",
+            model.c_str(), samples, WIND_STENCIL_SAMPLES);
+    nFailures++;
+  }
+}
+
+template <class FDM> void CRRC_Bench::runEOM(FDM* fdm)
+{
+  const EOM01::Frame frames[] = { EOM01::FRAME_GEOCENTRIC,
+                                  EOM01::FRAME_FLAT };
+  EOM01::Frame       frame    = fdm->getFrame();
+
+  // one set of forces and wind, as in a step
+  CRRCMath::Vector3 v_V_local_airmass, v_V_gust_body;
+  CRRCMath::Vector3 v_F(0.1, 0, -1), v_M(0.01, 0.02, 0);
+
+  for (unsigned int f=0; f<sizeof(frames)/sizeof(frames[0]); f++)
+  {
+    // reset() initialises the state in this frame
+    fdm->setFrame(frames[f]);
+    std::string suffix = (frames[f] == EOM01::FRAME_GEOCENTRIC) ? "" : " (flat)";
+
+    {
+      Timer t;
+      for (int r=0; r<runs; r++)
+      {
+        reset();
+        t.start();
+        for (long i=0; i<iterations; i++)
+          fdm->ls_step(Global::dt);
+        t.stop(iterations);
+        sink += fdm->v_P_CG_Rwy.r[2];
+      }
+      put(("EOM01::ls_step" + suffix).c_str(), t.best);
+    }
+
+    {
+      Timer t;
+      for (int r=0; r<runs; r++)
+      {
+        reset();
+        t.start();
+        for (long i=0; i<iterations; i++)
+          fdm->ls_aux(v_V_local_airmass, v_V_gust_body);
+        t.stop(iterations);
+        sink += fdm->getVRelAirmass();
+      }
+      put(("EOM01::ls_aux" + suffix).c_str(), t.best);
+    }
+
+    {
+      Timer t;
+      for (int r=0; r<runs; r++)
+      {
+        reset();
+        t.start();
+        for (long i=0; i<iterations; i++)
+          fdm->ls_accel(v_F, v_M);
+        t.stop(iterations);
+        sink += fdm->v_V_dot_local.r[2];
+      }
+      put(("EOM01::ls_accel" + suffix).c_str(), t.best);
+    }
+  }
+
+  fdm->setFrame(frame);
+}
+
+void CRRC_Bench::runAero(CRRC_AirplaneSim_Larcsim* fdm)
+{
+  Timer              t;
+  TSimInputs         in = inputs;
+  CRRCMath::Matrix33 m_V_atmo_rwy;
+  CRRCMath::Vector3  v_R_omega_gust_body, v_F, v_M;
+
+  for (int r=0; r<runs; r++)
+  {
+    reset();
+    t.start();
+    for (long i=0; i<iterations; i++)
+    {
+      fdm->aero(&in, m_V_atmo_rwy, v_R_omega_gust_body, v_F, v_M);
+      sink += v_F.r[2];
+    }
+    t.stop(iterations);
+  }
+  put("CRRC_AirplaneSim_Larcsim::aero", t.best);
+}
+
+void CRRC_Bench::runAero(CRRC_AirplaneSim_Heli01* fdm)
+{
+  Timer             t;
+  TSimInputs        in = inputs;
+  CRRCMath::Vector3 v_F, v_M;
+
+  for (int r=0; r<runs; r++)
+  {
+    reset();
+    t.start();
+    for (long i=0; i<iterations; i++)
+    {
+      fdm->aero(Global::dt, &in, v_F, v_M);
+      sink += v_F.r[2];
+    }
+    t.stop(iterations);
+  }
+  put("CRRC_AirplaneSim_Heli01::aero", t.best);
+}
+
+template <class FDM> void CRRC_Bench::runWheels(FDM* fdm)
+{
+  Timer      t;
+  TSimInputs in = inputs;
+
+  for (int r=0; r<runs; r++)
+  {
+    reset();
+    t.start();
+    for (long i=0; i<iterations; i++)
+    {
+      fdm->wheels.update(&in, fdm->env, fdm->LocalToBody, fdm->v_P_CG_Rwy,
+                         fdm->v_R_omega_body, fdm->v_V_local_rel_ground, fdm->Psi);
+      sink += fdm->wheels.getForces().r[2];
+    }
+    t.stop(iterations);
+  }
+  put("WheelSystem::update", t.best);
+}
+
+template <class FDM> void CRRC_Bench::runPower(FDM* fdm, Power::Power* power)
+{
+  Timer      t;
+  TSimInputs in = inputs;
+
+  for (int r=0; r<runs; r++)
+  {
+    reset();
+    t.start();
+    for (long i=0; i<iterations; i++)
+    {
+      CRRCMath::Vector3 v_F, v_M;
+      power->step(Global::dt, &in, fdm->v_V_wind_body*FT_TO_M, &v_F, &v_M);
+      sink += v_F.r[0];
+    }
+    t.stop(iterations);
+  }
+  put("Power::Power::step", t.best);
+}
+
+void CRRC_Bench::runAccuracy(std::string scenery, std::string model, double duration)
+{
+  const EOM01::Integrator intgr[] = { EOM01::INTGR_AB2,
+                                      EOM01::INTGR_SYMPLECTIC,
+                                      EOM01::INTGR_RK4 };
+  const int               factor[] = { 1, 2, 3, 4 };
+
+  this->scenery = scenery;
+  this->model   = model;
+
+  // every timestep used divides this
+  double sample_dt = 12 * Global::dt;
+
+  std::vector<CRRCMath::Vector3> ref;
+  if (fly(model, EOM01::INTGR_RK4, EOM01::FRAME_GEOCENTRIC, Global::dt/4,
+          duration, sample_dt, ref) < 0)
+    return;
+
+  for (unsigned int i=0; i<sizeof(intgr)/sizeof(intgr[0]); i++)
+  {
+    for (unsigned int f=0; f<sizeof(factor)/sizeof(factor[0]); f++)
+    {
+      std::vector<CRRCMath::Vector3> track, flat;
+      double dt      = factor[f] * Global::dt;
+      double ns      = fly(model, intgr[i], EOM01::FRAME_GEOCENTRIC, dt,
+                           duration, sample_dt, track);
+      double ns_flat = fly(model, intgr[i], EOM01::FRAME_FLAT, dt,
+                           duration, sample_dt, flat);
+
+      double err      = 0;
+      double err_flat = 0;
+      for (unsigned int n=0; n<track.size() && n<ref.size(); n++)
+      {
+        double e = (track[n] - ref[n]).length();
+        if (e > err)
+          err = e;
+        e = (flat[n] - ref[n]).length();
+        if (e > err_flat)
+          err_flat = e;
+      }
+      putAccuracy(intgr[i], EOM01::FRAME_GEOCENTRIC, dt, err, ns);
+
+      // the same flight in both frames
+      double diff  = 0;
+      bool   fSame = true;
+      for (unsigned int n=0; n<track.size() && n<flat.size(); n++)
+      {
+        double d = (flat[n] - track[n]).length();
+        if (d > diff)
+          diff = d;
+        if (d > FRAME_DIFF_REL * (track[n] - track[0]).length() + FRAME_DIFF_FT)
+          fSame = false;
+      }
+      putAccuracy(intgr[i], EOM01::FRAME_FLAT, dt, err_flat, ns_flat, diff);
+
+      if (!fSame)
+      {
+        fprintf(stderr, "%s: %s, dt=%g: the flat frame differs from the geocentric one by up to %g ft\n",
+                model.c_str(), EOM01::getIntegratorName(intgr[i]), dt, diff);
+        nFailures++;
+      }
+    }
+  }
+}
+
+double CRRC_Bench::fly(std::string model, EOM01::Integrator intgr, EOM01::Frame frame,
+                       double dt, double duration, double sample_dt,
+                       std::vector<CRRCMath::Vector3>& track)
+{
+  WindField       windfield;
+  CRRC_FDM_Env    env(cfgfile, &windfield);
+  ModFDMInterface fdmi;
+  TSimInputs      in = inputs;
+
+  // same wind as the benchmarks, but no turbulence: it would look
+  // different at every timestep
+  windfield.setWind(cfg->wind->getVelocity(), cfg->wind->getDirection(), 0);
+  windfield.init(cfg->getCurLocCfgPtr(cfgfile));
+
+  fdmi.loadAirplane(FileSysTools::getDataPath(model).c_str(), &env, cfgfile);
+
+  EOM01* eom = dynamic_cast<EOM01*>(fdmi.fdm);
+  if (eom == NULL)
+    return(-1);
+  eom->setIntegrator(intgr);
+  eom->setFrame(frame);
+
+  // launch like initialize_flight_model() does, but high enough not to
+  // touch the ground
+  double psi      = cfg->wind->getDirection()*M_PI/180;
+  double launchx  = cfgfile->getDouble("launch.rel_front", MODELSTART_REL_FRONT);
+  double launchy  = cfgfile->getDouble("launch.rel_right", MODELSTART_REL_RIGHT);
+  double posX     = -player_pos.r[2] + launchx*cos(psi) - launchy*sin(psi);
+  double posY     =  player_pos.r[0] + launchx*sin(psi) + launchy*cos(psi);
+  double altitude = cfgfile->getDouble("launch.altitude", 6) + 300
+                    + eom->getZLow() + Global::scenery->getHeight(posX, posY);
+
+  fdmi.initAirplaneState(cfgfile->getDouble("launch.velocity_rel", 1), 0.0,
+                         cfgfile->getDouble("launch.angle", 0), psi,
+                         posX, posY, -1*altitude);
+
+  int  steps_per_sample = (int)floor(sample_dt / dt + 0.5);
+  long samples          = (long)(duration / sample_dt);
+
+  track.clear();
+  unsigned long long t0 = CRRC_Profiler::now();
+  for (long n=0; n<samples; n++)
+  {
+    // thermals are moved once per sample, so they are the same in all runs
+    windfield.updateThermals(sample_dt);
+    fdmi.update(&in, dt, steps_per_sample);
+    track.push_back(eom->getPos());
+  }
+  double ns = (CRRC_Profiler::now() - t0) * 1000.0 / (samples * sample_dt);
+
+  return(ns);
+}
+
+/*****************************************************************************/
+
+/**
+ * All xml files in <code>dirname</code> (searched like any other data),
+ * sorted, with the directory in front (e.g. "models/allegro.xml").
+ */
+static std::vector<std::string> listDataFiles(std::string dirname)
+{
+  std::set<std::string>    files;
+  std::vector<std::string> paths;
+
+  FileSysTools::getSearchPathList(paths, dirname);
+  for (unsigned int i=0; i<paths.size(); i++)
+  {
+    DIR* dir = opendir(paths[i].c_str());
+    if (dir == NULL)
+      continue;
+
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+      std::string name = ent->d_name;
+      if (name.length() > 4 && name.substr(name.length()-4) == ".xml")
+        files.insert(dirname + "/" + name);
+    }
+    closedir(dir);
+  }
+
+  return(std::vector<std::string>(files.begin(), files.end()));
+}
+
+static void bench_usage(char *progname)
+{
+  fprintf(stderr,"\nUsage  : %s [options]\n",progname);
+  fprintf(stderr,  "Options:\n");
+  fprintf(stderr,  "         -h             : display this message\n");
+  fprintf(stderr,  "         -g <string>    : specify config file\n");
+  fprintf(stderr,  "         -i <value>     : compare integrators, flying for this many seconds\n");
+  fprintf(stderr,  "         -l <string>    : only this location/scenery file (e.g. scenery/davis.xml)\n");
+  fprintf(stderr,  "         -a <string>    : only this airplane file (e.g. models/allegro.xml)\n");
+  fprintf(stderr,  "         -o <string>    : output file (default: crrcsim_bench.json)\n");
+  fprintf(stderr,  "         -n <value>     : calls per run (default: 20000)\n");
+  fprintf(stderr,  "         -r <value>     : runs per benchmark (default: 3)\n");
+  fprintf(stderr,  "         -s <value>     : FDM timestep in s (default: simulation.flightModel.dt)\n");
+  fprintf(stderr,  "         -v             : print results to stderr, too\n");
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> airplane_files;
+  std::vector<std::string> location_files;
+  std::string output_file = "crrcsim_bench.json";
+  long        iterations  = 20000;
+  int         runs        = 3;
+  double      dt          = 0;
+  double      duration    = 0;
+  int         c;
+
+  // the config file has to be known before T_Config is created
+  for (int i = 1; i < argc - 1; i++)
+  {
+    if (!strcmp(argv[i], "-g"))
+      T_Config::putConfigFilePath(argv[i+1]);
+  }
+
+  FileSysTools::SetAppname("crrcsim");
+  SDL_Init(0);
+
+  try
+  {
+    cfg = new T_Config(cfgfile);
+    cfg->read(cfgfile);
+    cfgfile->setAttributeOverwrite("video.enabled", "0");
+    cfgfile->setAttributeOverwrite("sound.enabled", "0");
+  }
+  catch (XMLException e)
+  {
+    std::string s = "XMLException: ";
+    s += e.what();
+    crrc_exit(CRRC_EXIT_FAILURE, s.c_str());
+  }
+
+  while ((c = getopt(argc, argv, OPTION_STRING)) != -1)
+  {
+    switch (c)
+    {
+      case 'a':
+        airplane_files.push_back(optarg);
+        break;
+      case 'g':
+        // handled above
+        break;
+      case 'i':
+        duration = atof(optarg);
+        break;
+      case 'l':
+        location_files.push_back(optarg);
+        break;
+      case 'n':
+        iterations = atol(optarg);
+        break;
+      case 'o':
+        output_file = optarg;
+        break;
+      case 'r':
+        runs = atoi(optarg);
+        break;
+      case 's':
+        dt = atof(optarg);
+        break;
+      case 'v':
+        Global::nVerbosity++;
+        break;
+      default:
+        bench_usage(argv[0]);
+        return(CRRC_EXIT_FAILURE);
+    }
+  }
+  if (iterations < 1)
+    iterations = 1;
+  if (runs < 1)
+    runs = 1;
+
+  if (airplane_files.size() == 0)
+    airplane_files = listDataFiles("models");
+  if (location_files.size() == 0)
+    location_files = listDataFiles("scenery");
+
+  CRRC_Random::setSeed(1);
+  Global::wind_mode = cfgfile->getInt("wind_mode.fUse", 2);
+  Global::dt        = (dt > 0) ? dt : cfgfile->getDouble("simulation.flightModel.dt", 0.002777);
+
+  Global::Simulation  = new SimStateHandler();
+  Global::aircraft    = new Aircraft();
+  Global::gameHandler = new T_GameHandler();
+  headless_fdmenv = new CRRC_FDM_Env(cfgfile);
+
+  // Loading sceneries and airplanes writes to stdout, so the results
+  // always go to a file.
+  FILE* out = fopen(output_file.c_str(), "w");
+  if (out == NULL)
+    crrc_exit(CRRC_EXIT_FAILURE, ("Unable to open " + output_file).c_str());
+
+  int nFailed = 0;
+  {
+    CRRC_Bench bench(out, iterations, runs);
+
+    for (unsigned int l=0; l<location_files.size(); l++)
+    {
+      try
+      {
+        cfg->setLocation(location_files[l].c_str(), cfgfile);
+        Global::scenery = loadScenery(FileSysTools::getDataPath(location_files[l]).c_str(),
+                                      cfg->getSkyVariant());
+      }
+      catch (XMLException e)
+      {
+        fprintf(stderr, "%s: %s\n", location_files[l].c_str(), e.what());
+        Global::scenery = NULL;
+      }
+      if (Global::scenery == NULL)
+      {
+        fprintf(stderr, "%s: unable to load scenery\n", location_files[l].c_str());
+        nFailed++;
+        continue;
+      }
+      cfg->wind->read(cfgfile, cfg);
+      player_pos = Global::scenery->getPlayerPosition();
+      Init_mod_windfield();
+
+      bench.runScenery(location_files[l]);
+
+      for (unsigned int a=0; a<airplane_files.size(); a++)
+      {
+        try
+        {
+          cfgfile->setAttributeOverwrite("airplane.file",
+                                         FileSysTools::getDataPath(airplane_files[a]));
+          loadAirplane();
+          initialize_flight_model();
+        }
+        catch (XMLException e)
+        {
+          fprintf(stderr, "%s: %s\n", airplane_files[a].c_str(), e.what());
+          nFailed++;
+          continue;
+        }
+        catch (std::runtime_error& e)
+        {
+          fprintf(stderr, "%s: %s\n", airplane_files[a].c_str(), e.what());
+          nFailed++;
+          continue;
+        }
+
+        bench.runAirplane(location_files[l], airplane_files[a]);
+        if (duration > 0)
+        {
+          try
+          {
+            bench.runAccuracy(location_files[l], airplane_files[a], duration);
+          }
+          catch (XMLException e)
+          {
+            fprintf(stderr, "%s: %s\n", airplane_files[a].c_str(), e.what());
+            nFailed++;
+          }
+        }
+      }
+
+      clear_wind_field();
+      delete Global::scenery;
+      Global::scenery = NULL;
+    }
+    nFailed += bench.getFailures();
+  }
+  fclose(out);
+
+  delete Global::aircraft;
+  SDL_Quit();
+  return(nFailed ? CRRC_EXIT_FAILURE : CRRC_EXIT_SUCCESS);
+}
@@ -30,11 +30,14 @@
 #include "mod_env/earth/ls_gravity.h"
 #include "mod_fdm/fdm.h"
 
-CRRC_FDM_Env::CRRC_FDM_Env(SimpleXMLTransfer* cfg)
+CRRC_FDM_Env::CRRC_FDM_Env(SimpleXMLTransfer* cfg, WindField* windfield)
 {
+  if (windfield == NULL)
+    windfield = default_wind_field();
+  this->windfield = windfield;
+
   // instantiate list of controllers from global config file,
   // so these controllers are used no matter which model is loaded
-  controllers.clear();  
   int idx = cfg->indexOfChild("controllers");
   if (idx >= 0)
     Controller::LoadList(cfg->getChildAt(idx), controllers);
@@ -45,22 +48,28 @@ float CRRC_FDM_Env::GetSceneryHeight(float x_north, float y_east)
   return(Global::scenery->getHeight(x_north, y_east));
 }
 
+void CRRC_FDM_Env::GetSceneryHeights(const float* x_north, const float* y_east,
+                                     float* heights, int n)
+{
+  Global::scenery->getHeights(x_north, y_east, heights, n);
+}
+
 int CRRC_FDM_Env::CalculateWind(double  X_cg,      double  Y_cg,     double  Z_cg,
                                 double& Vel_north, double& Vel_east, double& Vel_down)
 {
-  return(calculate_wind(X_cg,      Y_cg,     Z_cg,
-                        Vel_north, Vel_east, Vel_down));
+  return(windfield->calculateWind(X_cg,      Y_cg,     Z_cg,
+                                  Vel_north, Vel_east, Vel_down));
 }
 
 int CRRC_FDM_Env::CalculateWindGrad(double X_cg, double Y_cg, double Z_cg, double delta_space,
                                     CRRCMath::Matrix33& m_V_grad)
 {
-  return(calculate_wind_grad(X_cg, Y_cg, Z_cg, delta_space, m_V_grad));
+  return(windfield->calculateWindGrad(X_cg, Y_cg, Z_cg, delta_space, m_V_grad));
 }
 
 void CRRC_FDM_Env::InitializeWindGust()
 {
-  initialize_gust();
+  windfield->initializeGust();
 }
 
 void CRRC_FDM_Env::CalculateWindGust(double dt, double altitude, double V_rel_wind, double b,
@@ -69,8 +78,8 @@ void CRRC_FDM_Env::CalculateWindGust(double dt, double altitude, double V_rel_wi
                                      CRRCMath::Vector3& v_V_gust_body,
                                      CRRCMath::Vector3& v_R_omega_gust_body)
 {
-  calculate_gust(dt, altitude, V_rel_wind, b, v_V_local_airmass, LocalToBody,
-                 v_V_gust_body, v_R_omega_gust_body);
+  windfield->calculateGust(dt, altitude, V_rel_wind, b, v_V_local_airmass, LocalToBody,
+                           v_V_gust_body, v_R_omega_gust_body);
 }
 
 double CRRC_FDM_Env::GetRho(double altitude)
@@ -92,20 +101,16 @@ void CRRC_FDM_Env::ControllerCallback(double      dt,
   pInputsToFDM->CopyFrom(pInputsFromUser);
 
   // Process controllers
-  for (unsigned int n=0; n<controllers.size(); n++)
-    controllers[n]->Calc(dt, fdm, pInputsFromUser, pInputsToFDM);
+  controllers.Calc(dt, fdm, pInputsFromUser, pInputsToFDM);
 }
 
 void CRRC_FDM_Env::ResetControllers()
 {
-  for (unsigned int n=0; n<controllers.size(); n++)
-    controllers[n]->Reset();
+  controllers.Reset();
 }
 
 CRRC_FDM_Env::~CRRC_FDM_Env()
 {
-  for (unsigned int n=0; n<controllers.size(); n++)
-    delete controllers[n];
 }
 
 void CRRC_FDM_Env::AddLogMsg(std::string message)
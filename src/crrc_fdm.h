@@ -28,6 +28,8 @@
 #include "mod_fdm/fdm_env.h"
 #include "mod_cntrl/controller.h"
 
+class WindField;
+
 /**
  * Connects CRRCSim to the module "FDM"
  * 
@@ -37,7 +39,11 @@ class CRRC_FDM_Env : public FDMEnviroment
 {
 public:
 
-  CRRC_FDM_Env(SimpleXMLTransfer* cfg);
+  /**
+   * <code>windfield</code> is the windfield the aircraft flies in. If it is
+   * NULL, the default windfield (the one displayed by crrcsim) is used.
+   */
+  CRRC_FDM_Env(SimpleXMLTransfer* cfg, WindField* windfield = NULL);
   virtual ~CRRC_FDM_Env();
   
   /**
@@ -47,6 +53,12 @@ public:
    *  \return terrain height at this point in ft
    */
   virtual float GetSceneryHeight(float x_north, float y_east);
+
+  /**
+   *  Get the height at <code>n</code> points at once.
+   */
+  virtual void GetSceneryHeights(const float* x_north, const float* y_east,
+                                 float* heights, int n);
   
   /**
    * Calculate the wind velocities in all three axes in the given position.
@@ -102,10 +114,15 @@ public:
   
 private:
   
+  /**
+   * Thermals, wind and turbulence
+   */
+  WindField* windfield;
+
   /**
    * List of active controllers
    */
-  std::vector<Controller*> controllers;
+  ControllerPipeline controllers;
 };
 
 #endif
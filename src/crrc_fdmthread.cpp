@@ -0,0 +1,272 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_fdmthread.cpp
+ *
+ *  Runs the flight model of the aircraft on a thread of its own, see
+ *  crrc_fdmthread.h
+ */
+#include "crrc_fdmthread.h"
+
+#include <math.h>
+#include "global.h"
+#include "aircraft.h"
+#include "SimStateHandler.h"
+#include "mod_fdm/fdm.h"
+#include "mod_inputdev/inputdev.h"
+#include "mod_misc/profiler.h"
+
+/**
+ * Interpolates between two angles, taking the short way round.
+ */
+static double lerpAngle(double a, double b, double f)
+{
+  double d = b - a;
+
+  if (d > M_PI)
+    d -= 2*M_PI;
+  else if (d < -M_PI)
+    d += 2*M_PI;
+
+  return(a + d*f);
+}
+
+
+FDMThread::FDMThread()
+  : thread(NULL), thread_id(0), fQuit(false), steps(0)
+{
+  mutex = SDL_CreateMutex();
+}
+
+FDMThread::~FDMThread()
+{
+  Stop();
+  for (unsigned int n=0; n<events.size(); n++)
+    delete events[n];
+  SDL_DestroyMutex(mutex);
+}
+
+void FDMThread::Start()
+{
+  if (thread != NULL)
+    return;
+
+  FDMSnapshot s;
+  ReadFDM(s);
+  Publish(s, s, SDL_GetTicks(), Global::dt*1000);
+
+  fQuit = false;
+  EventDispatcher::getInstance()->setFilter(this);
+  thread = SDL_CreateThread(ThreadFunc, this);
+  // The thread won't step before the lock is released
+  thread_id = SDL_GetThreadID(thread);
+}
+
+void FDMThread::Stop()
+{
+  if (thread == NULL)
+    return;
+
+  fQuit = true;
+  SDL_WaitThread(thread, NULL);
+  thread    = NULL;
+  thread_id = 0;
+  EventDispatcher::getInstance()->setFilter(NULL);
+}
+
+void FDMThread::SetInputs(TSimInputs* in)
+{
+  inputs.CopyFrom(in);
+}
+
+int FDMThread::TakeSteps()
+{
+  int n = steps;
+
+  steps = 0;
+  return(n);
+}
+
+void FDMThread::RaiseEvents()
+{
+  std::vector<Event*> ev;
+
+  ev.swap(events);
+  for (unsigned int n=0; n<ev.size(); n++)
+  {
+    EventDispatcher::getInstance()->raise(ev[n]);
+    delete ev[n];
+  }
+}
+
+bool FDMThread::operator()(const Event* ev)
+{
+  if (thread == NULL || SDL_ThreadID() != thread_id)
+    return(false);
+
+  events.push_back(ev->clone());
+  return(true);
+}
+
+void FDMThread::GetSnapshot(FDMSnapshot& snapshot)
+{
+  frames.Update();
+
+  const Frame& f = frames.Front();
+  double       a = (SDL_GetTicks() - f.t) / f.dt;
+
+  if (a < 0)
+    a = 0;
+  else if (a > 1)
+    a = 1;
+
+  snapshot.pos          = f.prev.pos + (f.cur.pos - f.prev.pos)*a;
+  snapshot.bat_cap_left = f.cur.bat_cap_left;
+
+  // Close to theta = +-90 degrees, phi and psi may jump by 180 degrees
+  // within one step. Don't interpolate the attitude in this case.
+  double dphi = lerpAngle(f.prev.phi, f.cur.phi, 1) - f.prev.phi;
+  double dpsi = lerpAngle(f.prev.psi, f.cur.psi, 1) - f.prev.psi;
+  if (fabs(dphi) > M_PI/2 || fabs(dpsi) > M_PI/2)
+  {
+    snapshot.phi   = f.cur.phi;
+    snapshot.theta = f.cur.theta;
+    snapshot.psi   = f.cur.psi;
+  }
+  else
+  {
+    snapshot.phi   = lerpAngle(f.prev.phi, f.cur.phi, a);
+    snapshot.theta = f.prev.theta + (f.cur.theta - f.prev.theta)*a;
+    snapshot.psi   = lerpAngle(f.prev.psi, f.cur.psi, a);
+  }
+}
+
+void FDMThread::GetAircraftSnapshot(FDMSnapshot& snapshot)
+{
+  if (Global::fdmThread != NULL)
+    Global::fdmThread->GetSnapshot(snapshot);
+  else
+    ReadFDM(snapshot);
+}
+
+int FDMThread::ThreadFunc(void* data)
+{
+  ((FDMThread*)data)->Run();
+  return(0);
+}
+
+void FDMThread::Run()
+{
+  double next = SDL_GetTicks();
+
+  CRRC_Profiler::setThreadName("fdm");
+
+  while (!fQuit)
+  {
+    Uint32 now = SDL_GetTicks();
+
+    if (now < next)
+    {
+      SDL_Delay(1);
+      continue;
+    }
+
+    Lock();
+    double dt_ms = Global::dt*1000;
+    if (IsRunning())
+    {
+      if (now - next > MAX_LAG)
+        next = now;
+
+      FDMSnapshot prev;
+      FDMSnapshot cur;
+      while (next <= now)
+      {
+        // the control positions as they were when this step was due
+        if (Global::TXInterface != NULL)
+          Global::TXInterface->getInputDataAt(next, &inputs);
+
+        ReadFDM(prev);
+        Global::aircraft->getFDMInterface()->update(&inputs, Global::dt, 1);
+        inputs.ClearKeys();
+        steps++;
+        next += dt_ms;
+      }
+      ReadFDM(cur);
+      Publish(prev, cur, next - dt_ms, dt_ms);
+    }
+    else
+    {
+      // paused, crashed, ...: show changes made by the main loop (reset,
+      // another airplane) and drop old control positions
+      if (Global::TXInterface != NULL)
+        Global::TXInterface->getInputDataAt(now, &inputs);
+
+      FDMSnapshot cur;
+      ReadFDM(cur);
+      Publish(cur, cur, now, dt_ms);
+      next = now + dt_ms;
+    }
+    Unlock();
+  }
+
+  CRRC_Profiler::endThread();
+}
+
+bool FDMThread::IsRunning()
+{
+  if (Global::aircraft->getFDM() == NULL)
+    return(false);
+
+  return(Global::testmode.test_mode ||
+         Global::Simulation->getState() == STATE_RUN);
+}
+
+void FDMThread::ReadFDM(FDMSnapshot& snapshot)
+{
+  FDMBase* fdm = Global::aircraft->getFDM();
+
+  if (fdm == NULL)
+  {
+    snapshot.pos          = CRRCMath::Vector3();
+    snapshot.phi          = 0;
+    snapshot.theta        = 0;
+    snapshot.psi          = 0;
+    snapshot.bat_cap_left = 0;
+    return;
+  }
+
+  snapshot.pos          = fdm->getPos();
+  snapshot.phi          = fdm->getPhi();
+  snapshot.theta        = fdm->getTheta();
+  snapshot.psi          = fdm->getPsi();
+  snapshot.bat_cap_left = fdm->getBatCapLeft();
+}
+
+void FDMThread::Publish(const FDMSnapshot& prev, const FDMSnapshot& cur,
+                        double t, double dt)
+{
+  Frame& f = frames.Back();
+
+  f.prev = prev;
+  f.cur  = cur;
+  f.t    = t;
+  f.dt   = dt;
+  frames.Publish();
+}
@@ -0,0 +1,180 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_fdmthread.h
+ *
+ *  Runs the flight model of the aircraft on a thread of its own.
+ */
+#ifndef CRRC_FDMTHREAD_H
+#define CRRC_FDMTHREAD_H
+
+#include <vector>
+#include <SDL.h>
+#include <SDL_thread.h>
+#include "mod_fdm/fdm_inputs.h"
+#include "mod_main/EventDispatcher.h"
+#include "mod_math/vector3.h"
+#include "mod_misc/triple_buffer.h"
+
+/**
+ * What is needed to draw the aircraft.
+ */
+struct FDMSnapshot
+{
+  CRRCMath::Vector3 pos;          ///< position [ft]
+  double            phi;          ///< Euler angles [rad]
+  double            theta;
+  double            psi;
+  double            bat_cap_left; ///< see FDMBase::getBatCapLeft()
+};
+
+/**
+ * Integrates the equations of motion of the aircraft (Global::aircraft)
+ * every Global::dt seconds on a thread of its own, independent of the
+ * frame rate.
+ *
+ * The main loop and the flight model share a lot of state (the FDM itself,
+ * the windfield, the scenery, the game mode, ...), so they don't run at
+ * the same time: the thread only steps the FDM while holding the lock,
+ * which the main loop holds during everything except drawing, swapping
+ * buffers and waiting for the next frame. Drawing takes it again for the
+ * short parts which ask the scenery or the windfield (shadow, wind
+ * vectors, thermals, game mode). So a slow frame no longer
+ * results in a burst of FDM steps with stale inputs; the FDM keeps on
+ * running while the frame is drawn.
+ *
+ * To draw the aircraft without holding the lock, every step publishes an
+ * FDMSnapshot through a triple buffer. GetSnapshot() interpolates between
+ * the states before and after the latest step, one step behind the wall
+ * clock, so the motion on the screen is smooth although frames and steps
+ * aren't aligned.
+ *
+ * If the input device is read on a thread of its own (see
+ * T_TX_Interface::startInputThread()), every step uses the control
+ * positions which were current when the step was due instead of the ones
+ * passed by SetInputs().
+ *
+ * Events raised by the flight model (crashes, log messages) are queued
+ * and raised on the main thread by RaiseEvents().
+ */
+class FDMThread : public EventFilter
+{
+  public:
+    FDMThread();
+
+    /**
+     * Stops the thread. Don't call while holding the lock.
+     */
+    ~FDMThread();
+
+    /**
+     * Starts the thread. Call while holding the lock.
+     */
+    void Start();
+
+    /**
+     * Stops the thread. Don't call while holding the lock.
+     */
+    void Stop();
+
+    /// @name Held by the main loop while it touches the simulation
+    //@{
+    void Lock()   { SDL_mutexP(mutex); };
+    void Unlock() { SDL_mutexV(mutex); };
+    //@}
+
+    /**
+     * Control inputs for the next steps. Keys are consumed by the next step.
+     * Call while holding the lock.
+     */
+    void SetInputs(TSimInputs* in);
+
+    /**
+     * Number of steps done since the last call. Call while holding the lock.
+     */
+    int TakeSteps();
+
+    /**
+     * Raises the events the flight model raised since the last call. Call
+     * while holding the lock.
+     */
+    void RaiseEvents();
+
+    /**
+     * The aircraft as it is to be drawn now. Call on the main thread, the
+     * lock is not needed.
+     */
+    void GetSnapshot(FDMSnapshot& snapshot);
+
+    /**
+     * Like GetSnapshot() if the thread is running (Global::fdmThread),
+     * otherwise reads the current state of the FDM.
+     */
+    static void GetAircraftSnapshot(FDMSnapshot& snapshot);
+
+    /**
+     * Queues the events raised on the FDM thread.
+     */
+    bool operator()(const Event* ev);
+
+  private:
+    /**
+     * Published after every step.
+     */
+    struct Frame
+    {
+      FDMSnapshot prev;   ///< state before the step
+      FDMSnapshot cur;    ///< state after the step
+      double      t;      ///< when cur is due [ms, SDL_GetTicks()]
+      double      dt;     ///< length of the step [ms]
+    };
+
+    /**
+     * Falling behind more than this [ms] (lock held for a long time by the
+     * main loop), the FDM doesn't try to catch up, but slows down.
+     */
+    enum { MAX_LAG = 200 };
+
+    static int ThreadFunc(void* data);
+
+    void Run();
+
+    bool IsRunning();
+
+    static void ReadFDM(FDMSnapshot& snapshot);
+
+    void Publish(const FDMSnapshot& prev, const FDMSnapshot& cur,
+                 double t, double dt);
+
+    SDL_Thread*   thread;
+    Uint32        thread_id;
+    SDL_mutex*    mutex;
+    volatile bool fQuit;
+
+    /// @name Protected by the lock
+    //@{
+    TSimInputs          inputs;
+    int                 steps;
+    std::vector<Event*> events;
+    //@}
+
+    TripleBuffer<Frame> frames;
+};
+
+#endif // CRRC_FDMTHREAD_H
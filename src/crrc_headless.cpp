@@ -0,0 +1,114 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_headless.cpp
+ *
+ *  Stand-ins for what crrc_main.cpp provides, see crrc_headless.h
+ */
+
+#include <crrc_config.h>
+#include "global.h"
+#include "defines.h"
+#include "crrc_headless.h"
+#include "aircraft.h"
+#include "config.h"
+#include "mod_landscape/crrc_scenery.h"
+#include "mod_windfield/windfield.h"
+#include "mod_misc/lib_conversions.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+CTime   *crrc_time = NULL;
+CRRCMath::Vector3 player_pos;
+T_VariometerSound *vario_sound = NULL;
+int vario_sound_channel = -1;
+
+FDMEnviroment* headless_fdmenv = 0;
+
+void activate_test_mode()
+{
+}
+
+void leave_test_mode()
+{
+}
+
+std::string reconfigureInputMethod(bool boRevertToMouse)
+{
+  return("");
+}
+
+void set_aux(int aux_num, int setting)
+{
+}
+
+void Init_mod_windfield()
+{
+  initialize_wind_field(cfg->getCurLocCfgPtr(cfgfile));
+  cfg->checkDynamicSoaring();
+}
+
+void loadAirplane()
+{
+  Global::aircraft->load(cfgfile, headless_fdmenv);
+}
+
+void write_globals_into_config()
+{
+  cfgfile->setAttributeOverwrite("wind_mode.fUse", Global::wind_mode);
+  cfgfile->setAttributeOverwrite("simulation.flightModel.dt",
+                                 doubleToString(Global::dt));
+}
+
+void crrc_exit(int exit_code, const char *errmsg)
+{
+  if ((errmsg != NULL) && (*errmsg != '\0'))
+    fprintf(stderr, "%s\n", errmsg);
+  exit(exit_code);
+}
+
+/**
+ * Launch the airplane according to the launch.* settings, relative to the
+ * player position (there is no start position selection in batch mode).
+ */
+void initialize_flight_model()
+{
+  double velocity_rel   = cfgfile->getDouble("launch.velocity_rel", 1);
+  double wind_direction = cfg->wind->getDirection()*M_PI/180;
+  double launchx        = cfgfile->getDouble("launch.rel_front", MODELSTART_REL_FRONT);
+  double launchy        = cfgfile->getDouble("launch.rel_right", MODELSTART_REL_RIGHT);
+  double posX = -player_pos.r[2] + launchx*cos(wind_direction) - launchy*sin(wind_direction);
+  double posY =  player_pos.r[0] + launchx*sin(wind_direction) + launchy*cos(wind_direction);
+  double theta = cfgfile->getDouble("launch.angle", 0);
+  double altitude = cfgfile->getDouble("launch.altitude", 6);
+
+  altitude += Global::aircraft->getFDM()->getZLow()
+            + Global::scenery->getHeight(posX, posY);
+
+  Global::aircraft->getFDMInterface()->initAirplaneState(velocity_rel,
+                                                         0.0,
+                                                         theta,
+                                                         wind_direction,
+                                                         posX,
+                                                         posY,
+                                                         -1*altitude);
+}
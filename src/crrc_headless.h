@@ -0,0 +1,38 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_headless.h
+ *
+ *  The functions and variables crrc_main.cpp exports to the rest of the
+ *  program (see crrc_main.h), for programs which are linked against the
+ *  same objects as crrcsim, but run without video, sound, GUI or input
+ *  devices (crrcsim_batch, crrcsim_bench).
+ */
+#ifndef CRRC_HEADLESS_H
+#define CRRC_HEADLESS_H
+
+#include "crrc_main.h"
+
+/**
+ * The FDM environment used by loadAirplane(). It has to be created by
+ * the program before an airplane is loaded.
+ */
+extern FDMEnviroment* headless_fdmenv;
+
+#endif
@@ -217,17 +217,15 @@ void CRRCAirplaneV2::initSound(SimpleXMLTransfer* xml)
  *
  *  This method actually does not draw anything. It only
  *  updates the aircraft's visualization with the
- *  aircraft's current position and orientation. The actual
+ *  aircraft's position and orientation. The actual
  *  drawing handled internally by mod_video.
  *
- *  \param airplane pointer to the airplane's FDM object
+ *  \param pos   position
+ *  \param phi   Euler angles
  */
-void CRRCAirplaneV2::draw(FDMBase* airplane)
+void CRRCAirplaneV2::draw(CRRCMath::Vector3 const& pos,
+                          double phi, double theta, double psi)
 {
-  Video::set_position(lVisID,
-                      airplane->getPos(),
-                      airplane->getPhi(),
-                      airplane->getTheta(),
-                      airplane->getPsi());
+  Video::set_position(lVisID, pos, phi, theta, psi);
 }
 
@@ -59,9 +59,11 @@ class CRRCAirplane
    
    /** \brief Draw the airplane
     *
-    *
+    *  \param pos   position
+    *  \param phi   Euler angles
     */
-   virtual void draw(FDMBase* airplane) = 0;
+   virtual void draw(CRRCMath::Vector3 const& pos,
+                     double phi, double theta, double psi) = 0;
 
    virtual int  getNumSounds()  {return (sound.size());};
   
@@ -81,7 +83,8 @@ class CRRCAirplaneV2 : public CRRCAirplane
     CRRCAirplaneV2(SimpleXMLTransfer* xml);
     ~CRRCAirplaneV2();
 
-    void draw(FDMBase* airplane);
+    void draw(CRRCMath::Vector3 const& pos,
+              double phi, double theta, double psi);
   
   private:
     long lVisID;    ///< ID for the airplane visualization
@@ -58,10 +58,14 @@ If you'd like to help with CRRCSIM, then send me an email!
 #include "crrc_system.h"
 #include "crrc_sound.h"
 #include "mod_landscape/crrc_scenery.h"
+#include "mod_landscape/scenery_loader.h"
+#include "mod_landscape/slope_wind_map.h"
 #include "SimStateHandler.h"
 #include "mod_windfield/windfield.h"
 #include "GUI/crrc_gui_main.h"
 #include "GUI/crrc_joy.h"
+#include "GUI/crrc_msgbox.h"
+#include "GUI/crrc_planecat.h"
 #include "mod_misc/SimpleXMLTransfer.h"
 #include "mod_misc/lib_conversions.h"
 #include "config.h"
@@ -83,6 +87,7 @@ If you'd like to help with CRRCSIM, then send me an email!
 
 #include "mod_main/eventhandler.h"
 #include "mod_main/crrc_checkopts.h"
+#include "mod_misc/profiler.h"
 
 #include "mod_inputdev/inputdev_serial2/inputdev_serial2.h"
 #include "mod_inputdev/inputdev_mnav/inputdev_mnav.h"
@@ -101,6 +106,7 @@ If you'd like to help with CRRCSIM, then send me an email!
 
 #include "record.h"
 #include "robots.h"
+#include "crrc_fdmthread.h"
 #include "mod_video/fonts.h"
 
 
@@ -324,6 +330,7 @@ std::string input_method_failed(std::string msg, bool boRevertToMouse = true)
     // close previous interface
     if (Global::TXInterface != (T_TX_Interface*)0)
     {
+      Global::TXInterface->stopInputThread();
       delete Global::TXInterface;
       Global::TXInterface = (T_TX_Interface*)0;
     }
@@ -359,6 +366,7 @@ std::string reconfigureInputMethod(bool boRevertToMouse)
   if (Global::TXInterface != (T_TX_Interface*)0)
   {
     Global::inputDev->closeJoystick();
+    Global::TXInterface->stopInputThread();
     delete Global::TXInterface;
     Global::TXInterface = (T_TX_Interface*)0;
   }
@@ -461,6 +469,10 @@ std::string reconfigureInputMethod(bool boRevertToMouse)
   else
     return(input_method_failed("", boRevertToMouse));
 
+  // drain the device independent of the frame rate
+  if (cfgfile->getInt("inputMethod.thread.fUse", 1))
+    Global::TXInterface->startInputThread();
+
   return("");
 }
 
@@ -478,6 +490,22 @@ void read_config_into_globals()
   Global::HUDCompass = cfgfile->getInt("HUDCompass.fUse", 0);
   Global::windVectors = cfgfile->getInt("windVectors.fUse", 0);
   Global::dt = cfgfile->getDouble("simulation.flightModel.dt", 0.002777);
+  
+  // Deterministic mode: fixed seed, fixed number of EOM steps per frame
+  if (cfgfile->getInt("simulation.deterministic.fUse", 0))
+  {
+    Global::fixed_multiloop = cfgfile->getInt("simulation.deterministic.multiloop", 6);
+    if (Global::fixed_multiloop < 1)
+      Global::fixed_multiloop = 1;
+    CRRC_Random::setSeed(cfgfile->getInt("simulation.deterministic.seed", 1));
+  }
+  else
+    Global::fixed_multiloop = 0;
+
+  // precalculated wind from terrain, results depend on when it's ready
+  SlopeWindMap::setEnabled(Global::fixed_multiloop == 0 &&
+                           cfgfile->getInt("wind_mode.fMap", 1));
+  
   Video::read_config(cfgfile);
 }
 
@@ -513,6 +541,8 @@ void initializeRandomNumberGenerator()
 void crrc_exit(int exit_code, const char *errmsg)
 {
   // ToDo: clean up allocated objects
+  CRRC_PlaneCatalogue::stopScan();
+  SceneryLoader::stop();
   SDL_Quit();
   
   if ((errmsg != NULL) && (*errmsg != '\0'))
@@ -585,10 +615,24 @@ void raiseInputEvent(TSimInputs const& inputs)
 void load_initial_scenery(T_Config *cfg)
 {
   std::string sceneryfile = cfg->getLocationName();
-  int sky_variant = cfg->getSkyVariant();
-  Global::scenery = loadScenery(FileSysTools::getDataPath(sceneryfile).c_str(),
-                                sky_variant);
-  if (Global::scenery == NULL)
+  Scenery*    new_scenery;
+
+  // Loading has been started in main() already, wait for it to finish.
+  CGUIWaitingBox* waitingbox = NULL;
+  if (cfgfile->getInt("video.enabled", 1))
+  {
+    waitingbox = new CGUIWaitingBox(_("Scenery loading..."));
+    Video::display();
+  }
+  new_scenery = SceneryLoader::wait();
+  if (waitingbox)
+    delete waitingbox;
+
+  if (new_scenery != NULL)
+  {
+    Global::scenery = new_scenery;
+  }
+  else
   {
     fprintf(stderr, "Unable to initialize scenery from file %s,\n",
                         sceneryfile.c_str());
@@ -613,6 +657,44 @@ void load_initial_scenery(T_Config *cfg)
   cfg->wind->read(cfgfile, cfg);
 }
 
+/*****************************************************************************
+*
+* Replaces the current scenery by one which has been loaded in the
+* background (see CGUILocationDialog::saveSelection()). If loading has
+* failed, the current one is kept.
+*
+**/
+void switch_scenery(Scenery* new_scenery)
+{
+  if (new_scenery)
+  {
+    clear_wind_field();
+    delete Global::scenery;
+    Global::scenery = new_scenery;
+    //reinitialise game mode
+    if (Global::gameHandler)
+    {
+      delete Global::gameHandler;
+    }
+    if (cfgfile->getInt("game.f3f.enabled",0))
+      Global::gameHandler = new HandlerF3F();
+    else
+      Global::gameHandler= new T_GameHandler();
+  }
+  else
+  {
+    LOG(_("Unable to load the scenery."));
+  }
+  cfg->read(cfgfile);
+  if (cfgfile->getInt("video.enabled", 1))
+  {
+    Video::setWindowTitleString();
+  }
+  player_pos = Global::scenery->getPlayerPosition();
+  Init_mod_windfield();
+  Global::Simulation->reset();
+}
+
 
 
 /*****************************************************************************/
@@ -774,12 +856,21 @@ int main(int argc,char **argv)
                     It allows to have a graphic context to display a message
                     during the load of the configured scenery.*/
 
+        // start loading the configured scenery, it is picked up by
+        // load_initial_scenery() after the airplane has been loaded
+        SceneryLoader::start(FileSysTools::getDataPath(cfg->getLocationName()),
+                             cfg->getSkyVariant());
+
         Init_mod_windfield();
 
         player_pos = Global::scenery->getPlayerPosition();
         // Create invisible GUI
         if (cfgfile->getInt("video.enabled", 1))
+        {
           Global::gui = new CGUIMain(false);
+          // bring the airplane catalogue up to date while the user is flying
+          CRRC_PlaneCatalogue::startScan();
+        }
         else
           Global::gui = NULL;
         
@@ -869,12 +960,38 @@ int main(int argc,char **argv)
     Scheduler scheduler;
     EventHandler eventHandler(&scheduler);
     
+    // Run the flight model on its own thread (not in deterministic mode,
+    // which needs a fixed number of steps per frame)
+    if (Global::fixed_multiloop == 0 && cfgfile->getInt("simulation.fdm_thread.fUse", 1))
+    {
+      Global::fdmThread = new FDMThread();
+      Global::fdmThread->Lock();
+      Global::fdmThread->Start();
+      Global::fdmThread->Unlock();
+    }
+    
     while (Global::Simulation->getState() != STATE_EXIT)
     {
       crrc_time->update();
+      
+      // Everything but drawing is done while holding the lock of the
+      // FDM thread.
+      if (Global::fdmThread != NULL)
+        Global::fdmThread->Lock();
+      
       scheduler.Run();
 
-      Global::TXInterface->getInputData(&Global::inputs);
+      // swap in a scenery which has been loaded in the background
+      {
+        Scenery* new_scenery;
+        if (SceneryLoader::poll(new_scenery))
+          switch_scenery(new_scenery);
+      }
+
+      {
+        CRRC_PROFILE("input");
+        Global::TXInterface->getInputData(&Global::inputs);
+      }
       raiseInputEvent(Global::inputs);
       
       if (Global::training_mode)
@@ -890,7 +1007,7 @@ int main(int argc,char **argv)
 
       Global::inputs.ClearKeys();
       
-      // random data
+      // random data (ignored in deterministic mode)
       {
         CRRC_Random::insertData(SDL_GetTicks());
         CRRC_Random::insertData(Global::inputs.getRandNum());                   
@@ -992,6 +1109,12 @@ int main(int argc,char **argv)
           Global::gui->doHUDCompass(field_of_view);
       }
       
+      double dPropFreq = Global::aircraft->getFDM()->getPropFreq();
+      double dRelVel   = Global::aircraft->getFDM()->getVRelAirmass()/Global::aircraft->getFDM()->getTrimmedFlightVelocity();
+      
+      if (Global::fdmThread != NULL)
+        Global::fdmThread->Unlock();
+      
       if (Global::gui)
       {
         Video::display();
@@ -1006,11 +1129,21 @@ int main(int argc,char **argv)
       if (Global::soundserver != (CRRCAudioServer*)0)
       {
         soundUpdate3D(distance_to_model,
-                      Global::aircraft->getFDM()->getPropFreq(),
+                      dPropFreq,
                       -1*vFdmPos.r[2],
-                      Global::aircraft->getFDM()->getVRelAirmass()/Global::aircraft->getFDM()->getTrimmedFlightVelocity());
+                      dRelVel);
       }
+      
+      CRRC_Profiler::frameMark();
     }
+    
+    delete Global::fdmThread;
+    Global::fdmThread = NULL;
+    if (Global::TXInterface != (T_TX_Interface*)0)
+      Global::TXInterface->stopInputThread();
+    CRRC_PlaneCatalogue::stopScan();
+    SceneryLoader::stop();
+    CRRC_Profiler::writeTrace();
 #ifdef LOG_FRAMES
     fclose(fp);
 #endif
@@ -90,7 +90,9 @@ void Init_mod_windfield();
 
 /**
  * Tries to load the airplane specified in the config file.
- * Throws an exception on error.
+ * Throws an exception on error. Unlike a scenery (see SceneryLoader),
+ * the airplane is loaded on the main thread, the simulation stops
+ * meanwhile.
  */
 void loadAirplane();
 
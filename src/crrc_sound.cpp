@@ -35,6 +35,7 @@
 #include "crrc_sound.h"
 #include "crrc_soundserver.h"
 #include "crrc_loadair.h"
+#include "mod_misc/triple_buffer.h"
 
 
 #define SPEED_OF_SOUND    ((float)(330.0 / 0.3048))    // ft/s
@@ -52,7 +53,20 @@ struct tagAudio3D
   float flDist;         ///< current distance to model
   float flH;            ///< current altitude
   float flRelVelocity;  ///< relative velocity
-} Audio3D;
+};
+
+/// Hands the latest tagAudio3D from the main thread to the sound thread.
+static TripleBuffer<tagAudio3D> Audio3DBuffer;
+
+/** \brief Get the latest 3D data.
+ *
+ *  Sound thread only.
+ */
+static const tagAudio3D& getAudio3D()
+{
+  Audio3DBuffer.Update();
+  return Audio3DBuffer.Front();
+}
 
 
 
@@ -165,6 +179,7 @@ void T_EngineSound::calculate()
   float flModelVolume;
 
   // get input values from inter-process swap buffer
+  const tagAudio3D& Audio3D = getAudio3D();
   flPropFreq    = Audio3D.flPropFreq;
   flDist        = Audio3D.flDist;
   flModelVolume = (float)server->getModelVolume() / (float)SDL_MIX_MAXVOLUME;
@@ -194,7 +209,7 @@ void T_EngineSound::calculate()
   }
   float pitch = 0.8 * flPropFreq*dPitchFactor / C_doppler;
   setPitch(pitch);
-  server->setChannelVolume(channel, nEngineVol);
+  setVolume((float)nEngineVol / (float)SDL_MIX_MAXVOLUME);
 }
 
 
@@ -222,6 +237,7 @@ void T_GliderSound::calculate()
   CRRCAudioServer *server = CRRCAudioServer::getRunningInstance();
 
   // get input values from inter-process swap buffer
+  const tagAudio3D& Audio3D = getAudio3D();
   float flDist        = Audio3D.flDist;
   float flRelV        = Audio3D.flRelVelocity;
   float flModelVolume = (float)server->getModelVolume() / (float)SDL_MIX_MAXVOLUME;;
@@ -255,7 +271,7 @@ void T_GliderSound::calculate()
   
   float pitch = 0.2 + 0.8 * dPitchFactor / C_doppler;
   setPitch(pitch);
-  server->setChannelVolume(channel, nSoundVol);
+  setVolume((float)nSoundVol / (float)SDL_MIX_MAXVOLUME);
 }
 
 
@@ -374,7 +390,7 @@ void T_VariometerSound::calculate()
   float         flSndTimeDiff = (float)Global::soundserver->getBufferSize() 
                                 / (float)Global::soundserver->getSampleRate();
   // get input values from inter-process swap buffer
-  flHIn       = Audio3D.flH;
+  flHIn       = getAudio3D().flH;
   
   // feet per second
   float flHDiff = (flHIn - flHOld) / flSndTimeDiff;
@@ -520,12 +536,13 @@ Uint8* T_VariometerSound::getMixableData(Uint32 playpos, Uint32 *len)
  */
 void soundUpdate3D(float flDist, float flPropFreq, float flH, float flRelV)
 {
-  SDL_LockAudio();
+  tagAudio3D& Audio3D = Audio3DBuffer.Back();
+
   Audio3D.flPropFreq    = flPropFreq;
   Audio3D.flDist        = flDist;
   Audio3D.flH           = flH;
   Audio3D.flRelVelocity = flRelV;
-  SDL_UnlockAudio();
+  Audio3DBuffer.Publish();
 }
 
 
@@ -35,6 +35,17 @@
 #include "crrc_soundserver.h"
 #include "crrc_main.h"
 #include "mod_misc/lib_conversions.h"
+#include "mod_misc/profiler.h"
+#include "GUI/util.h"
+
+#include <dirent.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define CRRC_AUDIO_SSE2 (1)
+#else
+# define CRRC_AUDIO_SSE2 (0)
+#endif
 
 
 // --- generic functions ----------------------------------
@@ -56,39 +67,137 @@ void PrintFormat(const char *title, SDL_AudioSpec *fmt)
 }
 
 
+/** \brief Add 16 bit samples to the mix bus.
+ *
+ *  The gain is ramped linearly from g0 to g1 across the
+ *  n samples, so volume changes don't click.
+ */
+static void mixS16(float* bus, const Sint16* src, int n, float g0, float g1)
+{
+  float step = (g1 - g0) / n;
+  int   i    = 0;
+
+#if CRRC_AUDIO_SSE2 == 1
+  __m128 g    = _mm_setr_ps(g0, g0 + step, g0 + 2*step, g0 + 3*step);
+  __m128 inc4 = _mm_set1_ps(4*step);
+  __m128 inc8 = _mm_set1_ps(8*step);
+
+  for (; i + 8 <= n; i += 8)
+  {
+    __m128i x  = _mm_loadu_si128((const __m128i*)(src + i));
+    // sign-extend to 32 bit
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+    _mm_storeu_ps(bus + i,     _mm_add_ps(_mm_loadu_ps(bus + i),
+                                          _mm_mul_ps(_mm_cvtepi32_ps(lo), g)));
+    _mm_storeu_ps(bus + i + 4, _mm_add_ps(_mm_loadu_ps(bus + i + 4),
+                                          _mm_mul_ps(_mm_cvtepi32_ps(hi), _mm_add_ps(g, inc4))));
+    g = _mm_add_ps(g, inc8);
+  }
+#endif
+  for (; i < n; i++)
+  {
+    bus[i] += src[i] * (g0 + i*step);
+  }
+}
+
+
+/** \brief Convert the mix bus to 16 bit samples.
+ *
+ *  Values outside the 16 bit range are saturated. This only
+ *  happens once per buffer, not after each channel.
+ */
+static void busToS16(const float* bus, Sint16* dst, int n)
+{
+  int i = 0;
+
+#if CRRC_AUDIO_SSE2 == 1
+  for (; i + 8 <= n; i += 8)
+  {
+    __m128i lo = _mm_cvtps_epi32(_mm_loadu_ps(bus + i));
+    __m128i hi = _mm_cvtps_epi32(_mm_loadu_ps(bus + i + 4));
+    // packs saturates to -32768...32767
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+  }
+#endif
+  for (; i < n; i++)
+  {
+    float v = bus[i];
+
+    if (v > 32767.0f)
+      v = 32767.0f;
+    else if (v < -32768.0f)
+      v = -32768.0f;
+    dst[i] = (Sint16)(v < 0 ? v - 0.5f : v + 0.5f);
+  }
+}
+
+
 /** \brief The sound callback
  *
  *  This callback routine is the low-level workhorse which
  *  interfaces the sound server to SDL. It is called by the
  *  SDL routines whenever the sound card accepts new input
  *  data.
+ *
+ *  It picks up the commands queued by the main thread and
+ *  mixes all channels. 16 bit samples are accumulated in
+ *  floating point and saturated once at the end; other
+ *  formats are left to SDL_MixAudio().
  */
 void snd_callback(void *_unused, Uint8 *stream, int len)
 {
   Uint32 samples;
   CRRCAudioServer *server = CRRCAudioServer::getRunningInstance();
   
+  server->runCommands();
+
   if (!server->is_paused)
   {
+    int   nBus  = len / 2;
+    bool  fBus  = (server->audio_spec->format == AUDIO_S16SYS
+                    && nBus <= (int)server->mixbus.size());
+    float *bus  = fBus ? &server->mixbus[0] : NULL;
+
+    if (fBus)
+    {
+      for (int n = 0; n < nBus; n++)
+        bus[n] = 0;
+    }
+
     for (int i = 0; i < CRRC_AUDIO_CHANNELS; i++)
     {
-      if (server->channel[i] != NULL && server->channel[i]->sample != NULL)
+      T_PlaybackContainer *pb = &server->channel[i];
+
+      if (pb->sample != NULL)
       {
         samples = len;
-        Uint8  *pos = server->channel[i]->sample->getMixableData(server->channel[i]->playpos, &samples);
+        Uint8  *pos = pb->sample->getMixableData(pb->playpos, &samples);
         
         // end of sample reached?
         if (samples == 0)
         {
-          server->stopChannel(i);
+          server->finishChannel(i);
         }
         else
         {
-          SDL_MixAudio(stream, pos, samples, server->channel[i]->volume);
-          server->channel[i]->playpos += samples;
+          float gain = (float)pb->volume / SDL_MIX_MAXVOLUME;
+
+          if (fBus)
+            mixS16(bus, (Sint16*)pos, samples / 2, pb->gain, gain);
+          else
+            SDL_MixAudio(stream, pos, samples, pb->volume);
+          pb->gain     = gain;
+          pb->playpos += samples;
         }
       }
     }
+
+    if (fBus)
+    {
+      busToS16(bus, (Sint16*)stream, nBus);
+    }
   }
 }
 
@@ -102,7 +211,8 @@ CRRCAudioServer* CRRCAudioServer::instance = NULL;
  *  \param config Pointer to the XML config file.
  */
 CRRCAudioServer::CRRCAudioServer(SimpleXMLTransfer *config)
-  : audio_spec(NULL), is_paused(true)
+  : audio_spec(NULL), is_paused(true),
+    cache_mutex(NULL), preload_thread(NULL), fStopPreload(false)
 {
   // Prepare config files
   config->makeSureAttributeExists("sound.samplerate", "48000");
@@ -125,7 +235,9 @@ CRRCAudioServer::CRRCAudioServer(SimpleXMLTransfer *config)
   
   for (int i = 0; i < CRRC_AUDIO_CHANNELS; i++)
   {
-    channel[i] = NULL;
+    channel[i].sample   = NULL;
+    assigned[i].sample  = NULL;
+    assigned[i].discard = false;
   }
 
   // try to open
@@ -143,6 +255,8 @@ CRRCAudioServer::CRRCAudioServer(SimpleXMLTransfer *config)
     instance = this;
   }
   free(desired);
+  mixbus.resize(audio_spec->samples * audio_spec->channels);
+  cache_mutex = SDL_CreateMutex();
   
   double dModelVolume = config->getDouble("sound.model.vol", 1.0);
   if (dModelVolume > 1.0)
@@ -163,25 +277,22 @@ CRRCAudioServer::CRRCAudioServer(SimpleXMLTransfer *config)
 CRRCAudioServer::~CRRCAudioServer()
 {
   SDL_PauseAudio(1);
+  SDL_CloseAudio();
 
-  // free any allocated samples
+  // The callback is gone, so take over its part. Free any
+  // allocated samples.
+  runCommands();
   for (int i = 0; i < CRRC_AUDIO_CHANNELS; i++)
   {
-    if (channel[i] != NULL)
+    if (channel[i].sample != NULL)
     {
-      if (channel[i]->discard)
-      {
-        #if DEBUG_SOUND_SERVER > 0
-        printf("Discarding sample %s.\n", channel[i]->sample->getName().c_str());
-        #endif
-        delete channel[i]->sample;
-      }
-      delete channel[i];
-      channel[i] = NULL;
+      finishChannel(i);
     }
   }
+  collectFinished();
+  clearSampleCache();
+  SDL_DestroyMutex(cache_mutex);
   free(audio_spec);
-  SDL_CloseAudio();
 }
 
 
@@ -225,7 +336,9 @@ int CRRCAudioServer::playSample(T_SoundSample *sample, unsigned int volume)
 
 /** \brief Play a sample directly from a file.
  *
- *  Creates a temporary T_SoundSample object from a file,
+ *  If the file has been preloaded by preloadSamples(), the
+ *  cached sample is shared with the channel. Otherwise this
+ *  creates a temporary T_SoundSample object from the file,
  *  adds the sample to the CRRCAudioServer and discards
  *  the temporary T_SoundSample afterwards. The sample will
  *  be played at the given volume, or at the maximum volume
@@ -247,6 +360,20 @@ int CRRCAudioServer::playSample(const char *filename, unsigned int volume)
 {
   int chan;
   T_SoundSample *sample = NULL;
+
+  SDL_mutexP(cache_mutex);
+  T_SampleCache::const_iterator it = sample_cache.find(filename);
+  if (it != sample_cache.end())
+  {
+    sample = it->second;
+  }
+  SDL_mutexV(cache_mutex);
+
+  if (sample != NULL)
+  {
+    // the cache keeps its own reference, nothing to clean up
+    return addSample(sample, volume, true);
+  }
   
   try
   {
@@ -275,7 +402,8 @@ int CRRCAudioServer::playSample(const char *filename, unsigned int volume)
  *  or -1 if there was no more free channel.
  *  \param sample Pointer to the sample to be played.
  *  \param volume playback volume
- *  \param disc   Discard sample after playback?
+ *  \param disc   Release sample after playback? The channel
+ *                takes a reference to the sample in this case.
  *  \return channel number or -1 on error
  */
 int CRRCAudioServer::addSample(T_SoundSample *sample,
@@ -294,17 +422,25 @@ int CRRCAudioServer::addSample(T_SoundSample *sample,
     sample->convert(audio_spec);
   }
   
-  SDL_LockAudio();
+  collectFinished();
   for (int i = 0; i < CRRC_AUDIO_CHANNELS; i++)
   {
-    if (channel[i] == NULL)
+    if (assigned[i].sample == NULL)
     {
-      T_PlaybackContainer *pb = new T_PlaybackContainer;
-      pb->sample = sample;
-      pb->volume = volume;
-      pb->discard = disc;
-      pb->playpos = 0;
-      channel[i] = pb;
+      T_AudioCommand cmd;
+
+      if (disc)
+      {
+        sample->ref();
+      }
+      assigned[i].sample  = sample;
+      assigned[i].discard = disc;
+
+      cmd.type   = T_AudioCommand::PLAY;
+      cmd.chan   = i;
+      cmd.sample = sample;
+      cmd.volume = volume > SDL_MIX_MAXVOLUME ? SDL_MIX_MAXVOLUME : volume;
+      postCommand(cmd);
       ret = i;
       #if DEBUG_SOUND_SERVER > 0
       printf("Added sample %s to channel %d.\n", sample->getName().c_str(), i);
@@ -312,7 +448,6 @@ int CRRCAudioServer::addSample(T_SoundSample *sample,
       break;
     }
   }
-  SDL_UnlockAudio();
   
   #if DEBUG_SOUND_SERVER > 0
   if (ret < 0)
@@ -338,32 +473,167 @@ SDL_AudioSpec* CRRCAudioServer::getAudioSpec() const
  *
  *  This stops the sample playing on channel c. If the
  *  sample was created by the server, it will automatically
- *  be deleted.
+ *  be deleted as soon as it is no longer cached or played
+ *  on another channel.
+ *
+ *  A sample which belongs to the caller is stopped right
+ *  away, so the caller may delete it afterwards. This
+ *  briefly locks the audio. Samples of the server are just
+ *  handed back by the audio thread when it gets to it.
  *
  *  \param c channel number
  */
 void CRRCAudioServer::stopChannel(int c)
 {
+  collectFinished();
   if ((c >= 0) && (c < CRRC_AUDIO_CHANNELS))
   {
-    if (channel[c] != NULL)
+    if (assigned[c].sample != NULL)
     {
       #if DEBUG_SOUND_SERVER > 0
-      printf("Stopping sample %s on channel %d.\n", channel[c]->sample->getName().c_str(), c);
+      printf("Stopping sample %s on channel %d.\n", assigned[c].sample->getName().c_str(), c);
       #endif
-      SDL_LockAudio();
-      if (channel[c]->discard)
+      if (assigned[c].discard)
       {
-        #if DEBUG_SOUND_SERVER > 0
-        printf("Discarding sample %s.\n", channel[c]->sample->getName().c_str());
-        #endif
-        delete channel[c]->sample;
-        
+        T_AudioCommand cmd;
+
+        cmd.type   = T_AudioCommand::STOP;
+        cmd.chan   = c;
+        cmd.sample = NULL;
+        cmd.volume = 0;
+        postCommand(cmd);
       }
-      delete channel[c];
-      channel[c] = NULL;
-      SDL_UnlockAudio();
+      else
+      {
+        // The callback can't run while the audio is locked,
+        // so act on its behalf.
+        SDL_LockAudio();
+        runCommands();
+        if (channel[c].sample != NULL)
+        {
+          finishChannel(c);
+        }
+        collectFinished();
+        SDL_UnlockAudio();
+      }
+    }
+  }
+}
+
+
+/** \brief Queue a command for the audio thread.
+ *
+ *  If the queue is full (the audio is paused or the callback
+ *  lags behind), the commands are executed on the calling
+ *  thread with the audio locked.
+ *
+ *  \param cmd the command
+ */
+void CRRCAudioServer::postCommand(const T_AudioCommand& cmd)
+{
+  if (!commands.Push(cmd))
+  {
+    SDL_LockAudio();
+    runCommands();
+    commands.Push(cmd);
+    SDL_UnlockAudio();
+  }
+}
+
+
+/** \brief Execute all queued commands.
+ *
+ *  Called by the audio callback, or by the main thread
+ *  with the audio locked.
+ */
+void CRRCAudioServer::runCommands()
+{
+  const T_AudioCommand* cmd;
+
+  while ((cmd = commands.Peek()) != NULL)
+  {
+    T_PlaybackContainer *pb = &channel[cmd->chan];
+
+    switch (cmd->type)
+    {
+      case T_AudioCommand::PLAY:
+        pb->sample  = cmd->sample;
+        pb->playpos = 0;
+        pb->volume  = cmd->volume;
+        pb->gain    = (float)cmd->volume / SDL_MIX_MAXVOLUME;
+        break;
+
+      case T_AudioCommand::STOP:
+        // the sample may have finished in the meantime
+        if (pb->sample != NULL)
+        {
+          finishChannel(cmd->chan);
+        }
+        break;
+
+      case T_AudioCommand::VOLUME:
+        pb->volume = cmd->volume;
+        break;
+    }
+    commands.Pop();
+  }
+}
+
+
+/** \brief Free a channel of the audio thread.
+ *
+ *  The channel is handed back to the main thread, which
+ *  releases the sample.
+ *
+ *  \param c channel number
+ */
+void CRRCAudioServer::finishChannel(int c)
+{
+  channel[c].sample = NULL;
+  // can't overflow: a channel is only handed back once
+  // before the main thread assigns it again
+  finished.Push(c);
+}
+
+
+/** \brief Take back the channels freed by the audio thread.
+ *
+ *  Main thread only.
+ */
+void CRRCAudioServer::collectFinished()
+{
+  const int* c;
+
+  while ((c = finished.Peek()) != NULL)
+  {
+    T_ChannelAssignment *as = &assigned[*c];
+
+    if (as->discard)
+    {
+      releaseSample(as->sample);
     }
+    as->sample  = NULL;
+    as->discard = false;
+    finished.Pop();
+  }
+}
+
+
+/** \brief Drop a reference to a sample.
+ *
+ *  Deletes the sample if this was the last reference.
+ *  Main thread only.
+ *
+ *  \param sample the sample to be released
+ */
+void CRRCAudioServer::releaseSample(T_SoundSample *sample)
+{
+  if (sample->unref())
+  {
+    #if DEBUG_SOUND_SERVER > 0
+    printf("Discarding sample %s.\n", sample->getName().c_str());
+    #endif
+    delete sample;
   }
 }
 
@@ -396,15 +666,135 @@ void CRRCAudioServer::setChannelVolume(int c, unsigned char vol)
 {
   if ((c >= 0) && (c < CRRC_AUDIO_CHANNELS))
   {
-    if (channel[c] != NULL)
+    if (assigned[c].sample != NULL)
     {
+      T_AudioCommand cmd;
+
       if (vol > SDL_MIX_MAXVOLUME)
       {
         vol = SDL_MIX_MAXVOLUME;
       }
-      channel[c]->volume = vol;
+      cmd.type   = T_AudioCommand::VOLUME;
+      cmd.chan   = c;
+      cmd.sample = NULL;
+      cmd.volume = vol;
+      postCommand(cmd);
+    }
+  }
+}
+
+
+/** \brief Preload all samples in a directory.
+ *
+ *  Loads every .wav file in dir in a background thread and
+ *  converts it into the server's format. Once a file is in
+ *  the cache, playSample() with the file name dir/name.wav
+ *  only has to assign a channel. Samples which are not
+ *  cached yet are still loaded from the file.
+ *
+ *  \param dir directory containing the samples
+ */
+void CRRCAudioServer::preloadSamples(const std::string& dir)
+{
+  stopPreload();
+
+  preload_dir    = dir;
+  fStopPreload   = false;
+  preload_thread = SDL_CreateThread(PreloadThread, this);
+  if (preload_thread == NULL)
+  {
+    fprintf(stderr, "Unable to preload samples from %s\n", dir.c_str());
+  }
+}
+
+
+/** \brief Empty the sample cache.
+ *
+ *  Stops a running preload and drops the cache's references.
+ *  Samples which are still playing are deleted when their
+ *  channel has finished.
+ */
+void CRRCAudioServer::clearSampleCache()
+{
+  stopPreload();
+
+  for (T_SampleCache::iterator it = sample_cache.begin(); it != sample_cache.end(); it++)
+  {
+    releaseSample(it->second);
+  }
+
+  SDL_mutexP(cache_mutex);
+  sample_cache.clear();
+  SDL_mutexV(cache_mutex);
+}
+
+
+/**
+ *  Waits for a running preload to quit.
+ */
+void CRRCAudioServer::stopPreload()
+{
+  if (preload_thread != NULL)
+  {
+    fStopPreload = true;
+    SDL_WaitThread(preload_thread, NULL);
+    preload_thread = NULL;
+  }
+}
+
+
+/**
+ *  Preload thread: loads all samples from preload_dir which
+ *  are not in the cache yet.
+ */
+int CRRCAudioServer::PreloadThread(void* server)
+{
+  CRRCAudioServer* self = (CRRCAudioServer*)server;
+  DIR*             dir;
+  struct dirent*   ent;
+
+  CRRC_Profiler::setThreadName("sound preload");
+
+  if ((dir = opendir(self->preload_dir.c_str())) == NULL)
+  {
+    CRRC_Profiler::endThread();
+    return(0);
+  }
+
+  while ((ent = readdir(dir)) != NULL && !self->fStopPreload)
+  {
+    std::string name = ent->d_name;
+    std::string path = self->preload_dir + "/" + name;
+    bool        fCached;
+
+    if (!T_GUI_Util::checkExtension(name, "wav"))
+      continue;
+
+    SDL_mutexP(self->cache_mutex);
+    fCached = (self->sample_cache.find(path) != self->sample_cache.end());
+    SDL_mutexV(self->cache_mutex);
+    if (fCached)
+      continue;
+
+    try
+    {
+      T_SoundSample* sample = new T_SoundSample(path.c_str(), self->audio_spec);
+
+      // nobody else can see the sample yet
+      sample->ref();
+      SDL_mutexP(self->cache_mutex);
+      self->sample_cache[path] = sample;
+      SDL_mutexV(self->cache_mutex);
+    }
+    catch (std::runtime_error& e)
+    {
+      fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
     }
   }
+  closedir(dir);
+
+  CRRC_Profiler::endThread();
+  return(0);
 }
 
 
@@ -419,9 +809,8 @@ void CRRCAudioServer::setModelVolume(unsigned char vol)
   {
     vol = SDL_MIX_MAXVOLUME;
   }
-  SDL_LockAudio();
+  // a single byte, read by the sounds in the callback
   ucModelVolume = vol;
-  SDL_UnlockAudio();
 }
 
 
@@ -434,7 +823,7 @@ void CRRCAudioServer::setModelVolume(unsigned char vol)
  *  data.
  */
 T_SoundSample::T_SoundSample(SDL_AudioSpec *fmt)
-  : samplename(""), length(0), buffer(NULL)
+  : samplename(""), length(0), buffer(NULL), refcount(0)
 {
   spec.format = fmt->format;
   spec.freq   = fmt->freq;
@@ -459,7 +848,7 @@ T_SoundSample::T_SoundSample(SDL_AudioSpec *fmt)
  * \param fmt desired audio format
  */
 T_SoundSample::T_SoundSample(const char *filename, SDL_AudioSpec *fmt)
-  : samplename(""), length(0), buffer(NULL)
+  : samplename(""), length(0), buffer(NULL), refcount(0)
 {
   SDL_AudioSpec *ret = SDL_LoadWAV(filename, &spec, &buffer, &length);
   if (NULL == ret)
@@ -628,7 +1017,8 @@ bool T_SoundSample::isSigned()
  *  buffer.
  */
 T_PitchVariableLoop::T_PitchVariableLoop(const char *filename, SDL_AudioSpec *fmt)
-  : T_SoundSample(filename, fmt), pitch(1.0), soundpos(0)
+  : T_SoundSample(filename, fmt), pitch(1.0), target_pitch(1.0),
+    volume(1.0), target_volume(1.0), soundpos(0)
 {
   #if DEBUG_SOUND_SERVER > 0
   printf("Reserving %d bytes dynamic sound sample buffer for %s.\n",
@@ -651,7 +1041,9 @@ T_PitchVariableLoop::~T_PitchVariableLoop()
  *
  *  This method returns a pointer to the dynamic sample buffer,
  *  filling the dynamic buffer with interpolated sample
- *  values based on the current pitch setting. If more data
+ *  values based on the current pitch setting. Pitch and volume
+ *  are ramped from the values of the last call to the ones
+ *  set by setPitch() and setVolume() in the meantime. If more data
  *  is requested than the buffer can hold, the buffer will
  *  be reallocated. The value of len will therefore never
  *  change, and the sound will loop forever.
@@ -696,9 +1088,18 @@ Uint8* T_PitchVariableLoop::getMixableData(Uint32 playpos, Uint32 *len)
   Sint16  *writeptr   = (Sint16*)&dyn_buffer[0];
   Uint32  uiSoundpos  = soundpos;         // position in integer-arithmetic (<< EIS), local copy for fast access
   Sint16* sndptr      = (Sint16*)buffer;  // local copy for fast access
-  Uint32  uiPitch     = (Uint32)( (1<<EIS) * pitch); // pitch in integer-arithmetic
+  float   flPitchEnd  = target_pitch;
+  float   flVolEnd    = target_volume;
+  float   flPitch     = (1<<EIS) * pitch;   // pitch in integer-arithmetic, ramped per sample
+  float   flPitchStep = nSamplesToCopy ? ((1<<EIS) * flPitchEnd - flPitch) / nSamplesToCopy : 0;
+  float   flVol       = volume;
+  float   flVolStep   = nSamplesToCopy ? (flVolEnd - flVol) / nSamplesToCopy : 0;
+  pitch  = flPitchEnd;
+  volume = flVolEnd;
   while (nSamplesToCopy--)
   {
+    Uint32 uiPitch = (Uint32)flPitch;
+    flPitch += flPitchStep;
     uiSoundpos += uiPitch;
     while (uiSoundpos >= uiSoundlen)
     {
@@ -734,7 +1135,7 @@ Uint8* T_PitchVariableLoop::getMixableData(Uint32 playpos, Uint32 *len)
     
     diff    = uiSoundpos & ((1 << EIS) - 1);
     diff = (((sample_l2 - sample_l1)*diff) >> EIS);
-    out_l = sample_l1 + diff;
+    out_l = (Sint32)((sample_l1 + diff) * flVol);
     
     // Limit to 16 bit samples
     if (out_l > 32767)
@@ -747,7 +1148,7 @@ Uint8* T_PitchVariableLoop::getMixableData(Uint32 playpos, Uint32 *len)
 #if CRRC_SOUND_STEREO == 1
     diff    = uiSoundpos & ((1 << EIS) - 1);
     diff = (((sample_r2 - sample_r1)*diff) >> EIS);
-    out_r = sample_r1 + diff;
+    out_r = (Sint32)((sample_r1 + diff) * flVol);
     
     // Limit to 16 bit samples
     if (out_r > 32767)
@@ -757,6 +1158,7 @@ Uint8* T_PitchVariableLoop::getMixableData(Uint32 playpos, Uint32 *len)
 
     *writeptr++ = out_r;
 #endif
+    flVol += flVolStep;
   }
   soundpos = uiSoundpos;    // write back the locally changed value
   return &dyn_buffer[0];
@@ -768,20 +1170,43 @@ Uint8* T_PitchVariableLoop::getMixableData(Uint32 playpos, Uint32 *len)
  *  This method controls the sample's pitch. A value
  *  of 1.0 will play the sample at the original pitch.
  *  Pitch values are automatically clamped to positive
- *  non-zero values.
+ *  non-zero values. The pitch is ramped to the new value
+ *  during the next fragment, so this doesn't need to lock
+ *  the audio.
  */
 void T_PitchVariableLoop::setPitch(float p)
 {
-  SDL_LockAudio();
   if (p < 0.0001)
   {
-    pitch = 0.0001;
+    target_pitch = 0.0001;
+  }
+  else
+  {
+    target_pitch = p;
+  }
+}
+
+
+/** \brief Set the volume of the sound loop.
+ *
+ *  Scales the loop's output in addition to the channel
+ *  volume. The value is clamped to 0.0...1.0 and ramped
+ *  like the pitch.
+ */
+void T_PitchVariableLoop::setVolume(float v)
+{
+  if (v < 0.0)
+  {
+    target_volume = 0.0;
+  }
+  else if (v > 1.0)
+  {
+    target_volume = 1.0;
   }
   else
   {
-    pitch = p;
+    target_volume = v;
   }
-  SDL_UnlockAudio();
 }
 
 
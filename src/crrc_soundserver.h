@@ -37,9 +37,11 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <map>
 #include <math.h>
 #include <SDL.h>
 #include "mod_misc/SimpleXMLTransfer.h"
+#include "mod_misc/spsc_ring.h"
 
 /// set this to 1 to generate some debug messages
 #define DEBUG_SOUND_SERVER (0)
@@ -67,17 +69,42 @@ void PrintFormat(const char *title, SDL_AudioSpec *fmt);
  *
  *  This container holds one sample while it is fed to
  *  the audio stream. It keeps track of all playback
- *  parameters needed by the callback.
+ *  parameters needed by the callback. It is owned by
+ *  the audio thread.
  */
 typedef struct
 {
-  T_SoundSample* sample;  ///< The sample to be played.
+  T_SoundSample* sample;  ///< The sample to be played, NULL if the channel is free.
   Uint32 playpos;         ///< Current playback position.
   Uint8  volume;          ///< Playback volume of the sample.
-  bool   discard;         ///< Free sample after playback has finished?
+  float  gain;            ///< Gain reached at the end of the last buffer.
 } T_PlaybackContainer;
 
 
+/** \brief A channel as seen by the main thread.
+ *
+ *  A channel is assigned when a sample is started and
+ *  handed back by the audio thread after the sample
+ *  has finished or has been stopped.
+ */
+typedef struct
+{
+  T_SoundSample* sample;  ///< The sample playing, NULL if the channel is free.
+  bool   discard;         ///< Release sample after playback has finished?
+} T_ChannelAssignment;
+
+
+/** \brief A command from the main thread to the audio thread.
+ */
+typedef struct
+{
+  enum {PLAY, STOP, VOLUME} type;
+  int            chan;    ///< channel number
+  T_SoundSample* sample;  ///< the sample to be played (PLAY)
+  Uint8          volume;  ///< playback volume (PLAY, VOLUME)
+} T_AudioCommand;
+
+
 /** \brief The sound server
  *
  *  The sound server offers a range of services to the main
@@ -103,6 +130,9 @@ class CRRCAudioServer
 
     void setChannelVolume(int c, unsigned char vol);
 
+    void preloadSamples(const std::string& dir);
+    void clearSampleCache();
+
     SDL_AudioSpec* getAudioSpec() const;
   
     /**
@@ -145,13 +175,32 @@ class CRRCAudioServer
   private:
     SDL_AudioSpec*  audio_spec;       ///< the server's internal sample format
     bool            is_paused;        ///< the state of the sound server (playing or not)
-    unsigned char   ucModelVolume;    ///< volume for model sounds
-    T_PlaybackContainer *channel[CRRC_AUDIO_CHANNELS];  ///< the sound channels
+    volatile unsigned char ucModelVolume; ///< volume for model sounds
+    T_PlaybackContainer channel[CRRC_AUDIO_CHANNELS];   ///< the sound channels (audio thread)
+    T_ChannelAssignment assigned[CRRC_AUDIO_CHANNELS];  ///< the sound channels (main thread)
+    SPSCRing<T_AudioCommand, 64>  commands;             ///< main thread -> audio thread
+    SPSCRing<int, 16>             finished;             ///< channels handed back to the main thread
+    std::vector<float>            mixbus;               ///< accumulates one buffer of all channels
     static CRRCAudioServer *instance;                   ///< the currently active instance
 
+    typedef std::map<std::string, T_SoundSample*> T_SampleCache;
+
+    T_SampleCache   sample_cache;     ///< preloaded samples, by file name
+    SDL_mutex*      cache_mutex;      ///< protects sample_cache
+    SDL_Thread*     preload_thread;   ///< loads preload_dir into the cache
+    std::string     preload_dir;      ///< directory being preloaded
+    volatile bool   fStopPreload;     ///< asks preload_thread to quit
+
     int addSample(T_SoundSample *sample,
                                  unsigned int volume,
                                  bool disc);
+    void releaseSample(T_SoundSample *sample);
+    void postCommand(const T_AudioCommand& cmd);
+    void runCommands();
+    void collectFinished();
+    void finishChannel(int c);
+    void stopPreload();
+    static int PreloadThread(void* server);
 
 };
 
@@ -201,12 +250,28 @@ class T_SoundSample
      *  full path that was specified in the ctor.
      */
     std::string getName() {return samplename;};
+
+    /** \brief Take a reference to the sample.
+     *
+     *  Samples which are shared between the sample cache and
+     *  the playback channels are reference-counted. The
+     *  count is only changed by the main thread; the audio
+     *  thread hands finished channels back instead.
+     */
+    void ref() {refcount++;};
+
+    /** \brief Drop a reference to the sample.
+     *
+     *  \return true if this was the last reference
+     */
+    bool unref() {return (--refcount <= 0);};
   
    protected:
     std::string   samplename;   ///< sample filename, including full path
     SDL_AudioSpec spec;         ///< sample format
     Uint32        length;       ///< length of the sample data
     Uint8         *buffer;      ///< data buffer containing the sample data
+    int           refcount;     ///< number of owners sharing the sample
    
     int   getSampleSize();
     int   bits();
@@ -226,11 +291,15 @@ class T_PitchVariableLoop : protected T_SoundSample
     virtual ~T_PitchVariableLoop();
     virtual Uint8*  getMixableData(Uint32 playpos, Uint32 *len);
     virtual void    setPitch(float p);
+    virtual void    setVolume(float v);
   
   protected:
-    std::vector<Uint8>  dyn_buffer;   ///< a buffer for the interpolated sample fragment
-    float               pitch;        ///< current pitch
-    Uint32              soundpos;     ///< current playback position in the sample
+    std::vector<Uint8>  dyn_buffer;     ///< a buffer for the interpolated sample fragment
+    float               pitch;          ///< pitch reached at the end of the last fragment
+    volatile float      target_pitch;   ///< pitch to ramp to during the next fragment
+    float               volume;         ///< volume reached at the end of the last fragment
+    volatile float      target_volume;  ///< volume to ramp to during the next fragment
+    Uint32              soundpos;       ///< current playback position in the sample
 };
 
 
@@ -0,0 +1,436 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file crrc_sweep.cpp
+ *
+ *  Parallel parameter sweep for crrcsim_batch, see crrc_sweep.h
+ */
+
+#include "crrc_sweep.h"
+
+#include "global.h"
+#include "defines.h"
+#include "config.h"
+#include "crrc_main.h"
+#include "crrc_fdm.h"
+#include "mod_fdm/fdm.h"
+#include "mod_fdm/xmlmodelfile.h"
+#include "mod_fdm/formats/airtoxml.h"
+#include "mod_landscape/crrc_scenery.h"
+#include "mod_windfield/windfield.h"
+#include "mod_misc/lib_conversions.h"
+
+#include <math.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * FDM environment of one simulation in a sweep. Log messages are only
+ * counted, as the message system of the GUI isn't thread-safe.
+ */
+class SweepFDMEnv : public CRRC_FDM_Env
+{
+  public:
+    SweepFDMEnv(SimpleXMLTransfer* cfg, WindField* windfield)
+      : CRRC_FDM_Env(cfg, windfield), nLogMsg(0) {};
+
+    virtual void AddLogMsg(std::string message) { nLogMsg++; };
+
+    int nLogMsg;
+};
+
+// ----- BatchInputScript -----------------------------------------------
+
+BatchInputScript::BatchInputScript(std::string filename) : idx(0)
+{
+  if (filename.length() == 0)
+    return;
+
+  std::ifstream in(filename.c_str());
+  if (!in)
+    throw std::runtime_error("Unable to open input script " + filename);
+
+  std::string line;
+  while (std::getline(in, line))
+  {
+    std::string::size_type pos = line.find('#');
+    if (pos != std::string::npos)
+      line.erase(pos);
+
+    std::istringstream ls(line);
+    Keyframe k;
+    if (!(ls >> k.t))
+      continue;
+    ls >> k.in.aileron >> k.in.elevator >> k.in.rudder >> k.in.throttle
+       >> k.in.flap >> k.in.spoiler >> k.in.retract >> k.in.pitch;
+    if (keys.size() && k.t < keys.back().t)
+      throw std::runtime_error("Input script " + filename + " is not sorted by time");
+    keys.push_back(k);
+  }
+}
+
+void BatchInputScript::getInputs(double t, TSimInputs* inputs)
+{
+  if (keys.size() == 0)
+    return;
+
+  while (idx+1 < keys.size() && keys[idx+1].t <= t)
+    idx++;
+
+  Keyframe const& k0 = keys[idx];
+  if (idx+1 == keys.size() || t <= k0.t)
+  {
+    copy(k0.in, k0.in, 0, inputs);
+    return;
+  }
+  Keyframe const& k1 = keys[idx+1];
+  copy(k0.in, k1.in, (t - k0.t)/(k1.t - k0.t), inputs);
+}
+
+void BatchInputScript::copy(TSimInputs const& a, TSimInputs const& b, double f, TSimInputs* out)
+{
+  out->aileron  = a.aileron  + f*(b.aileron  - a.aileron);
+  out->elevator = a.elevator + f*(b.elevator - a.elevator);
+  out->rudder   = a.rudder   + f*(b.rudder   - a.rudder);
+  out->throttle = a.throttle + f*(b.throttle - a.throttle);
+  out->flap     = a.flap     + f*(b.flap     - a.flap);
+  out->spoiler  = a.spoiler  + f*(b.spoiler  - a.spoiler);
+  out->retract  = a.retract  + f*(b.retract  - a.retract);
+  out->pitch    = a.pitch    + f*(b.pitch    - a.pitch);
+}
+
+// ----- CRRC_Sweep -----------------------------------------------------
+
+CRRC_Sweep::CRRC_Sweep(SimpleXMLTransfer* cfgfile, BatchInputScript const& script,
+                       double duration, double dt, int multiloop)
+  : cfgfile(cfgfile), airplane(NULL), script(script),
+    duration(duration), dt(dt), multiloop(multiloop)
+{
+  // Everything which might modify the configuration is done here, before
+  // any thread is started.
+  location = cfg->getCurLocCfgPtr(cfgfile);
+  if (location->indexOfChild("thermal") < 0)
+    location->addChild(GetDefaultConf_Thermal());
+  wind_vel  = cfg->wind->getVelocity();
+  wind_dir  = cfg->wind->getDirection();
+  wind_turb = cfg->wind->getTurbulence();
+
+  std::string filename = cfgfile->getString("airplane.file", "models/allegro.xml");
+  filename = air_to_xml_file_load(filename);
+  airplane = new SimpleXMLTransfer(filename);
+
+  SimpleXMLTransfer* ap = cfgfile->getChild("airplane", true);
+  XMLModelFile::SetGraphics(airplane, ap->attributeAsInt("graphics", 0));
+  XMLModelFile::SetConfig  (airplane, ap->attributeAsInt("config",   0));
+
+  load_mutex = SDL_CreateMutex();
+}
+
+CRRC_Sweep::~CRRC_Sweep()
+{
+  SDL_DestroyMutex(load_mutex);
+  delete airplane;
+}
+
+void CRRC_Sweep::addParameter(std::string spec)
+{
+  std::string::size_type eq = spec.find('=');
+  if (eq == std::string::npos || eq == 0)
+    throw std::runtime_error("Invalid sweep parameter " + spec + ", expected name=value,value,...");
+
+  Parameter p;
+  p.name = spec.substr(0, eq);
+
+  std::istringstream ls(spec.substr(eq+1));
+  std::string val;
+  while (std::getline(ls, val, ','))
+  {
+    std::istringstream vs(val);
+    double d;
+    if (!(vs >> d))
+      throw std::runtime_error("Invalid value " + val + " for sweep parameter " + p.name);
+    p.values.push_back(d);
+  }
+  if (p.values.size() == 0)
+    throw std::runtime_error("No values for sweep parameter " + p.name);
+
+  params.push_back(p);
+}
+
+int CRRC_Sweep::getNumCases()
+{
+  int n = 1;
+  for (unsigned int i=0; i<params.size(); i++)
+    n *= params[i].values.size();
+  return(n);
+}
+
+double CRRC_Sweep::getValue(Case const& c, std::string name, double dDefault)
+{
+  for (unsigned int i=0; i<params.size(); i++)
+  {
+    if (params[i].name == name)
+      return(c.values[i]);
+  }
+  return(dDefault);
+}
+
+int CRRC_Sweep::run(int nThreads, FILE* out)
+{
+  // all combinations of parameter values
+  int nCases = getNumCases();
+  cases.resize(nCases);
+  for (int n=0; n<nCases; n++)
+  {
+    int rest = n;
+    for (unsigned int i=0; i<params.size(); i++)
+    {
+      int nVals = params[i].values.size();
+      cases[n].values.push_back(params[i].values[rest % nVals]);
+      rest /= nVals;
+    }
+    cases[n].t       = 0;
+    cases[n].alt_max = 0;
+    cases[n].nLogMsg = 0;
+  }
+
+  if (nThreads > 1 && !Global::scenery->isReentrant())
+  {
+    fprintf(stderr, "Scenery lookups are not reentrant (getHeight_mode 0 or 3D wind data), using one thread\n");
+    nThreads = 1;
+  }
+  if (nThreads > nCases)
+    nThreads = nCases;
+  if (nThreads < 1)
+    nThreads = 1;
+
+  for (int i=0; i<nThreads; i++)
+  {
+    Worker* w = new Worker();
+    w->sweep  = this;
+    w->id     = i;
+    w->thread = NULL;
+    w->mutex  = SDL_CreateMutex();
+    w->steps  = 0;
+    workers.push_back(w);
+  }
+  for (int n=0; n<nCases; n++)
+    workers[n % nThreads]->queue.push_back(n);
+
+  Uint32 start = SDL_GetTicks();
+
+  // worker 0 is the calling thread
+  for (int i=1; i<nThreads; i++)
+    workers[i]->thread = SDL_CreateThread(workerThread, workers[i]);
+  workerThread(workers[0]);
+
+  long steps = workers[0]->steps;
+  for (int i=1; i<nThreads; i++)
+  {
+    SDL_WaitThread(workers[i]->thread, NULL);
+    steps += workers[i]->steps;
+  }
+  double wall = (SDL_GetTicks() - start) / 1000.0;
+
+  for (int i=0; i<nThreads; i++)
+  {
+    SDL_DestroyMutex(workers[i]->mutex);
+    delete workers[i];
+  }
+  workers.clear();
+
+  // results
+  int    nFailed  = 0;
+  double sim_time = 0;
+
+  fprintf(out, "# case");
+  for (unsigned int i=0; i<params.size(); i++)
+    fprintf(out, " %s", params[i].name.c_str());
+  fprintf(out, " t X Y Z alt_max V_rel_airmass log_msgs\n");
+  for (int n=0; n<nCases; n++)
+  {
+    Case const& c = cases[n];
+
+    fprintf(out, "%d", n);
+    for (unsigned int i=0; i<c.values.size(); i++)
+      fprintf(out, " %g", c.values[i]);
+    if (c.error.length())
+    {
+      fprintf(out, " # failed: %s\n", c.error.c_str());
+      nFailed++;
+      continue;
+    }
+    fprintf(out, " %.4f %.3f %.3f %.3f %.3f %.3f %d\n",
+            c.t, c.pos[0], c.pos[1], c.pos[2], c.alt_max, c.V_rel_airmass, c.nLogMsg);
+    sim_time += c.t;
+  }
+
+  fprintf(stderr, "%d cases on %d threads, %ld steps, %.2f s simulated in %.2f s (%.1f sim-s per wall-s)\n",
+          nCases, nThreads, steps, sim_time, wall, (wall > 0) ? sim_time/wall : 0.0);
+
+  return(nFailed);
+}
+
+int CRRC_Sweep::workerThread(void* data)
+{
+  Worker* w = (Worker*)data;
+  int     nCase;
+
+  while (w->sweep->getWork(w->id, nCase))
+    w->sweep->runCase(w->sweep->cases[nCase], w->steps);
+
+  return(0);
+}
+
+bool CRRC_Sweep::getWork(int id, int& nCase)
+{
+  // own queue first, newest entry
+  Worker* w = workers[id];
+  SDL_mutexP(w->mutex);
+  if (!w->queue.empty())
+  {
+    nCase = w->queue.back();
+    w->queue.pop_back();
+    SDL_mutexV(w->mutex);
+    return(true);
+  }
+  SDL_mutexV(w->mutex);
+
+  // steal oldest entry of another worker
+  int nWorkers = workers.size();
+  for (int i=1; i<nWorkers; i++)
+  {
+    Worker* v = workers[(id + i) % nWorkers];
+    SDL_mutexP(v->mutex);
+    if (!v->queue.empty())
+    {
+      nCase = v->queue.front();
+      v->queue.pop_front();
+      SDL_mutexV(v->mutex);
+      return(true);
+    }
+    SDL_mutexV(v->mutex);
+  }
+
+  // Cases don't create new cases, so there's nothing left to do.
+  return(false);
+}
+
+void CRRC_Sweep::runCase(Case& c, long& steps)
+{
+  WindField*       windfield = new WindField();
+  SweepFDMEnv*     env       = NULL;
+  ModFDMInterface* fdmi      = new ModFDMInterface();
+  BatchInputScript input(script);
+  TSimInputs       inputs;
+
+  double step_dt   = getValue(c, "dt",       dt);
+  double direction = getValue(c, "wind_dir", wind_dir);
+
+  windfield->setWind(getValue(c, "wind_vel", wind_vel), direction, wind_turb);
+
+  SDL_mutexP(load_mutex);
+  try
+  {
+    windfield->init(location);
+    env = new SweepFDMEnv(cfgfile, windfield);
+
+    SimpleXMLTransfer* xml = new SimpleXMLTransfer(airplane);
+    for (unsigned int i=0; i<params.size(); i++)
+    {
+      std::string const& name = params[i].name;
+      std::string        val  = doubleToString(c.values[i]);
+
+      if (name == "cg")
+      {
+        // An aero section inside of config takes precedence, see fdm_larcsim
+        SimpleXMLTransfer* conf = XMLModelFile::getConfig(xml);
+        if (conf->indexOfChild("aero") >= 0)
+          conf->setAttributeOverwrite("aero.misc.CG_arm", val);
+        else
+          xml->setAttributeOverwrite("aero.misc.CG_arm", val);
+      }
+      else if (name.find('.') != std::string::npos)
+        xml->setAttributeOverwrite(name, val);
+    }
+    fdmi->loadAirplane(xml, env, cfgfile);
+    delete xml;
+
+    if (fdmi->fdm == NULL)
+      throw std::runtime_error("Unable to load airplane specification file.");
+  }
+  catch (XMLException e)
+  {
+    c.error = std::string("XMLException: ") + e.what();
+  }
+  catch (std::runtime_error& e)
+  {
+    c.error = e.what();
+  }
+  SDL_mutexV(load_mutex);
+
+  if (c.error.length() == 0)
+  {
+    FDMBase* fdm = fdmi->fdm;
+
+    // launch like initialize_flight_model() does
+    double velocity_rel = getValue(c, "velocity_rel", cfgfile->getDouble("launch.velocity_rel", 1));
+    double psi          = direction*M_PI/180;
+    double launchx      = cfgfile->getDouble("launch.rel_front", MODELSTART_REL_FRONT);
+    double launchy      = cfgfile->getDouble("launch.rel_right", MODELSTART_REL_RIGHT);
+    double posX = -player_pos.r[2] + launchx*cos(psi) - launchy*sin(psi);
+    double posY =  player_pos.r[0] + launchx*sin(psi) + launchy*cos(psi);
+    double theta    = cfgfile->getDouble("launch.angle", 0);
+    double altitude = cfgfile->getDouble("launch.altitude", 6);
+
+    altitude += fdm->getZLow() + Global::scenery->getHeight(posX, posY);
+
+    fdmi->initAirplaneState(velocity_rel, 0.0, theta, psi, posX, posY, -1*altitude);
+
+    double t = 0;
+    c.alt_max = -fdm->getPos().r[2];
+    while (t < duration)
+    {
+      input.getInputs(t, &inputs);
+
+      windfield->updateThermals(step_dt * multiloop);
+      fdmi->update(&inputs, step_dt, multiloop);
+      inputs.ClearKeys();
+      t     += step_dt * multiloop;
+      steps += multiloop;
+
+      if (-fdm->getPos().r[2] > c.alt_max)
+        c.alt_max = -fdm->getPos().r[2];
+    }
+
+    CRRCMath::Vector3 pos = fdm->getPos();
+    c.t             = t;
+    c.pos[0]        = pos.r[0];
+    c.pos[1]        = pos.r[1];
+    c.pos[2]        = pos.r[2];
+    c.V_rel_airmass = fdm->getVRelAirmass();
+    c.nLogMsg       = env->nLogMsg;
+  }
+
+  delete fdmi;
+  delete env;
+  delete windfield;
+}
@@ -0,0 +1,203 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#ifndef CRRC_SWEEP_H
+#define CRRC_SWEEP_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <SDL.h>
+#include "mod_fdm/fdm_inputs.h"
+#include "mod_misc/SimpleXMLTransfer.h"
+
+/**
+ * A scripted timeline of control inputs.
+ *
+ * Format (one keyframe per line, '#' starts a comment):
+ * <pre>
+ *   time[s] aileron elevator rudder throttle [flap spoiler retract pitch]
+ * </pre>
+ * Inputs are interpolated linearly between keyframes and held constant
+ * after the last one. To get a step, repeat a time value.
+ */
+class BatchInputScript
+{
+  public:
+    /**
+     * Read keyframes from file. An empty filename results in an empty
+     * script (all inputs neutral, throttle off).
+     */
+    BatchInputScript(std::string filename);
+
+    /**
+     * Write the inputs at time <code>t</code> into <code>inputs</code>.
+     * Only the control surface channels are touched. <code>t</code> must
+     * not decrease between calls.
+     */
+    void getInputs(double t, TSimInputs* inputs);
+
+    /**
+     * Start again at t=0.
+     */
+    void rewind() { idx = 0; };
+
+  private:
+    struct Keyframe
+    {
+      double     t;
+      TSimInputs in;
+    };
+
+    void copy(TSimInputs const& a, TSimInputs const& b, double f, TSimInputs* out);
+
+    std::vector<Keyframe> keys;
+    std::vector<Keyframe>::size_type idx;
+};
+
+/**
+ * Runs many independent simulations of one airplane in one scenery, with
+ * different parameters, on several threads.
+ *
+ * Every simulation has its own flight model, FDM environment and windfield
+ * (thermals, turbulence, wind velocity and direction), so they don't
+ * influence each other. The scenery (Global::scenery) is shared and only
+ * read; if it isn't reentrant (see Scenery::isReentrant()), only one thread
+ * is used.
+ *
+ * Parameters are given as <code>name=value1,value2,...</code>. Every
+ * combination of values is simulated. Known names:
+ * <pre>
+ *   velocity_rel   launch velocity relative to trimmed flight
+ *   wind_dir       wind direction in degrees
+ *   wind_vel       wind velocity in ft/s
+ *   dt             FDM timestep in s
+ *   cg             CG position (aero.misc.CG_arm of the airplane)
+ *   a.b.c          any other name is an attribute path in the airplane file
+ * </pre>
+ *
+ * Scheduling: cases are distributed round robin over per-thread queues.
+ * A thread takes work from the back of its own queue; when that is empty
+ * it steals from the front of another thread's queue.
+ */
+class CRRC_Sweep
+{
+  public:
+    /**
+     * \param cfgfile    crrcsim's configuration (launch.*, controllers, airplane.*)
+     * \param script     control inputs, copied for every simulation
+     * \param duration   simulated time per case in s
+     * \param dt         default FDM timestep in s
+     * \param multiloop  FDM steps per thermal update
+     */
+    CRRC_Sweep(SimpleXMLTransfer* cfgfile, BatchInputScript const& script,
+               double duration, double dt, int multiloop);
+    ~CRRC_Sweep();
+
+    /**
+     * Add a parameter, e.g. "wind_dir=0,90,180,270".
+     * Throws std::runtime_error on syntax errors.
+     */
+    void addParameter(std::string spec);
+
+    /**
+     * Number of simulations to run
+     */
+    int getNumCases();
+
+    /**
+     * Runs all cases on <code>nThreads</code> threads and writes one line
+     * per case to <code>out</code>. Returns the number of failed cases.
+     */
+    int run(int nThreads, FILE* out);
+
+  private:
+    struct Parameter
+    {
+      std::string         name;
+      std::vector<double> values;
+    };
+
+    struct Case
+    {
+      std::vector<double> values;
+
+      /// @name results
+      //@{
+      double      t;
+      double      pos[3];
+      double      alt_max;
+      double      V_rel_airmass;
+      int         nLogMsg;
+      std::string error;
+      //@}
+    };
+
+    struct Worker
+    {
+      CRRC_Sweep*     sweep;
+      int             id;
+      SDL_Thread*     thread;
+      SDL_mutex*      mutex;
+      std::deque<int> queue;
+      long            steps;
+    };
+
+    static int workerThread(void* data);
+
+    /**
+     * Gets the next case for worker <code>id</code>. Returns false if there
+     * is no work left.
+     */
+    bool getWork(int id, int& nCase);
+
+    /**
+     * Simulate one case
+     */
+    void runCase(Case& c, long& steps);
+
+    double getValue(Case const& c, std::string name, double dDefault);
+
+    SimpleXMLTransfer*     cfgfile;
+    SimpleXMLTransfer*     location;
+    SimpleXMLTransfer*     airplane;
+    BatchInputScript       script;
+    double                 duration;
+    double                 dt;
+    int                    multiloop;
+
+    /// @name defaults from cfg->wind
+    //@{
+    double                 wind_vel;
+    double                 wind_dir;
+    double                 wind_turb;
+    //@}
+
+    std::vector<Parameter> params;
+    std::vector<Case>      cases;
+    std::vector<Worker*>   workers;
+
+    /**
+     * Loading an airplane writes to std::cout and reads the shared
+     * configuration, so this is only done by one thread at a time.
+     */
+    SDL_mutex*             load_mutex;
+};
+
+#endif
@@ -43,6 +43,7 @@ CRRCAudioServer*  Global::soundserver = NULL;
 T_GameHandler*    Global::gameHandler = NULL;
 TSimInputs        Global::inputs;
 float             Global::dt;
+int               Global::fixed_multiloop = 0;
 int               Global::nFPS;
 std::string       Global::verboseString;
 TestModeData      Global::testmode;
@@ -51,3 +52,4 @@ TInputDev*        Global::inputDev;
 Aircraft*         Global::aircraft;
 FlightRecorder*   Global::recorder;
 Robots*           Global::robots;
+FDMThread*        Global::fdmThread = NULL;
@@ -54,6 +54,7 @@ class TInputDev;
 class Aircraft;
 class FlightRecorder;
 class Robots;
+class FDMThread;
 
 /**
  * Contains data related to test mode.
@@ -89,6 +90,7 @@ class Global
     static T_GameHandler*   gameHandler;    ///< The active game mode.
     static TSimInputs       inputs;         ///< Control input values.
     static float            dt;             ///< time interval of integration of EOMs
+    static int              fixed_multiloop;///< EOM steps per frame in deterministic mode, 0: follow wall clock
     static std::string      verboseString;  ///< Informational line of text
     static TestModeData     testmode;       ///< Test mode data structure
     static int              nFPS;           ///< average video update rate (FPS)
@@ -97,6 +99,7 @@ class Global
     static Aircraft*        aircraft;       ///< A complete Aircraft (model & FDM).
     static FlightRecorder*  recorder;
     static Robots*          robots;
+    static FDMThread*       fdmThread;      ///< Runs the aircraft's FDM, NULL: FDM runs in idle()
 };
 
 
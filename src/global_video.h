@@ -86,12 +86,14 @@ void  setSloppyCam(float flValue);
 void initConsole();
 
 /**
- * Create a new airplane visualization
+ * Create a new airplane visualization. A shared visualization uses
+ * the same model as all other shared visualizations of this model.
  */
 long new_visualization( std::string const& model_name,
                         std::string const& texture_path,
                         CRRCMath::Vector3 const& pCG,
-                        SimpleXMLTransfer *xml);
+                        SimpleXMLTransfer *xml,
+                        bool shared = false);
 
 /**
  * Deallocate an airplane visualization
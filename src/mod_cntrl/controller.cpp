@@ -31,43 +31,39 @@
 #include "cntrl_limitflipthr/limitflipthrottle.h"
 
 
-void Controller::LoadList(SimpleXMLTransfer*       cfg, 
-                          std::vector<Controller*> &controllers)
+void Controller::LoadList(SimpleXMLTransfer*  cfg, 
+                          ControllerPipeline& pipeline)
 {
+  pipeline.Clear();
   try
   {
     SimpleXMLTransfer* cntrldescr;
-    Controller*        cntrl;
     std::string name;
     for (int n=0; n<cfg->getChildCount(); n++)
     {
       cntrldescr = cfg->getChildAt(n);
       name       = cntrldescr->getName();
-      cntrl      = 0;
       /*
        * MNav is not converted to this structure yet but should be...
       if (name.compare("MNAV") == 0)
         cntrl = new Cntrl_MNAV(cntrldescr);
       else */
       if (name.compare("InitInputs") == 0)
-        cntrl = new Cntrl_InitInputs(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctInitInputs, new Cntrl_InitInputs(cntrldescr));
       else if (name.compare("SetUserInput") == 0)
-        cntrl = new Cntrl_SetUserInput(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctSetUserInput, new Cntrl_SetUserInput(cntrldescr));
       else if (name.compare("RateOfClimb") == 0)
-        cntrl = new Cntrl_RateOfClimb(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctRateOfClimb, new Cntrl_RateOfClimb(cntrldescr));
       else if (name.compare("Phugoid") == 0)
-        cntrl = new Cntrl_Phugoid(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctPhugoid, new Cntrl_Phugoid(cntrldescr));
       else if (name.compare("Omega") == 0)
-        cntrl = new Cntrl_Omega(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctOmega, new Cntrl_Omega(cntrldescr));
       else if (name.compare("MCopter01") == 0)
-        cntrl = new Cntrl_MCopter01(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctMCopter01, new Cntrl_MCopter01(cntrldescr));
       else if (name.compare("ScaleThrottle") == 0)
-        cntrl = new Cntrl_ScaleThrottle(cntrldescr);
+        pipeline.Add(ControllerPipeline::ctScaleThrottle, new Cntrl_ScaleThrottle(cntrldescr));
       else if (name.compare("LimitFlipThrottle") == 0)
-        cntrl = new Cntrl_LimitFlipThrottle(cntrldescr);
-             
-      if (cntrl)
-        controllers.push_back(cntrl);
+        pipeline.Add(ControllerPipeline::ctLimitFlipThrottle, new Cntrl_LimitFlipThrottle(cntrldescr));
     }
   }
   catch (XMLException e)
@@ -91,3 +87,78 @@ int Controller::Limit(float &flVal)
   else
     return(0);
 }
+
+ControllerPipeline::~ControllerPipeline()
+{
+  Clear();
+}
+
+void ControllerPipeline::Add(eType type, Controller* cntrl)
+{
+  Stage stage;
+
+  stage.type  = type;
+  stage.cntrl = cntrl;
+  stages.push_back(stage);
+}
+
+void ControllerPipeline::Clear()
+{
+  for (unsigned int n=0; n<stages.size(); n++)
+    delete stages[n].cntrl;
+  stages.clear();
+}
+
+void ControllerPipeline::Reset()
+{
+  for (unsigned int n=0; n<stages.size(); n++)
+    stages[n].cntrl->Reset();
+}
+
+/**
+ * Calls <code>Class::Calc()</code> of the controller in <code>stage</code>
+ * directly, without looking it up in the vtable.
+ */
+#define CALC_STAGE(Class) \
+  static_cast<Class*>(stage.cntrl)->Class::Calc(dt, fdm, pInputsFromUser, pInputsToFDM)
+
+void ControllerPipeline::Calc(double      dt, 
+                              FDMBase*    fdm,
+                              TSimInputs* pInputsFromUser,
+                              TSimInputs* pInputsToFDM)
+{
+  for (unsigned int n=0; n<stages.size(); n++)
+  {
+    const Stage& stage = stages[n];
+
+    switch (stage.type)
+    {
+      case ctInitInputs:
+        CALC_STAGE(Cntrl_InitInputs);
+        break;
+      case ctSetUserInput:
+        CALC_STAGE(Cntrl_SetUserInput);
+        break;
+      case ctRateOfClimb:
+        CALC_STAGE(Cntrl_RateOfClimb);
+        break;
+      case ctPhugoid:
+        CALC_STAGE(Cntrl_Phugoid);
+        break;
+      case ctOmega:
+        CALC_STAGE(Cntrl_Omega);
+        break;
+      case ctMCopter01:
+        CALC_STAGE(Cntrl_MCopter01);
+        break;
+      case ctScaleThrottle:
+        CALC_STAGE(Cntrl_ScaleThrottle);
+        break;
+      case ctLimitFlipThrottle:
+        CALC_STAGE(Cntrl_LimitFlipThrottle);
+        break;
+    }
+  }
+}
+
+#undef CALC_STAGE
@@ -25,6 +25,10 @@
 #include "../mod_fdm/fdm_env.h"
 #include "../mod_fdm/fdm_inputs.h"
 
+#include <vector>
+
+class ControllerPipeline;
+
 /**
  * Base class/interface for a controller (autopilot or whatever).
  * Does also include static methods which might be needed by a controller or
@@ -55,9 +59,10 @@ public:
   
   /**
    * Creates a list of controllers according to the xml description in cfg.
+   * Any controllers loaded into <code>pipeline</code> before are deleted.
    */
-  static void LoadList(SimpleXMLTransfer*       cfg,
-                       std::vector<Controller*> &controllers);
+  static void LoadList(SimpleXMLTransfer*  cfg,
+                       ControllerPipeline& pipeline);
   
   /**
    * Limits flVal to -0.5 <= flVal <= 0.5
@@ -66,4 +71,62 @@ public:
   static int Limit(float &flVal);
 };
 
+/**
+ * The controllers of a model or of the simulation, in the order they are
+ * evaluated.
+ *
+ * The pipeline is built once by Controller::LoadList(). Each stage records
+ * which class its controller is, so Calc() calls the controllers directly
+ * instead of through the vtable. The pipeline owns its controllers.
+ */
+class ControllerPipeline
+{
+public:
+  ControllerPipeline() {};
+  ~ControllerPipeline();
+
+  /**
+   * Runs all controllers, see Controller::Calc().
+   */
+  void Calc(double      dt, 
+            FDMBase*    fdm,
+            TSimInputs* pInputsFromUser,
+            TSimInputs* pInputsToFDM);
+
+  /**
+   * Resets all controllers.
+   */
+  void Reset();
+
+  /**
+   * Deletes all controllers.
+   */
+  void Clear();
+
+  /**
+   * Number of controllers
+   */
+  unsigned int size() const { return(stages.size()); };
+
+private:
+  friend class Controller;
+
+  enum eType { ctInitInputs, ctSetUserInput, ctRateOfClimb, ctPhugoid,
+               ctOmega, ctMCopter01, ctScaleThrottle, ctLimitFlipThrottle };
+
+  struct Stage
+  {
+    eType       type;
+    Controller* cntrl;
+  };
+
+  void Add(eType type, Controller* cntrl);
+
+  std::vector<Stage> stages;
+
+  // not copyable, the controllers are owned
+  ControllerPipeline(const ControllerPipeline&);
+  ControllerPipeline& operator=(const ControllerPipeline&);
+};
+
 #endif
@@ -31,6 +31,8 @@
 #include <iostream>
 
 #include "../../mod_misc/ls_constants.h"
+#include "../../mod_misc/SimpleXMLTransfer.h"
+#include "../../mod_math/intgr.h"
 #include "../ls_geodesy.h"
 
 // A bigger value enables more details/effects. Note that a value of zero is 
@@ -38,8 +40,15 @@
 #define EOM_DETAIL       0
 #define EOM_CURVED_EARTH 1
 
-EOM01::EOM01(const char* logfilename, FDMEnviroment* myEnv) : FDMBase(logfilename, myEnv)
+// Geocentric linear velocities, see ls_geoc_rates()
+#define Latitude_dot            geocentric_rates_v[0]
+#define Longitude_dot           geocentric_rates_v[1]
+#define Radius_dot              geocentric_rates_v[2]
+
+EOM01::EOM01(const char* logfilename, FDMEnviroment* myEnv) : FDMBase(logfilename, myEnv),
+  integrator(INTGR_AB2), frame(FRAME_GEOCENTRIC)
 {
+  stage.fValid = false;
 }
 
 double EOM01::getPhi()
@@ -79,16 +88,22 @@ CRRCMath::Vector3 EOM01::getPQR()
 
 double EOM01::getLat()
 {
+  if (frame == FRAME_FLAT)
+    return(v_P_CG_Rwy.r[0] / Sea_level_radius);
   return(Latitude);
 }
 
 double EOM01::getLon()
 {
+  if (frame == FRAME_FLAT)
+    return(v_P_CG_Rwy.r[1] / Sea_level_radius);
   return(Longitude);
 }
 
 double EOM01::getAlt()
 {
+  if (frame == FRAME_FLAT)
+    return(-v_P_CG_Rwy.r[2]);
   return(Altitude);
 }
 
@@ -96,15 +111,30 @@ void EOM01::ls_step_init()
 {
   /* Set past values to zero */
   v_V_dot_past = CRRCMath::Vector3();
-  latitude_dot_past = longitude_dot_past = radius_dot_past  = 0;
+  pos_dot_past[0] = pos_dot_past[1] = pos_dot_past[2] = 0;
   v_R_omega_dot_body_past = CRRCMath::Vector3();
   e_dot_0_past = e_dot_1_past = e_dot_2_past = e_dot_3_past = 0;
+  stage.fValid = false;
 
-  /* Initialize geocentric position from geodetic latitude and altitude */
+  if (frame == FRAME_FLAT)
+  {
+    /* Initialize runway position like the flight models derived
+       latitude and longitude from it: with the radius at the equator */
+
+    double dummy;
+    ls_geod_to_geoc( 0, 0, &Sea_level_radius, &dummy);
+    v_P_CG_Rwy.r[0] = Sea_level_radius * Latitude;
+    v_P_CG_Rwy.r[1] = Sea_level_radius * Longitude;
+    v_P_CG_Rwy.r[2] = -Altitude;
+  }
+  else
+  {
+    /* Initialize geocentric position from geodetic latitude and altitude */
 
-  ls_geod_to_geoc( Latitude, Altitude, &Sea_level_radius, &Lat_geocentric);
-  Lon_geocentric = Longitude;
-  Radius_to_vehicle = Altitude + Sea_level_radius;
+    ls_geod_to_geoc( Latitude, Altitude, &Sea_level_radius, &Lat_geocentric);
+    Lon_geocentric = Longitude;
+    Radius_to_vehicle = Altitude + Sea_level_radius;
+  }
 
   /* Initialize quaternions and transformation matrix from Euler angles */
 
@@ -146,18 +176,26 @@ void EOM01::ls_step_init()
  */
 void EOM01::ls_step( SCALAR dt )   
 {
-  SCALAR        dth;
-  SCALAR        epsilon, inv_eps;
-  SCALAR        e_dot_0, e_dot_1, e_dot_2, e_dot_3;
-  SCALAR        cos_Lat_geocentric, inv_Radius_to_vehicle;
-    
-  CRRCMath::Vector3    v_R_omega_total;    /* Diff btw B & L       */
+  switch (integrator)
+  {
+   case INTGR_SYMPLECTIC:
+    ls_step_symplectic(dt);
+    break;
+   case INTGR_RK4:
+    ls_step_rk4(dt);
+    break;
+   default:
+    ls_step_ab2(dt);
+    break;
+  }
+}
 
-  VECTOR_3    geocentric_rates_v;       /* Geocentric linear velocities */
-#define Geocentric_rates_v      geocentric_rates_v
-#define Latitude_dot            geocentric_rates_v[0]
-#define Longitude_dot           geocentric_rates_v[1]
-#define Radius_dot              geocentric_rates_v[2]
+void EOM01::ls_step_ab2( SCALAR dt )
+{
+  SCALAR        dth;
+  SCALAR        e_dot[4];
+  VECTOR_3      pos_rates_v;              /* Geocentric or runway linear velocities */
+  SCALAR*       pos = ls_pos();
 
 /* Update time */
 
@@ -174,8 +212,105 @@ void EOM01::ls_step( SCALAR dt )
 
   v_V_dot_past = v_V_dot_local;
 
-/* Calculate trajectory rate (geocentric coordinates) */
+/* Calculate trajectory rate (geocentric or runway coordinates) */
+
+  ls_pos_rates(pos_rates_v);
+
+/*  A N G U L A R   V E L O C I T I E S   A N D   P O S I T I O N S  */
+
+/* Integrate rotational accelerations to get velocities */
+
+  v_R_omega_body = v_R_omega_body + (v_R_omega_dot_body*3 - v_R_omega_dot_body_past)*dth;
+  ls_limit_omega(dt);
+  
+/* Save past states */
+  
+  v_R_omega_dot_body_past = v_R_omega_dot_body;
+
+/* Transform to quaternion rates (see Appendix E in [2]) */
+
+  ls_quat_rates(e_dot);
 
+/* Integrate using trapezoidal as before */
+
+  e_0 = e_0 + dth*(e_dot[0] + e_dot_0_past);
+  e_1 = e_1 + dth*(e_dot[1] + e_dot_1_past);
+  e_2 = e_2 + dth*(e_dot[2] + e_dot_2_past);
+  e_3 = e_3 + dth*(e_dot[3] + e_dot_3_past);
+
+/* Save past values */
+
+  e_dot_0_past = e_dot[0];
+  e_dot_1_past = e_dot[1];
+  e_dot_2_past = e_dot[2];
+  e_dot_3_past = e_dot[3];
+
+  ls_update_attitude();
+
+/*  L I N E A R   P O S I T I O N S   */
+
+/* Trapezoidal acceleration for position */
+
+  for (int n=0; n<3; n++)
+    pos[n] = pos[n] + dth*(pos_rates_v[n] + pos_dot_past[n]);
+
+/* Save past values */
+
+  for (int n=0; n<3; n++)
+    pos_dot_past[n] = pos_rates_v[n];
+
+/* end of ls_step */
+}
+
+void EOM01::ls_step_symplectic( SCALAR dt )
+{
+  SCALAR        e_dot[4];
+  VECTOR_3      pos_rates_v;
+  SCALAR*       pos = ls_pos();
+
+  // velocities first...
+  v_V_local      += v_V_dot_local*dt;
+  v_R_omega_body += v_R_omega_dot_body*dt;
+  ls_limit_omega(dt);
+
+  // ...then attitude and position, using the new velocities
+  ls_quat_rates(e_dot);
+  e_0 += dt*e_dot[0];
+  e_1 += dt*e_dot[1];
+  e_2 += dt*e_dot[2];
+  e_3 += dt*e_dot[3];
+  ls_update_attitude();
+
+  ls_pos_rates(pos_rates_v);
+  for (int n=0; n<3; n++)
+    pos[n] += dt*pos_rates_v[n];
+}
+
+void EOM01::ls_step_rk4( SCALAR dt )
+{
+  CRRCMath::IntegrationsverfahrenRK4<State> rk4;
+  StageFunc                                 f(this);
+
+  rk4.init(ls_get_state());
+  rk4.step(dt, ls_derivs(), f);
+  ls_set_state(rk4.val);
+  ls_limit_omega(dt);
+}
+
+void EOM01::ls_limit_omega(SCALAR dt)
+{
+  // sanity check: v_R_omega_body.length() * dt < pi/2
+  double vRo_max = 0.5*M_PI / dt;
+  double vRo_len = v_R_omega_body.length();
+  
+  if (vRo_len > vRo_max)
+    v_R_omega_body *= vRo_max/vRo_len;
+}
+
+void EOM01::ls_geoc_rates(VECTOR_3 geocentric_rates_v)
+{
+  SCALAR        cos_Lat_geocentric, inv_Radius_to_vehicle;
+  
   inv_Radius_to_vehicle = 1.0/Radius_to_vehicle;
   cos_Lat_geocentric = cos(Lat_geocentric);
 
@@ -196,30 +331,35 @@ void EOM01::ls_step( SCALAR dt )
 
   Latitude_dot = v_V_local.r[0]*inv_Radius_to_vehicle;
   Radius_dot   = -v_V_local.r[2];
+}
 
-/*  A N G U L A R   V E L O C I T I E S   A N D   P O S I T I O N S  */
-
-/* Integrate rotational accelerations to get velocities */
+SCALAR* EOM01::ls_pos()
+{
+  if (frame == FRAME_FLAT)
+    return(v_P_CG_Rwy.r);
+  return(geocentric_position_v);
+}
 
-  v_R_omega_body = v_R_omega_body + (v_R_omega_dot_body*3 - v_R_omega_dot_body_past)*dth;
-  
-  // sanity check: v_R_omega_body.length() * dt < pi/2
+void EOM01::ls_pos_rates(VECTOR_3 pos_rates_v)
+{
+  if (frame == FRAME_FLAT)
   {
-    double vRo_max = 0.5*M_PI / dt;
-    double vRo_len = v_R_omega_body.length();
-    
-    if (vRo_len > vRo_max)
-      v_R_omega_body *= vRo_max/vRo_len;
+    for (int n=0; n<3; n++)
+      pos_rates_v[n] = v_V_local.r[n];
   }
-  
-/* Save past states */
-  
-  v_R_omega_dot_body_past = v_R_omega_dot_body;
+  else
+    ls_geoc_rates(pos_rates_v);
+}
+
+void EOM01::ls_quat_rates(SCALAR e_dot[4])
+{
+  CRRCMath::Vector3    v_R_omega_total;    /* Diff btw B & L       */
 
-  if (EOM_DETAIL >= EOM_CURVED_EARTH)
+  if (EOM_DETAIL >= EOM_CURVED_EARTH && frame == FRAME_GEOCENTRIC)
   {
     CRRCMath::Vector3    v_R_omega_local;    /* Angular L rates      */
     CRRCMath::Vector3    v_R_local_in_body;
+    SCALAR               inv_Radius_to_vehicle = 1.0/Radius_to_vehicle;
     
     /* Calculate local axis frame rates due to travel over curved earth */
     v_R_omega_local.r[0] =  v_V_local.r[1]*inv_Radius_to_vehicle;
@@ -237,17 +377,15 @@ void EOM01::ls_step( SCALAR dt )
 
 /* Transform to quaternion rates (see Appendix E in [2]) */
 
-  e_dot_0 = 0.5*( -v_R_omega_total.r[0]*e_1 - v_R_omega_total.r[1]*e_2 - v_R_omega_total.r[2]*e_3 );
-  e_dot_1 = 0.5*(  v_R_omega_total.r[0]*e_0 - v_R_omega_total.r[1]*e_3 + v_R_omega_total.r[2]*e_2 );
-  e_dot_2 = 0.5*(  v_R_omega_total.r[0]*e_3 + v_R_omega_total.r[1]*e_0 - v_R_omega_total.r[2]*e_1 );
-  e_dot_3 = 0.5*( -v_R_omega_total.r[0]*e_2 + v_R_omega_total.r[1]*e_1 + v_R_omega_total.r[2]*e_0 );
-
-/* Integrate using trapezoidal as before */
+  e_dot[0] = 0.5*( -v_R_omega_total.r[0]*e_1 - v_R_omega_total.r[1]*e_2 - v_R_omega_total.r[2]*e_3 );
+  e_dot[1] = 0.5*(  v_R_omega_total.r[0]*e_0 - v_R_omega_total.r[1]*e_3 + v_R_omega_total.r[2]*e_2 );
+  e_dot[2] = 0.5*(  v_R_omega_total.r[0]*e_3 + v_R_omega_total.r[1]*e_0 - v_R_omega_total.r[2]*e_1 );
+  e_dot[3] = 0.5*( -v_R_omega_total.r[0]*e_2 + v_R_omega_total.r[1]*e_1 + v_R_omega_total.r[2]*e_0 );
+}
 
-  e_0 = e_0 + dth*(e_dot_0 + e_dot_0_past);
-  e_1 = e_1 + dth*(e_dot_1 + e_dot_1_past);
-  e_2 = e_2 + dth*(e_dot_2 + e_dot_2_past);
-  e_3 = e_3 + dth*(e_dot_3 + e_dot_3_past);
+void EOM01::ls_update_attitude()
+{
+  SCALAR        epsilon, inv_eps;
 
 /* calculate orthagonality correction  - scale quaternion to unity length */
 
@@ -259,13 +397,6 @@ void EOM01::ls_step( SCALAR dt )
   e_2 = inv_eps*e_2;
   e_3 = inv_eps*e_3;
 
-/* Save past values */
-
-  e_dot_0_past = e_dot_0;
-  e_dot_1_past = e_dot_1;
-  e_dot_2_past = e_dot_2;
-  e_dot_3_past = e_dot_3;
-
 /* Update local to body transformation matrix */
 
   LocalToBody.v[0][0] = e_0*e_0 + e_1*e_1 - e_2*e_2 - e_3*e_3;
@@ -295,22 +426,141 @@ void EOM01::ls_step( SCALAR dt )
 /* Resolve Psi to 0 - 359.9999 */
 
   if (Psi < 0 ) Psi = Psi + 2*M_PI;
+}
 
-/*  L I N E A R   P O S I T I O N S   */
+EOM01::State EOM01::State::operator+(State const& b) const
+{
+  State s;
+
+  s.v_V_local      = v_V_local      + b.v_V_local;
+  s.v_R_omega_body = v_R_omega_body + b.v_R_omega_body;
+  for (int n=0; n<4; n++)
+    s.e[n] = e[n] + b.e[n];
+  for (int n=0; n<3; n++)
+    s.pos[n] = pos[n] + b.pos[n];
+  return(s);
+}
 
-/* Trapezoidal acceleration for position */
+EOM01::State EOM01::State::operator*(double f) const
+{
+  State s;
+
+  s.v_V_local      = v_V_local      * f;
+  s.v_R_omega_body = v_R_omega_body * f;
+  for (int n=0; n<4; n++)
+    s.e[n] = e[n] * f;
+  for (int n=0; n<3; n++)
+    s.pos[n] = pos[n] * f;
+  return(s);
+}
 
-  Lat_geocentric       = Lat_geocentric    + dth*(Latitude_dot  + latitude_dot_past );
-  Lon_geocentric       = Lon_geocentric    + dth*(Longitude_dot + longitude_dot_past);
-  Radius_to_vehicle    = Radius_to_vehicle + dth*(Radius_dot    + radius_dot_past );
+EOM01::State EOM01::ls_get_state()
+{
+  State   y;
+  SCALAR* pos = ls_pos();
+
+  y.v_V_local      = v_V_local;
+  y.v_R_omega_body = v_R_omega_body;
+  y.e[0]           = e_0;
+  y.e[1]           = e_1;
+  y.e[2]           = e_2;
+  y.e[3]           = e_3;
+  for (int n=0; n<3; n++)
+    y.pos[n] = pos[n];
+  return(y);
+}
 
-/* Save past values */
+void EOM01::ls_set_state(State const& y)
+{
+  SCALAR* pos = ls_pos();
+
+  v_V_local      = y.v_V_local;
+  v_R_omega_body = y.v_R_omega_body;
+  e_0            = y.e[0];
+  e_1            = y.e[1];
+  e_2            = y.e[2];
+  e_3            = y.e[3];
+  for (int n=0; n<3; n++)
+    pos[n] = y.pos[n];
+  ls_update_attitude();
+}
 
-  latitude_dot_past  = Latitude_dot;
-  longitude_dot_past = Longitude_dot;
-  radius_dot_past    = Radius_dot;
+EOM01::State EOM01::ls_derivs()
+{
+  State d;
 
-/* end of ls_step */
+  d.v_V_local      = v_V_dot_local;
+  d.v_R_omega_body = v_R_omega_dot_body;
+  ls_quat_rates(d.e);
+  ls_pos_rates(d.pos);
+  return(d);
+}
+
+EOM01::State EOM01::ls_derivs_at(State const& y)
+{
+  ls_set_state(y);
+  if (stage.fValid)
+    ls_stage();
+  return(ls_derivs());
+}
+
+const char* EOM01::getIntegratorName(Integrator intgr)
+{
+  switch (intgr)
+  {
+   case INTGR_SYMPLECTIC:
+    return("symplectic");
+   case INTGR_RK4:
+    return("rk4");
+   default:
+    return("ab2");
+  }
+}
+
+EOM01::Integrator EOM01::getIntegratorByName(std::string name)
+{
+  if (name == "ab2")
+    return(INTGR_AB2);
+  else if (name == "symplectic")
+    return(INTGR_SYMPLECTIC);
+  else if (name == "rk4")
+    return(INTGR_RK4);
+  else
+    throw XMLException("unknown integrator " + name);
+}
+
+const char* EOM01::getFrameName(Frame frm)
+{
+  switch (frm)
+  {
+   case FRAME_FLAT:
+    return("flat");
+   default:
+    return("geocentric");
+  }
+}
+
+EOM01::Frame EOM01::getFrameByName(std::string name)
+{
+  if (name == "geocentric")
+    return(FRAME_GEOCENTRIC);
+  else if (name == "flat")
+    return(FRAME_FLAT);
+  else
+    throw XMLException("unknown frame " + name);
+}
+
+void EOM01::ls_read_integrator(SimpleXMLTransfer* cfg)
+{
+  integrator = INTGR_AB2;
+  frame      = FRAME_GEOCENTRIC;
+  if (cfg->indexOfChild("integrator") >= 0)
+  {
+    SimpleXMLTransfer* item = cfg->getChild("integrator");
+
+    integrator = getIntegratorByName(item->attribute("type",  "ab2"));
+    frame      = getFrameByName(item->attribute("frame", "geocentric"));
+  }
 }
 
 
@@ -321,11 +571,17 @@ void EOM01::ls_step( SCALAR dt )
  */
 void EOM01::ls_aux(CRRCMath::Vector3 v_V_local_airmass, CRRCMath::Vector3 v_V_gust_body)
 {
-  /* update geodetic position */
-  ls_geoc_to_geod_fastbowring(Lat_geocentric, Radius_to_vehicle,
-                              &Latitude, &Altitude, &Sea_level_radius);
+  /* update geodetic position; a flat earth only needs the altitude,
+     latitude and longitude are calculated by getLat() and getLon() */
+  if (frame == FRAME_FLAT)
+    Altitude = -v_P_CG_Rwy.r[2];
+  else
+  {
+    ls_geoc_to_geod_fastbowring(Lat_geocentric, Radius_to_vehicle,
+                                &Latitude, &Altitude, &Sea_level_radius);
 
-  Longitude = Lon_geocentric;
+    Longitude = Lon_geocentric;
+  }
 
   /* Form relative velocity vector */
 
@@ -357,11 +613,15 @@ void EOM01::ls_aux(CRRCMath::Vector3 v_V_local_airmass, CRRCMath::Vector3 v_V_gu
 
   Density = env->GetRho(Altitude);
   
-  /* Determine location in runway coordinates */
+  /* Determine location in runway coordinates (with a flat earth,
+     that is what ls_step() integrates) */
 
-  v_P_CG_Rwy.r[0] = Sea_level_radius * Latitude;
-  v_P_CG_Rwy.r[1] = Sea_level_radius * Longitude;
-  v_P_CG_Rwy.r[2] = Sea_level_radius - Radius_to_vehicle;
+  if (frame == FRAME_GEOCENTRIC)
+  {
+    v_P_CG_Rwy.r[0] = Sea_level_radius * Latitude;
+    v_P_CG_Rwy.r[1] = Sea_level_radius * Longitude;
+    v_P_CG_Rwy.r[2] = Sea_level_radius - Radius_to_vehicle;
+  }
   
   /* end of ls_aux */
 }
@@ -449,17 +709,28 @@ void EOM01::ls_accel(CRRCMath::Vector3 v_F,
   
   /* Calculate linear accelerations */
 
-  tan_Lat_geocentric = tan(Lat_geocentric);
   inv_Mass    = 1/Mass;
-  inv_Radius  = 1/Radius_to_vehicle;
+
+  if (frame == FRAME_FLAT)
+  {
+    v_V_dot_local = v_F_local*inv_Mass;
+#if EOM_TEST == 0
+    v_V_dot_local.r[2] += Gravity;
+#endif
+  }
+  else
+  {
+    tan_Lat_geocentric = tan(Lat_geocentric);
+    inv_Radius  = 1/Radius_to_vehicle;
   
-  v_V_dot_local.r[0] = inv_Mass*v_F_local.r[0] + inv_Radius*(v_V_local.r[0]*v_V_local.r[2] - v_V_local.r[1]*v_V_local.r[1] *tan_Lat_geocentric);
-  v_V_dot_local.r[1] = inv_Mass*v_F_local.r[1] + inv_Radius*(v_V_local.r[1]*v_V_local.r[2]  + v_V_local.r[0]*v_V_local.r[1]*tan_Lat_geocentric);
+    v_V_dot_local.r[0] = inv_Mass*v_F_local.r[0] + inv_Radius*(v_V_local.r[0]*v_V_local.r[2] - v_V_local.r[1]*v_V_local.r[1] *tan_Lat_geocentric);
+    v_V_dot_local.r[1] = inv_Mass*v_F_local.r[1] + inv_Radius*(v_V_local.r[1]*v_V_local.r[2]  + v_V_local.r[0]*v_V_local.r[1]*tan_Lat_geocentric);
 #if EOM_TEST != 0
-  v_V_dot_local.r[2] = inv_Mass*v_F_local.r[2]           - inv_Radius*(v_V_local.r[0]*v_V_local.r[0] + v_V_local.r[1]*v_V_local.r[1]);
+    v_V_dot_local.r[2] = inv_Mass*v_F_local.r[2]           - inv_Radius*(v_V_local.r[0]*v_V_local.r[0] + v_V_local.r[1]*v_V_local.r[1]);
 #else
-  v_V_dot_local.r[2] = inv_Mass*v_F_local.r[2] + Gravity - inv_Radius*(v_V_local.r[0]*v_V_local.r[0] + v_V_local.r[1]*v_V_local.r[1]);
+    v_V_dot_local.r[2] = inv_Mass*v_F_local.r[2] + Gravity - inv_Radius*(v_V_local.r[0]*v_V_local.r[0] + v_V_local.r[1]*v_V_local.r[1]);
 #endif
+  }
   
   // The altitude-controller, because it is very easy here:
   if (fixed_z < EOM01_FIXED_Z_OFF*0.98)
@@ -29,6 +29,7 @@
 # define EOM01_H
 
 # include <vector>
+# include <string>
 # include "../ls_types.h"
 # include "../fdm.h"
 # include "../../mod_math/vector3.h"
@@ -69,6 +70,82 @@ class EOM01 : public FDMBase
 {   
 public:
   
+  /**
+   * Integration methods ls_step() can use, see setIntegrator()
+   */
+  enum Integrator
+  {
+    /**
+     * Adams-Bashforth for velocities, trapezoidal for attitude and
+     * position. This is what CRRCSim always used.
+     */
+    INTGR_AB2,
+
+    /**
+     * Semi-implicit (symplectic) Euler: velocities first, then attitude
+     * and position with the new velocities. Stays stable with stiff
+     * springs (gear) at larger steps.
+     */
+    INTGR_SYMPLECTIC,
+
+    /**
+     * Classical Runge-Kutta, fourth order. Forces are calculated again
+     * at the intermediate points, see ls_stage().
+     */
+    INTGR_RK4
+  };
+
+  void setIntegrator(Integrator intgr) { integrator = intgr; };
+  Integrator getIntegrator() { return(integrator); };
+
+  /**
+   * Name of an integrator as used in model files ("ab2", "symplectic",
+   * "rk4").
+   */
+  static const char* getIntegratorName(Integrator intgr);
+
+  /**
+   * The integrator with this name. Throws XMLException if there is none.
+   */
+  static Integrator getIntegratorByName(std::string name);
+
+  /**
+   * Frames the position can be integrated in, see setFrame()
+   */
+  enum Frame
+  {
+    /**
+     * Geocentric latitude, longitude and radius over a round earth,
+     * converted to geodetic coordinates and to the runway frame in
+     * every step. This is what CRRCSim always used.
+     */
+    FRAME_GEOCENTRIC,
+
+    /**
+     * North/east/down relative to the runway over a flat earth. There is
+     * no trigonometry in a step, latitude and longitude are only
+     * calculated by getLat() and getLon().
+     */
+    FRAME_FLAT
+  };
+
+  /**
+   * Has to be called before the state is initialised (ls_step_init(),
+   * called by initAirplaneState()).
+   */
+  void setFrame(Frame frm) { frame = frm; };
+  Frame getFrame() { return(frame); };
+
+  /**
+   * Name of a frame as used in model files ("geocentric", "flat").
+   */
+  static const char* getFrameName(Frame frm);
+
+  /**
+   * The frame with this name. Throws XMLException if there is none.
+   */
+  static Frame getFrameByName(std::string name);
+  
   /**
    * The world coordinate vector vWorld is transformed
    * to body coordinates and returned.
@@ -127,7 +204,30 @@ protected:
   
   virtual void ls_step_init();
   
+  /**
+   * Advances the state by <code>dt</code>, using the accelerations
+   * calculated by the last call of ls_accel() and the integrator
+   * selected (see setIntegrator()).
+   */
   void ls_step( SCALAR dt);
+
+  /**
+   * Reads the integrator and the frame from the model file
+   * (<code>integrator.type</code> and <code>integrator.frame</code> in
+   * <code>cfg</code>, the config section). Defaults are INTGR_AB2 and
+   * FRAME_GEOCENTRIC.
+   */
+  void ls_read_integrator(SimpleXMLTransfer* cfg);
+
+  /**
+   * Called by ls_step() with INTGR_RK4 at the intermediate points of a
+   * step, after the state has been set. It has to call ls_aux() and
+   * ls_accel() with forces for the new state, using what has been
+   * stored in <code>stage</code> for everything which isn't calculated
+   * again. If it doesn't do anything, the accelerations from the start
+   * of the step are used for the whole step.
+   */
+  virtual void ls_stage() {};
   
   /**
    * if fixed_z < EOM01_FIXED_Z_OFF, this altitude is forced by a controller
@@ -139,11 +239,42 @@ protected:
 
   float Controller_s(float s_diff, float v);
 
+  /**
+   * What ls_stage() needs besides the state. The flight model stores it
+   * together with the forces of each step when INTGR_RK4 is used. Wind,
+   * turbulence and the forces of parts which have states of their own
+   * (like the engine) are kept constant during a step.
+   */
+  struct StageInputs
+  {
+    /**
+     * false until the flight model has stored something
+     */
+    bool               fValid;
+    CRRCMath::Vector3  v_V_local_airmass;
+    CRRCMath::Matrix33 m_V_local_airmass_grad;
+    CRRCMath::Vector3  v_V_gust_body;
+    CRRCMath::Vector3  v_R_omega_gust_body;
+
+    /// @name Forces and moments kept constant
+    //@{
+    CRRCMath::Vector3  v_F;
+    CRRCMath::Vector3  v_M;
+    //@}
+  } stage;
+
+  Integrator integrator;
+
+  Frame frame;
+
 protected:
   
   /// @name written by step
   //@{
-  SCALAR  latitude_dot_past, longitude_dot_past, radius_dot_past;
+  /**
+   * Rates of the position (see ls_pos()) in the last step
+   */
+  VECTOR_3 pos_dot_past;
   
   /**
    * P, Q, R
@@ -230,6 +361,89 @@ protected:
   CRRCMath::Vector3 v_P_CG_Rwy;
   
   //@}
+
+private:
+
+  /**
+   * Everything ls_step() integrates. Needed by INTGR_RK4, which has to
+   * combine states and their derivatives.
+   */
+  struct State
+  {
+    CRRCMath::Vector3 v_V_local;
+    CRRCMath::Vector3 v_R_omega_body;
+    SCALAR            e[4];
+    SCALAR            pos[3];    ///< see ls_pos()
+
+    State operator+(State const& b) const;
+    State operator*(double f) const;
+  };
+
+  /**
+   * Calls ls_derivs_at() for IntegrationsverfahrenRK4
+   */
+  class StageFunc
+  {
+    public:
+      StageFunc(EOM01* eom) : eom(eom) {};
+      State operator()(State const& y, double dT) { return(eom->ls_derivs_at(y)); };
+    private:
+      EOM01* eom;
+  };
+  friend class StageFunc;
+
+  void ls_step_ab2(SCALAR dt);
+  void ls_step_symplectic(SCALAR dt);
+  void ls_step_rk4(SCALAR dt);
+
+  /**
+   * Limits v_R_omega_body, so that it turns by less than 90 degrees
+   * in one step.
+   */
+  void ls_limit_omega(SCALAR dt);
+
+  /**
+   * Calculates the rates of latitude, longitude and radius
+   * (geocentric_rates_v) from v_V_local.
+   */
+  void ls_geoc_rates(VECTOR_3 geocentric_rates_v);
+
+  /**
+   * The position ls_step() integrates: geocentric_position_v or, with
+   * FRAME_FLAT, v_P_CG_Rwy.
+   */
+  SCALAR* ls_pos();
+
+  /**
+   * Calculates the rates of ls_pos() from v_V_local.
+   */
+  void ls_pos_rates(VECTOR_3 pos_rates_v);
+
+  /**
+   * Calculates the rates of the quaternion from v_R_omega_body.
+   */
+  void ls_quat_rates(SCALAR e_dot[4]);
+
+  /**
+   * Normalizes the quaternion and calculates LocalToBody and the Euler
+   * angles from it.
+   */
+  void ls_update_attitude();
+
+  State ls_get_state();
+  void  ls_set_state(State const& y);
+
+  /**
+   * Derivative of the current state, using the accelerations calculated
+   * by the last call of ls_accel().
+   */
+  State ls_derivs();
+
+  /**
+   * Sets the state to <code>y</code>, calls ls_stage() and returns the
+   * derivative.
+   */
+  State ls_derivs_at(State const& y);
 };
 
 #endif
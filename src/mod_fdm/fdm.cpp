@@ -24,6 +24,7 @@
 #include <iostream>
 
 #include "../mod_misc/lib_conversions.h"
+#include "../mod_misc/profiler.h"
 #include "../mod_fdm_config.h"
 
 #if (MOD_FDM_USE_002 != 0)
@@ -64,6 +65,7 @@ void ModFDMInterface::update(TSimInputs* inputs,
                              double      dt,
                              int         multiloop)
 {
+  CRRC_PROFILE("fdm");
   fdm->update(inputs, dt, multiloop);
 }
 
@@ -54,6 +54,20 @@ public:
    *  \return terrain height at this point in ft
    */
   virtual float GetSceneryHeight(float x_north, float y_east) = 0;
+
+  /**
+   *  Get the height at <code>n</code> points at once.
+   *  \param x_north x coordinates (positive north)
+   *  \param y_east  y coordinates (positive east)
+   *  \param heights terrain heights in ft are stored here
+   *  \param n       number of points
+   */
+  virtual void GetSceneryHeights(const float* x_north, const float* y_east,
+                                 float* heights, int n)
+  {
+    for (int i=0; i<n; i++)
+      heights[i] = GetSceneryHeight(x_north[i], y_east[i]);
+  };
   
   /**
    * Calculate the wind velocities in all three axes in the given position.
@@ -32,6 +32,7 @@
 #include "../ls_geodesy.h"
 #include "../../mod_misc/SimpleXMLTransfer.h"
 #include "../../mod_misc/lib_conversions.h"
+#include "../../mod_misc/profiler.h"
 #include "../xmlmodelfile.h"
 
 #define PITCH_FIXED_PITCH          1.0
@@ -112,23 +113,47 @@ void CRRC_AirplaneSim_Heli01::update(TSimInputs* inputs,
     logVal(getPsi());    
 #endif
             
-    ls_step( dt );
+    {
+      CRRC_PROFILE("ls_step");
+      ls_step( dt );
+    }
     ls_aux(v_V_local_airmass, v_V_gust_body);
 
     env->ControllerCallback(dt, this, inputs, &myInputs);
     
-    aero(dt, &myInputs, v_F_aero, v_M_aero);
+    {
+      CRRC_PROFILE("aero");
+      aero(dt, &myInputs, v_F_aero, v_M_aero);
+    }
     
 #if FDM_LOG_AERO_OUT != 0
     logVal(v_F_aero);
     logVal(v_M_aero);
 #endif
     
-    engine(dt, &myInputs , v_F_engine, v_M_engine);
-    gear(&myInputs, v_F_gear, v_M_gear);
+    {
+      CRRC_PROFILE("engine");
+      engine(dt, &myInputs , v_F_engine, v_M_engine);
+    }
+    {
+      CRRC_PROFILE("gear");
+      gear(&myInputs, v_F_gear, v_M_gear);
+    }
+    
+    if (integrator == INTGR_RK4)
+    {
+      stage.fValid            = true;
+      stage.v_V_local_airmass = v_V_local_airmass;
+      stage.v_V_gust_body     = v_V_gust_body;
+      stage.v_F               = v_F_aero + v_F_engine;
+      stage.v_M               = v_M_aero + v_M_engine;
+    }
         
-    ls_accel(v_F_aero + v_F_engine + v_F_gear, v_M_aero + v_M_engine + v_M_gear,
-             myInputs.heli_fixed_z, fFixedHorizon);
+    {
+      CRRC_PROFILE("ls_accel");
+      ls_accel(v_F_aero + v_F_engine + v_F_gear, v_M_aero + v_M_engine + v_M_gear,
+               myInputs.heli_fixed_z, fFixedHorizon);
+    }
   }
 }
 
@@ -165,6 +190,8 @@ void CRRC_AirplaneSim_Heli01::LoadFromXML(SimpleXMLTransfer* xml, int nVerbosity
   SimpleXMLTransfer* i;
   SimpleXMLTransfer* cfg = XMLModelFile::getConfig(xml);  
   
+  ls_read_integrator(cfg);
+  
   {
     double to_slug;
     double to_slug_ft_ft;
@@ -592,6 +619,22 @@ void CRRC_AirplaneSim_Heli01::aero(double dt, TSimInputs* inputs, CRRCMath::Vect
 }
 
 
+/**
+ * Only the gear is calculated again for the intermediate states of the
+ * RK4 integrator: aerodynamics and engine keep internal states which must
+ * only be advanced once per step, so their forces from the start of the
+ * step are used.
+ */
+void CRRC_AirplaneSim_Heli01::ls_stage()
+{
+  CRRCMath::Vector3 v_F_gear, v_M_gear;
+
+  ls_aux(stage.v_V_local_airmass, stage.v_V_gust_body);
+  gear(&myInputs, v_F_gear, v_M_gear);
+  ls_accel(stage.v_F + v_F_gear, stage.v_M + v_M_gear,
+           myInputs.heli_fixed_z, fFixedHorizon);
+}
+
 void CRRC_AirplaneSim_Heli01::ls_step_init() 
 {
   CRRCMath::Vector3 v_F_aero, v_F_engine, v_F_gear; // Force x/y/z
@@ -42,6 +42,7 @@ class CRRC_AirplaneSim_Heli01 : public EOM01
 {
    friend class ModFDMInterface;
    friend class CRRC_AirplaneSim_DisplayMode;
+   friend class CRRC_Bench;
    
   public:
 
@@ -135,6 +136,7 @@ class CRRC_AirplaneSim_Heli01 : public EOM01
    void aero(double dt, TSimInputs* inputs, CRRCMath::Vector3& v_F, CRRCMath::Vector3& v_M);
    void engine(SCALAR dt, TSimInputs* inputs, CRRCMath::Vector3& v_F, CRRCMath::Vector3& v_M);
    virtual void ls_step_init();
+   virtual void ls_stage();
  
    float GroundEffect(float dRotorToGround);
 
@@ -24,7 +24,6 @@
 # define CRRC_INPUTS_H
 
 # include <iostream>
-# include <set>
 
 #define EOM01_FIXED_Z_OFF 2.0E6
 
@@ -32,6 +31,9 @@
  *
  * Although the sim currently does only use the four basic inputs,
  * I leave the additional ones...
+ *
+ * The struct is copied in every step of the flight model, so it must not
+ * own any memory: it is trivially copyable.
  */
 class TSimInputs
 {
@@ -43,6 +45,12 @@ class TSimInputs
    enum eSteeringMap { smNOTHING, smAILERON, smELEVATOR, smRUDDER, smTHROTTLE, smFLAP, smSPOILER, smRETRACT, smPITCH };
   
    enum { NUM_AUX_INPUTS=4 };
+
+   /**
+    * Maximum number of keypresses waiting to be consumed. More keys pressed
+    * within one frame are dropped.
+    */
+   enum { MAX_KEYS=16 };
  
    float aileron;    ///< aileron input,          -0.5 ... 0.5
    float elevator;   ///< elevator input,         -0.5 ... 0.5
@@ -64,21 +72,7 @@ class TSimInputs
    */
   void CopyFrom(TSimInputs* source)
   {
-    this->aileron  = source->aileron;
-    this->elevator = source->elevator;
-    this->rudder   = source->rudder;
-    this->throttle = source->throttle;
-    this->flap     = source->flap;
-    this->spoiler  = source->spoiler;
-    this->retract  = source->retract;
-    this->pitch    = source->pitch;
-    
-    for(int i = 0; i < NUM_AUX_INPUTS; i++)
-      this->aux[i] = source->aux[i];
-    
-    this->heli_fixed_z = source->heli_fixed_z;
-    
-    this->keys = source->keys;
+    *this = *source;
   };
   
    /**
@@ -148,6 +142,7 @@ class TSimInputs
        aux[i] = 0;
      
      heli_fixed_z = EOM01_FIXED_Z_OFF;
+     numKeys      = 0;
    };
    
    void print()
@@ -161,7 +156,13 @@ class TSimInputs
    */
   void AddKey(int key)
   {
-    keys.insert(key);
+    for (int i = 0; i < numKeys; i++)
+    {
+      if (keys[i] == key)
+        return;
+    }
+    if (numKeys < MAX_KEYS)
+      keys[numKeys++] = key;
   }
   
   /**
@@ -170,7 +171,7 @@ class TSimInputs
    */
   void ClearKeys()
   {
-    keys.clear();
+    numKeys = 0;
   }
   
   /**
@@ -180,24 +181,29 @@ class TSimInputs
    */
   bool KeyPressed(int key)
   {
-    std::set<int>::iterator it;
-    
-    it = keys.find(key);
-    if (it == keys.end())
-      return(false);
-    else
+    for (int i = 0; i < numKeys; i++)
     {
-      keys.erase(it);
-      return(true);
+      if (keys[i] == key)
+      {
+        // the order doesn't matter
+        keys[i] = keys[--numKeys];
+        return(true);
+      }
     }
+    return(false);
   }
   
 private:
   
   /**
-   * keypresses not consumed by GUI
+   * keypresses not consumed by GUI, each key at most once
+   */
+  int keys[MAX_KEYS];
+
+  /**
+   * number of valid entries in keys
    */
-  std::set<int> keys;
+  int numKeys;
   
   /**
    * inline method to convert the bit pattern of a float
@@ -34,6 +34,7 @@
 #include "../ls_geodesy.h"
 #include "../../mod_misc/SimpleXMLTransfer.h"
 #include "../../mod_misc/lib_conversions.h"
+#include "../../mod_misc/profiler.h"
 #include "../xmlmodelfile.h"
 
 // 0, 1, 2
@@ -92,6 +93,10 @@ void CRRC_AirplaneSim_Larcsim::initAirplaneState(double dRelVel,
   ls_step_init();
   
   power->InitStates(v_V_wind_body * FT_TO_M);  
+
+  // Using a length of about roughly one half of the aircrafts size to
+  // calculate wind gradients, like the stencil in update() does.
+  windpatch.init(getAircraftSize()/2, windpatchAge);
 }
 
 
@@ -106,24 +111,30 @@ void CRRC_AirplaneSim_Larcsim::update(TSimInputs* inputs,
   CRRCMath::Vector3 v_F_aero, v_F_engine, v_F_gear; // Force x/y/z
   CRRCMath::Vector3 v_M_aero, v_M_engine, v_M_gear; // l/m/n <-> roll/pitch/yaw
 
-  int nAircraftOutsideWindfieldSim = 
-    env->CalculateWind(v_P_CG_Rwy.r[0],        v_P_CG_Rwy.r[1],        v_P_CG_Rwy.r[2],
-                       v_V_local_airmass.r[0], v_V_local_airmass.r[1], v_V_local_airmass.r[2]);
-                       
-  /**
-   * Using a length of about roughly one half of the aircrafts
-   * size to calculate wind gradients. 0.1 foot had been used before,
-   * which leads to very high or zero gradients.
-   */
-  double delta_space = getAircraftSize()/2;
-  
-  nAircraftOutsideWindfieldSim |= 
-    env->CalculateWindGrad(v_P_CG_Rwy.r[0], v_P_CG_Rwy.r[1], v_P_CG_Rwy.r[2], delta_space,
-                           m_V_local_airmass_grad);
+  int nAircraftOutsideWindfieldSim;
 
-  if (nAircraftOutsideWindfieldSim)
+  if (windpatchAge < 0)
   {
-    env->AddLogMsg("Error: aircraft outside windfield simulation");
+    nAircraftOutsideWindfieldSim = 
+      env->CalculateWind(v_P_CG_Rwy.r[0],        v_P_CG_Rwy.r[1],        v_P_CG_Rwy.r[2],
+                         v_V_local_airmass.r[0], v_V_local_airmass.r[1], v_V_local_airmass.r[2]);
+                       
+    /**
+     * Using a length of about roughly one half of the aircrafts
+     * size to calculate wind gradients. 0.1 foot had been used before,
+     * which leads to very high or zero gradients.
+     */
+    double delta_space = getAircraftSize()/2;
+  
+    nAircraftOutsideWindfieldSim |= 
+      env->CalculateWindGrad(v_P_CG_Rwy.r[0], v_P_CG_Rwy.r[1], v_P_CG_Rwy.r[2], delta_space,
+                             m_V_local_airmass_grad);
+  }
+  else
+  {
+    // sampled once per frame, interpolated in every step
+    nAircraftOutsideWindfieldSim = windpatch.update(env, v_P_CG_Rwy);
+    windpatch.getWind(v_P_CG_Rwy, v_V_local_airmass, m_V_local_airmass_grad);
   }
     
   for (int n=0; n<multiloop; n++)
@@ -143,7 +154,17 @@ void CRRC_AirplaneSim_Larcsim::update(TSimInputs* inputs,
     logVal(m_V_atmo_rwy);
 #endif
             
-    ls_step(dt);
+    {
+      CRRC_PROFILE("ls_step");
+      ls_step(dt);
+    }
+
+    // wind at the new position
+    if (windpatchAge >= 0)
+    {
+      windpatch.advance(dt);
+      windpatch.getWind(v_P_CG_Rwy, v_V_local_airmass, m_V_local_airmass_grad);
+    }
 
     // update wind turbulence linear & rotational velocities
     env->CalculateWindGust(dt, getAlt(), v_V_local_rel_airmass.length(), getWingspan(),
@@ -154,18 +175,46 @@ void CRRC_AirplaneSim_Larcsim::update(TSimInputs* inputs,
 
     env->ControllerCallback(dt, this, inputs, &myInputs);
     
-    aero(&myInputs, m_V_local_airmass_grad, v_R_omega_gust_body, v_F_aero, v_M_aero);
+    {
+      CRRC_PROFILE("aero");
+      aero(&myInputs, m_V_local_airmass_grad, v_R_omega_gust_body, v_F_aero, v_M_aero);
+    }
     
 #if FDM_LOG_AERO_OUT != 0
     logVal(v_F_aero);
     logVal(v_M_aero);
 #endif
     
-    engine(dt, &myInputs, v_F_engine, v_M_engine);
-    gear(&myInputs, v_F_gear, v_M_gear);
+    {
+      CRRC_PROFILE("engine");
+      engine(dt, &myInputs, v_F_engine, v_M_engine);
+    }
+    {
+      CRRC_PROFILE("gear");
+      gear(&myInputs, v_F_gear, v_M_gear);
+    }
+
+    if (integrator == INTGR_RK4)
+    {
+      stage.fValid                 = true;
+      stage.v_V_local_airmass      = v_V_local_airmass;
+      stage.m_V_local_airmass_grad = m_V_local_airmass_grad;
+      stage.v_V_gust_body          = v_V_gust_body;
+      stage.v_R_omega_gust_body    = v_R_omega_gust_body;
+      stage.v_F                    = v_F_engine;
+      stage.v_M                    = v_M_engine*effectivePropellerTorqueFactor;
+    }
 
     /* Sum forces and moments at reference point (center of gravity) */
-    ls_accel(v_F_aero + v_F_engine + v_F_gear, v_M_aero + v_M_engine*effectivePropellerTorqueFactor + v_M_gear);
+    {
+      CRRC_PROFILE("ls_accel");
+      ls_accel(v_F_aero + v_F_engine + v_F_gear, v_M_aero + v_M_engine*effectivePropellerTorqueFactor + v_M_gear);
+    }
+  }
+
+  if (nAircraftOutsideWindfieldSim)
+  {
+    env->AddLogMsg("Error: aircraft outside windfield simulation");
   }
 }
 
@@ -177,6 +226,7 @@ CRRC_AirplaneSim_Larcsim::CRRC_AirplaneSim_Larcsim(const char* filename, FDMEnvi
   SimpleXMLTransfer* fileinmemory = new SimpleXMLTransfer(filename);
   
   power = 0;
+  windpatchAge = cfg->getDouble("simulation.flightModel.wind_patch_age", -1);
   LoadFromXML(fileinmemory, cfg->getInt("airplane.verbosity", 5));
   
   delete fileinmemory;
@@ -186,6 +236,7 @@ CRRC_AirplaneSim_Larcsim::CRRC_AirplaneSim_Larcsim(const char* filename, FDMEnvi
 CRRC_AirplaneSim_Larcsim::CRRC_AirplaneSim_Larcsim(SimpleXMLTransfer* xml, FDMEnviroment* myEnv, SimpleXMLTransfer* cfg) : EOM01("fdm_larcsim.dat", myEnv)
 {
   power = 0;
+  windpatchAge = cfg->getDouble("simulation.flightModel.wind_patch_age", -1);
   LoadFromXML(xml, cfg->getInt("airplane.verbosity", 5));
 }
 
@@ -195,6 +246,8 @@ void CRRC_AirplaneSim_Larcsim::LoadFromXML(SimpleXMLTransfer* xml, int nVerbosit
   SimpleXMLTransfer* cfg = XMLModelFile::getConfig(xml);
   SimpleXMLTransfer* aero;
   
+  ls_read_integrator(cfg);
+  
   // File format extension: an aero section inside of config takes
   // precedence over the general aero section.
   {
@@ -668,6 +721,22 @@ void CRRC_AirplaneSim_Larcsim::aero(TSimInputs* inputs,
 }
 
 
+/**
+ * Aerodynamics and gear are calculated again for the intermediate states
+ * of the RK4 integrator, wind and engine stay as they were at the start
+ * of the step.
+ */
+void CRRC_AirplaneSim_Larcsim::ls_stage()
+{
+  CRRCMath::Vector3 v_F_aero, v_F_gear;
+  CRRCMath::Vector3 v_M_aero, v_M_gear;
+
+  ls_aux(stage.v_V_local_airmass, stage.v_V_gust_body);
+  aero(&myInputs, stage.m_V_local_airmass_grad, stage.v_R_omega_gust_body, v_F_aero, v_M_aero);
+  gear(&myInputs, v_F_gear, v_M_gear);
+  ls_accel(v_F_aero + stage.v_F + v_F_gear, v_M_aero + stage.v_M + v_M_gear);
+}
+
 void CRRC_AirplaneSim_Larcsim::ls_step_init()
 {
   CRRCMath::Vector3 v_F_aero, v_F_engine, v_F_gear; // Force x/y/z
@@ -36,6 +36,7 @@
 # include "../../mod_math/matrix33.h"
 # include "../power/power.h"
 # include "../gear01/gear.h"
+# include "../windpatch/windpatch.h"
 
 /**
  * physical model for a fixed wing airplane
@@ -74,6 +75,7 @@ class CRRC_AirplaneSim_Larcsim : public EOM01
 {
    friend class ModFDMInterface;
    friend class CRRC_AirplaneSim_DisplayMode;
+   friend class CRRC_Bench;
    
   public:
 
@@ -230,6 +232,23 @@ class CRRC_AirplaneSim_Larcsim : public EOM01
     */
    double effectivePropellerTorqueFactor;
    //@}
+
+   /// @name Wind
+   //@{
+
+   /**
+    * Wind samples around the aircraft, taken once per call of update()
+    * and interpolated in every step.
+    */
+   WindPatch windpatch;
+
+   /**
+    * Maximum age of wind samples [s]. If it is negative (default), wind
+    * is only calculated once per call of update() and the wind patch
+    * isn't used.
+    */
+   double windpatchAge;
+   //@}
   
   private:
 
@@ -240,6 +259,7 @@ class CRRC_AirplaneSim_Larcsim : public EOM01
              CRRCMath::Vector3& v_F, CRRCMath::Vector3& v_M);
    void engine( SCALAR dt, TSimInputs* inputs, CRRCMath::Vector3& v_F, CRRCMath::Vector3& v_M);
    virtual void ls_step_init();
+   virtual void ls_stage();
    
   private:   
 
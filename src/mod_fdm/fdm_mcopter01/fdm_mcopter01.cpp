@@ -32,6 +32,7 @@
 #include "../ls_geodesy.h"
 #include "../../mod_misc/SimpleXMLTransfer.h"
 #include "../../mod_misc/lib_conversions.h"
+#include "../../mod_misc/profiler.h"
 #include "../xmlmodelfile.h"
 
 #define PITCH_FIXED_PITCH          1.0
@@ -81,8 +82,7 @@ void CRRC_AirplaneSim_MCopter01::initAirplaneState(double dRelVel,
   v_R_omega_body    = CRRCMath::Vector3(R_X, R_Y, R_Z); // body rate   [rad/s]  
   v_V_dot_local     = CRRCMath::Vector3(); // local acceleration   [ft/s^2]
 
-  for (unsigned int n=0; n<controllers.size(); n++)
-    controllers[n]->Reset();
+  controllers.Reset();
   
   for (unsigned int n=0; n<power.size(); n++)
     power[n]->InitStates(CRRCMath::Vector3());
@@ -109,7 +109,10 @@ void CRRC_AirplaneSim_MCopter01::update(TSimInputs* inputs,
   
   for (int n=0; n<multiloop; n++)
   {
-    ls_step( dt );
+    {
+      CRRC_PROFILE("ls_step");
+      ls_step( dt );
+    }
     ls_aux(v_V_local_airmass, v_V_gust_body);
 
     // Global controllers first...
@@ -118,26 +121,45 @@ void CRRC_AirplaneSim_MCopter01::update(TSimInputs* inputs,
     OutputOfLocalControllers.CopyFrom(&myInputs); // in case there is no controller for something
     if (myInputs.throttle > 0.05)
     {
-      for (unsigned int n=0; n<controllers.size(); n++)
-        controllers[n]->Calc(dt, this, &myInputs, &OutputOfLocalControllers);
+      controllers.Calc(dt, this, &myInputs, &OutputOfLocalControllers);
       v_URel = CRRCMath::Vector3(OutputOfLocalControllers.aileron, OutputOfLocalControllers.elevator, OutputOfLocalControllers.rudder);
     }
     else
     {
       v_URel = CRRCMath::Vector3();
-      for (unsigned int n=0; n<controllers.size(); n++)
-        controllers[n]->Reset();
+      controllers.Reset();
     }
     // Because local controllers only remove key presses from the queue in myInputs and not from inputs,
     // it needs to be done manually here:
     inputs->ClearKeys();
 
-    aero(dt, v_F_aero, v_M_aero);
+    {
+      CRRC_PROFILE("aero");
+      aero(dt, v_F_aero, v_M_aero);
+    }
+    
+    {
+      CRRC_PROFILE("engine");
+      engine(dt, &OutputOfLocalControllers, v_URel, v_F_engine, v_M_engine);
+    }
+    {
+      CRRC_PROFILE("gear");
+      gear(&myInputs, v_F_gear, v_M_gear);
+    }
     
-    engine(dt, &OutputOfLocalControllers, v_URel, v_F_engine, v_M_engine);
-    gear(&myInputs, v_F_gear, v_M_gear);
+    if (integrator == INTGR_RK4)
+    {
+      stage.fValid            = true;
+      stage.v_V_local_airmass = v_V_local_airmass;
+      stage.v_V_gust_body     = v_V_gust_body;
+      stage.v_F               = v_F_aero + v_F_engine;
+      stage.v_M               = v_M_aero + v_M_engine;
+    }
         
-    ls_accel(v_F_aero + v_F_engine + v_F_gear, v_M_aero + v_M_engine + v_M_gear);        
+    {
+      CRRC_PROFILE("ls_accel");
+      ls_accel(v_F_aero + v_F_engine + v_F_gear, v_M_aero + v_M_engine + v_M_gear);        
+    }
   }
 }
 
@@ -174,6 +196,8 @@ void CRRC_AirplaneSim_MCopter01::LoadFromXML(SimpleXMLTransfer* xml, int nVerbos
   SimpleXMLTransfer* i;
   SimpleXMLTransfer* cfg = XMLModelFile::getConfig(xml);  
   
+  ls_read_integrator(cfg);
+  
   {
     double to_slug;
     double to_slug_ft_ft;
@@ -252,7 +276,6 @@ void CRRC_AirplaneSim_MCopter01::LoadFromXML(SimpleXMLTransfer* xml, int nVerbos
       power[n]->ReloadParams(cfg, nVerbosity);
   }
   
-  controllers.clear();  
   Controller::LoadList(cfg->getChild("controllers"), controllers);  
 }
 
@@ -416,6 +439,21 @@ void CRRC_AirplaneSim_MCopter01::aero(double dt, CRRCMath::Vector3& v_F, CRRCMat
 }
 
 
+/**
+ * Only the gear is calculated again for the intermediate states of the
+ * RK4 integrator: aerodynamics and engine keep internal states which must
+ * only be advanced once per step, so their forces from the start of the
+ * step are used.
+ */
+void CRRC_AirplaneSim_MCopter01::ls_stage()
+{
+  CRRCMath::Vector3 v_F_gear, v_M_gear;
+
+  ls_aux(stage.v_V_local_airmass, stage.v_V_gust_body);
+  gear(&myInputs, v_F_gear, v_M_gear);
+  ls_accel(stage.v_F + v_F_gear, stage.v_M + v_M_gear);
+}
+
 void CRRC_AirplaneSim_MCopter01::ls_step_init() 
 {
   CRRCMath::Vector3 v_F_aero, v_F_engine, v_F_gear; // Force x/y/z
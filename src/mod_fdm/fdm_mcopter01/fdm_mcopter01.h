@@ -60,6 +60,7 @@ class CRRC_AirplaneSim_MCopter01 : public EOM01
 {
   friend class ModFDMInterface;
   friend class CRRC_AirplaneSim_DisplayMode;
+  friend class CRRC_Bench;
   
 public:
   
@@ -151,6 +152,7 @@ private:
               CRRCMath::Vector3& v_F,
               CRRCMath::Vector3& v_M);
   virtual void ls_step_init();
+  virtual void ls_stage();
   
   float GroundEffect(float dRotorToGround);
   
@@ -217,7 +219,7 @@ private:
   /**
    * List of active controllers
    */
-  std::vector<Controller*> controllers;
+  ControllerPipeline controllers;
   
 };
 
@@ -233,17 +233,50 @@ Wheel::Wheel(const WheelSystem* ws)
 
 
 /**
- * Interface to CRRC_AirplaneSim_Larcsim:
+ * Calculate wheel position w.r.t. runway
  *
  * CRRCMath::Matrix33 LocalToBody           (Transformation matrix local to body)
  * CRRCMath::Vector3  v_P_CG_Rwy            (CG relative to runway, in rwy coordinates N/E/D)
+ */
+void Wheel::updatePosition(CRRCMath::Matrix33 const& LocalToBody,
+                           CRRCMath::Vector3  const& v_P_CG_Rwy)
+{
+  /* update the animation */
+  if (hpt != NULL)
+  {
+    hpt->update();
+  }
+
+  /* First calculate wheel location w.r.t. cg in body (X-Y-Z) axes... */
+
+  v_P_wheel_cg_body = v_P;
+
+  /* ...transform the wheel position if it is coupled to a transformation... */
+  if (hpt != NULL)
+  {
+    hpt->transform(v_P_wheel_cg_body);
+  }
+
+  /* then converting to local (North-East-Down) axes
+     and adding wheel offset to cg location in local axes */
+
+  v_P_wheel_rwy_local = LocalToBody.multrans(v_P_wheel_cg_body) + v_P_CG_Rwy;
+}
+
+
+/**
+ * Interface to CRRC_AirplaneSim_Larcsim:
+ *
+ * SCALAR             z_earth               (terrain height below wheel, positive down)
+ * CRRCMath::Matrix33 LocalToBody           (Transformation matrix local to body)
  * CRRCMath::Vector3  v_R_omega_body        (Angular body rates)
  * CRRCMath::Vector3  v_V_local_rel_ground  (V rel w.r.t. earth surface)
  * SCALAR             euler_angles_v[2]     (Psi)
+ *
+ * updatePosition() has to be called before.
  */
-void Wheel::update( FDMEnviroment* env,
-                    CRRCMath::Matrix33 LocalToBody,
-                    CRRCMath::Vector3  const& v_P_CG_Rwy,
+void Wheel::update( SCALAR z_earth,
+                    CRRCMath::Matrix33 const& LocalToBody,
                     CRRCMath::Vector3  const& v_R_omega_body,
                     CRRCMath::Vector3  const& v_V_local_rel_ground,
                     SCALAR psi)
@@ -290,46 +323,9 @@ void Wheel::update( FDMEnviroment* env,
   CRRCMath::Vector3 v_V_wheel_local;
   CRRCMath::Vector3 v_F_wheel_local;
   
-  /* wheel offset from cg,  X-Y-Z */
-  CRRCMath::Vector3 v_P_wheel_cg_body;
-  
-  /* wheel offset from cg,  N-E-D */
-  CRRCMath::Vector3 v_P_wheel_cg_local;
-  
-  /* wheel offset from rwy, N-E-U */
-  CRRCMath::Vector3 v_P_wheel_rwy_local;
-  
-
-  /* update the animation */
-  if (hpt != NULL)
-  {
-    hpt->update();
-  }
 
   beta_mu = max_mu/(skid_v-bkout_v);
   
-  /*========================================*/
-  /* Calculate wheel position w.r.t. runway */
-  /*========================================*/
-
-  /* First calculate wheel location w.r.t. cg in body (X-Y-Z) axes... */
-
-  v_P_wheel_cg_body = v_P;
-
-  /* ...transform the wheel position if it is coupled to a transformation... */
-  if (hpt != NULL)
-  {
-    hpt->transform(v_P_wheel_cg_body);
-  }
-
-  /* then converting to local (North-East-Down) axes... */
-
-  v_P_wheel_cg_local = LocalToBody.multrans(v_P_wheel_cg_body);
-  
-  /* Add wheel offset to cg location in local axes */
-
-  v_P_wheel_rwy_local = v_P_wheel_cg_local + v_P_CG_Rwy;
-
   /*============================*/
   /* Calculate wheel velocities */
   /*============================*/
@@ -372,8 +368,6 @@ void Wheel::update( FDMEnviroment* env,
 
   reaction_normal_force = 0.;
 
-  SCALAR z_earth = -1*env->GetSceneryHeight(v_P_wheel_rwy_local.r[0], v_P_wheel_rwy_local.r[1]);
-  
   if (v_P_wheel_rwy_local.r[2] > z_earth)
   {
     // Forces are in lbf here, lengths in ft, velocities in ft/s. 
@@ -466,12 +460,29 @@ void WheelSystem::update( TSimInputs* inputs,
 
   v_Forces  = CRRCMath::Vector3();  /* Initialize sum of forces... */
   v_Moments = CRRCMath::Vector3();  /* ...and moments  */
+
+  /*
+   * Get the terrain height below all wheels at once
+   */
+  if ((int)wheel_h.size() != num_wheels)
+  {
+    wheel_x.resize(num_wheels);
+    wheel_y.resize(num_wheels);
+    wheel_h.resize(num_wheels);
+  }
+  for (i=0;i<num_wheels;i++)
+  {
+    wheels[i].updatePosition(LocalToBody, v_P_CG_Rwy);
+    wheel_x[i] = wheels[i].v_P_wheel_rwy_local.r[0];
+    wheel_y[i] = wheels[i].v_P_wheel_rwy_local.r[1];
+  }
+  if (num_wheels > 0)
+    env->GetSceneryHeights(&wheel_x[0], &wheel_y[0], &wheel_h[0], num_wheels);
       
   for (i=0;i<num_wheels;i++)     /* Loop for each wheel */
   {
-    wheels[i].update( env,
+    wheels[i].update( -1*wheel_h[i],
                       LocalToBody,
-                      v_P_CG_Rwy,
                       v_R_omega_body,
                       v_V_local_rel_ground,
                       psi);
@@ -596,6 +607,17 @@ void WheelSystem::init(SimpleXMLTransfer *ModelFile, SCALAR  def_span)
     }
     break;
   }        
+  // looked up for every wheel of every model loaded
+  static const XMLPath pos_x("pos.x");
+  static const XMLPath pos_y("pos.y");
+  static const XMLPath pos_z("pos.z");
+  static const XMLPath pos_animation("pos.animation");
+  static const XMLPath spring_constant("spring.constant");
+  static const XMLPath spring_damping("spring.damping");
+  static const XMLPath spring_max_force("spring.max_force");
+  static const XMLPath percent_brake("percent_brake");
+  static const XMLPath caster_angle_rad("caster_angle_rad");
+
   uSize = i->getChildCount();
   for (unsigned int n=0; n<uSize; n++)
   {
@@ -605,13 +627,13 @@ void WheelSystem::init(SimpleXMLTransfer *ModelFile, SCALAR  def_span)
     
     e = i->getChildAt(n);
     
-    x = e->getDouble("pos.x") * to_ft - pCG.r[0];
-    y = e->getDouble("pos.y") * to_ft - pCG.r[1];
-    z = e->getDouble("pos.z") * to_ft - pCG.r[2];
+    x = e->getDouble(pos_x) * to_ft - pCG.r[0];
+    y = e->getDouble(pos_y) * to_ft - pCG.r[1];
+    z = e->getDouble(pos_z) * to_ft - pCG.r[2];
     wheel.v_P = CRRCMath::Vector3(x, y, z);
     
     // let's see if this wheel is coupled to an animation
-    wheel.anim_name = e->getString("pos.animation", "");
+    wheel.anim_name = e->getString(pos_animation, "");
     if (wheel.anim_name != "")
     {
       std::cout << "WheelSystem::init: hardpoint is coupled to anim ";
@@ -636,11 +658,11 @@ void WheelSystem::init(SimpleXMLTransfer *ModelFile, SCALAR  def_span)
       }
     }
 
-    wheel.spring_constant    = e->getDouble("spring.constant") * to_lbf_per_ft;
-    wheel.spring_damping     = e->getDouble("spring.damping")  * to_lbf_s_per_ft;
-    wheel.max_force          = e->getDouble("spring.max_force", 9999) * to_lbf;
-    wheel.percent_brake      = e->getDouble("percent_brake");
-    wheel.caster_angle_rad   = e->getDouble("caster_angle_rad");
+    wheel.spring_constant    = e->getDouble(spring_constant) * to_lbf_per_ft;
+    wheel.spring_damping     = e->getDouble(spring_damping)  * to_lbf_s_per_ft;
+    wheel.max_force          = e->getDouble(spring_max_force, 9999) * to_lbf;
+    wheel.percent_brake      = e->getDouble(percent_brake);
+    wheel.caster_angle_rad   = e->getDouble(caster_angle_rad);
 
     if (e->indexOfChild("steering") >= 0)
     {
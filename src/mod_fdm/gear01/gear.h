@@ -98,14 +98,34 @@ class Wheel
   public:
     Wheel(const WheelSystem* ws);
     
-    void update(FDMEnviroment*      env,
-                CRRCMath::Matrix33  LocalToBody,
-                CRRCMath::Vector3   const& v_P_CG_Rwy,
+    /**
+     * Calculates the position of the wheel in runway coordinates
+     * (v_P_wheel_rwy_local). This has to be done before update().
+     */
+    void updatePosition(CRRCMath::Matrix33  const& LocalToBody,
+                        CRRCMath::Vector3   const& v_P_CG_Rwy);
+
+    /**
+     * Calculates forces and moments. z_earth is the terrain below
+     * the wheel (positive down).
+     */
+    void update(SCALAR              z_earth,
+                CRRCMath::Matrix33  const& LocalToBody,
                 CRRCMath::Vector3   const& v_R_omega_body,
                 CRRCMath::Vector3   const& v_V_local_rel_ground,
                 SCALAR psi);
     CRRCMath::Vector3 tempF, tempM;
  
+    /**
+     * wheel offset from cg, X-Y-Z (written by updatePosition())
+     */
+    CRRCMath::Vector3 v_P_wheel_cg_body;
+
+    /**
+     * wheel offset from rwy, N-E-D (written by updatePosition())
+     */
+    CRRCMath::Vector3 v_P_wheel_rwy_local;
+ 
   private:
     /** An arbitrary ID assigned by the WheelSystem.
      *  For debugging only.
@@ -204,6 +224,13 @@ class WheelSystem
     * A local copy of the current sim inputs
     */
    TSimInputs wheel_inputs;
+
+   /// @name Positions of all wheels and the terrain height below them
+   //@{
+   std::vector<float> wheel_x;
+   std::vector<float> wheel_y;
+   std::vector<float> wheel_h;
+   //@}
    
 };
 
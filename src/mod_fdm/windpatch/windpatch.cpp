@@ -0,0 +1,179 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+/** \file windpatch.cpp
+ *
+ *  Cached wind samples around the aircraft
+ */
+
+#include "windpatch.h"
+#include <math.h>
+
+WindPatch::WindPatch() : spacing(1), maxAge(0), nSamples(0)
+{
+  reset();
+}
+
+void WindPatch::init(double spacing, double maxAge)
+{
+  if (spacing <= 0)
+    spacing = 1;
+  this->spacing = spacing;
+  this->maxAge  = maxAge;
+  reset();
+}
+
+void WindPatch::reset()
+{
+  for (int c=0; c<8; c++)
+    corner[c].valid = false;
+}
+
+void WindPatch::advance(double dt)
+{
+  for (int c=0; c<8; c++)
+    corner[c].age += dt;
+}
+
+int WindPatch::update(FDMEnviroment* env, CRRCMath::Vector3 const& pos)
+{
+  int base[3];
+
+  for (int k=0; k<3; k++)
+    base[k] = (int)floor(pos.r[k] / spacing);
+
+  // corners of the cell pos is in; reuse what is still valid
+  if (!(corner[0].valid &&
+        corner[0].idx[0] == base[0] &&
+        corner[0].idx[1] == base[1] &&
+        corner[0].idx[2] == base[2]))
+  {
+    Sample next[8];
+
+    for (int c=0; c<8; c++)
+    {
+      next[c].valid = false;
+      for (int k=0; k<3; k++)
+        next[c].idx[k] = base[k] + ((c >> k) & 1);
+
+      for (int o=0; o<8; o++)
+      {
+        if (corner[o].valid &&
+            corner[o].idx[0] == next[c].idx[0] &&
+            corner[o].idx[1] == next[c].idx[1] &&
+            corner[o].idx[2] == next[c].idx[2])
+        {
+          next[c] = corner[o];
+          break;
+        }
+      }
+    }
+    for (int c=0; c<8; c++)
+      corner[c] = next[c];
+  }
+
+  int taken = 0;
+  int err   = 0;
+  for (;;)
+  {
+    // a missing corner, otherwise the oldest one which is too old
+    int c_next = -1;
+    for (int c=0; c<8; c++)
+    {
+      if (!corner[c].valid)
+      {
+        c_next = c;
+        break;
+      }
+      if (corner[c].age > maxAge &&
+          (c_next < 0 || corner[c].age > corner[c_next].age))
+        c_next = c;
+    }
+    if (c_next < 0)
+      break;
+
+    Sample& s = corner[c_next];
+    if (s.valid && taken >= MAX_SAMPLES)
+      break;
+
+    double vn, ve, vd;
+    s.err   = env->CalculateWind(s.idx[0]*spacing, s.idx[1]*spacing, s.idx[2]*spacing,
+                                 vn, ve, vd);
+    s.v     = CRRCMath::Vector3(vn, ve, vd);
+    s.age   = 0;
+    s.valid = true;
+    nSamples++;
+    taken++;
+  }
+
+  for (int c=0; c<8; c++)
+    err |= corner[c].err;
+
+  return(err);
+}
+
+void WindPatch::getWind(CRRCMath::Vector3 const& pos,
+                        CRRCMath::Vector3& v_V,
+                        CRRCMath::Matrix33& m_V_grad)
+{
+  // position in the cell; outside of it (the aircraft has left it since
+  // the last update()) this extrapolates
+  double f[3];
+
+  for (int k=0; k<3; k++)
+    f[k] = pos.r[k] / spacing - corner[0].idx[k];
+
+  // trilinear interpolation and its derivative
+  v_V = CRRCMath::Vector3();
+  for (int i=0; i<3; i++)
+    for (int j=0; j<3; j++)
+      m_V_grad.v[i][j] = 0;
+
+  for (int c=0; c<8; c++)
+  {
+    double w[3];   // weight in each direction
+    double dw[3];  // derivative of w
+
+    for (int k=0; k<3; k++)
+    {
+      if ((c >> k) & 1)
+      {
+        w[k]  = f[k];
+        dw[k] = 1/spacing;
+      }
+      else
+      {
+        w[k]  = 1 - f[k];
+        dw[k] = -1/spacing;
+      }
+    }
+
+    double weight = w[0]*w[1]*w[2];
+    double dx     = dw[0]* w[1]* w[2];
+    double dy     =  w[0]*dw[1]* w[2];
+    double dz     =  w[0]* w[1]*dw[2];
+
+    for (int i=0; i<3; i++)
+    {
+      v_V.r[i]         += weight * corner[c].v.r[i];
+      m_V_grad.v[i][0] += dx * corner[c].v.r[i];
+      m_V_grad.v[i][1] += dy * corner[c].v.r[i];
+      m_V_grad.v[i][2] += dz * corner[c].v.r[i];
+    }
+  }
+}
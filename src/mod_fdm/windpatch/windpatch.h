@@ -0,0 +1,120 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+/** \file windpatch.h
+ *
+ *  Cached wind samples around the aircraft
+ */
+
+#ifndef FDM_WINDPATCH_H
+#define FDM_WINDPATCH_H
+
+# include "../../mod_math/vector3.h"
+# include "../../mod_math/matrix33.h"
+# include "../fdm_env.h"
+
+/**
+ * A small piece of the windfield around the aircraft.
+ *
+ * The wind is sampled (FDMEnviroment::CalculateWind()) at the corners of
+ * a cubic lattice cell which is aligned to multiples of the lattice spacing
+ * in world coordinates. This is done once per frame by update(). In every
+ * integration step of the frame, velocity and its gradient are interpolated
+ * trilinearly (getWind()); if the aircraft leaves the cell before the
+ * frame is over, they are extrapolated from it.
+ *
+ * When the aircraft moves on to a neighbouring cell, the samples of the
+ * shared corners are reused. Samples get older while time passes. Wind
+ * changes with time (thermals move and decay), so samples older than a
+ * maximum age are taken again, the oldest first, but only a few of them
+ * in one frame.
+ */
+class WindPatch
+{
+  public:
+    WindPatch();
+
+    /**
+     * Samples which are too old are only taken again as long as update()
+     * has taken less than this number of samples. Samples for corners of
+     * a new cell are always taken.
+     */
+    enum { MAX_SAMPLES = 4 };
+
+    /**
+     * \param spacing  lattice spacing in ft; the gradient is calculated over
+     *                 this distance
+     * \param maxAge   samples older than this (s) are taken again
+     */
+    void init(double spacing, double maxAge);
+
+    /**
+     * Forget all samples, e.g. after the aircraft has been relocated.
+     */
+    void reset();
+
+    /**
+     * Let time pass.
+     */
+    void advance(double dt);
+
+    /**
+     * Moves the patch to the cell <code>pos</code> is in and takes the
+     * samples which are missing or too old. To be called once per frame.
+     *
+     * Returns nonzero if one of the samples is outside of the windfield
+     * simulation.
+     */
+    int update(FDMEnviroment* env, CRRCMath::Vector3 const& pos);
+
+    /**
+     * Wind velocity (north/east/down) at <code>pos</code> and its gradient
+     * (<code>m_V_grad.v[i][j]</code> = d v_i / d x_j), from the samples
+     * of the last update().
+     */
+    void getWind(CRRCMath::Vector3 const& pos,
+                 CRRCMath::Vector3& v_V,
+                 CRRCMath::Matrix33& m_V_grad);
+
+    /**
+     * Number of FDMEnviroment::CalculateWind() calls so far
+     */
+    unsigned long getNumSamples() { return(nSamples); };
+
+  private:
+    struct Sample
+    {
+      int               idx[3];
+      bool              valid;
+      int               err;
+      double            age;
+      CRRCMath::Vector3 v;
+    };
+
+    /**
+     * corners of the current cell, bit k of the index is the offset in
+     * direction k
+     */
+    Sample        corner[8];
+
+    double        spacing;
+    double        maxAge;
+    unsigned long nSamples;
+};
+
+#endif
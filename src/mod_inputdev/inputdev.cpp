@@ -23,6 +23,7 @@
 #include "../i18n.h"
 #include "../global.h"
 #include "inputdev.h"
+#include "inputdev_thread.h"
 #include "../GUI/util.h"
 #include "../mod_misc/lib_conversions.h"
 #include <cstdlib>
@@ -72,7 +73,7 @@ void T_TX_Interface::getInputData(TSimInputs* inputs)
 
 T_TX_Interface::T_TX_Interface()
   : mixer(NULL), calib(NULL), map(NULL), errMsg(""),
-    keyb_retract_limited(-0.5, 1)
+    keyb_retract_limited(-0.5, 1), inputThread(NULL)
 {
 #if DEBUG_TX_INTERFACE > 0
   printf("T_TX_Interface::T_TX_Interface\n");
@@ -86,6 +87,48 @@ T_TX_Interface::~T_TX_Interface()
 #if DEBUG_TX_INTERFACE > 0
   printf("T_TX_Interface::~T_TX_Interface\n");
 #endif
+  stopInputThread();
+}
+
+bool T_TX_Interface::getInputDataAt(double t, TSimInputs* inputs)
+{
+  float raw[TX_MAXAXIS];
+
+  if (inputThread == NULL || !inputThread->getSample(t, raw))
+    return(false);
+
+  CalibMixMapValues(inputs, raw);
+  return(true);
+}
+
+void T_TX_Interface::startInputThread()
+{
+  float raw[TX_MAXAXIS];
+
+  if (inputThread != NULL)
+    return;
+
+  // initializes raw data and finds out whether readDevice() is supported
+  memset(raw, 0, sizeof(raw));
+  if (!readDevice(raw))
+    return;
+
+  inputThread = new T_TX_InputThread(this);
+  inputThread->Start();
+}
+
+void T_TX_Interface::stopInputThread()
+{
+  delete inputThread;
+  inputThread = NULL;
+}
+
+bool T_TX_Interface::pollDevice(float* raw)
+{
+  if (inputThread != NULL)
+    return(inputThread->getLatest(raw));
+  else
+    return(readDevice(raw));
 }
 
 void T_TX_Interface::putBackIntoCfg(SimpleXMLTransfer* config)
@@ -52,6 +52,7 @@ class T_TX_Interface;
 class T_TX_Mixer;
 class T_AxisMapper;
 class T_Calibration;
+class T_TX_InputThread;
 
 
 /** \brief A simple axis-number-to-function-mapper.
@@ -294,6 +295,8 @@ class T_Calibration
  */
 class T_TX_Interface
 {
+  friend class T_TX_InputThread;
+
   public:
     T_TX_Interface();
     virtual ~T_TX_Interface();
@@ -338,6 +341,28 @@ class T_TX_Interface
      *               getNumAxes() values!
      */
     virtual void getRawData(float* target) {};
+
+    /**
+     * Like getInputData(), but with the values which were current at time
+     * <code>t</code> [ms, SDL_GetTicks()], see startInputThread(). Returns
+     * false (and doesn't touch <code>inputs</code>) if the device isn't read
+     * on a thread of its own.
+     * Not to be called on the same thread as getInputData().
+     */
+    bool getInputDataAt(double t, TSimInputs* inputs);
+
+    /**
+     * Reads the device on a thread of its own from now on, if the interface
+     * supports it (see readDevice()). Afterwards, getInputData() and
+     * getRawData() use the latest values read by this thread.
+     */
+    void startInputThread();
+
+    /**
+     * Reads the device on the calling thread again. Has to be called
+     * before deleting the interface.
+     */
+    void stopInputThread();
    
      
     /**
@@ -487,6 +512,22 @@ class T_TX_Interface
     void reset();
 
   protected:
+    /**
+     * Reads all data available from the device and writes the raw axis
+     * values (TX_MAXAXIS of them) to <code>raw</code>. Values not available
+     * are left alone. Returns false if the interface doesn't read its device
+     * this way (it can't be read on a thread of its own).
+     *
+     * If the input thread is running, it is called on this thread only.
+     */
+    virtual bool readDevice(float* raw) { return(false); };
+
+    /**
+     * Gets the raw axis values either from the input thread or, if it isn't
+     * running, by calling readDevice(). Returns false if there are none.
+     */
+    bool pollDevice(float* raw);
+
     /**
      * What kind of input device is this?
      */
@@ -508,6 +549,11 @@ class T_TX_Interface
   
     CRRCMath::RateLimiter<float> keyb_retract_limited;
     CRRCMath::RateLimiter<float> keyb_spoiler_limited;
+
+    /**
+     * Reads the device if running, see startInputThread()
+     */
+    T_TX_InputThread* inputThread;
 };
 
 
@@ -27,6 +27,10 @@ T_TX_InterfacePPM::T_TX_InterfacePPM()
 #if DEBUG_TX_INTERFACE > 0
   printf("T_TX_InterfacePPM::T_TX_InterfacePPM()\n");
 #endif  
+  for (int i = 0; i < 11; i++)
+    rc_channel_values[i] = 0;
+  for (int i = 0; i < TX_MAXAXIS; i++)
+    values[i] = 0;
 }
 
 T_TX_InterfacePPM::~T_TX_InterfacePPM()
@@ -57,7 +61,8 @@ void T_TX_InterfacePPM::getInputData(TSimInputs* inputs)
 #if DEBUG_TX_INTERFACE > 1
   printf("int T_TX_InterfacePPM::getInputData(TSimInputs* inputs)\n");
 #endif
-  CalibMixMapValues(inputs, rc_channel_values);
+  pollDevice(values);
+  CalibMixMapValues(inputs, values);
 }
 
 
@@ -70,11 +75,22 @@ void T_TX_InterfacePPM::getRawData(float *dest)
   }
   for (int i = 0; i < axes; i++)
   {
-    *(dest + i) = rc_channel_values[i];
+    *(dest + i) = values[i];
   }
 }
 
 
+bool T_TX_InterfacePPM::readDevice(float* raw)
+{
+  readChannels();
+  for (int i = 0; i < TX_MAXAXIS; i++)
+  {
+    raw[i] = rc_channel_values[i];
+  }
+  return(true);
+}
+
+
 void T_TX_InterfacePPM::putBackIntoCfg(SimpleXMLTransfer* config)
 {
   calib->putBackIntoCfg(config);
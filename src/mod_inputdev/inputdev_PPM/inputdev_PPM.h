@@ -82,9 +82,27 @@ class T_TX_InterfacePPM : public T_TX_Interface
 
   protected:
    /**
-    * Channel values, range -1..1
+    * Reads the channel values from the device into
+    * <code>rc_channel_values</code>.
+    */
+   virtual void readChannels() = 0;
+
+   /**
+    * Calls readChannels().
+    */
+   virtual bool readDevice(float* raw);
+
+   /**
+    * Channel values, range -1..1. Written by readChannels(), which
+    * may run on the input thread.
     */
    float rc_channel_values[11];
+
+  private:
+   /**
+    * Channel values as used by getInputData() and getRawData()
+    */
+   float values[TX_MAXAXIS];
 };
 
 #endif
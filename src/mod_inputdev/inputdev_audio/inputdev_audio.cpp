@@ -178,14 +178,13 @@ int T_TX_InterfaceAudio::init(SimpleXMLTransfer* config)
  *
  *  \param inputs Pointer to a structure that stores the input values.
  */
-void T_TX_InterfaceAudio::getInputData(TSimInputs* inputs)
+void T_TX_InterfaceAudio::readChannels()
 {
 #if DEBUG_TX_INTERFACE > 1
-  printf("void T_TX_InterfaceAudio::getInputData(TSimInputs* inputs)\n");
+  printf("void T_TX_InterfaceAudio::readChannels()\n");
 #endif
   
   get_data_from_audio_interface(rc_channel_values);
-  T_TX_InterfacePPM::getInputData(inputs);
 }
 
 
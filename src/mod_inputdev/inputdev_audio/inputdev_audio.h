@@ -116,6 +116,11 @@ class T_TX_InterfaceAudio : public T_TX_InterfacePPM
   static int getDeviceList(std::vector<std::string>& Devices);
    
   private:
+    /**
+     * Reads the channel values from the device.
+     */
+    void readChannels();
+
     const char *cname;        ///< name in the config file
   
     // The device is identified by its device name
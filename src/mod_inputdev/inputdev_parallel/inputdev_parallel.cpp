@@ -160,10 +160,9 @@ int T_TX_InterfaceParallel::init(SimpleXMLTransfer* config)
 }
 
 
-void T_TX_InterfaceParallel::getInputData(TSimInputs* inputs)
+void T_TX_InterfaceParallel::readChannels()
 {
   get_data_from_parallel_interface(rc_channel_values);
-  T_TX_InterfacePPM::getInputData(inputs);
 }
 
 
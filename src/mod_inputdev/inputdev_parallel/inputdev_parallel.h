@@ -44,12 +44,6 @@ class T_TX_InterfaceParallel : public T_TX_InterfacePPM
     */
    int init(SimpleXMLTransfer* config);
    
-   /**
-    * Set current input data. If some value is not available, the value 
-    * is not overwritten.
-    */
-   void getInputData(TSimInputs* inputs);
-
    /**
     * Write configuration back
     */
@@ -63,6 +57,11 @@ class T_TX_InterfaceParallel : public T_TX_InterfacePPM
    const char * getConfigName() {return cname;};
 
   private:
+   /**
+    * Reads the channel values from the device.
+    */
+   void readChannels();
+
    void calibrate_parallel_interface();
    int init_parallel_interface(int lpt);
    void get_data_from_parallel_interface(float *rc_channel_values);
@@ -71,7 +71,7 @@ int T_TX_Interface_RCTran2::init(SimpleXMLTransfer* config)
 #endif
 }
 
-void T_TX_Interface_RCTran2::getInputData(TSimInputs* inputs)
+void T_TX_Interface_RCTran2::readChannels()
 {
   // read values from file
   int nVal[8];
@@ -86,8 +86,6 @@ void T_TX_Interface_RCTran2::getInputData(TSimInputs* inputs)
   {
     rc_channel_values[n] = convVal(nVal[n]);
   }
-
-  T_TX_InterfacePPM::getInputData(inputs);
 }
 
 void T_TX_Interface_RCTran2::putBackIntoCfg(SimpleXMLTransfer* config)
@@ -48,12 +48,6 @@ class T_TX_Interface_RCTran2 : public T_TX_InterfacePPM
     */
    int init(SimpleXMLTransfer* config);
    
-   /**
-    * Set current input data. If some value is not available, the value 
-    * is not overwritten.
-    */
-   void getInputData(TSimInputs* inputs);
-
    /**
     * Write configuration back
     */
@@ -67,6 +61,11 @@ class T_TX_Interface_RCTran2 : public T_TX_InterfacePPM
    const char * getConfigName() {return cname;};
 
   private:
+   /**
+    * Reads the channel values from the device.
+    */
+   void readChannels();
+
    /**
     * Path of the file to read values from
     */
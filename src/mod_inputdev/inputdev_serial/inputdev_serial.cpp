@@ -79,6 +79,12 @@ T_TX_InterfaceSerial::T_TX_InterfaceSerial ()/*{{{*/
   map=new T_AxisMapper (this);
   calib=new T_Calibration (this);
 
+  for (int i = 0; i < TX_MAXAXIS; ++i)
+  {
+    rawData[i]=0;
+    values[i]=0;
+  }
+
 #if DEBUG_TX_INTERFACE>0
   dbgbufferidx=0;
 #endif
@@ -272,17 +278,17 @@ void T_TX_InterfaceSerial::setRts (bool rts)/*{{{*/
 
 void T_TX_InterfaceSerial::getInputData (TSimInputs *inputs)/*{{{*/
 {
-  // Read serial data and update rawData[]
-  readSerialData ();
+  // Read serial data (or take it from the input thread) and update values[]
+  pollDevice (values);
 
-  CalibMixMapValues(inputs, rawData);
+  CalibMixMapValues(inputs, values);
 }
 /*}}}*/
 
 void T_TX_InterfaceSerial::getRawData (float *dest)/*{{{*/
 {
-  // Read serial data and update rawData[]
-  readSerialData ();
+  // Read serial data (or take it from the input thread) and update values[]
+  pollDevice (values);
 
   int numAxes=getNumAxes ();
   if (numAxes > TX_MAXAXIS)
@@ -291,8 +297,21 @@ void T_TX_InterfaceSerial::getRawData (float *dest)/*{{{*/
   }
   for (int i = 0; i < numAxes; ++i)
   {
-    *(dest + i) = rawData[i];
+    *(dest + i) = values[i];
+  }
+}
+/*}}}*/
+
+bool T_TX_InterfaceSerial::readDevice (float *raw)/*{{{*/
+{
+  // Read serial data and update rawData[]
+  readSerialData ();
+
+  for (int i = 0; i < TX_MAXAXIS; ++i)
+  {
+    raw[i] = rawData[i];
   }
+  return true;
 }
 /*}}}*/
 
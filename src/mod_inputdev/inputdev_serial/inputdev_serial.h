@@ -107,6 +107,7 @@ class T_TX_InterfaceSerial: public T_TX_Interface
       return baudRate;
     }
     virtual void processDataByte (unsigned char byte)=0; // Implementations need to implement this
+    virtual bool readDevice (float *raw); // Calls readSerialData, maybe on the input thread
     virtual void setErrMsg (string msg)
     {
       errorMessage=msg;
@@ -127,7 +128,8 @@ class T_TX_InterfaceSerial: public T_TX_Interface
     static const int nNumBaudrates;
     static const int anBaudRates[];
 
-    float rawData[TX_MAXAXIS];
+    float rawData[TX_MAXAXIS]; // Written by readSerialData
+    float values[TX_MAXAXIS];  // As used by getInputData and getRawData
 
     string errorMessage;
 
@@ -0,0 +1,136 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+/**
+ *  \file inputdev_thread.cpp
+ *
+ *  Reads an input device on a thread of its own, see inputdev_thread.h
+ */
+#include "inputdev_thread.h"
+
+#include <string.h>
+#include "../mod_misc/profiler.h"
+
+T_TX_InputThread::T_TX_InputThread(T_TX_Interface* iface)
+  : iface(iface), thread(NULL), fQuit(false), fCurrent(false), fLatest(false)
+{
+}
+
+T_TX_InputThread::~T_TX_InputThread()
+{
+  Stop();
+}
+
+void T_TX_InputThread::Start()
+{
+  if (thread != NULL)
+    return;
+
+  fQuit  = false;
+  thread = SDL_CreateThread(ThreadFunc, this);
+}
+
+void T_TX_InputThread::Stop()
+{
+  if (thread == NULL)
+    return;
+
+  fQuit = true;
+  SDL_WaitThread(thread, NULL);
+  thread = NULL;
+}
+
+bool T_TX_InputThread::getLatest(float* raw)
+{
+  if (latest.Update())
+    fLatest = true;
+  if (!fLatest)
+    return(false);
+
+  memcpy(raw, latest.Front().axis, sizeof(float)*TX_MAXAXIS);
+  return(true);
+}
+
+bool T_TX_InputThread::getSample(double t, float* raw)
+{
+  const T_TX_RawSample* s;
+
+  while ((s = queue.Peek()) != NULL && s->t <= t)
+  {
+    current  = *s;
+    fCurrent = true;
+    queue.Pop();
+  }
+  if (!fCurrent)
+    return(false);
+
+  memcpy(raw, current.axis, sizeof(float)*TX_MAXAXIS);
+  return(true);
+}
+
+int T_TX_InputThread::ThreadFunc(void* data)
+{
+  ((T_TX_InputThread*)data)->Run();
+  return(0);
+}
+
+void T_TX_InputThread::Run()
+{
+  T_TX_RawSample last;
+  bool           fLast    = false;
+  bool           fPending = false;  // last hasn't been queued yet
+
+  memset(last.axis, 0, sizeof(last.axis));
+  CRRC_Profiler::setThreadName("input");
+
+  while (!fQuit)
+  {
+    T_TX_RawSample s;
+
+    memcpy(s.axis, last.axis, sizeof(s.axis));
+    bool fRead;
+    {
+      CRRC_PROFILE("read_device");
+      fRead = iface->readDevice(s.axis);
+    }
+    if (fRead &&
+        (!fLast || memcmp(s.axis, last.axis, sizeof(s.axis)) != 0))
+    {
+      s.t = SDL_GetTicks();
+
+      latest.Back() = s;
+      latest.Publish();
+
+      last     = s;
+      fLast    = true;
+      fPending = true;
+    }
+
+    // If the flight model doesn't pick them up, the oldest values are
+    // the ones to keep: they are what the flight model is due to see next.
+    // Values which don't fit are replaced by newer ones, and the newest
+    // is queued as soon as there is room again, so the flight model
+    // doesn't stay at an old position.
+    if (fPending && queue.Push(last))
+      fPending = false;
+
+    SDL_Delay(1);
+  }
+
+  CRRC_Profiler::endThread();
+}
@@ -0,0 +1,110 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+/**
+ *  \file inputdev_thread.h
+ *
+ *  Reads an input device on a thread of its own.
+ */
+#ifndef TX_INPUTTHREAD_H
+#define TX_INPUTTHREAD_H
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#include "inputdev.h"
+#include "../mod_misc/spsc_ring.h"
+#include "../mod_misc/triple_buffer.h"
+
+/**
+ * Raw axis values of a device and when they were read.
+ */
+struct T_TX_RawSample
+{
+  Uint32 t;                   ///< SDL_GetTicks() [ms]
+  float  axis[TX_MAXAXIS];
+};
+
+/**
+ * Polls T_TX_Interface::readDevice() every millisecond on a thread of its
+ * own, so the device is drained no matter how long a frame takes.
+ *
+ * Every change is timestamped and queued for the flight model (see
+ * getSample()), which runs on another thread when
+ * <code>simulation.fdm_thread</code> is enabled. The latest values are
+ * also published for the main loop (see getLatest()).
+ */
+class T_TX_InputThread
+{
+  public:
+    T_TX_InputThread(T_TX_Interface* iface);
+
+    /**
+     * Stops the thread.
+     */
+    ~T_TX_InputThread();
+
+    void Start();
+    void Stop();
+
+    /**
+     * Latest values read from the device. Returns false if nothing has been
+     * read so far. Only one thread may call this (the main loop).
+     */
+    bool getLatest(float* raw);
+
+    /**
+     * Values which were current at time <code>t</code> [ms, SDL_GetTicks()].
+     * Samples older than that are dropped. Returns false if nothing has been
+     * read so far. Only one thread may call this (the flight model).
+     */
+    bool getSample(double t, float* raw);
+
+  private:
+    /**
+     * Size of the queue. At most one sample per millisecond is queued, so
+     * this covers the longest time the flight model may lag behind. If it
+     * lags behind even more, the changes in between are lost, but the
+     * latest values are queued once there is room.
+     */
+    enum { QUEUE_SIZE = 256 };
+
+    static int ThreadFunc(void* data);
+
+    void Run();
+
+    T_TX_Interface* iface;
+    SDL_Thread*     thread;
+    volatile bool   fQuit;
+
+    SPSCRing<T_TX_RawSample, QUEUE_SIZE> queue;
+    TripleBuffer<T_TX_RawSample>         latest;
+
+    /// @name Consumer side of queue
+    //@{
+    T_TX_RawSample current;
+    bool           fCurrent;
+    //@}
+
+    /// @name Consumer side of latest
+    //@{
+    bool           fLatest;
+    //@}
+};
+
+#endif
@@ -734,11 +734,11 @@ float BuiltinSceneryDavis::getHeightAndPlane(float x_north, float y_east, float
  *  
  */
 int BuiltinSceneryDavis::getWindComponents(double X_cg, double Y_cg, double Z_cg,
+    float flWindVel, float flWindDir,
     float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity)
 {
-  float flWindVel = cfg->wind->getVelocity();
-  *x_wind_velocity = -1 * flWindVel * cos(M_PI*cfg->wind->getDirection()/180);
-  *y_wind_velocity = -1 * flWindVel * sin(M_PI*cfg->wind->getDirection()/180);
+  *x_wind_velocity = -1 * flWindVel * cos(M_PI*flWindDir/180);
+  *y_wind_velocity = -1 * flWindVel * sin(M_PI*flWindDir/180);
   *z_wind_velocity = 0.;
   
   return 0;
@@ -1619,11 +1619,11 @@ BuiltinSceneryCapeCod::BuiltinSceneryCapeCod(SimpleXMLTransfer *xml, int sky_var
  *  
  */
 int BuiltinSceneryCapeCod::getWindComponents(double X_cg, double Y_cg, double Z_cg,
+    float flWindVel, float flWindDir,
     float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity)
 {
-  float flWindVel = cfg->wind->getVelocity();
-  *x_wind_velocity = -1 * flWindVel * cos(M_PI*cfg->wind->getDirection()/180);
-  *y_wind_velocity = -1 * flWindVel * sin(M_PI*cfg->wind->getDirection()/180);
+  *x_wind_velocity = -1 * flWindVel * cos(M_PI*flWindDir/180);
+  *y_wind_velocity = -1 * flWindVel * sin(M_PI*flWindDir/180);
   *z_wind_velocity = 0.;
 
   if (cfg->getDynamicSoaring()==FALSE)
@@ -103,7 +103,9 @@ class BuiltinScenery : public Scenery
     /**
      *  Get wind components at position X_cg, Y_cg, Z_cg
      */
+    using Scenery::getWindComponents;
     virtual int getWindComponents(double X_cg, double Y_cg, double Z_cg,
+                                  float flWindVel, float flWindDir,
                                   float *x_wind_velocity, 
                                   float *y_wind_velocity, 
                                   float *z_wind_velocity) = 0;
@@ -171,7 +173,9 @@ class BuiltinSceneryDavis : public BuiltinScenery
     /**
      *  Get wind components at position X_cg, Y_cg, Z_cg
      */
+    using Scenery::getWindComponents;
     int getWindComponents(double X_cg,double Y_cg,double Z_cg,
+                          float flWindVel, float flWindDir,
                           float *x_wind_velocity, 
                           float *y_wind_velocity,
                           float *z_wind_velocity);
@@ -271,7 +275,9 @@ class BuiltinSceneryCapeCod : public BuiltinScenery
     /**
      *  Get wind components at position X_cg, Y_cg, Z_cg
      */
+    using Scenery::getWindComponents;
     int getWindComponents(double X_cg,double Y_cg,double Z_cg,
+                          float flWindVel, float flWindDir,
                           float *x_wind_velocity, 
                           float *y_wind_velocity,
                           float *z_wind_velocity);
@@ -60,17 +60,43 @@
 Scenery* loadScenery(const char *fname, int sky_variant)
 {
   Scenery* new_scenery = NULL;
-  SimpleXMLTransfer* xml = NULL;
 	
   // open waiting box : Display message during the execution of this function
-  CGUIWaitingBox waitingbox(_("Scenery loading..."));
-  Video::display();
+  // (not available when running without video, e.g. in crrcsim_batch)
+  CGUIWaitingBox* waitingbox = NULL;
+  if (cfgfile->getInt("video.enabled", 1))
+  {
+    waitingbox = new CGUIWaitingBox(_("Scenery loading..."));
+    Video::display();
+  }
 
   // try to open the specified file
+  try
+  {
+    new_scenery = createScenery(new SimpleXMLTransfer(fname), sky_variant, fname);
+  }
+  catch (XMLException e)
+  {
+    std::string s = "XMLException: ";
+    s += e.what();
+    fprintf(stderr, "%s\n", s.c_str());
+    new_scenery = NULL;
+  }
+  if (new_scenery)
+    new_scenery->activate();
+  if (waitingbox)
+    delete waitingbox;
+  return new_scenery;
+}
+
+
+Scenery* createScenery(SimpleXMLTransfer *xml, int sky_variant, const char *fname)
+{
+  Scenery* new_scenery = NULL;
+
   try
   {
     SimpleXMLTransfer* tag;
-    xml = new SimpleXMLTransfer(fname);
 
     // Take a look at the version number of the config file.
     int nVer = xml->attributeAsInt("version", 1);
@@ -106,7 +132,7 @@ Scenery* loadScenery(const char *fname, int sky_variant)
     }
     else if (type == "model-based")
     {
-      new_scenery = new ModelBasedScenery(xml, sky_variant);
+      new_scenery = new ModelBasedScenery(xml, sky_variant, fname);
     }
     else // "not specified" or other unknown type
     {
@@ -129,11 +155,18 @@ Scenery* loadScenery(const char *fname, int sky_variant)
 }
 
 
+bool canCreateSceneryInBackground(SimpleXMLTransfer *xml)
+{
+  // built-in sceneries create their textures and display lists right away
+  return(xml->attribute("scene.type", "") == "model-based");
+}
+
+
 /**
  *  Constructor of the base class
  */
 Scenery::Scenery(SimpleXMLTransfer *xml, int sky_variant)
-    : name("unknown"), nSkyVariant(sky_variant)
+    : name("unknown"), sky(NULL), nSkyVariant(sky_variant)
 {
   flDefaultWindSpeed = 0.0f;
   flDefaultWindDirection = 0.0f;
@@ -176,35 +209,40 @@ Scenery::Scenery(SimpleXMLTransfer *xml, int sky_variant)
     flDefaultWindDirection = tag->attributeAsDouble("direction", 270.0f);
     wdDefaultTurbulence = tag->attributeAsDouble("turbulence", 1.0f);    
 
-    if (cfgfile->getInt("video.enabled", 1))
+    // the sky itself is set up by activate()
+    int children = xml->getChildCount();
+    std::vector<int> skies;
+    for (int i = 0; i < children; i++)
     {
-      /// \todo error handling if creating the sky fails?
-      int children = xml->getChildCount();
-      std::vector<int> skies;
-      for (int i = 0; i < children; i++)
+      if (xml->getChildAt(i)->getName() == "sky")
       {
-        if (xml->getChildAt(i)->getName() == "sky")
-        {
-          skies.push_back(i);
-          std::cout << "  <sky> " << i << " at child idx " << i << std::endl;
-        }
-      }
-      if (sky_variant < (int)skies.size())
-      {
-        std::cout << "  Using sky variant " << sky_variant << std::endl;
-        Video::setup_sky(xml->getChildAt(skies[sky_variant]));
-      }
-      else
-      {
-        std::cout << "  Using first sky definition" << std::endl;
-        Video::setup_sky(xml->getChild("sky", true));
-        nSkyVariant = 0;
+        skies.push_back(i);
+        std::cout << "  <sky> " << i << " at child idx " << i << std::endl;
       }
     }
+    if (sky_variant < (int)skies.size())
+    {
+      std::cout << "  Using sky variant " << sky_variant << std::endl;
+      sky = xml->getChildAt(skies[sky_variant]);
+    }
+    else
+    {
+      std::cout << "  Using first sky definition" << std::endl;
+      sky = xml->getChild("sky", true);
+      nSkyVariant = 0;
+    }
   }
 }
 
 
+void Scenery::activate()
+{
+  /// \todo error handling if creating the sky fails?
+  if (sky != NULL && cfgfile->getInt("video.enabled", 1))
+    Video::setup_sky(sky);
+}
+
+
 /**
  *  Destructor of the base class
  */
@@ -217,6 +255,32 @@ if (xml_description != NULL)
 }
 
 
+void Scenery::getHeights(const float* x, const float* z, float* heights, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = getHeight(x[i], z[i]);
+}
+
+
+void Scenery::getHeightsAndPlanes(const float* x, const float* z,
+                                  float* heights, float* tplanes, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = getHeightAndPlane(x[i], z[i], &tplanes[4*i]);
+}
+
+
+int Scenery::getWindComponents(double X_cg, double Y_cg, double Z_cg,
+                               float *x_wind_velocity, 
+                               float *y_wind_velocity,
+                               float *z_wind_velocity)
+{
+  return getWindComponents(X_cg, Y_cg, Z_cg,
+                           cfg->wind->getVelocity(), cfg->wind->getDirection(),
+                           x_wind_velocity, y_wind_velocity, z_wind_velocity);
+}
+
+
 /**
  * Get pointeur on XML description section named "section_name"
  *
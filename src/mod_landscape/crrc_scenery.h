@@ -72,6 +72,14 @@ class Scenery
      */
     virtual ~Scenery();
 
+    /**
+     *  Second part of the initialization, which needs the OpenGL
+     *  context: sets up the sky. The constructor may run on another
+     *  thread, this has to be called on the main thread before the
+     *  scenery is drawn.
+     */
+    virtual void activate();
+
      /**
      * Get pointeur on XML description section named "name"
      *
@@ -135,11 +143,44 @@ class Scenery
      *  \return terrain height at this point in ft
      */
     virtual float getHeightAndPlane(float x, float z, float tplane[4]) = 0;
+
+    /**
+     *  Get the height at <code>n</code> points at once.
+     *  \param x       x coordinates
+     *  \param z       z coordinates
+     *  \param heights terrain heights in ft are stored here
+     *  \param n       number of points
+     */
+    virtual void getHeights(const float* x, const float* z, float* heights, int n);
+
+    /**
+     *  Get height and plane equation at <code>n</code> points at once.
+     *  \param x       x coordinates
+     *  \param z       z coordinates
+     *  \param heights terrain heights in ft are stored here
+     *  \param tplanes plane equations are stored here (4 floats per point)
+     *  \param n       number of points
+     */
+    virtual void getHeightsAndPlanes(const float* x, const float* z,
+                                     float* heights, float* tplanes, int n);
     
     /**
-     *  Get wind components at position X_cg, Y_cg, Z_cg
+     *  Get wind components at position X_cg, Y_cg, Z_cg, using the
+     *  wind configured in <code>cfg->wind</code>.
+     */
+    int getWindComponents(double X_cg, double Y_cg, double Z_cg,
+                          float *x_wind_velocity, 
+                          float *y_wind_velocity,
+                          float *z_wind_velocity);
+
+    /**
+     *  Get wind components at position X_cg, Y_cg, Z_cg for a freestream
+     *  wind of <code>flWindVel</code> (ft/s) from <code>flWindDir</code>
+     *  (degrees). Must not modify the scenery, as it may be called from
+     *  several simulations at once.
      */
     virtual int getWindComponents(double X_cg, double Y_cg, double Z_cg,
+                                  float flWindVel, float flWindDir,
                                   float *x_wind_velocity, 
                                   float *y_wind_velocity,
                                   float *z_wind_velocity) = 0;
@@ -151,6 +192,12 @@ class Scenery
      */
     void drawWindField(CRRCMath::Vector3 pos, int mode);
 
+    /**
+     *  Returns true if height and wind lookups may be done from several
+     *  threads at once.
+     */
+    virtual bool isReentrant() { return(true); };
+
     /**
      *  Get an ID code for this location or scenery type
      */
@@ -203,6 +250,7 @@ class Scenery
     int parsePositions(SimpleXMLTransfer *tag, T_PosnArray& pa, bool default_on_empty = true);
   
     SimpleXMLTransfer *xml_description;
+    SimpleXMLTransfer *sky;         ///< sky definition to be set up by activate()
     T_PosnArray views;
     T_PosnArray starts;
     int nSkyVariant;                ///< Index of the currently loaded sky variant
@@ -219,6 +267,20 @@ class Scenery
  */
 Scenery* loadScenery(const char *fname, int sky_variant = 0);
 
+/**
+ *  Create the scenery described by a scenery file, without activating
+ *  it. Takes over <code>xml</code>.
+ *
+ *  eturn Pointer to new scenery on success, NULL on error
+ */
+Scenery* createScenery(SimpleXMLTransfer *xml, int sky_variant, const char *fname);
+
+/**
+ *  Returns true if createScenery() may be called for <code>xml</code>
+ *  on a thread without OpenGL context.
+ */
+bool canCreateSceneryInBackground(SimpleXMLTransfer *xml);
+
 
 /** \brief initial NULL renderer scenery 
  *
@@ -231,7 +293,9 @@ class SceneryNull : public Scenery
     float getHeight(float x, float z){return 0;}
     float getHeightAndPlane(float x, float z, float tplane[4]){return 0;}
     int getID() {return 0;}
+    using Scenery::getWindComponents;
     int getWindComponents(double X_cg,double Y_cg,double Z_cg,
+                          float flWindVel, float flWindDir,
                           float *x_wind_velocity, 
                           float *y_wind_velocity, 
                           float *z_wind_velocity){return 1;}
@@ -0,0 +1,246 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "hd_cache.h"
+#include "../mod_misc/filesystools.h"
+
+#include <iostream>
+#include <string.h>
+
+#ifndef WIN32
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+/// Increment this if the format or the calculation of any height data changes.
+#define HD_CACHE_VERSION   1
+
+#define FNV_OFFSET_BASIS   14695981039346656037ULL
+#define FNV_PRIME          1099511628211ULL
+
+
+HD_Cache::HD_Cache(std::string sceneryfile, std::string extension)
+  : nCreated(-1), key(FNV_OFFSET_BASIS), data(NULL), size(0)
+{
+  filenames.push_back(sceneryfile + extension);
+
+  // sceneries in different directories may have the same name
+  std::string home = FileSysTools::getHomePath();
+  if (home != "")
+  {
+    std::string mangled = sceneryfile;
+
+    for (unsigned int n = 0; n < mangled.length(); n++)
+    {
+      if (mangled[n] == '/' || mangled[n] == '\\' || mangled[n] == ':')
+        mangled[n] = '_';
+    }
+    filenames.push_back(home + "/cache/" + mangled + extension);
+  }
+}
+
+HD_Cache::~HD_Cache()
+{
+  close();
+}
+
+void HD_Cache::addToKey(const void* buf, size_t len)
+{
+  const unsigned char* p = (const unsigned char*)buf;
+
+  for (size_t n = 0; n < len; n++)
+  {
+    key ^= p[n];
+    key *= FNV_PRIME;
+  }
+}
+
+void HD_Cache::addToKey(double val)
+{
+  addToKey(&val, sizeof(val));
+}
+
+void HD_Cache::addToKey(std::string str)
+{
+  // including the terminating zero
+  addToKey(str.c_str(), str.length()+1);
+}
+
+bool HD_Cache::addFileToKey(std::string filename)
+{
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL)
+    return(false);
+
+  char   buf[65536];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+    addToKey(buf, len);
+  fclose(fp);
+
+  return(true);
+}
+
+const char* HD_Cache::open(uint32_t type, size_t& datasize)
+{
+  for (unsigned int n = 0; n < filenames.size(); n++)
+  {
+    if (!mapFile(filenames[n]))
+      continue;
+
+    Header h;
+    if (size >= sizeof(Header))
+    {
+      memcpy(&h, data, sizeof(Header));
+      if (memcmp(h.magic, "CRHD", 4) == 0 &&
+          h.version   == HD_CACHE_VERSION &&
+          h.type      == type &&
+          h.byteorder == 0x01020304 &&
+          h.key       == key)
+      {
+        std::cout << "Using precalculated data from " << filenames[n] << std::endl;
+        datasize = size - sizeof(Header);
+        return(data + sizeof(Header));
+      }
+    }
+    close();
+  }
+
+  datasize = 0;
+  return(NULL);
+}
+
+FILE* HD_Cache::create(uint32_t type)
+{
+  close();
+
+  Header h;
+  memcpy(h.magic, "CRHD", 4);
+  h.version   = HD_CACHE_VERSION;
+  h.type      = type;
+  h.byteorder = 0x01020304;
+  h.key       = key;
+
+  for (unsigned int n = 0; n < filenames.size(); n++)
+  {
+    if (n > 0)
+      FileSysTools::makeSurePathExists(filenames[n].substr(0, filenames[n].rfind('/')));
+
+    std::string tmp = filenames[n] + ".tmp";
+    FILE*       fp  = fopen(tmp.c_str(), "wb");
+    if (fp != NULL)
+    {
+      if (fwrite(&h, sizeof(h), 1, fp) == 1)
+      {
+        nCreated = n;
+        return(fp);
+      }
+      fclose(fp);
+      remove(tmp.c_str());
+    }
+  }
+
+  return(NULL);
+}
+
+void HD_Cache::commit(FILE* fp, bool fSuccess)
+{
+  if (fp == NULL || nCreated < 0)
+    return;
+
+  std::string file = filenames[nCreated];
+  std::string tmp  = file + ".tmp";
+  nCreated = -1;
+
+  if (fclose(fp) != 0)
+    fSuccess = false;
+
+  if (fSuccess)
+  {
+#ifdef WIN32
+    remove(file.c_str());
+#endif
+    if (rename(tmp.c_str(), file.c_str()) == 0)
+    {
+      std::cout << "Wrote precalculated data to " << file << std::endl;
+      return;
+    }
+  }
+
+  std::cerr << "Unable to write precalculated data to " << file << std::endl;
+  remove(tmp.c_str());
+}
+
+bool HD_Cache::mapFile(std::string filename)
+{
+  close();
+
+#ifdef WIN32
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL)
+    return(false);
+
+  char   buf[65536];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+    buffer.insert(buffer.end(), buf, buf+len);
+  fclose(fp);
+
+  if (buffer.size() == 0)
+    return(false);
+  data = &buffer[0];
+  size = buffer.size();
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return(false);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    ::close(fd);
+    return(false);
+  }
+
+  void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return(false);
+
+  data = (const char*)p;
+  size = st.st_size;
+#endif
+
+  return(true);
+}
+
+void HD_Cache::close()
+{
+#ifdef WIN32
+  buffer.clear();
+#else
+  if (data != NULL)
+    munmap((void*)data, size);
+#endif
+  data = NULL;
+  size = 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef HD_CACHE_H
+#define HD_CACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/// @name Types of height data in a HD_Cache
+//@{
+#define HD_CACHE_TABULATED  1
+#define HD_CACHE_TILING     2
+#define HD_CACHE_WINDGRID   3   ///< not height data, see WindGrid
+//@}
+
+/**
+ * A file holding height data (HD_TabulatedTerrain, HD_TilingTerrain)
+ * calculated for a scenery, so it doesn't have to be calculated again
+ * the next time the scenery is loaded.
+ *
+ * The file starts with a header (magic number, version, type of height
+ * data, byte order and a key), followed by data written by the
+ * HeightData class. The key is a hash of everything the height data
+ * depends on: the contents of the model files, their transformations
+ * and the height mode. If anything changes, the key doesn't match, the
+ * height data is calculated again and the file is replaced.
+ *
+ * The file is written next to the scenery file. If that isn't possible,
+ * it is written to the directory "cache" in the user's CRRCsim directory,
+ * named after the full path of the scenery file.
+ * Other precalculated data (WindGrid) uses the same format, in a file
+ * of its own.
+ *
+ * A valid file is mapped into memory (read on Windows), so the height
+ * data can use it without copying. The mapping exists as long as the
+ * HD_Cache object does.
+ */
+class HD_Cache
+{
+  public:
+    /**
+     * \param sceneryfile  scenery file (with full path)
+     * \param extension    appended to its name to get the cache file
+     */
+    HD_Cache(std::string sceneryfile, std::string extension = ".heightcache");
+
+    ~HD_Cache();
+
+    /// @name Calculation of the key
+    //@{
+    void addToKey(const void* buf, size_t len);
+    void addToKey(double val);
+    void addToKey(std::string str);
+
+    /**
+     * Adds the contents of a file. Returns false if it couldn't be read.
+     */
+    bool addFileToKey(std::string filename);
+    //@}
+
+    /**
+     * Maps the cache file. Returns the data following the header or NULL
+     * if there is no valid file for this type of height data and key.
+     *
+     * \param type      type of height data
+     * \param datasize  size of the data is stored here
+     */
+    const char* open(uint32_t type, size_t& datasize);
+
+    /**
+     * Creates a new (temporary) cache file and writes the header. The caller
+     * writes the data, then calls commit().
+     * Returns NULL if no file could be created.
+     */
+    FILE* create(uint32_t type);
+
+    /**
+     * Closes the file opened by create() and replaces the cache file with
+     * it. If fSuccess is false, the file is removed instead.
+     */
+    void commit(FILE* fp, bool fSuccess);
+
+  private:
+    struct Header
+    {
+      char     magic[4];
+      uint32_t version;
+      uint32_t type;
+      uint32_t byteorder;
+      uint64_t key;
+    };
+
+    void close();
+
+    bool mapFile(std::string filename);
+
+    /**
+     * Possible locations of the cache file, in the order they are tried
+     */
+    std::vector<std::string> filenames;
+
+    /**
+     * Index into filenames of the file being written by create()
+     */
+    int nCreated;
+
+    /**
+     * FNV-1a hash
+     */
+    uint64_t key;
+
+    /// @name The mapped file
+    //@{
+    const char*       data;
+    size_t            size;
+    std::vector<char> buffer;
+    //@}
+};
+
+#endif // HD_CACHE_H
@@ -51,6 +51,11 @@ class HD_SsgLOSTerrain : public HeightData
      *  \return terrain height at this point in ft
      */
     float getHeightAndPlane(float x_north, float y_east, float tplane[4]);
+
+    /**
+     *  ssgLOS() keeps its state in static variables.
+     */
+    bool isReentrant() { return(false); };
 };
 
 #endif // HD_SSGLOSTERRAIN_H
@@ -20,12 +20,46 @@
  */
 
 #include "hd_tabulatedterrain.h"
+#include <string.h>
 
 
-HD_TabulatedTerrain::HD_TabulatedTerrain(ssgRoot* SceneGraph)
+HD_TabulatedTerrain::HD_TabulatedTerrain(ssgRoot* SceneGraph, HD_Cache* cache)
 : HeightData::HeightData(SceneGraph)
 {
+  // The cache holds the number of points per row, tab_HOT and tab_Plane.
+  const int32_t n = SIZE_GRID_PLANES+1;
+
+  if (cache)
+  {
+    size_t      size;
+    const char* data = cache->open(HD_CACHE_TABULATED, size);
+    int32_t     n_cache;
+
+    if (data && size == sizeof(n) + sizeof(tab_HOT) + sizeof(tab_Plane))
+    {
+      memcpy(&n_cache, data, sizeof(n));
+      if (n_cache == n)
+      {
+        memcpy(tab_HOT,   data + sizeof(n),                   sizeof(tab_HOT));
+        memcpy(tab_Plane, data + sizeof(n) + sizeof(tab_HOT), sizeof(tab_Plane));
+        return;
+      }
+    }
+  }
+
   make_tab_HeightAndPlane();
+
+  if (cache)
+  {
+    FILE* fp = cache->create(HD_CACHE_TABULATED);
+    if (fp)
+    {
+      bool fOK = (fwrite(&n,        sizeof(n),         1, fp) == 1 &&
+                  fwrite(tab_HOT,   sizeof(tab_HOT),   1, fp) == 1 &&
+                  fwrite(tab_Plane, sizeof(tab_Plane), 1, fp) == 1);
+      cache->commit(fp, fOK);
+    }
+  }
 }
 
 HD_TabulatedTerrain::~HD_TabulatedTerrain()
@@ -75,6 +109,20 @@ float HD_TabulatedTerrain::getHeightAndPlane(float x_north, float y_east, float
   return hot;
 }
 
+void HD_TabulatedTerrain::getHeights(const float* x_north, const float* y_east,
+                                    float* heights, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = HD_TabulatedTerrain::getHeightAndPlane(x_north[i], y_east[i], NULL);
+}
+
+void HD_TabulatedTerrain::getHeightsAndPlanes(const float* x_north, const float* y_east,
+                                             float* heights, float* tplanes, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = HD_TabulatedTerrain::getHeightAndPlane(x_north[i], y_east[i], &tplanes[4*i]);
+}
+
 void HD_TabulatedTerrain::make_tab_HeightAndPlane()
 {
   for (int i = 0; i <= SIZE_GRID_PLANES; i++)
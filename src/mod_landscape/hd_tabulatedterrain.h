@@ -23,6 +23,7 @@
 #define HD_TABULATEDTERRAIN_H
 
 #include "heightdata.h"
+#include "hd_cache.h"
 #include <plib/ssg.h>
 
 #define SIZE_GRID_PLANES        150
@@ -32,7 +33,11 @@
 class HD_TabulatedTerrain : public HeightData
 {
   public:
-    HD_TabulatedTerrain(ssgRoot* SceneGraph);
+    /**
+     * If a HD_Cache is given, the table is taken from it if possible.
+     * Otherwise it is calculated and written to the cache.
+     */
+    HD_TabulatedTerrain(ssgRoot* SceneGraph, HD_Cache* cache = NULL);
   
     ~HD_TabulatedTerrain();
   
@@ -55,6 +60,20 @@ class HD_TabulatedTerrain : public HeightData
      *  \return terrain height at this point in ft
      */
     float getHeightAndPlane(float x_north, float y_east, float tplane[4]);
+
+    /**
+     *  Get the height at <code>n</code> points at once, without a
+     *  virtual call per point.
+     */
+    void getHeights(const float* x_north, const float* y_east,
+                    float* heights, int n);
+
+    /**
+     *  Get height and plane equation at <code>n</code> points at once,
+     *  without a virtual call per point.
+     */
+    void getHeightsAndPlanes(const float* x_north, const float* y_east,
+                             float* heights, float* tplanes, int n);
     
   private:
     void make_tab_HeightAndPlane(); 
@@ -20,34 +20,46 @@
  */
 
 #include "hd_tilingterrain.h"
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+#include <math.h>
 
+/// Average number of triangles per grid cell
+#define TRIANGLES_PER_CELL  4
+/// Smallest grid cell [ft]
+#define MIN_CELL_SIZE       0.5
+/// Maximum number of grid cells along x or y
+#define MAX_CELLS           2048
 
-HD_TilingTerrain::HD_TilingTerrain(ssgRoot* SceneGraph)
+
+HD_TilingTerrain::HD_TilingTerrain(ssgRoot* SceneGraph, HD_Cache* cache)
 : HeightData::HeightData(SceneGraph)
 {
-  for ( int i = 0 ; i < SIZE_GRID_PLANES; i++ )
+  if (cache)
   {
-    for ( int j = 0 ; j < SIZE_GRID_PLANES; j++ )
-    {
-      tile_table[i][j] = new ssgVertexArray();
-    }
+    size_t      size;
+    const char* data = cache->open(HD_CACHE_TILING, size);
+    if (data && readGrid(data, size))
+      return;
   }
 
+  std::vector<float> verts;
   sgMat4 xform;
   sgMakeIdentMat4(xform);
-  tiling_terrain(SceneGraph,xform);
+  tiling_terrain(SceneGraph, xform, verts);
+  makeGrid(verts);
+
+  if (cache)
+  {
+    FILE* fp = cache->create(HD_CACHE_TILING);
+    if (fp)
+      cache->commit(fp, writeGrid(fp));
+  }
 }
 
 HD_TilingTerrain::~HD_TilingTerrain()
 {
-  for ( int i = 0 ; i < SIZE_GRID_PLANES; i++)
-  {
-    for ( int j = 0 ; j < SIZE_GRID_PLANES; j++)
-    {
-      if (tile_table[i][j])
-        delete tile_table[i][j];
-    }
-  }
 }
 
 float HD_TilingTerrain::getHeight(float x_north, float y_east)
@@ -55,54 +67,67 @@ float HD_TilingTerrain::getHeight(float x_north, float y_east)
   return getHeightAndPlane(x_north, y_east, NULL);
 }
 
+int HD_TilingTerrain::getCell(float x_north, float y_east)
+{
+  float fx = (x_north - x_min) / cell_size;
+  float fy = (y_east  - y_min) / cell_size;
+
+  if (fx < 0 || fy < 0)
+    return(-1);
+
+  int ix = (int)fx;
+  int iy = (int)fy;
+  if (ix >= nx || iy >= ny)
+    return(-1);
+
+  return(ix*ny + iy);
+}
+
 float HD_TilingTerrain::getHeightAndPlane(float x_north, float y_east, float tplane[4])
 {
-  int numero = -1;
-
-  int i = (int)(y_east/SIZE_CELL_GRID_PLANES) + SIZE_GRID_PLANES/2;
-  int j = (int)(-x_north/SIZE_CELL_GRID_PLANES) + SIZE_GRID_PLANES/2;
-  if (i < 0) i = 0;
-  if (i > SIZE_GRID_PLANES-1) i = SIZE_GRID_PLANES-1;
-  if (j < 0) j = 0;
-  if (j > SIZE_GRID_PLANES-1) j = SIZE_GRID_PLANES-1;
-  ssgVertexArray* tile = tile_table[i][j];
-//std::cout << "utilise cellule " << i<<", "<<j<< std::endl;
-
-  int nt = tile->getNum();
-  float hot = DEEPEST_HELL ;
-//std::cout << "cellule nb triangle/cellule*3 i,j "<<tile <<"  " << nt <<"  "<< i <<"  "<< j << std::endl;
-//std::cout << "nord, east" <<x_north<<"  "<< y_east <<"  " << std::endl;
-
-  for ( int n = 0 ; n < nt ; n+=3 )
+  float           hot  = DEEPEST_HELL;
+  const Triangle* best = NULL;
+  int             c    = getCell(x_north, y_east);
+
+  if (c >= 0)
   {
-    float *p1 = tile->get(n);
-    float *p2 = tile->get(n+1);
-    float *p3 = tile->get(n+2);
-    /*
-    std::cout << "-------------- " << p1[0]<<"  "<< p1[1]<<"  "<< p1[2]<<"  "<< std::endl;
-    std::cout << "-------------- " << p2[0]<<"  "<< p2[1]<<"  "<< p2[2]<<"  "<< std::endl;
-    std::cout << "-------------- " << p3[0]<<"  "<< p3[1]<<"  "<< p3[2]<<"  "<< std::endl;
-    */
-    if ( on_triangle(-x_north, y_east, p1, p2, p3))
+    const int32_t* it  = cell_tris + cell_start[c];
+    const int32_t* end = cell_tris + cell_start[c+1];
+
+    for (; it < end; it++)
     {
-      sgVec4 plane;
-      sgMakePlane ( plane, p1, p2, p3);
-      float h = -(-plane[2]*x_north + plane[0]*y_east + plane[3])/plane[1];
-      if (h > hot)
+      const Triangle& t = tris[*it];
+
+      // sorted by h_max: no triangle after this one can be higher
+      if (t.h_max <= hot)
+        break;
+
+      bool t1 = (t.e[0][0]*x_north + t.e[0][1]*y_east + t.e[0][2] > 0);
+      bool t2 = (t.e[1][0]*x_north + t.e[1][1]*y_east + t.e[1][2] > 0);
+      bool t3 = (t.e[2][0]*x_north + t.e[2][1]*y_east + t.e[2][2] > 0);
+      if (t1 == t2 && t1 == t3)
       {
-        numero = n;
-        hot = h;
-        if (tplane) sgCopyVec4(tplane, plane);
+        float h = t.h[0]*x_north + t.h[1]*y_east + t.h[2];
+        if (h > hot)
+        {
+          hot  = h;
+          best = &t;
+        }
       }
-      //std::cout << "----plane***" <<  plane[0] <<"  "<<  plane[1] <<"  "<<  plane[2]<<"  "<<  plane[3] << "hot" << hot <<std::endl;
     }
   }
-  if ( tplane )
+
+  if (tplane)
   {
-    if ( numero >= 0)
+    if (best)
     {
-      if (tplane[1]<0) /*  ??? revoir :  preferable d'orienter correctement les facettes */
-        sgNegateVec4 ( tplane , tplane );
+      // plane equation in scene graph coordinates (east, up, south),
+      // normal pointing up
+      float len = sqrt(best->h[0]*best->h[0] + best->h[1]*best->h[1] + 1);
+      tplane[0] = -best->h[1] / len;
+      tplane[1] =  1          / len;
+      tplane[2] =  best->h[0] / len;
+      tplane[3] = -best->h[2] / len;
     }
     else
     {
@@ -115,25 +140,39 @@ float HD_TilingTerrain::getHeightAndPlane(float x_north, float y_east, float tpl
   return hot;
 }
 
+void HD_TilingTerrain::getHeights(const float* x_north, const float* y_east,
+                                 float* heights, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = HD_TilingTerrain::getHeightAndPlane(x_north[i], y_east[i], NULL);
+}
+
+void HD_TilingTerrain::getHeightsAndPlanes(const float* x_north, const float* y_east,
+                                          float* heights, float* tplanes, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = HD_TilingTerrain::getHeightAndPlane(x_north[i], y_east[i], &tplanes[4*i]);
+}
+
 /**
- * \brief Tile the terrain
+ * \brief Collect the triangles of the terrain
  *
- * This function recursively walks the scene graph and sorts all
- * triangles into a grid of smaller graphs. This reduces the
- * calculation effort: If the position of the plane and therefore
- * the grid below it is known, only a small fraction of all
- * triangles has to be tested.
+ * This function recursively walks the scene graph and collects all
+ * triangles, which are sorted into a grid by makeGrid() afterwards.
+ * This reduces the calculation effort: If the position of the plane
+ * and therefore the grid cell below it is known, only a small fraction
+ * of all triangles has to be tested.
  *
  * During the recursive walk down the tree, the function tracks
  * all transformations. If a leaf node is encountered, the contained
  * triangles are transformed by the tracked transformations to
- * get the absolute position of each triangle. Then all triangles
- * are sorted into the grid by their absolute position.
+ * get the absolute position of each triangle.
  *
  * \param e       Pointer to the currently processed entity
  * \param xform   Reference to the current transformation
+ * \param verts   Corners of all triangles are appended to this array
  */
-void HD_TilingTerrain::tiling_terrain(ssgEntity * e, sgMat4 xform)
+void HD_TilingTerrain::tiling_terrain(ssgEntity * e, sgMat4 xform, std::vector<float>& verts)
 {
   // only continue if HOT traversal is enabled for this entity
   if ( e->getTraversalMask() & SSGTRAV_HOT )
@@ -165,7 +204,7 @@ void HD_TilingTerrain::tiling_terrain(ssgEntity * e, sgMat4 xform)
       sgCopyMat4(local_xform, xform);
       for ( int i = 0 ; i < br -> getNumKids () ; i++ )
       {
-        tiling_terrain ( br -> getKid ( i ), xform);
+        tiling_terrain ( br -> getKid ( i ), xform, verts);
         // restore transformation matrix
         sgCopyMat4(xform, local_xform);
       }
@@ -194,73 +233,271 @@ void HD_TilingTerrain::tiling_terrain(ssgEntity * e, sgMat4 xform)
         std::cout << "-------------- " << v2[0]<<"  "<< v2[1]<<"  "<< v2[2]<<"  "<< std::endl;
         std::cout << "-------------- " << v3[0]<<"  "<< v3[1]<<"  "<< v3[2]<<"  "<< std::endl;
         */
-        //calcule cube englobant
-        sgBox box;
-        box.empty();
-        box.extend(v1);
-        box.extend(v2);
-        box.extend(v3);
-        //std::cout << "Min " << box.min[0]<<", "<<box.min[1]<<", "<<box.min[2]<<" Max"<<box.max[0]<<", "<<box.max[1]<<", "<<box.max[2]<< std::endl;
-        //ajoute dans cellules recouvertes
-        int i1 = (int)(-0.1+box.min[0]/SIZE_CELL_GRID_PLANES) + SIZE_GRID_PLANES/2;
-        int i2 = (int)(0.1+box.max[0]/SIZE_CELL_GRID_PLANES) + SIZE_GRID_PLANES/2;
-        int j1 = (int)(-0.1+box.min[2]/SIZE_CELL_GRID_PLANES) + SIZE_GRID_PLANES/2;
-        int j2 = (int)(0.1+box.max[2]/SIZE_CELL_GRID_PLANES) + SIZE_GRID_PLANES/2;
-        if (i1 < 0)
-          i1 = 0;
-        if (i1 > SIZE_GRID_PLANES-1)
-          i1 = SIZE_GRID_PLANES-1;
-        if (i2 < 0)
-          i2 = 0;
-        if (i2 > SIZE_GRID_PLANES-1)
-          i2 = SIZE_GRID_PLANES-1;
-        if (j1 < 0)
-          j1 = 0;
-        if (j1 > SIZE_GRID_PLANES-1)
-          j1 = SIZE_GRID_PLANES-1;
-        if (j2 < 0)
-          j2 = 0;
-        if (j2 > SIZE_GRID_PLANES-1)
-          j2 = SIZE_GRID_PLANES-1;
-        //std::cout << "cellules i, j  " << i1 <<", "<<i2<<", "<<j1<<","<<j2<< std::endl;
-        for (int i = i1; i <= i2; i++)
+        for (int k = 0; k < 3; k++)
+        {
+          verts.push_back(v1[k]);
+        }
+        for (int k = 0; k < 3; k++)
+        {
+          verts.push_back(v2[k]);
+        }
+        for (int k = 0; k < 3; k++)
+        {
+          verts.push_back(v3[k]);
+        }
+      }
+    }
+  }
+}
+
+bool HD_TilingTerrain::isHigher(TriangleBox const& a, TriangleBox const& b)
+{
+  return(a.t.h_max > b.t.h_max);
+}
+
+/**
+ * \brief Create the grid
+ *
+ * Calculates edge and plane equations of all triangles, then chooses
+ * a cell size and sorts the triangles into all cells their bounding box
+ * touches. As the triangles are sorted by height before, the list of
+ * every cell is sorted, too.
+ *
+ * \param verts   Corners of all triangles, see tiling_terrain()
+ */
+void HD_TilingTerrain::makeGrid(std::vector<float> const& verts)
+{
+  std::vector<TriangleBox> tb;
+  int                      nVerts = verts.size() / 3;
+
+  // Scene graph coordinates are east, up, south.
+  // The triangles use north, east, up.
+  tb.reserve(nVerts / 3);
+  for (int n = 0; n + 2 < nVerts; n += 3)
+  {
+    float p[3][3];
+    for (int k = 0; k < 3; k++)
+    {
+      p[k][0] = -verts[3*(n+k)+2];
+      p[k][1] =  verts[3*(n+k)];
+      p[k][2] =  verts[3*(n+k)+1];
+    }
+
+    sgVec4 plane;
+    sgMakePlane(plane, &verts[3*n], &verts[3*n+3], &verts[3*n+6]);
+
+    // A vertical triangle doesn't have a height.
+    if (fabs(plane[1]) < 1.0E-6)
+      continue;
+
+    TriangleBox x;
+    Triangle&   t = x.t;
+    t.h[0] =  plane[2] / plane[1];
+    t.h[1] = -plane[0] / plane[1];
+    t.h[2] = -plane[3] / plane[1];
+
+    t.h_max   = p[0][2];
+    x.box[0] = x.box[1] = p[0][0];
+    x.box[2] = x.box[3] = p[0][1];
+    for (int k = 0; k < 3; k++)
+    {
+      // edge from corner k-1 to corner k: the sign tells on which side of
+      // it a point is
+      const float* a = p[(k+2)%3];
+      const float* b = p[k];
+      t.e[k][0] =  (b[1] - a[1]);
+      t.e[k][1] = -(b[0] - a[0]);
+      t.e[k][2] = -(t.e[k][0]*a[0] + t.e[k][1]*a[1]);
+
+      t.h_max  = std::max(t.h_max,  p[k][2]);
+      x.box[0] = std::min(x.box[0], p[k][0]);
+      x.box[1] = std::max(x.box[1], p[k][0]);
+      x.box[2] = std::min(x.box[2], p[k][1]);
+      x.box[3] = std::max(x.box[3], p[k][1]);
+    }
+    tb.push_back(x);
+  }
+  std::sort(tb.begin(), tb.end(), isHigher);
+
+  // bounding box of all triangles
+  float x_max = 0;
+  float y_max = 0;
+  x_min = y_min = 0;
+  for (std::vector<TriangleBox>::size_type n = 0; n < tb.size(); n++)
+  {
+    if (n == 0 || tb[n].box[0] < x_min)
+      x_min = tb[n].box[0];
+    if (n == 0 || tb[n].box[1] > x_max)
+      x_max = tb[n].box[1];
+    if (n == 0 || tb[n].box[2] < y_min)
+      y_min = tb[n].box[2];
+    if (n == 0 || tb[n].box[3] > y_max)
+      y_max = tb[n].box[3];
+  }
+
+  // cell size
+  if (tb.size() > 0)
+    cell_size = sqrt((x_max - x_min) * (y_max - y_min) * TRIANGLES_PER_CELL / tb.size());
+  else
+    cell_size = MIN_CELL_SIZE;
+  if (cell_size < MIN_CELL_SIZE)
+    cell_size = MIN_CELL_SIZE;
+  if ((x_max - x_min) / cell_size > MAX_CELLS)
+    cell_size = (x_max - x_min) / MAX_CELLS;
+  if ((y_max - y_min) / cell_size > MAX_CELLS)
+    cell_size = (y_max - y_min) / MAX_CELLS;
+  if (tb.size() > 0)
+  {
+    nx = (int)((x_max - x_min) / cell_size) + 1;
+    ny = (int)((y_max - y_min) / cell_size) + 1;
+  }
+  else
+    nx = ny = 0;
+
+  // Count the triangles in every cell, then fill the cells.
+  // cell_start_v[c+1] is used as a counter for cell c.
+  cell_start_v.assign(nx*ny+1, 0);
+  for (int pass = 0; pass < 2; pass++)
+  {
+    if (pass == 1)
+    {
+      for (int c = 0; c < nx*ny; c++)
+        cell_start_v[c+1] += cell_start_v[c];
+      cell_tris_v.resize(cell_start_v[nx*ny]);
+    }
+
+    for (std::vector<TriangleBox>::size_type n = 0; n < tb.size(); n++)
+    {
+      // a bit larger, so no point on a cell border is missed
+      float eps = 0.001*cell_size;
+      int   x1  = (int)((tb[n].box[0] - eps - x_min) / cell_size);
+      int   x2  = (int)((tb[n].box[1] + eps - x_min) / cell_size);
+      int   y1  = (int)((tb[n].box[2] - eps - y_min) / cell_size);
+      int   y2  = (int)((tb[n].box[3] + eps - y_min) / cell_size);
+      x1 = std::max(x1, 0);
+      y1 = std::max(y1, 0);
+      x2 = std::min(x2, nx-1);
+      y2 = std::min(y2, ny-1);
+
+      for (int ix = x1; ix <= x2; ix++)
+      {
+        for (int iy = y1; iy <= y2; iy++)
         {
-          for (int j = j1; j <= j2; j++)
-          {
-            //std::cout << "met dans cellule " << i <<", "<<j<<  std::endl;
-            tile_table[i][j]->add(v1);
-            tile_table[i][j]->add(v2);
-            tile_table[i][j]->add(v3);
-          }
+          int c = ix*ny + iy;
+          if (pass == 0)
+            cell_start_v[c+1]++;
+          else
+            cell_tris_v[cell_start_v[c]++] = n;
         }
       }
     }
   }
+  // the second pass moved every cell_start_v[c] to the start of cell c+1
+  for (int c = nx*ny; c > 0; c--)
+    cell_start_v[c] = cell_start_v[c-1];
+  cell_start_v[0] = 0;
+
+  tris_v.resize(tb.size());
+  for (std::vector<TriangleBox>::size_type n = 0; n < tb.size(); n++)
+    tris_v[n] = tb[n].t;
+
+  nTris      = tris_v.size();
+  nRefs      = cell_tris_v.size();
+  tris       = nTris > 0 ? &tris_v[0]      : NULL;
+  cell_start = &cell_start_v[0];
+  cell_tris  = nRefs > 0 ? &cell_tris_v[0] : NULL;
+
+  std::cout << "HD_TilingTerrain: " << nTris << " triangles, "
+            << nx << "x" << ny << " cells of " << cell_size << " ft, "
+            << nRefs << " references\n";
 }
 
-// utility routine
-float HD_TilingTerrain::Isleft(myPoint2D p1, myPoint2D p2, myPoint2D p)
+/**
+ * Layout of the grid in a HD_Cache: this header, followed by
+ * nTris Triangles, nx*ny+1 cell starts and nRefs triangle indices.
+ */
+typedef struct
+{
+  float   x_min;
+  float   y_min;
+  float   cell_size;
+  int32_t nx;
+  int32_t ny;
+  int32_t nTris;
+  int32_t nRefs;
+  int32_t triangle_size;
+} T_TilingCacheHeader;
+
+bool HD_TilingTerrain::readGrid(const char* data, size_t size)
 {
-  return ((p2.x - p1.x) * (p.y - p1.y) - (p.x - p1.x) * (p2.y - p1.y));
+  T_TilingCacheHeader h;
+
+  if (size < sizeof(h))
+    return(false);
+  memcpy(&h, data, sizeof(h));
+  if (h.triangle_size != (int32_t)sizeof(Triangle) ||
+      h.nx < 0 || h.ny < 0 || h.nTris < 0 || h.nRefs < 0 ||
+      h.cell_size <= 0)
+    return(false);
+  if (size != sizeof(h) + (size_t)h.nTris*sizeof(Triangle) +
+              ((size_t)h.nx*h.ny + 1 + h.nRefs)*sizeof(int32_t))
+    return(false);
+
+  // the lookup trusts these, so check them before accepting the file
+  const Triangle* t_tris  = (const Triangle*)(data + sizeof(h));
+  const int32_t*  t_start = (const int32_t*)(t_tris + h.nTris);
+  const int32_t*  t_refs  = t_start + h.nx*h.ny + 1;
+
+  if (t_start[0] != 0 || t_start[h.nx*h.ny] != h.nRefs)
+    return(false);
+  for (int32_t c = 0; c < h.nx*h.ny; c++)
+  {
+    if (t_start[c+1] < t_start[c])
+      return(false);
+  }
+  for (int32_t r = 0; r < h.nRefs; r++)
+  {
+    if (t_refs[r] < 0 || t_refs[r] >= h.nTris)
+      return(false);
+  }
+
+  x_min      = h.x_min;
+  y_min      = h.y_min;
+  cell_size  = h.cell_size;
+  nx         = h.nx;
+  ny         = h.ny;
+  nTris      = h.nTris;
+  nRefs      = h.nRefs;
+  tris       = t_tris;
+  cell_start = t_start;
+  cell_tris  = t_refs;
+
+  std::cout << "HD_TilingTerrain: " << nTris << " triangles, "
+            << nx << "x" << ny << " cells of " << cell_size << " ft, "
+            << nRefs << " references\n";
+  return(true);
 }
 
-// test si point x,y, dans la projection du trianle p1, p2,p3 sur plan horizontal
-int HD_TilingTerrain::on_triangle(float x, float y, float *p1, float *p2, float *p3)
+bool HD_TilingTerrain::writeGrid(FILE* fp)
 {
-  int t1,t2,t3,test;
-  myPoint2D a,b,c,p;
-  p.x = x;//east
-  p.y = y;//nord
-  //p1,p2,p3 : est, up,sud
-  a.x = p1[2];
-  a.y = p1[0];
-  b.x = p2[2];
-  b.y = p2[0];
-  c.x = p3[2];
-  c.y = p3[0];
-  t1 = (Isleft(c,a,p)>0);
-  t2 = (Isleft(b,c,p)>0);
-  t3 = (Isleft(a,b,p)>0);
-  test =  (t1==t2) && (t1==t3);
-  return test;
+  T_TilingCacheHeader h;
+
+  h.x_min         = x_min;
+  h.y_min         = y_min;
+  h.cell_size     = cell_size;
+  h.nx            = nx;
+  h.ny            = ny;
+  h.nTris         = nTris;
+  h.nRefs         = nRefs;
+  h.triangle_size = sizeof(Triangle);
+
+  if (fwrite(&h, sizeof(h), 1, fp) != 1)
+    return(false);
+  if (nTris > 0 && fwrite(tris, sizeof(Triangle), nTris, fp) != (size_t)nTris)
+    return(false);
+  if (fwrite(cell_start, sizeof(int32_t), nx*ny+1, fp) != (size_t)(nx*ny+1))
+    return(false);
+  if (nRefs > 0 && fwrite(cell_tris, sizeof(int32_t), nRefs, fp) != (size_t)nRefs)
+    return(false);
+  return(true);
 }
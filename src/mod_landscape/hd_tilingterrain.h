@@ -23,22 +23,35 @@
 #define HD_TILINGTERRAIN_H
 
 #include "heightdata.h"
+#include "hd_cache.h"
+#include <vector>
 #include <plib/ssg.h>
 
-#define SIZE_GRID_PLANES      150
-#define SIZE_CELL_GRID_PLANES 20
-
-typedef struct
-{
-  float x;
-  float y;
-} myPoint2D;
-
-
+/**
+ * Height data from the triangles of the scene graph, sorted into a
+ * uniform grid.
+ *
+ * The grid covers the bounding box of all triangles; its cell size is
+ * chosen from the number of triangles and the area they cover, so that a
+ * cell contains only a few of them. Cells and triangles are stored in flat
+ * arrays: cell <code>c</code> references the triangles
+ * <code>cell_tris[cell_start[c]]</code> to
+ * <code>cell_tris[cell_start[c+1]-1]</code>, sorted by descending
+ * maximum height. So when looking for the highest triangle at a point, the
+ * search stops at the first triangle which can't be higher than the
+ * best one found so far.
+ *
+ * If a HD_Cache is given, the grid is taken from it if possible.
+ * Otherwise it is calculated and written to the cache.
+ */
 class HD_TilingTerrain : public HeightData
 {
   public:
-    HD_TilingTerrain(ssgRoot* SceneGraph);
+    /**
+     * \param SceneGraph  the scenery
+     * \param cache       optional; must exist as long as this object does
+     */
+    HD_TilingTerrain(ssgRoot* SceneGraph, HD_Cache* cache = NULL);
   
     ~HD_TilingTerrain();
   
@@ -61,17 +74,115 @@ class HD_TilingTerrain : public HeightData
      *  \return terrain height at this point in ft
      */
     float getHeightAndPlane(float x_north, float y_east, float tplane[4]);
+
+    /**
+     *  Get the height at <code>n</code> points at once, without a
+     *  virtual call per point.
+     */
+    void getHeights(const float* x_north, const float* y_east,
+                    float* heights, int n);
+
+    /**
+     *  Get height and plane equation at <code>n</code> points at once,
+     *  without a virtual call per point.
+     */
+    void getHeightsAndPlanes(const float* x_north, const float* y_east,
+                             float* heights, float* tplanes, int n);
     
   private:
-    void tiling_terrain(ssgEntity * e, sgMat4 xform);
+    /**
+     * A triangle, projected to the horizontal plane. Everything is
+     * given in local coordinates (x north, y east), heights are positive up.
+     */
+    struct Triangle
+    {
+      /**
+       * Edge k: e[k][0]*x + e[k][1]*y + e[k][2]. A point is inside if
+       * all three are positive or all three are not.
+       */
+      float e[3][3];
+
+      /**
+       * Height is h[0]*x + h[1]*y + h[2]
+       */
+      float h[3];
+
+      /**
+       * Height of the highest corner
+       */
+      float h_max;
+    };
+
+    /**
+     * A triangle and its bounding box (x_min, x_max, y_min, y_max),
+     * only used while creating the grid.
+     */
+    struct TriangleBox
+    {
+      Triangle t;
+      float    box[4];
+    };
 
-    // test si point x,y, dans la projection du trianle p1, p2,p3 
-    // sur plan horizontal
-    int on_triangle(float x, float y, float *p1,float *p2, float *p3);
+    /**
+     * Sort order of triangles in the grid: descending maximum height
+     */
+    static bool isHigher(TriangleBox const& a, TriangleBox const& b);
+
+    /**
+     * Recursively walks the scene graph and appends the corners of all
+     * triangles to <code>verts</code> (9 floats per triangle: east, up,
+     * south for every corner).
+     */
+    void tiling_terrain(ssgEntity * e, sgMat4 xform, std::vector<float>& verts);
+
+    /**
+     * Creates <code>tris</code> and the grid from the corners collected by
+     * tiling_terrain().
+     */
+    void makeGrid(std::vector<float> const& verts);
+
+    /**
+     * Use the grid in <code>data</code> (from HD_Cache::open()).
+     * Returns false if it isn't valid.
+     */
+    bool readGrid(const char* data, size_t size);
+
+    /**
+     * Writes the grid to <code>fp</code> (from HD_Cache::create()).
+     */
+    bool writeGrid(FILE* fp);
+
+    /**
+     * Index of the cell containing x|y or -1 if outside of the grid.
+     */
+    int getCell(float x_north, float y_east);
+
+    /// @name grid
+    //@{
+    float x_min;
+    float y_min;
+    float cell_size;
+    int   nx;
+    int   ny;
+    //@}
+
+    /// @name The index, either in the vectors below or in a HD_Cache
+    //@{
+    const Triangle* tris;
+
+    /**
+     * nx*ny+1 entries, x changes slowest.
+     */
+    const int32_t*  cell_start;
+    const int32_t*  cell_tris;
 
-    float Isleft(myPoint2D p1, myPoint2D p2, myPoint2D p);
+    int             nTris;
+    int             nRefs;
+    //@}
 
-    ssgVertexArray* tile_table[SIZE_GRID_PLANES][SIZE_GRID_PLANES];
+    std::vector<Triangle> tris_v;
+    std::vector<int32_t>  cell_start_v;
+    std::vector<int32_t>  cell_tris_v;
 };
 
 #endif // HD_TILINGTERRAIN_H
@@ -27,6 +27,20 @@ HeightData::HeightData(ssgRoot* SceneGraph)
   SceneGraph_ = SceneGraph;
 }
 
+void HeightData::getHeights(const float* x_north, const float* y_east,
+                            float* heights, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = getHeight(x_north[i], y_east[i]);
+}
+
+void HeightData::getHeightsAndPlanes(const float* x_north, const float* y_east,
+                                     float* heights, float* tplanes, int n)
+{
+  for (int i = 0; i < n; i++)
+    heights[i] = getHeightAndPlane(x_north[i], y_east[i], &tplanes[4*i]);
+}
+
 float HeightData::getHeightAndPlane_(float x_north, float y_east, float tplane[4])
 {
   ssgHit *results;
@@ -76,7 +76,38 @@ class HeightData
      */
     virtual float getHeightAndPlane(float x_north, float y_east, float tplane[4]) = 0;
 
+    /**
+     *  Get the height at <code>n</code> points at once, in local
+     *  coordinates, unit is ft
+     *
+     *  \param x_north  x coordinates (x positive == north)
+     *  \param y_east   y coordinates (y positive == east)
+     *  \param heights  terrain heights are stored here
+     *  \param n        number of points
+     */
+    virtual void getHeights(const float* x_north, const float* y_east,
+                            float* heights, int n);
+
+    /**
+     *  Get height and plane equation at <code>n</code> points at once,
+     *  in local coordinates, unit is ft
+     *
+     *  \param x_north  x coordinates (x positive == north)
+     *  \param y_east   y coordinates (y positive == east)
+     *  \param heights  terrain heights are stored here
+     *  \param tplanes  plane equations are stored here (4 floats per point)
+     *  \param n        number of points
+     */
+    virtual void getHeightsAndPlanes(const float* x_north, const float* y_east,
+                                     float* heights, float* tplanes, int n);
+
     float getHeightAndPlane_(float x_north, float y_east, float tplane[4]);
+
+    /**
+     *  Returns true if getHeight() and getHeightAndPlane() may be called
+     *  from several threads at once.
+     */
+    virtual bool isReentrant() { return(true); };
   
   private:
     ssgRoot* SceneGraph_;
@@ -34,8 +34,10 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 #include "../crrc_main.h"
+#include "../global.h"
 #include "../mod_misc/SimpleXMLTransfer.h"
 #include "../mod_misc/filesystools.h"
 #include "../mod_misc/ls_constants.h"
@@ -44,10 +46,9 @@
 #include "hd_tabulatedterrain.h"
 #include "hd_tilingterrain.h"
 #include "wind_from_terrain.h"
+#include "scenery_loader.h"
 
-#if WINDDATA3D != 1
 #include "../GUI/crrc_msgbox.h"
-#endif
 
 // This module uses some internal SSG stuff from the video module!
 #include "../mod_video/crrc_ssgutils.h"
@@ -56,12 +57,20 @@
 /****************************************************************************/
 /* Model based scenery                                                      */
 /****************************************************************************/
-ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
-    : Scenery(xml, sky_variant), location(Scenery::MODEL_BASED)
+ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant, const char* fname)
+    : Scenery(xml, sky_variant), location(Scenery::MODEL_BASED), hd_cache(NULL)
 {
   ssgEntity *model = NULL;
   SimpleXMLTransfer *scene = xml->getChild("scene", true);
   getHeight_mode = scene->attributeAsInt("getHeight_mode", DEFAULT_HEIGHT_MODE);
+
+  // The key of the height data cache covers everything which is put
+  // into the scene graph below.
+  if (fname != NULL && (getHeight_mode == 1 || getHeight_mode == 2))
+  {
+    hd_cache = new HD_Cache(fname);
+    hd_cache->addToKey(getHeight_mode);
+  }
   //std::cout << "----getHeight_mode : " <<  getHeight_mode <<std::endl;
   SceneGraph = new ssgRoot();
 
@@ -94,6 +103,14 @@ ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
 
   // find all "objects" defined in the file
   int num_children = scene->getChildCount();
+  int num_objects  = 0;
+  int cur_object   = 0;
+
+  for (int cur_child = 0; cur_child < num_children; cur_child++)
+  {
+    if (scene->getChildAt(cur_child)->getName() == "object")
+      num_objects++;
+  }
 
   for (int cur_child = 0; cur_child < num_children; cur_child++)
   {
@@ -111,9 +128,11 @@ ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
       std::string    of  = FileSysTools::getDataPath("objects/" + filename, TRUE);
       // compile and set relative texture path
       std::string    tp  = of.substr(0, of.length()-filename.length()-1-7) + "textures";
-      ssgTexturePath(tp.c_str());
 
       // load model
+      std::ostringstream progress;
+      progress << "Loading 3D object " << ++cur_object << " of " << num_objects;
+      SceneryLoader::setProgress(progress.str());
       std::cout << "Loading 3D object \"" << of.c_str() << "\"";
       if (is_terrain)
       {
@@ -124,7 +143,17 @@ ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
         std::cout << " (invisible)";
       }
       std::cout << std::endl;
-      model = ssgLoad(of.c_str());
+      if (hd_cache)
+      {
+        hd_cache->addToKey(filename);
+        hd_cache->addToKey(is_terrain);
+        if (!hd_cache->addFileToKey(of))
+        {
+          delete hd_cache;
+          hd_cache = NULL;
+        }
+      }
+      model = SSGUtil::loadModel(of, tp, &textures);
       if (model != NULL)
       {
         if (!is_visible)
@@ -178,6 +207,11 @@ ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
             std::cout << "  Placing instance at " << coord.xyz[SG_X] << ";" << coord.xyz[SG_Y] << ";" << coord.xyz[SG_Z];
             std::cout << ", orientation " << (180-coord.hpr[0]) << ";" << -coord.hpr[1] << ";" << -coord.hpr[2] << std::endl;
             std::cout << std::setprecision(6);
+            if (hd_cache)
+            {
+              hd_cache->addToKey(coord.xyz, sizeof(coord.xyz));
+              hd_cache->addToKey(coord.hpr, sizeof(coord.hpr));
+            }
             ssgTransform *trans = new ssgTransform();
             trans->setTransform(&coord);
             
@@ -205,33 +239,35 @@ ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
   }
   
   // create actual terrain height model
+  SceneryLoader::setProgress("Building terrain height data");
   if (getHeight_mode == 1)
   {
-    heightdata = new HD_TabulatedTerrain(SceneGraph);
+    heightdata = new HD_TabulatedTerrain(SceneGraph, hd_cache);
   }
   else if (getHeight_mode == 2)
   {
-    heightdata = new HD_TilingTerrain(SceneGraph);
+    heightdata = new HD_TilingTerrain(SceneGraph, hd_cache);
   }
   else
   {
     heightdata = new HD_SsgLOSTerrain(SceneGraph);
   }
 
+  // the grid is calculated on another thread, so the height lookup has
+  // to be reentrant
+  slope_wind = NULL;
+  if (SlopeWindMap::isEnabled() && heightdata->isReentrant())
+  {
+    CRRCMath::Vector3 pos = getPlayerPosition();
+    slope_wind = new SlopeWindMap(this, pos.r[2], pos.r[0]);
+  }
+
   //wind
   SimpleXMLTransfer *wind = xml->getChild("wind", true);
   std::string wind_filename = wind->attribute("filename","");
-#if WINDDATA3D == 1
   wind_data = 0;//default : no wind_data
+  fWindfieldIgnored = false;
   std::string wind_position_unit = wind->attribute("unit","");
-  try {
-    flDefaultWindDirection = wind->attributeAsInt("direction");
-    ImposeWindDirection = true;
-    }
-  catch (XMLException)
-    {
-    // if not attribut "direction", normal mode
-    }
   
   if (wind_position_unit.compare("m")==0)
   {
@@ -245,16 +281,33 @@ ModelBasedScenery::ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant)
   if (wind_filename.length() > 0)
   {
     wind_filename = FileSysTools::getDataPath(wind_filename);  
-    std::cout << "init wind ---------";
-    int n = init_wind_data((wind_filename.c_str()));
-    std::cout << n << "  points processed" << std::endl;
+    SceneryLoader::setProgress("Reading wind data");
+    std::cout << "init wind ---------" << std::endl;
+    wind_data = WindGrid::load(wind_filename, wind->attributeAsDouble("grid", 0));
+    fWindfieldIgnored = (wind_data == NULL && !WindGrid::canResample());
   }
-#else
-  if (wind_filename.length() > 0)
+  if (wind_data)
+  {
+    // the wind data has been calculated for this direction
+    try {
+      flDefaultWindDirection = wind->attributeAsInt("direction");
+      ImposeWindDirection = true;
+      }
+    catch (XMLException)
+      {
+      // if not attribut "direction", normal mode
+      }
+  }
+}
+
+void ModelBasedScenery::activate()
+{
+  Scenery::activate();
+  textures.upload(SceneGraph);
+  if (fWindfieldIgnored)
   {
     new CGUIMsgBox("Insufficient configuration to read windfields.");
   }
-#endif
 }
 
 void ModelBasedScenery::setToInvisibleState(ssgEntity* ent)
@@ -326,12 +379,14 @@ void ModelBasedScenery::evaluateNodeAttributes(ssgEntity* ent)
 
 ModelBasedScenery::~ModelBasedScenery()
 {
+  // stop using the height data first
+  delete slope_wind;
   delete SceneGraph;
   delete heightdata;
-#if WINDDATA3D == 1
+  if (hd_cache)
+    delete hd_cache;
   if (wind_data)
     delete wind_data;
-#endif
 }
 
 void ModelBasedScenery::draw(double current_time)
@@ -349,30 +404,44 @@ float ModelBasedScenery::getHeightAndPlane(float x, float y, float tplane[4])
   return heightdata->getHeightAndPlane(x, y, tplane);
 }
 
+void ModelBasedScenery::getHeights(const float* x, const float* y, float* heights, int n)
+{
+  heightdata->getHeights(x, y, heights, n);
+}
+
+void ModelBasedScenery::getHeightsAndPlanes(const float* x, const float* y,
+                                            float* heights, float* tplanes, int n)
+{
+  heightdata->getHeightsAndPlanes(x, y, heights, tplanes, n);
+}
+
+bool ModelBasedScenery::isReentrant()
+{
+  return(heightdata->isReentrant());
+}
+
 int ModelBasedScenery::getWindComponents(double X, double Y,double Z,
+    float flWindVel, float flWindDir,
     float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity)
 {
   // freestream wind velocity
-  float flWindVel = cfg->wind->getVelocity();
-  float flWindDir = cfg->wind->getDirection()*DEG_TO_RAD;
-  *x_wind_velocity = -1 * flWindVel * cos(flWindDir);
-  *y_wind_velocity = -1 * flWindVel * sin(flWindDir);
+  *x_wind_velocity = -1 * flWindVel * cos(flWindDir*DEG_TO_RAD);
+  *y_wind_velocity = -1 * flWindVel * sin(flWindDir*DEG_TO_RAD);
   *z_wind_velocity = 0.;
 
-#if WINDDATA3D == 1
   //import wind data from file
-  float x,y,z,vx,vy,vz;
+  float x,y,z,v[3];
   if (wind_data)
   {
     x =  X * wind_position_coef;
     y =  Y * wind_position_coef;
     z = -Z * wind_position_coef;
-    if (find_wind_data(x,y,z,&vx,&vy,&vz))
+    if (wind_data->getWind(x,y,z,v))
     {
       // point found
-      *x_wind_velocity = vx * flWindVel;
-      *y_wind_velocity = vy * flWindVel;
-      *z_wind_velocity = vz * flWindVel;
+      *x_wind_velocity = v[0] * flWindVel;
+      *y_wind_velocity = v[1] * flWindVel;
+      *z_wind_velocity = v[2] * flWindVel;
       //std::cout << "----at"<< x<<"  "<<y<<"  "<< z<<"wind components***" << *x_wind_velocity <<"  "<< *y_wind_velocity <<"  "<<  *z_wind_velocity<<std::endl;
       return 0;
     }
@@ -383,9 +452,15 @@ int ModelBasedScenery::getWindComponents(double X, double Y,double Z,
    }
   }
   else
-#endif
   {
     //default mode
-    return wind_from_terrain(X, Y, Z, x_wind_velocity, y_wind_velocity, z_wind_velocity);
+    if (slope_wind != NULL &&
+        slope_wind->getWind(X, Y, Z, flWindVel, flWindDir, Global::wind_mode,
+                            x_wind_velocity, y_wind_velocity, z_wind_velocity))
+    {
+      return 0;
+    }
+    return wind_from_terrain(this, Global::wind_mode, X, Y, Z, flWindVel, flWindDir,
+                             x_wind_velocity, y_wind_velocity, z_wind_velocity);
   }
 }
@@ -31,8 +31,11 @@
 #include "../mod_math/vector3.h"
 #include "../mod_misc/SimpleXMLTransfer.h"
 #include <plib/ssg.h>
-#include "winddata3D.h"
+#include "windgrid.h"
+#include "slope_wind_map.h"
 #include "heightdata.h"
+#include "hd_cache.h"
+#include "../mod_video/ssg_loader.h"
 
 #define DEFAULT_HEIGHT_MODE   2
 
@@ -43,18 +46,27 @@
  */
 class ModelBasedScenery : public Scenery
 {
+  friend class CRRC_Bench;
+
   public:
     /**
      *  The constructor
      *
      *  \param xml SimpleXMLTransfer from which the base classes will be initialized
+     *  \param fname scenery file (with full path). If it is given, the
+     *               height data is stored in a HD_Cache.
      */
-    ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant);
+    ModelBasedScenery(SimpleXMLTransfer *xml, int sky_variant, const char* fname = NULL);
   
     /**
      *  The destructor
      */
     ~ModelBasedScenery();
+
+    /**
+     *  Sets up the sky and hands the textures to OpenGL
+     */
+    void activate();
   
     /**
      *  Draw the scenery
@@ -77,6 +89,17 @@ class ModelBasedScenery : public Scenery
      *  \return terrain height at this point in ft
      */
     float getHeightAndPlane(float x, float z, float tplane[4]);
+
+    /**
+     *  Get the height at <code>n</code> points at once.
+     */
+    void getHeights(const float* x, const float* z, float* heights, int n);
+
+    /**
+     *  Get height and plane equation at <code>n</code> points at once.
+     */
+    void getHeightsAndPlanes(const float* x, const float* z,
+                             float* heights, float* tplanes, int n);
     
     /**
      *  Get an ID code for this location or scenery type
@@ -86,10 +109,17 @@ class ModelBasedScenery : public Scenery
     /**
      *  Get wind components at position X_cg, Y_cg, Z_cg
      */
+    using Scenery::getWindComponents;
     int getWindComponents(double X_cg, double Y_cg, double Z_cg,
+                          float flWindVel, float flWindDir,
                           float *x_wind_velocity, 
                           float *y_wind_velocity,
                           float *z_wind_velocity);
+
+    /**
+     *  Depends on getHeight_mode and 3D wind data
+     */
+    bool isReentrant();
   
   private:
     ssgRoot        *SceneGraph;
@@ -103,15 +133,27 @@ class ModelBasedScenery : public Scenery
 
     HeightData *heightdata;
 
+    /**
+     * Precalculated height data, may be used by heightdata.
+     */
+    HD_Cache   *hd_cache;
+
+    /**
+     * Textures of all objects, not uploaded before activate().
+     */
+    SSGUtil::DeferredTextures textures;
+
     void  setToInvisibleState(ssgEntity* ent);
     void  evaluateNodeAttributes(ssgEntity* ent);
     
-#if WINDDATA3D == 1
-    int init_wind_data(const char* filename);
-    int find_wind_data(float n, float e, float u, float *vx, float *vy, float * vz);
-    WindData *wind_data;
+    /**
+     * Precalculated wind from terrain, NULL if not used.
+     */
+    SlopeWindMap *slope_wind;
+
+    WindGrid *wind_data;
     float wind_position_coef;
-#endif
+    bool  fWindfieldIgnored;  ///< tell the user in activate()
 };
 
 #endif  // MODEL_BASED_SCENERY_H
@@ -0,0 +1,226 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file scenery_loader.cpp
+ *
+ *  Loading a scenery in the background, see scenery_loader.h
+ */
+
+#include "scenery_loader.h"
+
+#include "../global.h"
+#include "../mod_misc/SimpleXMLTransfer.h"
+#include "../mod_misc/profiler.h"
+#include "../mod_video/ssg_loader.h"
+#include "crrc_scenery.h"
+
+#include <SDL.h>
+#include <stdio.h>
+
+namespace
+{
+  SDL_Thread*  thread  = NULL;
+  SDL_mutex*   mutex   = NULL;   ///< guards progress and the results
+
+  /// @name Request being worked on, written while no thread is running
+  //@{
+  std::string  fname;
+  int          sky_variant = 0;
+  //@}
+
+  /// @name Request to be started when the current one is finished
+  //@{
+  bool         fNext       = false;
+  std::string  next_fname;
+  int          next_sky_variant = 0;
+  //@}
+
+  /// @name Results of the thread
+  //@{
+  bool               fDone   = false;
+  Scenery*           scenery = NULL;
+  SimpleXMLTransfer* xml     = NULL;   ///< to be created on the main thread
+  //@}
+
+  std::string  progress;
+  std::string  reported;              ///< main thread only
+
+  int ThreadFunc(void*)
+  {
+    CRRC_Profiler::setThreadName("scenery");
+
+    SimpleXMLTransfer* new_xml     = NULL;
+    Scenery*           new_scenery = NULL;
+
+    SceneryLoader::setProgress("Reading " + fname);
+    try
+    {
+      new_xml = new SimpleXMLTransfer(fname);
+    }
+    catch (XMLException e)
+    {
+      fprintf(stderr, "XMLException: %s\n", e.what());
+      new_xml = NULL;
+    }
+
+    if (new_xml != NULL && canCreateSceneryInBackground(new_xml))
+    {
+      new_scenery = createScenery(new_xml, sky_variant, fname.c_str());
+      new_xml     = NULL;
+    }
+
+    SDL_mutexP(mutex);
+    scenery = new_scenery;
+    xml     = new_xml;
+    fDone   = true;
+    SDL_mutexV(mutex);
+    CRRC_Profiler::endThread();
+    return(0);
+  }
+
+  /**
+   * Waits for the thread and finishes what it has left to do, unless
+   * the result is to be thrown away anyway.
+   */
+  Scenery* finish(bool fKeep)
+  {
+    Scenery* new_scenery;
+
+    if (thread != NULL)
+      SDL_WaitThread(thread, NULL);
+    thread = NULL;
+
+    new_scenery = scenery;
+    if (xml != NULL)
+    {
+      if (fKeep)
+        new_scenery = createScenery(xml, sky_variant, fname.c_str());
+      else
+        delete xml;
+    }
+    scenery = NULL;
+    xml     = NULL;
+    fDone   = false;
+
+    return(new_scenery);
+  }
+
+  void run()
+  {
+    fDone    = false;
+    progress = "";
+    reported = "";
+    thread   = SDL_CreateThread(ThreadFunc, NULL);
+    if (thread == NULL)
+    {
+      // no thread, do it right now
+      ThreadFunc(NULL);
+    }
+  }
+}
+
+
+void SceneryLoader::start(std::string file, int sky)
+{
+  if (mutex == NULL)
+    mutex = SDL_CreateMutex();
+  SSGUtil::initModelLoader();
+
+  if (isLoading())
+  {
+    fNext            = true;
+    next_fname       = file;
+    next_sky_variant = sky;
+  }
+  else
+  {
+    fname       = file;
+    sky_variant = sky;
+    run();
+  }
+}
+
+bool SceneryLoader::poll(Scenery*& new_scenery)
+{
+  bool fFinished;
+
+  if (!isLoading())
+    return(false);
+
+  SDL_mutexP(mutex);
+  fFinished = fDone;
+  std::string text = progress;
+  SDL_mutexV(mutex);
+
+  if (text != reported)
+  {
+    reported = text;
+    LOG(text);
+  }
+
+  if (!fFinished)
+    return(false);
+
+  if (fNext)
+  {
+    // a newer request has come in meanwhile
+    delete finish(false);
+    fNext       = false;
+    fname       = next_fname;
+    sky_variant = next_sky_variant;
+    run();
+    return(false);
+  }
+
+  new_scenery = finish(true);
+  if (new_scenery != NULL)
+    new_scenery->activate();
+  return(true);
+}
+
+Scenery* SceneryLoader::wait()
+{
+  Scenery* new_scenery = NULL;
+
+  while (isLoading() && !poll(new_scenery))
+    SDL_Delay(10);
+  return(new_scenery);
+}
+
+bool SceneryLoader::isLoading()
+{
+  return(thread != NULL || fDone);
+}
+
+void SceneryLoader::stop()
+{
+  fNext = false;
+  if (isLoading())
+    delete finish(false);
+}
+
+void SceneryLoader::setProgress(std::string text)
+{
+  if (mutex == NULL)
+    return;
+
+  SDL_mutexP(mutex);
+  progress = text;
+  SDL_mutexV(mutex);
+}
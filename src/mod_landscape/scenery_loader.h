@@ -0,0 +1,93 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file scenery_loader.h
+ *
+ *  Loading a scenery in the background.
+ */
+
+#ifndef SCENERY_LOADER_H
+#define SCENERY_LOADER_H
+
+#include <string>
+
+class Scenery;
+
+/**
+ * Loads a scenery on a thread of its own while the current one is still
+ * being used.
+ *
+ * The worker thread parses the scenery file, loads the models, decodes
+ * their textures and builds the height data. Only the short remainder
+ * which needs the OpenGL context (Scenery::activate()) is done by poll()
+ * on the main thread. Built-in sceneries need OpenGL right from the
+ * start, so they are created by poll() completely.
+ *
+ * All methods except setProgress() are to be called on the main thread.
+ */
+class SceneryLoader
+{
+  public:
+    /**
+     * Starts loading a scenery. If another one is being loaded, it will
+     * be thrown away as soon as it is finished and this one is loaded
+     * instead.
+     *
+     * \param fname       scenery file with full path
+     * \param sky_variant which sky to use
+     */
+    static void start(std::string fname, int sky_variant);
+
+    /**
+     * Checks whether the scenery has been loaded, reports progress on the
+     * console.
+     *
+     * \param scenery the new scenery, already activated, or NULL if it
+     *                could not be loaded
+     * \return true if loading has finished, false if it is still running
+     *         or nothing has been started
+     */
+    static bool poll(Scenery*& scenery);
+
+    /**
+     * Waits until loading has finished.
+     *
+     * \return the new scenery, already activated, or NULL if it could not
+     *         be loaded or nothing has been started
+     */
+    static Scenery* wait();
+
+    /**
+     * Returns true if a scenery is being loaded.
+     */
+    static bool isLoading();
+
+    /**
+     * Waits for the thread and throws away what it has loaded.
+     */
+    static void stop();
+
+    /**
+     * Sets the description of what is being done right now. May be called
+     * on any thread.
+     */
+    static void setProgress(std::string text);
+};
+
+#endif // SCENERY_LOADER_H
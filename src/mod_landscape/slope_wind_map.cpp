@@ -0,0 +1,278 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "slope_wind_map.h"
+#include "crrc_scenery.h"
+#include "wind_from_terrain.h"
+#include "../mod_misc/profiler.h"
+
+#include <math.h>
+
+#if defined(_MSC_VER)
+# include <windows.h>
+#endif
+
+/// Half the width of the grid [ft]
+#define MAP_RANGE     1500.
+/// Grid points along x and y
+#define MAP_POINTS    256
+/// Height above ground of the lowest layer [ft]
+#define LAYER_MIN     1.
+/// Ratio of the heights of two layers
+#define LAYER_RATIO   3.16227766
+/// Number of layers, the highest one is at 1000 ft
+#define LAYERS        7
+/// Number of grids kept
+#define MAX_MAPS      8
+
+bool SlopeWindMap::fEnabled = false;
+
+static void Barrier()
+{
+#if defined(_MSC_VER)
+  MemoryBarrier();
+#else
+  __sync_synchronize();
+#endif
+}
+
+
+SlopeWindMap::SlopeWindMap(Scenery* scenery, float x_center, float y_center)
+  : scenery(scenery), n(MAP_POINTS),
+    thread(NULL), fQuit(false), fRequest(false), req_dir(0), req_mode(0),
+    nUsed(0), current(NULL), last_dir(-1), last_mode(-1)
+{
+  cell_size = 2*MAP_RANGE / (n - 1);
+  x_min     = x_center - MAP_RANGE;
+  y_min     = y_center - MAP_RANGE;
+  mutex     = SDL_CreateMutex();
+  cond      = SDL_CreateCond();
+}
+
+SlopeWindMap::~SlopeWindMap()
+{
+  if (thread != NULL)
+  {
+    SDL_mutexP(mutex);
+    fQuit = true;
+    SDL_CondSignal(cond);
+    SDL_mutexV(mutex);
+    SDL_WaitThread(thread, NULL);
+  }
+  SDL_DestroyCond(cond);
+  SDL_DestroyMutex(mutex);
+
+  for (unsigned int i = 0; i < maps.size(); i++)
+    delete maps[i];
+}
+
+void SlopeWindMap::setEnabled(bool fEnable)
+{
+  fEnabled = fEnable;
+}
+
+bool SlopeWindMap::isEnabled()
+{
+  return(fEnabled);
+}
+
+bool SlopeWindMap::getWind(double X, double Y, double Z,
+                           float flWindVel, float flWindDir, int mode,
+                           float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity)
+{
+  const Map* map = current;
+
+  if (map == NULL || map->dir != flWindDir || map->mode != mode)
+  {
+    request(flWindDir, mode);
+    return(false);
+  }
+
+  float fx = (X - x_min) / cell_size;
+  float fy = (Y - y_min) / cell_size;
+  if (!(fx >= 0 && fx < n-1 && fy >= 0 && fy < n-1))
+    return(false);
+
+  float z_c = scenery->getHeight(X, Y);
+  if (z_c <= DEEPEST_HELL)
+    return(false);
+  float dz = -Z - z_c;
+  if (dz < LAYER_MIN)
+    dz = LAYER_MIN;
+  float fz = log(dz/LAYER_MIN) / log(LAYER_RATIO);
+  if (fz > LAYERS-1)
+    return(false);
+
+  int ix = (int)fx;
+  int iy = (int)fy;
+  int iz = (fz < LAYERS-1) ? (int)fz : LAYERS-2;
+  float tx = fx - ix;
+  float ty = fy - iy;
+  float tz = fz - iz;
+
+  // sum up the corners of the cell
+  float v[3] = { 0, 0, 0 };
+  for (int k = 0; k < 2; k++)
+  {
+    for (int j = 0; j < 2; j++)
+    {
+      for (int i = 0; i < 2; i++)
+      {
+        const float* p = &map->v[(((iz+k)*n + iy+j)*n + ix+i)*4];
+        float        w = (i ? tx : 1-tx) * (j ? ty : 1-ty) * (k ? tz : 1-tz);
+
+        if (p[3] == 0)
+          return(false);
+        v[0] += w*p[0];
+        v[1] += w*p[1];
+        v[2] += w*p[2];
+      }
+    }
+  }
+
+  *x_wind_velocity = v[0] * flWindVel;
+  *y_wind_velocity = v[1] * flWindVel;
+  *z_wind_velocity = v[2] * flWindVel;
+  return(true);
+}
+
+void SlopeWindMap::request(float dir, int mode)
+{
+  if (dir == last_dir && mode == last_mode)
+    return;
+
+  SDL_mutexP(mutex);
+  last_dir  = dir;
+  last_mode = mode;
+  req_dir   = dir;
+  req_mode  = mode;
+  fRequest  = true;
+  if (thread == NULL)
+    thread = SDL_CreateThread(ThreadFunc, this);
+  else
+    SDL_CondSignal(cond);
+  SDL_mutexV(mutex);
+}
+
+int SlopeWindMap::ThreadFunc(void* data)
+{
+  CRRC_Profiler::setThreadName("slope wind");
+  ((SlopeWindMap*)data)->run();
+  CRRC_Profiler::endThread();
+  return(0);
+}
+
+void SlopeWindMap::run()
+{
+  SDL_mutexP(mutex);
+  while (!fQuit)
+  {
+    if (!fRequest)
+    {
+      SDL_CondWait(cond, mutex);
+      continue;
+    }
+
+    float dir  = req_dir;
+    int   mode = req_mode;
+    fRequest = false;
+    SDL_mutexV(mutex);
+
+    Map* map = NULL;
+    for (unsigned int i = 0; i < maps.size() && map == NULL; i++)
+    {
+      if (maps[i]->dir == dir && maps[i]->mode == mode)
+        map = maps[i];
+    }
+    if (map == NULL && (mode == 1 || mode == 2))
+    {
+      if (maps.size() < MAX_MAPS)
+        map = new Map;
+      else
+      {
+        // Reuse the grid which was used least recently. It isn't current,
+        // and hasn't been since at least one other grid was made current,
+        // so getWind() doesn't read it anymore.
+        unsigned int lru = 0;
+        for (unsigned int i = 0; i < maps.size(); i++)
+        {
+          if (maps[i] != current &&
+              (maps[lru] == current || maps[i]->used < maps[lru]->used))
+            lru = i;
+        }
+        map = maps[lru];
+        maps.erase(maps.begin() + lru);
+      }
+      map->dir  = dir;
+      map->mode = mode;
+      if (build(map))
+        maps.push_back(map);
+      else
+      {
+        delete map;
+        map = NULL;
+      }
+    }
+    if (map != NULL)
+    {
+      map->used = ++nUsed;
+
+      // the grid has to be complete before anybody can see it
+      Barrier();
+      current = map;
+    }
+
+    SDL_mutexP(mutex);
+  }
+  SDL_mutexV(mutex);
+}
+
+bool SlopeWindMap::build(Map* map)
+{
+  map->v.resize(LAYERS*n*n*4);
+
+  for (int j = 0; j < n; j++)
+  {
+    // give up if something else is wanted now
+    if (fQuit || fRequest)
+      return(false);
+
+    for (int i = 0; i < n; i++)
+    {
+      float x   = x_min + i*cell_size;
+      float y   = y_min + j*cell_size;
+      float z_c = scenery->getHeight(x, y);
+      float dz  = LAYER_MIN;
+
+      for (int k = 0; k < LAYERS; k++, dz *= LAYER_RATIO)
+      {
+        float* p = &map->v[((k*n + j)*n + i)*4];
+
+        if (z_c > DEEPEST_HELL &&
+            wind_from_terrain(scenery, map->mode, x, y, -(z_c + dz),
+                              1.0, map->dir, &p[0], &p[1], &p[2]) == 0)
+          p[3] = 1;
+        else
+          p[0] = p[1] = p[2] = p[3] = 0;
+      }
+    }
+  }
+
+  return(true);
+}
@@ -0,0 +1,131 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef SLOPE_WIND_MAP_H
+#define SLOPE_WIND_MAP_H
+
+#include <SDL.h>
+#include <vector>
+
+class Scenery;
+
+/**
+ * Precalculated wind_from_terrain() for the area around the flying site.
+ *
+ * The wind calculated from the terrain only depends on the position, the
+ * wind direction and the wind mode, and is proportional to the wind
+ * velocity. For a direction and mode, it is calculated on a grid: square
+ * cells, and layers of height above ground spaced logarithmically between
+ * 1 and 1000 ft. Queries only need the terrain height below the point and
+ * interpolate between the grid points.
+ *
+ * The grid is calculated on a thread of its own as soon as a query asks
+ * for a direction or mode for which there isn't one. Until it's ready
+ * (and for points outside of the grid), getWind() returns false and the
+ * caller has to use wind_from_terrain(). Grids for up to eight
+ * direction/mode pairs are kept, so going back to a previous direction
+ * doesn't need a new grid. Beyond that, the grid used least recently is
+ * replaced.
+ *
+ * As the result depends on whether the grid is ready, grids are only
+ * used after setEnabled() (crrcsim, unless in deterministic mode).
+ */
+class SlopeWindMap
+{
+  public:
+    /**
+     * \param scenery     terrain, its height lookup has to be reentrant
+     * \param x_center    center of the grid (north) [ft]
+     * \param y_center    center of the grid (east) [ft]
+     */
+    SlopeWindMap(Scenery* scenery, float x_center, float y_center);
+
+    /**
+     * Stops the calculation, if it is running.
+     */
+    ~SlopeWindMap();
+
+    /**
+     * Grids are only used if this has been set before the scenery
+     * is loaded.
+     */
+    static void setEnabled(bool fEnable);
+    static bool isEnabled();
+
+    /**
+     * Wind at X|Y|Z, see wind_from_terrain(). Returns false if there is no
+     * grid for this point, direction and mode (yet).
+     */
+    bool getWind(double X, double Y, double Z,
+                 float flWindVel, float flWindDir, int mode,
+                 float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity);
+
+  private:
+    /**
+     * The grid for one direction/mode
+     */
+    struct Map
+    {
+      float              dir;
+      int                mode;
+      unsigned long      used;  ///< when it was made current the last time
+      std::vector<float> v;     ///< vx, vy, vz, valid of point (layer*n + j)*n + i
+    };
+
+    void request(float dir, int mode);
+
+    /**
+     * Calculates a grid. Returns false if it has been aborted because
+     * another one has been requested.
+     */
+    bool build(Map* map);
+
+    static int ThreadFunc(void* data);
+    void run();
+
+    static bool fEnabled;
+
+    Scenery*  scenery;
+    float     x_min;
+    float     y_min;
+    float     cell_size;
+    int       n;        ///< grid points along x and y
+
+    /// @name Thread
+    //@{
+    SDL_Thread*        thread;
+    SDL_mutex*         mutex;    ///< guards the request
+    SDL_cond*          cond;
+    volatile bool      fQuit;
+    volatile bool      fRequest;
+    float              req_dir;
+    int                req_mode;
+    std::vector<Map*>  maps;     ///< all grids, written by the thread only
+    unsigned long      nUsed;    ///< counts grids made current, for Map::used
+    //@}
+
+    /// @name Read without locking
+    //@{
+    Map* volatile      current;  ///< grid being used
+    volatile float     last_dir; ///< last request, to avoid locking
+    volatile int       last_mode;
+    //@}
+};
+
+#endif // SLOPE_WIND_MAP_H
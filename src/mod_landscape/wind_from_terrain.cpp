@@ -62,18 +62,25 @@ data used by simple 2D panel method
 #define IT_MAX    20            // max iter in defining streamwise position of land's end
 #define DELTAX    10.           // to compute terain slope at land's end
 
-static float x[NPTS], z[NPTS];    // panel vertex coords
-static float cx[NPAN], cz[NPAN];  // panel control point coords
-static float cc[NPAN], ss[NPAN];  // panel cosine & sine
-static float A[NPAN][NPAN];       // system matrix
-static float src[NPAN];           // unknown sources
+/**
+ * Panel geometry and solution. Lives on the stack of wind_from_terrain(),
+ * so concurrent simulations don't interfere.
+ */
+typedef struct
+{
+  float x[NPTS], z[NPTS];    // panel vertex coords
+  float cx[NPAN], cz[NPAN];  // panel control point coords
+  float cc[NPAN], ss[NPAN];  // panel cosine & sine
+  float A[NPAN][NPAN];       // system matrix
+  float src[NPAN];           // unknown sources
+} T_Panels;
 
 /**
  * Compute normal velocity induced on control point of panel i
  * by a uniform source strength distribution on panel j
  *
  */
-static float vn_src0(int i, int j)
+static float vn_src0(const T_Panels& p, int i, int j)
 {
 	float xr1, zr1, xr2, zr2, rq1, rq2, b0, c0, d0, e0;
 
@@ -83,15 +90,15 @@ static float vn_src0(int i, int j)
   }
   else
   {
-    xr1 = cx[i] - x[j];
-    zr1 = cz[i] - z[j];
-    xr2 = cx[i] - x[j+1];
-    zr2 = cz[i] - z[j+1];
+    xr1 = p.cx[i] - p.x[j];
+    zr1 = p.cz[i] - p.z[j];
+    xr2 = p.cx[i] - p.x[j+1];
+    zr2 = p.cz[i] - p.z[j+1];
     rq1 = xr1*xr1 + zr1*zr1;
     rq2 = xr2*xr2 + zr2*zr2;
     b0 = atan2(zr2*xr1 - xr2*zr1, xr2*xr1 + zr2*zr1);
-    c0 = ss[i]*cc[j] - cc[i]*ss[j];
-    d0 = cc[i]*cc[j] + ss[i]*ss[j];
+    c0 = p.ss[i]*p.cc[j] - p.cc[i]*p.ss[j];
+    d0 = p.cc[i]*p.cc[j] + p.ss[i]*p.ss[j];
     e0 = .5*log(rq2/rq1);
     return c0*e0 + d0*b0;
   }
@@ -102,19 +109,19 @@ static float vn_src0(int i, int j)
  * by a uniform source strength distribution on panel j.
  *
  */
-static void v_src0(float px, float pz, int j, float *vx, float *vz)
+static void v_src0(const T_Panels& p, float px, float pz, int j, float *vx, float *vz)
 {
 	float xr1, zr1, xr2, zr2, rq1, rq2, b0, c0, d0, e0;
 
-  xr1 = px - x[j];
-  zr1 = pz - z[j];
-  xr2 = px - x[j+1];
-  zr2 = pz - z[j+1];
+  xr1 = px - p.x[j];
+  zr1 = pz - p.z[j];
+  xr2 = px - p.x[j+1];
+  zr2 = pz - p.z[j+1];
   rq1 = xr1*xr1 + zr1*zr1;
   rq2 = xr2*xr2 + zr2*zr2;
   b0 = atan2(zr2*xr1 - xr2*zr1, xr2*xr1 + zr2*zr1);
-  c0 = -ss[j];
-  d0 = cc[j];
+  c0 = -p.ss[j];
+  d0 = p.cc[j];
   e0 = .5*log(rq2/rq1);
   *vz = c0 * e0 + d0 * b0;
   *vx = c0 * b0 - d0 * e0;
@@ -146,16 +153,16 @@ static void solve_gs(float A[][NPAN], float x[], int n)
   }
 }
 
-int wind_from_terrain(double X, double Y, double Z,
+int wind_from_terrain(Scenery* scenery, int mode,
+                      double X, double Y, double Z,
+                      float flWindVel, float flWindDir,
                       float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity)
 {
   // freestream wind velocity
-  float flWindVel = cfg->wind->getVelocity();
-  float flWindDir = cfg->wind->getDirection()*M_PI/180.;
-  float flWindDirX = cos(flWindDir); //upstream versor
-  float flWindDirY = sin(flWindDir); //upstream versor
+  float flWindDirX = cos(flWindDir*M_PI/180.); //upstream versor
+  float flWindDirY = sin(flWindDir*M_PI/180.); //upstream versor
   
-  float z_c = Global::scenery->getHeight(X, Y); //terrain height below the point
+  float z_c = scenery->getHeight(X, Y); //terrain height below the point
   float H = -Z; //positive down -> positive up
   if ((H - z_c) < H_MIN)
     H = z_c + H_MIN;
@@ -166,7 +173,7 @@ int wind_from_terrain(double X, double Y, double Z,
   {
     sgVec3 wind;
 
-    if (Global::wind_mode == 1)
+    if (mode == 1)
     {
       //
       //We tilt the vector of wind along the slope, with the same speed in module
@@ -175,16 +182,21 @@ int wind_from_terrain(double X, double Y, double Z,
       float dx = COEF*dz*flWindDirX; //upstream vector
       float dy = COEF*dz*flWindDirY; //upstream vector
       
-      float z_f = Global::scenery->getHeight(X+dx, Y+dy);//terrain height upstream
+      // terrain height upstream and downstream
+      float qx[2] = { (float)(X+dx), (float)(X-dx) };
+      float qy[2] = { (float)(Y+dy), (float)(Y-dy) };
+      float qz[2];
+      scenery->getHeights(qx, qy, qz, 2);
+      float z_f = qz[0];
       if (z_f==DEEPEST_HELL) { z_f = z_c;}
-      float z_b = Global::scenery->getHeight(X-dx, Y-dy);//terrain height downstream
+      float z_b = qz[1];
       if (z_b==DEEPEST_HELL) { z_b = z_c;}
       sgVec3 p_c, p_f, p_b;
       sgSetVec3(p_c, X, Y, -z_c);
       sgSetVec3(p_f, X+dx, Y+dy, -z_f);
       sgSetVec3(p_b, X-dx, Y-dy, -z_b);
-      //float z_l = Global::scenery->getHeight(X+dx, Y-dsin);//left
-      //float z_r = Global::scenery->getHeight(X-dx, Y+dy);//right
+      //float z_l = scenery->getHeight(X+dx, Y-dsin);//left
+      //float z_r = scenery->getHeight(X-dx, Y+dy);//right
       //sgVec3 p_0, p_l, p_r;
       //sgSetVec3(p_0,X,Y,H);
 
@@ -193,12 +205,17 @@ int wind_from_terrain(double X, double Y, double Z,
       sgNormaliseVec3(dir); //-> Unit vector in the direction of the wind
       sgScaleVec3(wind, dir, -flWindVel); 
     }
-    else if (Global::wind_mode == 2)
+    else if (mode == 2)
     {
       //
       //2D potential flow in a wind-aligned vertical plane
       //
       
+      T_Panels p;
+      float* x   = p.x;
+      float* z   = p.z;
+      float* src = p.src;
+
       // define panels vertex points in a reference system with x axis aligned 
       // with wind direction (negative upstream) and origin on the point X,Y   
       if (dz < 0.1*REF_Z) dz = 0.1*REF_Z; // do not reduce ref length too much
@@ -210,16 +227,29 @@ int wind_from_terrain(double X, double Y, double Z,
       float dzdd2 = 0.0;
       float z1 = DEEPEST_HELL;
       float z2 = DEEPEST_HELL;
+
+      // terrain height at all points along the profile
+      float qx[NPTS];
+      float qy[NPTS];
       for(int i=1; i <= N_UP_PTS; i++)
       {
         float dx = ds*flWindDirX;
         float dy = ds*flWindDirY;
         
-        x[N_UP_PTS-i]   = -ds;
-        z[N_UP_PTS-i]   = Global::scenery->getHeight(X+dx, Y+dy);
-        x[N_UP_PTS-1+i] = +ds;
-        z[N_UP_PTS-1+i] = Global::scenery->getHeight(X-dx, Y-dy);
+        x[N_UP_PTS-i]    = -ds;
+        qx[N_UP_PTS-i]   = X+dx;
+        qy[N_UP_PTS-i]   = Y+dy;
+        x[N_UP_PTS-1+i]  = +ds;
+        qx[N_UP_PTS-1+i] = X-dx;
+        qy[N_UP_PTS-1+i] = Y-dy;
+
+        dd *= (i == 1 ? 2. : 1.)*RATE;
+        ds += dd;
+      }
+      scenery->getHeights(qx, qy, z, NPTS);
 
+      for(int i=1; i <= N_UP_PTS; i++)
+      {
         // check if upwind point is outside defined terrain profile
         // in case find terrain elevation and slope at upstream land's end
         if (z[N_UP_PTS-i] == DEEPEST_HELL)
@@ -235,7 +265,7 @@ int wind_from_terrain(double X, double Y, double Z,
             {
               it++;
               xc = 0.5*(xa + xb);
-              zc = Global::scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
+              zc = scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
               if (zc == DEEPEST_HELL)
                 xb = xc;
               else
@@ -248,7 +278,7 @@ int wind_from_terrain(double X, double Y, double Z,
             z1 = za;
             // estimate terrain slope at land's end
             xc = xa + DELTAX;
-            zc = Global::scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
+            zc = scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
             dzdd1 = (z1 - zc)/DELTAX;
           }
           z[N_UP_PTS-i] = z1 + dzdd1*REF_L*(1. - exp(-fabs(x[N_UP_PTS-i] - d1)/REF_L));
@@ -268,7 +298,7 @@ int wind_from_terrain(double X, double Y, double Z,
             {
               it++;
               xc = 0.5*(xa + xb);
-              zc = Global::scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
+              zc = scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
               if (zc == DEEPEST_HELL)
                 xb = xc;
               else
@@ -281,38 +311,35 @@ int wind_from_terrain(double X, double Y, double Z,
             z2 = za;
             // estimate terrain slope at land's end
             xc = xa - DELTAX;
-            zc = Global::scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
+            zc = scenery->getHeight(X-xc*flWindDirX, Y-xc*flWindDirY);
             dzdd2 = (z2 - zc)/DELTAX;
           }
           z[N_UP_PTS-1+i] = z2 + dzdd2*REF_L*(1. - exp(-fabs(x[N_UP_PTS-1+i] - d2)/REF_L));
         }
-        
-        dd *= (i == 1 ? 2. : 1.)*RATE;
-        ds += dd;
       }
       
       // compute panels geometry
       for(int i = 0; i < NPAN; i++)
       {
-        cx[i] = .5*(x[i+1] + x[i]);
-        cz[i] = .5*(z[i+1] + z[i]);
+        p.cx[i] = .5*(x[i+1] + x[i]);
+        p.cz[i] = .5*(z[i+1] + z[i]);
         float lx = x[i+1] - x[i];
         float lz = z[i+1] - z[i];
         float ll = hypot(lx, lz);
-        ss[i] = lz/ll;
-        cc[i] = lx/ll;
+        p.ss[i] = lz/ll;
+        p.cc[i] = lx/ll;
       }
       
       // construct system matrix and source term
       for(int i = 0; i < NPAN; i++)
       {
-        src[i] = ss[i]; // freestream flow = horizontal wind
+        src[i] = p.ss[i]; // freestream flow = horizontal wind
         for( int j = 0; j < NPAN; j++ )
-          A[i][j] = vn_src0(i, j);
+          p.A[i][j] = vn_src0(p, i, j);
       }
       
       // solve system matrix for the unknown source/vortex strength
-      solve_gs(A, src, NPAN);
+      solve_gs(p.A, src, NPAN);
 
       // compute velocity induced on target point
       float vx = 1.; // freestream flow = horizontal wind
@@ -320,7 +347,7 @@ int wind_from_terrain(double X, double Y, double Z,
       for(int i = 0; i < NPAN; i++)
       {
         float dvx, dvz;
-        v_src0(0., H, i, &dvx, &dvz); // induced (in plane) velocity on target point
+        v_src0(p, 0., H, i, &dvx, &dvz); // induced (in plane) velocity on target point
         vx += src[i]*dvx;
         vz += src[i]*dvz;
       }
@@ -27,8 +27,18 @@
 #ifndef CRRC_WINDFROMTERRAIN_H
 #define CRRC_WINDFROMTERRAIN_H
 
+class Scenery;
  
-int wind_from_terrain(double X, double Y, double Z,
+/**
+ * Wind at X|Y|Z for a freestream wind of flWindVel (ft/s) coming from
+ * flWindDir (degrees), calculated from the terrain of <code>scenery</code>
+ * using <code>mode</code> (see Global::wind_mode). Returns 1 if there is
+ * no terrain below the point.
+ * Reentrant as long as the scenery's height lookup is.
+ */
+int wind_from_terrain(Scenery* scenery, int mode,
+    double X, double Y, double Z,
+    float flWindVel, float flWindDir,
     float *x_wind_velocity, float *y_wind_velocity, float *z_wind_velocity);
     
 #endif //CRRC_WINDFROMTERRAIN_H
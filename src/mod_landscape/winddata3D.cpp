@@ -37,9 +37,9 @@
 
 #include <crrc_config.h>
 
-#include "crrc_scenery.h"
-#include "model_based_scenery.h"
+#include "winddata3D.h"
 #if WINDDATA3D == 1
+#include <stdio.h>
 #if CGAL_VERSION3 == 1
 # include <CGAL/assertions.h>
 #else
@@ -48,10 +48,11 @@
 #ifdef TEST_WINDDATA
 //main program for test only
 WindData *wind_data=NULL;
+Cell_handle hint;
 main()
 {
 //init
-  int r= init_wind_data("scenery/Brie/wind.data");
+  int r= init_wind_data("scenery/Brie/wind.data", wind_data);
   std::cout << r << "  points processed" << std::endl;
 //std::cout <<T;
   float x,y,z,vx,vy,vz;
@@ -62,7 +63,7 @@ main()
     scanf("%f",&x);
     scanf("%f",&y);
     scanf("%f",&z);
-    ok = find_wind_data(x,y,z,&vx,&vy,&vz);
+    ok = find_wind_data(wind_data,hint,x,y,z,&vx,&vy,&vz);
     if (ok)
     {
       std::cout<<"find:  " << vx << "  "<< vy << "  " << vz <<std::endl;
@@ -78,11 +79,7 @@ main()
 #endif
 //////////////////
 
-#ifdef TEST_WINDDATA
-int init_wind_data(char * filename)
-#else
-int ModelBasedScenery::init_wind_data(const char* filename)
-#endif
+int init_wind_data(const char* filename, WindData*& wind_data)
 {
   CGAL::set_error_behaviour ( CGAL::CONTINUE); //CGAL failure behaviour
   Vertex_handle v;
@@ -91,6 +88,7 @@ int ModelBasedScenery::init_wind_data(const char* filename)
   int npt=0;
   int nread;
   int stop=0;
+  wind_data = NULL;
   if (!input) fprintf(stderr, "Error open wind filename:  %s \n",filename);
   else
 #if 1
@@ -130,6 +128,7 @@ int ModelBasedScenery::init_wind_data(const char* filename)
     L.clear();
   }
 #endif
+  if (input) fclose(input);
   return npt;
 }
 void Point_sgVec3(Point p, sgVec3 v)
@@ -156,18 +155,13 @@ float cbary(Point pb , Point pa, Point pc, Point pd)
   return res;
 }
 
-#ifdef TEST_WINDDATA
-int find_wind_data(float n,float e,float u, float *vx, float *vy, float * vz)
-#else
-int ModelBasedScenery::find_wind_data(float n,float e,float u, float *vx, float *vy, float * vz)
-#endif
+int find_wind_data(WindData* wind_data, Cell_handle& hint,
+                   float n,float e,float u, float *vx, float *vy, float * vz)
 {
-  static Cell_handle mem_cell_handle=NULL;
   Cell_handle c;
   Point p0 = Point(n,e,u);
-  if (mem_cell_handle==NULL) c = wind_data->locate(p0,mem_cell_handle);
-  else c = wind_data->locate(p0);
-  mem_cell_handle = c;
+  c = wind_data->locate(p0, hint);
+  hint = c;
   if (wind_data->is_infinite (c)) return false;
   Vertex_handle va = c->vertex(0);
   Vertex_handle vb = c->vertex(1);
@@ -39,8 +39,6 @@
 #include <CGAL/Delaunay_triangulation_3.h>
 #include <CGAL/Triangulation_vertex_base_with_info_3.h>
 
-int init_wind_data(char *);
-int find_wind_data(float,float,float,float*,float*,float*);
 typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
 typedef CGAL::Triangulation_vertex_base_with_info_3<sgVec3, K> Vb;
 typedef CGAL::Triangulation_data_structure_3<Vb>                    Tds;
@@ -50,6 +48,23 @@ typedef WindData::Point   Point;
 typedef Tds::Vertex_handle  Vertex_handle; 
 typedef Tds::Cell_handle  Cell_handle; 
 
+/**
+ * Reads a wind data file (X Y Z vx vy vz per line) into a new
+ * triangulation. Returns the number of points, wind_data is NULL if the
+ * file can't be opened.
+ */
+int init_wind_data(const char* filename, WindData*& wind_data);
+
+/**
+ * Interpolates the wind at a point linearly between the corners of the
+ * tetrahedron containing it.
+ *
+ * \param hint cell to start searching from, the cell found is stored here
+ * \return false if the point is outside of the data
+ */
+int find_wind_data(WindData* wind_data, Cell_handle& hint,
+                   float n, float e, float u, float *vx, float *vy, float *vz);
+
 #endif // WINDDATA3D
 
 #endif // WINDDATA3D_H
@@ -0,0 +1,281 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "windgrid.h"
+#include "hd_cache.h"
+#include "winddata3D.h"
+
+#include <iostream>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+/// Maximum number of grid points
+#define MAX_SAMPLES   (1 << 20)
+
+
+WindGrid* WindGrid::load(std::string windfile, float spacing)
+{
+  HD_Cache* cache = new HD_Cache(windfile, ".windgrid");
+
+  // the key covers the wind data and the parameters of the grid
+  cache->addToKey(spacing);
+  if (!cache->addFileToKey(windfile))
+  {
+    std::cerr << "Unable to read wind data " << windfile << std::endl;
+    delete cache;
+    return(NULL);
+  }
+
+  WindGrid*   grid = new WindGrid(cache);
+  size_t      size;
+  const char* data = cache->open(HD_CACHE_WINDGRID, size);
+  if (data && grid->readGrid(data, size))
+    return(grid);
+
+#if WINDDATA3D == 1
+  FILE* fp = cache->create(HD_CACHE_WINDGRID);
+  if (fp)
+  {
+    cache->commit(fp, resample(windfile, spacing, fp));
+    data = cache->open(HD_CACHE_WINDGRID, size);
+    if (data && grid->readGrid(data, size))
+      return(grid);
+  }
+#endif
+
+  delete grid;
+  return(NULL);
+}
+
+bool WindGrid::canResample()
+{
+  return(WINDDATA3D == 1);
+}
+
+WindGrid::WindGrid(HD_Cache* cache)
+  : cache(cache), samples(NULL)
+{
+  memset(&h, 0, sizeof(h));
+}
+
+WindGrid::~WindGrid()
+{
+  delete cache;
+}
+
+bool WindGrid::readGrid(const char* data, size_t size)
+{
+  if (size < sizeof(h))
+    return(false);
+  memcpy(&h, data, sizeof(h));
+  if (h.sample_size != sizeof(Sample))
+    return(false);
+  // the total like the writer does, the product could overflow size_t
+  double nSamples = 1;
+  for (int n = 0; n < 3; n++)
+  {
+    if (h.size[n] < 2 || !(h.spacing[n] > 0))
+      return(false);
+    nSamples *= h.size[n];
+  }
+  if (nSamples > MAX_SAMPLES)
+    return(false);
+  if ((size - sizeof(h)) / sizeof(Sample) != (size_t)nSamples ||
+      (size - sizeof(h)) % sizeof(Sample) != 0)
+    return(false);
+
+  samples = (const Sample*)(data + sizeof(h));
+
+  std::cout << "WindGrid: " << h.size[0] << "x" << h.size[1] << "x" << h.size[2]
+            << " points, spacing " << h.spacing[0] << std::endl;
+  return(true);
+}
+
+bool WindGrid::getWind(float n, float e, float u,
+                       float v[3], float grad[3][3]) const
+{
+  float pos[3] = { n, e, u };
+  int   idx[3];
+  float t[3];
+
+  for (int a = 0; a < 3; a++)
+  {
+    float f = (pos[a] - h.origin[a]) / h.spacing[a];
+
+    if (!(f >= 0 && f <= h.size[a] - 1))
+      return(false);
+    idx[a] = (int)f;
+    if (idx[a] > (int)h.size[a] - 2)
+      idx[a] = h.size[a] - 2;
+    t[a] = f - idx[a];
+  }
+
+  // corners of the cell, c[k][j][i]
+  const int     nx = h.size[0];
+  const int     ny = h.size[1];
+  const Sample* c[2][2][2];
+
+  for (int k = 0; k < 2; k++)
+  {
+    for (int j = 0; j < 2; j++)
+    {
+      for (int i = 0; i < 2; i++)
+      {
+        c[k][j][i] = samples + ((idx[2] + k)*ny + idx[1] + j)*nx + idx[0] + i;
+        if (c[k][j][i]->valid == 0)
+          return(false);
+      }
+    }
+  }
+
+  for (int m = 0; m < 3; m++)
+  {
+    // interpolate along north...
+    float d00 = c[0][0][1]->v[m] - c[0][0][0]->v[m];
+    float d10 = c[0][1][1]->v[m] - c[0][1][0]->v[m];
+    float d01 = c[1][0][1]->v[m] - c[1][0][0]->v[m];
+    float d11 = c[1][1][1]->v[m] - c[1][1][0]->v[m];
+    float c00 = c[0][0][0]->v[m] + d00*t[0];
+    float c10 = c[0][1][0]->v[m] + d10*t[0];
+    float c01 = c[1][0][0]->v[m] + d01*t[0];
+    float c11 = c[1][1][0]->v[m] + d11*t[0];
+    // ...east...
+    float c0  = c00 + (c10 - c00)*t[1];
+    float c1  = c01 + (c11 - c01)*t[1];
+    // ...and up
+    v[m] = c0 + (c1 - c0)*t[2];
+
+    if (grad)
+    {
+      grad[m][0] = ((d00 + (d10 - d00)*t[1])*(1 - t[2]) +
+                    (d01 + (d11 - d01)*t[1])*t[2]) / h.spacing[0];
+      grad[m][1] = ((c10 - c00)*(1 - t[2]) + (c11 - c01)*t[2]) / h.spacing[1];
+      grad[m][2] = (c1 - c0) / h.spacing[2];
+    }
+  }
+
+  return(true);
+}
+
+#if WINDDATA3D == 1
+bool WindGrid::resample(std::string windfile, float spacing, FILE* fp)
+{
+  WindData* wind_data;
+  int       npt = init_wind_data(windfile.c_str(), wind_data);
+
+  std::cout << "WindGrid: resampling " << npt << " points" << std::endl;
+  if (wind_data == NULL || npt < 4)
+  {
+    delete wind_data;
+    return(false);
+  }
+
+  // bounding box of the data
+  float min[3] = {  HUGE_VAL,  HUGE_VAL,  HUGE_VAL };
+  float max[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+
+  for (WindData::Finite_vertices_iterator it = wind_data->finite_vertices_begin();
+       it != wind_data->finite_vertices_end(); it++)
+  {
+    float p[3] = { (float)it->point().x(), (float)it->point().y(), (float)it->point().z() };
+
+    for (int a = 0; a < 3; a++)
+    {
+      if (p[a] < min[a])
+        min[a] = p[a];
+      if (p[a] > max[a])
+        max[a] = p[a];
+    }
+  }
+
+  float volume = 1;
+  for (int a = 0; a < 3; a++)
+  {
+    if (max[a] - min[a] > 0)
+      volume *= max[a] - min[a];
+  }
+  if (!(spacing > 0))
+  {
+    // about one grid point per data point
+    spacing = pow(volume / npt, 1.0/3.0);
+  }
+
+  // limit the number of grid points
+  T_WindGridHeader h;
+  while (true)
+  {
+    double nSamples = 1;
+
+    for (int a = 0; a < 3; a++)
+    {
+      h.origin[a]  = min[a];
+      h.spacing[a] = spacing;
+      h.size[a]    = (uint32_t)ceil((max[a] - min[a]) / spacing) + 1;
+      if (h.size[a] < 2)
+        h.size[a] = 2;
+      nSamples *= h.size[a];
+    }
+    if (nSamples <= MAX_SAMPLES)
+      break;
+    spacing *= 1.1;
+  }
+  h.sample_size = sizeof(Sample);
+
+  std::vector<Sample> grid(h.size[0]*h.size[1]*h.size[2]);
+  Cell_handle         hint;
+  int                 nValid = 0;
+
+  for (unsigned int k = 0; k < h.size[2]; k++)
+  {
+    for (unsigned int j = 0; j < h.size[1]; j++)
+    {
+      for (unsigned int i = 0; i < h.size[0]; i++)
+      {
+        Sample& s = grid[(k*h.size[1] + j)*h.size[0] + i];
+
+        if (find_wind_data(wind_data, hint,
+                           h.origin[0] + i*h.spacing[0],
+                           h.origin[1] + j*h.spacing[1],
+                           h.origin[2] + k*h.spacing[2],
+                           &s.v[0], &s.v[1], &s.v[2]))
+        {
+          s.valid = 1;
+          nValid++;
+        }
+        else
+        {
+          s.v[0] = s.v[1] = s.v[2] = 0;
+          s.valid = 0;
+        }
+      }
+    }
+  }
+  delete wind_data;
+
+  std::cout << "WindGrid: " << nValid << " of " << grid.size()
+            << " grid points inside of the data" << std::endl;
+
+  if (fwrite(&h, sizeof(h), 1, fp) != 1)
+    return(false);
+  if (fwrite(&grid[0], sizeof(Sample), grid.size(), fp) != grid.size())
+    return(false);
+  return(true);
+}
+#endif
@@ -0,0 +1,119 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef WINDGRID_H
+#define WINDGRID_H
+
+#include <crrc_config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+class HD_Cache;
+
+/**
+ * Wind data of a scenery on a regular 3D grid.
+ *
+ * The wind data file of a scenery holds the wind at scattered points
+ * (X Y Z vx vy vz per line, see winddata3D.cpp). Interpolating between
+ * them needs a Delaunay triangulation (CGAL), which is slow to build and
+ * to query. Instead, the data is resampled once onto a regular grid and
+ * stored in a HD_Cache file next to the wind data file, which is mapped
+ * into memory when the scenery is loaded. Queries interpolate trilinearly
+ * and don't change any state, so they may be done by several threads.
+ *
+ * Resampling needs CGAL. Without it, only grids which have been
+ * calculated before can be used (see <code>crrcsim_batch -c</code>).
+ *
+ * Coordinates and velocities are those of the wind data file: north,
+ * east and up, velocities normalized to the wind speed.
+ */
+class WindGrid
+{
+  public:
+    /**
+     * Loads the grid for a wind data file from the cache, resamples the
+     * wind data if there is no valid one.
+     *
+     * \param windfile  wind data file (with full path)
+     * \param spacing   distance of grid points, 0 to choose one matching
+     *                  the density of the data
+     * \return the grid or NULL if there is none and it couldn't be made
+     */
+    static WindGrid* load(std::string windfile, float spacing);
+
+    /**
+     * Returns true if this build is able to resample wind data.
+     */
+    static bool canResample();
+
+    ~WindGrid();
+
+    /**
+     * Interpolates the wind at a point.
+     *
+     * \param n,e,u position
+     * \param v     wind velocity (north, east, up) is stored here
+     * \param grad  if not NULL, the gradient is stored here:
+     *              grad[i][j] = d v[i] / d x[j], x = (n, e, u)
+     * \return false if the point is outside of the data
+     */
+    bool getWind(float n, float e, float u,
+                 float v[3], float grad[3][3] = NULL) const;
+
+    /// @name Grid geometry
+    //@{
+    const float* getOrigin()  const { return(h.origin); };
+    const float* getSpacing() const { return(h.spacing); };
+    int          getSize(int axis) const { return(h.size[axis]); };
+    //@}
+
+  private:
+    struct T_WindGridHeader
+    {
+      float    origin[3];   ///< position of the first grid point
+      float    spacing[3];  ///< distance of grid points along each axis
+      uint32_t size[3];     ///< number of grid points along each axis
+      uint32_t sample_size; ///< sizeof(Sample), to detect incompatible files
+    };
+
+    /**
+     * One grid point
+     */
+    struct Sample
+    {
+      float v[3];
+      float valid;    ///< 0 if the point is outside of the wind data
+    };
+
+    WindGrid(HD_Cache* cache);
+
+    bool readGrid(const char* data, size_t size);
+
+#if WINDDATA3D == 1
+    static bool resample(std::string windfile, float spacing, FILE* fp);
+#endif
+
+    HD_Cache*         cache;     ///< holds the mapped file
+    T_WindGridHeader  h;
+    const Sample*     samples;   ///< index ((k*ny + j)*nx + i)
+};
+
+#endif // WINDGRID_H
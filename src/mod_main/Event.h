@@ -68,6 +68,9 @@ class Event
     /// \return The event's group-specific type code
     unsigned long getType() const {return ev_type;};
     
+    /// Create a copy of the event (to raise it later)
+    virtual Event* clone() const {return new Event(*this);};
+    
     /// Destroy the event
     virtual ~Event();
 
@@ -128,6 +131,8 @@ class JoystickButtonEvent : public JoystickEvent
     /// \retval false   Button is not pressed
     bool isPressed() const {return m_IsPressed;}
     
+    Event* clone() const {return new JoystickButtonEvent(*this);}
+    
     /// Set the state of the button that caused the event
     void setPressed(bool boPressed) {m_IsPressed = boPressed;}
     
@@ -173,6 +178,8 @@ class LogMessageEvent : public Event
     {
       return m_Msg;
     }
+    
+    Event* clone() const {return new LogMessageEvent(*this);}
   
   private:
     std::string m_Msg;
@@ -216,6 +223,8 @@ class AxisUpdateEvent : public Event
     float getRetract() const  {return m_retract;}
     float getPitch() const    {return m_pitch;}
     
+    Event* clone() const {return new AxisUpdateEvent(*this);}
+    
 
   private:
     float m_aileron;    ///< aileron input,          -0.5 ... 0.5
@@ -240,6 +249,8 @@ class CrashEvent : public Event
     : Event(Event::Generic, Event::CrashEvent)
     {
     }
+    
+    Event* clone() const {return new CrashEvent(*this);}
   
 };
 
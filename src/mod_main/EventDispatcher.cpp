@@ -108,6 +108,11 @@ void EventDispatcher::raise(const Event* ev)
   std::cout << std::hex << ev->getGroup() << std::dec << std::endl;
   #endif
 
+  if (Filter != NULL && (*Filter)(ev))
+  {
+    return;
+  }
+
   ListenerQueue::const_iterator allListeners = Listeners.begin();
   while (allListeners != Listeners.end())
   {
@@ -32,6 +32,7 @@
 #ifndef EVENT_DISPATCHER_H_
 #define EVENT_DISPATCHER_H_
 
+#include <cstddef>
 #include <deque>
 #include <iostream>
 
@@ -135,6 +136,24 @@ class EventAdapter : public EventListener
 
 
 
+/**
+ *  \brief Intercepts events before they are dispatched.
+ *
+ *  Used to keep events away from the listeners, e.g. if they have been
+ *  raised on another thread and have to be raised again later.
+ */
+class EventFilter
+{
+  public:
+    virtual ~EventFilter() {};
+
+    /// Return true if the event has been taken care of and must
+    /// not be passed to the listeners.
+    virtual bool operator()(const Event* ev) = 0;
+};
+
+
+
 /**
  *  \brief The EventDispatcher singleton class.
  *
@@ -157,9 +176,10 @@ class EventDispatcher
     } T_ListenerContainer;
     typedef std::deque< T_ListenerContainer > ListenerQueue;
     ListenerQueue Listeners;
+    EventFilter*  Filter;
     
     /// Default constructor, not accessible
-    EventDispatcher(){};
+    EventDispatcher() : Filter(NULL) {};
     /// Copy constructor, not accessible
     EventDispatcher(EventDispatcher const&){};
 
@@ -170,6 +190,9 @@ class EventDispatcher
     bool registerListener(EventListener *Listener, unsigned long ulGroups = Event::All);
     bool unregisterListener(EventListener *Listener);
     void raise(const Event* ev);
+
+    /// Every event is passed to this filter first (NULL: no filter).
+    void setFilter(EventFilter* NewFilter) {Filter = NewFilter;};
 };
 
 #endif // EVENT_DISPATCHER_H_
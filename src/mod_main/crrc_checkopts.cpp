@@ -38,12 +38,13 @@ extern int    optind;
 
 #include "../global.h"
 #include "../crrc_main.h"
+#include "../mod_misc/profiler.h"
 
 // Prototypes for local functions
 static void crrc_version_info();
 static void crrc_usage(char *progname);
 
-#define OPTION_STRING "b:c:d:fg:hi:j:l:m:s:u:vVw:x:y:"
+#define OPTION_STRING "b:c:d:fg:hi:j:l:m:p:s:u:vVw:x:y:"
 
 /**
  * Print usage information and exit
@@ -65,6 +66,7 @@ static void crrc_usage(char *progname)
   fprintf(stderr,  "         -g <string>    : specify config file\n");
   fprintf(stderr,  "         -i <string>    : input method : KEYBOARD|MOUSE|JOYSTICK|RCTRAN|SERIAL2|PARALLEL|AUDIO|MNAV|ZHENHUA\n");
   fprintf(stderr,  "         -m <string>    : mouse x motion : AILERON|RUDDER\n");
+  fprintf(stderr,  "         -p <string>    : profile frames, show them on screen and write a Chrome trace file\n");
   fprintf(stderr,  "         -s <on/off>    : sound on/off\n");
   fprintf(stderr,  "         -u <on/off>    : user interface on/off\n");
   fprintf(stderr,  "         -w <value>     : wind velocity in ft/sec\n");
@@ -153,6 +155,9 @@ int crrc_checkopts (int                argc,
         else if (strcasecmp(optarg,"RUDDER")==0)
           Global::inputDev->mouse_bind_x = T_AxisMapper::RUDDER;
         break;
+      case 'p':
+        CRRC_Profiler::enable(optarg);
+        break;
       case 's':
         if      (strcasecmp(optarg,"ON")==0)
           cfgfile->setAttributeOverwrite("sound.enabled", "1");
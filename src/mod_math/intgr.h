@@ -172,6 +172,49 @@ namespace CRRCMath
       */
      C val;
   };
+
+  /**
+   * Klassisches Runge-Kutta-Verfahren vierter Ordnung
+   *
+   * Abschnitt 9.3.4 in [2]
+   *
+   * Unlike the methods above, this one needs the derivative at points
+   * between the old and the new value, so it is given a function object
+   * <code>f</code> which is called as <code>C f(C const& y, double dT)</code>
+   * and returns the derivative at <code>y</code>, which is
+   * <code>dT</code> after the start of the step. C needs
+   * <code>operator+(C)</code> and <code>operator*(double)</code>.
+   *
+   * As there is nothing to remember between steps, this doesn't need
+   * to be instantiated for each type in intgr.cpp.
+   */
+  template<class C> class IntegrationsverfahrenRK4
+  {
+    public:
+
+     /**
+      * Festlegung des Startwerts
+      */
+     void init(C Startwert) { val = Startwert; };
+
+     /**
+      * Ausfhrung eines Integrationsschritts. <code>Abl</code> is the
+      * derivative at the start of the step.
+      */
+     template<class F> void step(double dT, C Abl, F& f)
+     {
+       C k2 = f(val + Abl*(0.5*dT), 0.5*dT);
+       C k3 = f(val + k2 *(0.5*dT), 0.5*dT);
+       C k4 = f(val + k3 *dT,       dT);
+
+       val = val + (Abl + (k2 + k3)*2 + k4)*(dT/6);
+     };
+
+     /**
+      * der integrierte Wert
+      */
+     C val;
+  };
   
 }
 #endif
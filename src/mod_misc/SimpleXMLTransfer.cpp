@@ -35,9 +35,15 @@
 #include "SimpleXMLTransfer.h"
 #include "lib_conversions.h"
 #include <ctype.h>
+#include <string.h>
 #include <iostream>
+#include <set>
 #include <cstdlib>
 
+#if defined(_MSC_VER)
+# include <windows.h>
+#endif
+
 // 1: ?
 // 2: show compare
 #define DEBUG 0
@@ -46,6 +52,121 @@
 # include <stdio.h>
 #endif
 
+namespace
+{
+  /**
+   * Characters to be parsed, read from a stream one at a time. Nothing
+   * after the end of the outermost element is read, so the stream can be
+   * used for something else afterwards.
+   */
+  class StreamSource
+  {
+    public:
+      StreamSource(std::istream& in) : in(in) {};
+
+      int get() { return(in.get()); };
+
+      /**
+       * Reads up to (not including) the next <code>term</code> and appends
+       * it to <code>out</code> (if it isn't NULL). <code>c1</code> and
+       * <code>c2</code> are the last and the one but last character read.
+       */
+      void skipTo(char term, std::string* out, char& c1, char& c2)
+      {
+        int data;
+
+        while ((data = in.peek()) >= 0 && (char)data != term)
+        {
+          in.get();
+          if (out != NULL)
+            out->push_back((char)data);
+          c2 = c1;
+          c1 = (char)data;
+        }
+      };
+
+    private:
+      std::istream& in;
+  };
+
+  /**
+   * Characters to be parsed, all of them in memory. skipTo() copies
+   * whole runs of characters at once.
+   */
+  class BufferSource
+  {
+    public:
+      BufferSource(const char* begin, const char* end) : p(begin), end(end) {};
+
+      int get() { return((p < end) ? (unsigned char)*p++ : -1); };
+
+      /// see StreamSource::skipTo()
+      void skipTo(char term, std::string* out, char& c1, char& c2)
+      {
+        const char* q = (const char*)memchr(p, term, end - p);
+
+        if (q == NULL)
+          q = end;
+        if (q > p)
+        {
+          if (out != NULL)
+            out->append(p, q - p);
+          c2 = (q - p >= 2) ? q[-2] : c1;
+          c1 = q[-1];
+          p  = q;
+        }
+      };
+
+    private:
+      const char* p;
+      const char* end;
+  };
+
+  /**
+   * All names seen so far, see XMLPath::intern()
+   */
+  std::set<std::string>& internedNames()
+  {
+    static std::set<std::string> names;
+    return(names);
+  }
+
+  volatile long internLock = 0;
+}
+
+const std::string* XMLPath::intern(std::string const& name)
+{
+#if defined(_MSC_VER)
+  while (InterlockedExchange(&internLock, 1))
+    Sleep(0);
+#else
+  while (__sync_lock_test_and_set(&internLock, 1))
+    ;
+#endif
+
+  const std::string* ptr = &*internedNames().insert(name).first;
+
+#if defined(_MSC_VER)
+  InterlockedExchange(&internLock, 0);
+#else
+  __sync_lock_release(&internLock);
+#endif
+  return(ptr);
+}
+
+XMLPath::XMLPath(std::string path) : path(path)
+{
+  std::string::size_type start = 0;
+  std::string::size_type pos;
+
+  while ((pos = path.find('.', start)) != std::string::npos)
+  {
+    elements.push_back(intern(path.substr(start, pos - start)));
+    start = pos + 1;
+  }
+  attr = intern(path.substr(start));
+}
+
 XMLException::XMLException(std::string message)
 {
   myMessage = message;
@@ -61,16 +182,16 @@ const char *XMLException::what()
  */
 SimpleXMLTransfer::SimpleXMLTransfer()
 {
-  myName      = "data";
+  myName      = XMLPath::intern("data");
   content     = (std::string *) 0;
   sourcedescr = "default constructor";
 }
 
-SimpleXMLTransfer::SimpleXMLTransfer(std::istream & in, int data)
+template <class Source> SimpleXMLTransfer::SimpleXMLTransfer(Source& src, int data)
 {
   content     = (std::string *) 0;
   sourcedescr = "istream";
-  readStream(in, data);
+  readSource(src, data);
 }
 
 /**
@@ -95,16 +216,18 @@ SimpleXMLTransfer::SimpleXMLTransfer(std::string source)
   }
   else
   {
-    readStream(in, -2);
+    readAll(in);
     in.close();
   }
 }
 
 SimpleXMLTransfer::SimpleXMLTransfer(std::istream& in)
 {
+  StreamSource src(in);
+
   content = (std::string*) 0;
   sourcedescr = "stream";
-  readStream(in, -2);
+  readSource(src, -2);
 }
 
 SimpleXMLTransfer::SimpleXMLTransfer(SimpleXMLTransfer* source)
@@ -137,10 +260,34 @@ SimpleXMLTransfer::~SimpleXMLTransfer()
   }
 }
 
+/**
+ * Liest den ganzen Stream auf einmal ein.
+ */
+void SimpleXMLTransfer::readAll(std::istream& in)
+{
+  std::string data;
+
+  in.seekg(0, std::ios::end);
+  std::streamoff size = in.tellg();
+  in.seekg(0, std::ios::beg);
+
+  if (size > 0)
+  {
+    // In text mode, there may be less to read than the file's size.
+    data.resize((std::string::size_type)size);
+    in.read(&data[0], size);
+    data.resize((std::string::size_type)in.gcount());
+  }
+
+  BufferSource src(data.data(), data.data() + data.length());
+
+  readSource(src, -2);
+}
+
 /**
  * Nur zur internen Vewendung.
  */
-void SimpleXMLTransfer::readStream(std::istream & in, int data)
+template <class Source> void SimpleXMLTransfer::readSource(Source& src, int data)
 {
   bool fLesen = true;
   bool fGeschlossen = false;
@@ -158,18 +305,45 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
   std::string attributename;
   std::string attributeval;
 
+  static const std::string* noName = XMLPath::intern("");
+
+  myName = noName;
+
   if (data != -2)
   {
     nState = STATE_READNAME;
-    myName = "";
-    myName.push_back((char) data);
+    name   = "";
+    name.push_back((char) data);
   }
   else
     nState = STATE_IDLE;
 
   while (fLesen)
   {
-    data = in.get();
+    // Where nothing but the end of a run of characters matters, they are
+    // skipped (or copied) at once.
+    switch (nState)
+    {
+      case STATE_IDLE:
+        src.skipTo('<', NULL, c1, c2);
+        break;
+      case STATE_INITTAG:
+        src.skipTo('>', NULL, c1, c2);
+        break;
+      case STATE_COMMENT:
+        src.skipTo('>', &myComment, c1, c2);
+        break;
+      case STATE_ATTR_VAL:
+        src.skipTo('"', &attributeval, c1, c2);
+        break;
+      case STATE_ENDTAG:
+        src.skipTo('>', &endTagName, c1, c2);
+        break;
+      default:
+        break;
+    }
+
+    data = src.get();
 
     if (data < 0)
       fLesen = false;
@@ -197,8 +371,8 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
           else
           {
             nState = STATE_READNAME;
-            myName = "";
-            myName.push_back(c0);
+            name   = "";
+            name.push_back(c0);
           }
           break;
 
@@ -229,12 +403,13 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
             throw
             XMLException
             ("Found \'=\' without preceding attributename in " +
-             myName);
+             name);
           }
           else
             if ((c0 == '/' || c0 == ' ' || c0 == '\n' || c0 == '\r'
-                 || c0 == '\t') && myName.length() > 0)
+                 || c0 == '\t') && name.length() > 0)
             {
+              setName(name);
               nState = STATE_ATTR_NAME;
               attributename = "";
             }
@@ -242,10 +417,11 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
             {
               if (c0 == '>')
               {
+                setName(name);
                 nState = STATE_WAIT_CONT;
               }
               else
-                myName.push_back(c0);
+                name.push_back(c0);
             }
           break;
 
@@ -260,7 +436,7 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
               throw
               XMLException
               ("Found \'=\' without preceding attributename in " +
-               myName);
+               getName());
             }
             nState = STATE_ATTR_VAL_START;
           }
@@ -299,7 +475,7 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
             nState = STATE_ATTR_VAL_START;
           else if (isspace(c0) == false)
           {
-            throw XMLException("Element " + myName +
+            throw XMLException("Element " + getName() +
                                ": expected \'=\', got \'" + c0 +
                                "\' after attribute " + attributename);
           }
@@ -317,7 +493,9 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
           if (c0 == '"')
           {
             if (attributename.length() > 0)
-              addAttribute(attributename, convFromXML(attributeval));
+              addAttribute(attributename,
+                           (attributeval.find('&') == std::string::npos) ? attributeval
+                                                                          : convFromXML(attributeval));
             attributeval = "";
 
             nState = STATE_ATTR_NAME;
@@ -351,7 +529,7 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
           else
           {
             SimpleXMLTransfer *child =
-              new SimpleXMLTransfer(in, (int) c0);
+              new SimpleXMLTransfer(src, (int) c0);
             addChild(child);
             nState = STATE_WAIT_CONT;
           }
@@ -413,7 +591,7 @@ void SimpleXMLTransfer::readStream(std::istream & in, int data)
  */
 std::string SimpleXMLTransfer::getName()
 {
-  return (myName);
+  return (*myName);
 }
 
 /**
@@ -502,17 +680,7 @@ int SimpleXMLTransfer::getContentInt()
  */
 std::string SimpleXMLTransfer::getString(std::string path)
 {
-  std::string::size_type pos = path.rfind('.');
-
-  if (pos != std::string::npos)
-  {
-    SimpleXMLTransfer *item = getChild(path.substr(0, pos));
-    return (item->attribute(path.substr(pos + 1)));
-  }
-  else
-  {
-    return (attribute(path));
-  }
+  return (value(path));
 }
 
 /**
@@ -524,17 +692,7 @@ std::string SimpleXMLTransfer::getString(std::string path)
  */
 int SimpleXMLTransfer::getInt(std::string path)
 {
-  std::string::size_type pos = path.rfind('.');
-
-  if (pos != std::string::npos)
-  {
-    SimpleXMLTransfer *item = getChild(path.substr(0, pos));
-    return (item->attributeAsInt(path.substr(pos + 1)));
-  }
-  else
-  {
-    return (attributeAsInt(path));
-  }
+  return (convToInt(value(path)));
 }
 
 /**
@@ -543,97 +701,233 @@ int SimpleXMLTransfer::getInt(std::string path)
  */
 double SimpleXMLTransfer::getDouble(std::string path)
 {
-  std::string::size_type pos = path.rfind('.');
+  return (convToDouble(value(path)));
+}
 
-  if (pos != std::string::npos)
+std::string SimpleXMLTransfer::getString(std::string path, std::string stringDefault)
+{
+  return (getStringDefault(path, stringDefault));
+}
+
+int SimpleXMLTransfer::getInt(std::string path, int nDefault)
+{
+  return (getIntDefault(path, nDefault));
+}
+
+double SimpleXMLTransfer::getDouble(std::string path, double dDefault)
+{
+  return (getDoubleDefault(path, dDefault));
+}
+
+std::string SimpleXMLTransfer::getString(XMLPath const& path)
+{
+  return (value(path));
+}
+
+int SimpleXMLTransfer::getInt(XMLPath const& path)
+{
+  return (convToInt(value(path)));
+}
+
+double SimpleXMLTransfer::getDouble(XMLPath const& path)
+{
+  return (convToDouble(value(path)));
+}
+
+std::string SimpleXMLTransfer::getString(XMLPath const& path, std::string stringDefault)
+{
+  return (getStringDefault(path, stringDefault));
+}
+
+int SimpleXMLTransfer::getInt(XMLPath const& path, int nDefault)
+{
+  return (getIntDefault(path, nDefault));
+}
+
+double SimpleXMLTransfer::getDouble(XMLPath const& path, double dDefault)
+{
+  return (getDoubleDefault(path, dDefault));
+}
+
+template <class Path>
+std::string SimpleXMLTransfer::getStringDefault(Path const& path, std::string stringDefault)
+{
+  const std::string* val = findValue(path);
+
+  if (val == NULL)
   {
-    SimpleXMLTransfer *item = getChild(path.substr(0, pos));
-    return (item->attributeAsDouble(path.substr(pos + 1)));
+    makeSureAttributeExists(pathString(path), stringDefault.c_str());
+    return(stringDefault);
   }
-  else
+  return (*val);
+}
+
+template <class Path>
+int SimpleXMLTransfer::getIntDefault(Path const& path, int nDefault)
+{
+  const std::string* val = findValue(path);
+
+  if (val == NULL)
+  {
+    makeSureAttributeExists(pathString(path), itoStr(nDefault, ' ', 1).c_str());
+    return(nDefault);
+  }
+
+  // as before: if the value can't be converted, the default is used
+  try
   {
-    return (attributeAsDouble(path));
+    return (convToInt(*val));
+  }
+  catch (XMLException e)
+  {
+    return(nDefault);
   }
 }
 
-std::string SimpleXMLTransfer::getString(std::string path, std::string stringDefault)
+template <class Path>
+double SimpleXMLTransfer::getDoubleDefault(Path const& path, double dDefault)
 {
-  try
+  const std::string* val = findValue(path);
+
+  if (val == NULL)
   {
-    std::string::size_type pos = path.rfind('.');
+    makeSureAttributeExists(pathString(path), doubleToString(dDefault).c_str());
+    return(dDefault);
+  }
 
-    if (pos != std::string::npos)
-    {
-      SimpleXMLTransfer *item = getChild(path.substr(0, pos));
-      return (item->attribute(path.substr(pos + 1)));
-    }
-    else
-    {
-      return (attribute(path));
-    }
+  // as before: if the value can't be converted, the default is used
+  try
+  {
+    return (convToDouble(*val));
   }
   catch (XMLException e)
   {
-    makeSureAttributeExists(path, stringDefault.c_str());
-    return(stringDefault);
+    return(dDefault);
   }
 }
 
-/**
- * Schnellfunktion zum Zugriff auf ein Attribut dieses Elements oder von
- * einem Kindeskind.
- *
- * Mgliche Notation fr einen Integer-Wert: dezimal, hexadezimal mit
- * vorangestelltem '0x' oder binr mit vorangestelltem '0b'.
- */
-int SimpleXMLTransfer::getInt(std::string path, int nDefault)
+template <class Path>
+const std::string* SimpleXMLTransfer::findValue(Path const& path)
 {
-  try
+  SimpleXMLTransfer* item = findElement(path, false);
+
+  if (item == NULL)
+    return(NULL);
+
+  int index = item->indexOfLeaf(path);
+  if (index < 0)
+    return(NULL);
+
+  return (&item->attrVal[index]);
+}
+
+template <class Path>
+std::string const& SimpleXMLTransfer::value(Path const& path)
+{
+  SimpleXMLTransfer* item  = findElement(path, true);
+  int                index = item->indexOfLeaf(path);
+
+  if (index < 0)
+    throw XMLException("No Attribute named " + leafName(path) + " in " + item->getName());
+
+  return (item->attrVal[index]);
+}
+
+SimpleXMLTransfer* SimpleXMLTransfer::findElement(XMLPath const& path, bool fThrow)
+{
+  SimpleXMLTransfer* item = this;
+
+  for (unsigned int n = 0; n < path.elements.size(); n++)
   {
-    std::string::size_type pos = path.rfind('.');
+    const std::string* name = path.elements[n];
+    SimpleXMLTransfer* next = NULL;
 
-    if (pos != std::string::npos)
+    for (unsigned int i = 0; i < item->children.size(); i++)
     {
-      SimpleXMLTransfer *item = getChild(path.substr(0, pos));
-      return (item->attributeAsInt(path.substr(pos + 1)));
+      if (item->children[i]->myName == name)
+      {
+        next = item->children[i];
+        break;
+      }
     }
-    else
+
+    if (next == NULL)
     {
-      return (attributeAsInt(path));
+      if (fThrow)
+        throw XMLException("No child named " + *name + " in " + item->getName() +
+                           " (" + path.str() + ")");
+      return(NULL);
     }
+    item = next;
   }
-  catch (XMLException e)
-  {
-    makeSureAttributeExists(path, itoStr(nDefault, ' ', 1).c_str());
-    return(nDefault);
-  }
+
+  return (item);
 }
 
-/**
- * Schnellfunktion zum Zugriff auf ein Attribut dieses Elements oder von
- * einem Kindeskind.
- */
-double SimpleXMLTransfer::getDouble(std::string path, double dDefault)
+SimpleXMLTransfer* SimpleXMLTransfer::findElement(std::string const& path, bool fThrow)
 {
-  try
+  SimpleXMLTransfer*     item  = this;
+  std::string::size_type start = 0;
+  std::string::size_type pos;
+
+  // compare the parts of the path in place, without copying them
+  while ((pos = path.find('.', start)) != std::string::npos)
   {
-    std::string::size_type pos = path.rfind('.');
+    std::string::size_type len  = pos - start;
+    SimpleXMLTransfer*     next = NULL;
 
-    if (pos != std::string::npos)
+    for (unsigned int i = 0; i < item->children.size(); i++)
     {
-      SimpleXMLTransfer *item = getChild(path.substr(0, pos));
-      return (item->attributeAsDouble(path.substr(pos + 1)));
+      std::string const& name = *item->children[i]->myName;
+
+      if (name.length() == len && path.compare(start, len, name) == 0)
+      {
+        next = item->children[i];
+        break;
+      }
     }
-    else
+
+    if (next == NULL)
     {
-      return (attributeAsDouble(path));
+      if (fThrow)
+        throw XMLException("No child named " + path.substr(start, len) + " in " +
+                           item->getName() + " (" + path + ")");
+      return(NULL);
     }
+    item  = next;
+    start = pos + 1;
   }
-  catch (XMLException e)
-  {
-    makeSureAttributeExists(path, doubleToString(dDefault).c_str());
-    return(dDefault);
-  }
+
+  return (item);
+}
+
+int SimpleXMLTransfer::indexOfLeaf(XMLPath const& path) const
+{
+  return (indexOfAttribute(path.attr));
+}
+
+int SimpleXMLTransfer::indexOfLeaf(std::string const& path) const
+{
+  std::string::size_type pos = path.rfind('.');
+  std::string::size_type start = (pos == std::string::npos) ? 0 : pos + 1;
+
+  for (unsigned int i = 0; i < attrName.size(); i++)
+    if (path.compare(start, std::string::npos, *attrName[i]) == 0)
+      return (i);
+
+  return (-1);
+}
+
+std::string SimpleXMLTransfer::leafName(XMLPath const& path)
+{
+  return (*path.attr);
+}
+
+std::string SimpleXMLTransfer::leafName(std::string const& path)
+{
+  std::string::size_type pos = path.rfind('.');
+
+  return ((pos == std::string::npos) ? path : path.substr(pos + 1));
 }
 
 #if 1 == 2
@@ -931,7 +1225,7 @@ SimpleXMLTransfer::addAttribute(std::string attributeName,
 {
   //       System.out.println("SimpleXMLTransfer.addAttribute(" + attributeName + ", " + attributeVal + ")");
   //
-  attrName.push_back(attributeName);
+  attrName.push_back(XMLPath::intern(attributeName));
   attrVal.push_back(attributeVal);
 }
 
@@ -1005,7 +1299,7 @@ void SimpleXMLTransfer::print(std::ostream & out, int nIndent)
       for (unsigned int i = 0; i < attrName.size(); i++)
       {
         aVal = convToXML(attrVal[i]);
-        aName = attrName[i];
+        aName = *attrName[i];
 
         if (nSpalte + aVal.length() + aName.length() > 80)
         {
@@ -1192,7 +1486,7 @@ int SimpleXMLTransfer::indexOfAttribute(std::string attr) const
   int index = -1;
 
   for (unsigned int i = 0; i < attrName.size() && index == -1; i++)
-    if (attr.compare(attrName[i]) == 0)
+    if (attr.compare(*attrName[i]) == 0)
       index = i;
 
 #if DEBUG == 1
@@ -1202,6 +1496,15 @@ int SimpleXMLTransfer::indexOfAttribute(std::string attr) const
   return (index);
 }
 
+int SimpleXMLTransfer::indexOfAttribute(const std::string* attr) const
+{
+  for (unsigned int i = 0; i < attrName.size(); i++)
+    if (attrName[i] == attr)
+      return (i);
+
+  return (-1);
+}
+
 double SimpleXMLTransfer::convToDouble(std::string value)
 {
   char*       ptr;
@@ -1365,7 +1668,7 @@ int SimpleXMLTransfer::indexOfChild(std::string child)
   int size  = children.size();
 
   for (int i = 0; i < size && index == -1; i++)
-    if (child.compare(children[i]->getName()) == 0)
+    if (child.compare(*children[i]->myName) == 0)
       index = i;
 
   return (index);
@@ -1383,13 +1686,13 @@ int SimpleXMLTransfer::indexOfChild(std::string child, int nStartIdx)
   int size  = children.size();
 
   for (int i = nStartIdx; i < size && index == -1; i++)
-    if (child.compare(children[i]->getName()) == 0)
+    if (child.compare(*children[i]->myName) == 0)
       index = i;
 
   if (index < 0)
   {
     for (int i = 0; i < nStartIdx && index == -1; i++)
-      if (child.compare(children[i]->getName()) == 0)
+      if (child.compare(*children[i]->myName) == 0)
         index = i;
   }
 
@@ -1459,7 +1762,7 @@ void SimpleXMLTransfer::replaceChild(SimpleXMLTransfer* XMLPtrOld,
  */
 void SimpleXMLTransfer::setName(std::string name)
 {
-  myName = name;
+  myName = XMLPath::intern(name);
 }
 
 /**
@@ -1619,15 +1922,15 @@ bool SimpleXMLTransfer::equals(SimpleXMLTransfer* item)
     if (item->indexOfAttribute(attrName[n]) == -1)
     {
 #if DEBUG == 2
-      printf("No attribute %s\n", attrName[n].c_str());
+      printf("No attribute %s\n", attrName[n]->c_str());
 #endif
       return(false);
     }
 
-    if (item->attribute(attrName[n]).compare(attrVal[n]))
+    if (item->attribute(*attrName[n]).compare(attrVal[n]))
     {
 #if DEBUG == 2
-      printf("%s: %s != %s\n", attrName[n].c_str(), attrVal[n].c_str(), item->attribute(attrName[n]).c_str());
+      printf("%s: %s != %s\n", attrName[n]->c_str(), attrVal[n].c_str(), item->attribute(*attrName[n]).c_str());
 #endif
       return(false);
     }
@@ -1699,15 +2002,15 @@ bool SimpleXMLTransfer::equalsOrdered(SimpleXMLTransfer* item)
     if (item->indexOfAttribute(attrName[n]) == -1)
     {
 #if DEBUG == 2
-      printf("No attribute %s\n", attrName[n].c_str());
+      printf("No attribute %s\n", attrName[n]->c_str());
 #endif
       return(false);
     }
 
-    if (item->attribute(attrName[n]).compare(attrVal[n]))
+    if (item->attribute(*attrName[n]).compare(attrVal[n]))
     {
 #if DEBUG == 2
-      printf("%s: %s != %s\n", attrName[n].c_str(), attrVal[n].c_str(), item->attribute(attrName[n]).c_str());
+      printf("%s: %s != %s\n", attrName[n]->c_str(), attrVal[n].c_str(), item->attribute(*attrName[n]).c_str());
 #endif
       return(false);
     }
@@ -1749,7 +2052,7 @@ std::string SimpleXMLTransfer::attributeName(unsigned int index)
   if (index > attrName.size())
     throw XMLException("No such attribute in " + getName());
   else
-    return(attrName[index]);
+    return(*attrName[index]);
 }
 
 std::string SimpleXMLTransfer::attributeVal(unsigned int index)
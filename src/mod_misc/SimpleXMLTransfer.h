@@ -76,6 +76,39 @@ class XMLException
 
 class SimpleXMLTransfer;
 
+/** \brief Precompiled path to an attribute.
+ *
+ *  A path like <code>aero.misc.CG_arm</code> is split into its parts and
+ *  their names are looked up (see intern()) once, when the XMLPath is
+ *  created. Looking it up in an element afterwards doesn't allocate and
+ *  only compares pointers. Paths used repeatedly (in a loop or for every
+ *  model file loaded) should be kept, e.g. as static constants.
+ */
+class XMLPath
+{
+  friend class SimpleXMLTransfer;
+
+  public:
+    explicit XMLPath(std::string path);
+
+    /**
+     * The path as given to the constructor.
+     */
+    std::string const& str() const { return(path); };
+
+    /**
+     * Returns the one and only copy of <code>name</code>: every element
+     * and attribute name is stored only once, so names can be compared
+     * by comparing pointers. The copies are never freed. Thread safe.
+     */
+    static const std::string* intern(std::string const& name);
+
+  private:
+    std::vector<const std::string*> elements;   ///< children's children
+    const std::string*              attr;
+    std::string                     path;
+};
+
 /** \brief Simple XML parser class.
  *
  * This class should correspond to the Java-class jCoCo.SimpleXMLTransfer.
@@ -314,6 +347,16 @@ class SimpleXMLTransfer
      */
     double getDouble(std::string path, double dDefault);
 
+    /// @name Like the functions above, for a precompiled path
+    //@{
+    std::string getString(XMLPath const& path);
+    int         getInt   (XMLPath const& path);
+    double      getDouble(XMLPath const& path);
+    std::string getString(XMLPath const& path, std::string stringDefault);
+    int         getInt   (XMLPath const& path, int nDefault);
+    double      getDouble(XMLPath const& path, double dDefault);
+    //@}
+
 #if 1 == 2
 
     /**
@@ -464,22 +507,73 @@ class SimpleXMLTransfer
    std::string attributeVal (unsigned int index);
       
   private:
-    std::string                          myName;
+    const std::string*                   myName;    ///< see XMLPath::intern()
     std::vector<SimpleXMLTransfer*>      children;
-    std::vector<std::string>             attrName;
+    std::vector<const std::string*>      attrName;  ///< see XMLPath::intern()
     std::vector<std::string>             attrVal;
     std::vector<std::string>             comment;
     std::vector<int>                     commentPos;
     std::string*                         content;
 
     /**
-     * Only for internal purposes!
+     * Only for internal purposes! Reads from a Source (see
+     * SimpleXMLTransfer.cpp), <code>data</code> is the first character
+     * of the element's name or -2 to start outside of an element.
+     */
+    template <class Source> void readSource(Source& src,
+                                            int     data);
+
+    template <class Source> SimpleXMLTransfer(Source& src,
+                                              int     data);
+
+    /**
+     * Reads all of <code>in</code> and parses it.
+     */
+    void readAll(std::istream& in);
+
+    /**
+     * Index of the attribute <code>attr</code> (which has been interned)
+     * or -1.
+     */
+    int indexOfAttribute(const std::string* attr) const;
+
+    /// @name Looking up paths
+    /// Path is either an XMLPath or a std::string like "a.b.c".
+    //@{
+
+    /**
+     * The element holding the attribute <code>path</code> leads to.
+     * Returns NULL or throws an XMLException if it doesn't exist.
+     */
+    SimpleXMLTransfer* findElement(XMLPath const& path, bool fThrow);
+    SimpleXMLTransfer* findElement(std::string const& path, bool fThrow);
+
+    /**
+     * Index of the attribute at the end of <code>path</code> or -1
+     */
+    int indexOfLeaf(XMLPath const& path) const;
+    int indexOfLeaf(std::string const& path) const;
+
+    static std::string leafName(XMLPath const& path);
+    static std::string leafName(std::string const& path);
+    static std::string const& pathString(XMLPath const& path) { return(path.str()); };
+    static std::string const& pathString(std::string const& path) { return(path); };
+
+    /**
+     * The value of the attribute <code>path</code> leads to or NULL.
+     */
+    template <class Path> const std::string* findValue(Path const& path);
+
+    /**
+     * Like findValue(), but throws an XMLException instead of returning
+     * NULL.
      */
-    void readStream(std::istream&  in,
-                    int            data);
+    template <class Path> std::string const& value(Path const& path);
 
-    SimpleXMLTransfer(std::istream&  in,
-                      int            data);
+    template <class Path> std::string getStringDefault(Path const& path, std::string stringDefault);
+    template <class Path> int         getIntDefault   (Path const& path, int nDefault);
+    template <class Path> double      getDoubleDefault(Path const& path, double dDefault);
+    //@}
 
 
     /**
@@ -25,9 +25,31 @@
 
 unsigned int CRRC_Random::uRandState16;
 unsigned int CRRC_Random::uRandState32;
+bool         CRRC_Random::fDeterministic = false;
+unsigned int CRRC_Random::uSeed = 0;
+
+void CRRC_Random::setSeed(unsigned int uNewSeed)
+{
+  fDeterministic = true;
+  uSeed          = uNewSeed;
+  uRandState16   = 0;
+  uRandState32   = uNewSeed;
+  srand(uNewSeed);
+}
+
+unsigned int CRRC_Random::getSeed()
+{
+  if (fDeterministic)
+    return(uSeed);
+  else
+    return(::rand());
+}
 
 void CRRC_Random::insertData(int nData)
 {
+  if (fDeterministic)
+    return;
+  
   uRandState16 += nData;
   
   const int a = 1103515245;
@@ -50,13 +72,13 @@ void CRRC_Random::insertData(int nData)
   srand(uRandState32);
 }
 
-RandGauss::RandGauss()
+RandGauss::RandGauss() : stream_(NULL)
 {
   SetSigmaAndMean( 1.0, 0.0 );
   phase = 0.0;
 }
 
-RandGauss::RandGauss( double sigma, double mean )
+RandGauss::RandGauss( double sigma, double mean ) : stream_(NULL)
 {
   SetSigmaAndMean( sigma, mean );
   phase = 0.0;
@@ -72,8 +94,16 @@ double RandGauss::Get()
   {
     do
     {
-      U1 = (double)rand() / RAND_MAX;
-      U2 = (double)rand() / RAND_MAX;
+      if (stream_)
+      {
+        U1 = (double)stream_->rand() / CRRC_RandomStream::max();
+        U2 = (double)stream_->rand() / CRRC_RandomStream::max();
+      }
+      else
+      {
+        U1 = (double)rand() / RAND_MAX;
+        U2 = (double)rand() / RAND_MAX;
+      }
 
       V1 = 2 * U1 - 1;
       V2 = 2 * U2 - 1;
@@ -23,6 +23,7 @@
 #define CRRC_RAND
 
 #include <stdlib.h>
+#include <stdint.h>
 
 /**
  * This is just a wrapper around standard functions rand and srand which
@@ -70,11 +71,32 @@ class CRRC_Random
    
    /**
     * Call this using some random data you have, anytime you want to.
+    * Does nothing in deterministic mode.
     */
    static void insertData(int nData);
    
+   /**
+    * Switches to deterministic mode: the generator is seeded with 
+    * <code>uNewSeed</code> and insertData() doesn't change it anymore.
+    * Simulations seed their own streams (CRRC_RandomStream) with 
+    * getSeed() instead of some random value, so identical inputs lead 
+    * to identical results.
+    */
+   static void setSeed(unsigned int uNewSeed);
+   
+   static bool isDeterministic() { return(fDeterministic); };
+   
+   /**
+    * Seed for a new CRRC_RandomStream: the seed given to setSeed() in
+    * deterministic mode, a random value otherwise.
+    */
+   static unsigned int getSeed();
+   
   private:
    
+   static bool         fDeterministic;
+   static unsigned int uSeed;
+   
    /**
     * random state
     */
@@ -83,6 +105,44 @@ class CRRC_Random
    
 };
 
+/**
+ * A random number generator with its own state, so every simulation
+ * (windfield, gust model, ...) can have its own sequence which doesn't 
+ * depend on anything else using random numbers. The sequence only depends
+ * on the seed and is the same on every platform.
+ *
+ * It is a 64 bit linear congruential generator (constants by D. Knuth),
+ * returning the upper 31 bits.
+ */
+class CRRC_RandomStream
+{
+  public:
+  
+    CRRC_RandomStream(unsigned int uSeed = 1) { seed(uSeed); };
+    
+    void seed(unsigned int uSeed) { state = uSeed; rand(); };
+    
+    /**
+     * Returns a random number between 0 and max().
+     */
+    inline int rand()
+    {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return((int)(state >> 33));
+    };
+    
+    static inline int max() { return(0x7FFFFFFF); };
+    
+    /**
+     * Returns a random number in [0, 1).
+     */
+    inline double uniform() { return(rand() / (max() + 1.0)); };
+    
+  private:
+  
+    uint64_t state;
+};
+
 /**
  * Returns random numbers with normal (gaussian) distribution, 
  * possibly of specified sigma and average.
@@ -90,6 +150,8 @@ class CRRC_Random
  * Thanks to rhoads@paul.rutgers.edu for this code!
  * http://remus.rutgers.edu/~rhoads/Code/code.html
  * 
+ * Uses rand() unless a stream has been set with SetStream().
+ * 
  * @author Jens W. Wulf
  */
 class RandGauss
@@ -109,12 +171,26 @@ class RandGauss
     inline void SetSigmaAndMean( double sigma, double mean )
       { sigma_ = sigma; mean_ = mean; };
     
+    /**
+     * Take uniform random numbers from <code>stream</code> (NULL: rand()).
+     */
+    inline void SetStream(CRRC_RandomStream* stream)
+      { stream_ = stream; };
+    
+    /**
+     * Forget the second value of the last pair, so the next values only
+     * depend on the stream.
+     */
+    inline void Reset()
+      { phase = 0; };
+    
     double Get();
     
   private:
   
     double sigma_, mean_, V2, fac;
     int phase;
+    CRRC_RandomStream* stream_;
 };
 
 #endif
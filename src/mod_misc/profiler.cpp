@@ -0,0 +1,380 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#include "profiler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WIN32
+# include <windows.h>
+#else
+# include <sys/time.h>
+#endif
+
+#if defined(_MSC_VER)
+# define CRRC_THREAD_LOCAL __declspec(thread)
+#else
+# define CRRC_THREAD_LOCAL __thread
+#endif
+
+namespace
+{
+  /**
+   * One measured scope
+   */
+  struct Event
+  {
+    const char*        name;
+    unsigned long long start;   ///< [us]
+    unsigned int       dur;     ///< [us]
+    unsigned int       depth;   ///< 0: outermost scope
+  };
+
+  /**
+   * What one thread recorded. Only written by this thread.
+   */
+  struct ThreadLog
+  {
+    char               name[32];
+    long               tid;     ///< index into threads
+    Event*             events;
+    unsigned long      count;   ///< number of events recorded so far
+    unsigned int       depth;   ///< of the scope being entered
+    volatile long      fEnded;  ///< the thread has ended, see endThread()
+    unsigned long long tEnded;  ///< when it ended
+  };
+
+  /**
+   * Number of events kept per thread (the latest ones), must be a power
+   * of two. At about 2000 events per second, this is more than a minute.
+   */
+  const unsigned long LOG_SIZE = 1 << 17;
+
+  /**
+   * Number of logs. When all of them are taken, a new thread takes over
+   * the log of the thread which has ended first.
+   */
+  const int MAX_THREADS = 16;
+
+  ThreadLog*    threads[MAX_THREADS];
+  volatile long nThreads = 0;
+  volatile long fTooMany = 0;   ///< the overflow has been reported
+
+  CRRC_THREAD_LOCAL ThreadLog* thisThread = NULL;
+  ThreadLog*                   mainThread = NULL;
+
+  std::string        traceFile;
+  unsigned long long t0;
+
+  /// @name Main thread only
+  //@{
+  unsigned long                     frameStart   = 0;
+  unsigned long long                frameStartT  = 0;
+  double                            lastFrameMs  = 0;
+  std::vector<CRRC_Profiler::Stage> lastFrame;
+  //@}
+
+  /**
+   * Sets <code>*flag</code> from <code>from</code> to <code>to</code>,
+   * returns false if it wasn't <code>from</code>.
+   */
+  bool exchange(volatile long* flag, long from, long to)
+  {
+#if defined(_MSC_VER)
+    return(InterlockedCompareExchange(flag, to, from) == from);
+#else
+    return(__sync_bool_compare_and_swap(flag, from, to));
+#endif
+  }
+
+  /**
+   * Takes over the log of the thread which has ended first. Its events
+   * are thrown away. Returns NULL if no thread has ended.
+   */
+  ThreadLog* reuseThreadLog()
+  {
+    while (true)
+    {
+      ThreadLog* oldest = NULL;
+
+      for (int n = 0; n < MAX_THREADS; n++)
+      {
+        ThreadLog* log = threads[n];
+
+        if (log != NULL && log->fEnded &&
+            (oldest == NULL || log->tEnded < oldest->tEnded))
+          oldest = log;
+      }
+      if (oldest == NULL)
+        return(NULL);
+
+      // another thread may be taking it right now
+      if (exchange(&oldest->fEnded, 1, 0))
+      {
+        oldest->count = 0;
+        oldest->depth = 0;
+        return(oldest);
+      }
+    }
+  }
+
+  /**
+   * The log of the calling thread, created on first use. Returns NULL if
+   * profiling is disabled or too many threads are running.
+   */
+  ThreadLog* getThreadLog()
+  {
+    if (thisThread != NULL || !CRRC_Profiler::isEnabled())
+      return(thisThread);
+
+    ThreadLog* log = NULL;
+
+    if (nThreads < MAX_THREADS)
+    {
+#if defined(_MSC_VER)
+      long n = InterlockedIncrement(&nThreads) - 1;
+#else
+      long n = __sync_fetch_and_add(&nThreads, 1);
+#endif
+      if (n < MAX_THREADS)
+      {
+        log = new ThreadLog;
+        log->tid    = n;
+        log->events = new Event[LOG_SIZE];
+        log->count  = 0;
+        log->depth  = 0;
+        log->fEnded = 0;
+        log->tEnded = 0;
+        threads[n]  = log;
+      }
+    }
+    if (log == NULL)
+      log = reuseThreadLog();
+    if (log == NULL)
+    {
+      if (exchange(&fTooMany, 0, 1))
+        fprintf(stderr, "Profiler: more than %d threads at once, "
+                        "not recording the others\n", MAX_THREADS);
+      return(NULL);
+    }
+
+    sprintf(log->name, "thread %ld", log->tid);
+    thisThread = log;
+    return(log);
+  }
+
+  /**
+   * Writes <code>s</code> as a JSON string
+   */
+  void putString(FILE* f, const char* s)
+  {
+    fputc('"', f);
+    for (; *s; s++)
+    {
+      if (*s == '"' || *s == '\\')
+        fputc('\\', f);
+      if ((unsigned char)*s >= ' ')
+        fputc(*s, f);
+    }
+    fputc('"', f);
+  }
+}
+
+bool CRRC_Profiler::fEnabled = false;
+
+
+void CRRC_Profiler::enable(std::string filename)
+{
+  traceFile = filename;
+  t0        = now();
+  fEnabled  = true;
+  setThreadName("main");
+  mainThread = thisThread;
+}
+
+void CRRC_Profiler::setThreadName(const char* name)
+{
+  if (!fEnabled)
+    return;
+
+  ThreadLog* log = getThreadLog();
+
+  if (log != NULL)
+  {
+    strncpy(log->name, name, sizeof(log->name)-1);
+    log->name[sizeof(log->name)-1] = '\0';
+  }
+}
+
+void CRRC_Profiler::endThread()
+{
+  ThreadLog* log = thisThread;
+
+  // the loaders run their thread function on the main thread if they
+  // can't start a thread
+  if (log == NULL || log == mainThread)
+    return;
+
+  thisThread  = NULL;
+  log->tEnded = now();
+#if defined(_MSC_VER)
+  InterlockedExchange(&log->fEnded, 1);
+#else
+  __sync_lock_test_and_set(&log->fEnded, 1);
+#endif
+}
+
+unsigned long long CRRC_Profiler::now()
+{
+#ifdef WIN32
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER        cnt;
+
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&cnt);
+  return((unsigned long long)(cnt.QuadPart * 1000000.0 / freq.QuadPart));
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return((unsigned long long)tv.tv_sec * 1000000 + tv.tv_usec);
+#endif
+}
+
+void CRRC_Profiler::enter()
+{
+  ThreadLog* log = getThreadLog();
+
+  if (log != NULL)
+    log->depth++;
+}
+
+void CRRC_Profiler::record(const char* name, unsigned long long start)
+{
+  unsigned long long end = now();
+  ThreadLog*         log = thisThread;
+
+  if (log == NULL)
+    return;
+
+  Event& ev = log->events[log->count & (LOG_SIZE-1)];
+  log->depth--;
+  ev.name  = name;
+  ev.start = start;
+  ev.dur   = (unsigned int)(end - start);
+  ev.depth = log->depth;
+  log->count++;
+}
+
+void CRRC_Profiler::frameMark()
+{
+  ThreadLog*         log = thisThread;
+  unsigned long long t   = now();
+
+  if (!fEnabled || log == NULL)
+    return;
+
+  // don't look at events which have been overwritten already
+  if (log->count - frameStart > LOG_SIZE)
+    frameStart = log->count - LOG_SIZE;
+
+  lastFrame.clear();
+  for (unsigned long i = frameStart; i < log->count; i++)
+  {
+    const Event& ev = log->events[i & (LOG_SIZE-1)];
+
+    if (ev.depth != 0)
+      continue;
+
+    unsigned int n = 0;
+    while (n < lastFrame.size() && strcmp(lastFrame[n].name, ev.name) != 0)
+      n++;
+    if (n == lastFrame.size())
+    {
+      Stage s;
+      s.name = ev.name;
+      s.ms   = 0;
+      lastFrame.push_back(s);
+    }
+    lastFrame[n].ms += ev.dur * 0.001;
+  }
+
+  if (frameStartT != 0)
+    lastFrameMs = (t - frameStartT) * 0.001;
+  frameStart  = log->count;
+  frameStartT = t;
+}
+
+const std::vector<CRRC_Profiler::Stage>& CRRC_Profiler::getLastFrame(double& frame_ms)
+{
+  frame_ms = lastFrameMs;
+  return(lastFrame);
+}
+
+bool CRRC_Profiler::writeTrace()
+{
+  if (!fEnabled || traceFile.empty())
+    return(true);
+
+  FILE* f = fopen(traceFile.c_str(), "w");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Unable to write trace to %s\n", traceFile.c_str());
+    return(false);
+  }
+
+  long n = nThreads;
+  if (n > MAX_THREADS)
+    n = MAX_THREADS;
+
+  fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  for (long tid = 0; tid < n; tid++)
+  {
+    ThreadLog* log = threads[tid];
+
+    if (log == NULL)
+      continue;
+
+    fprintf(f, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%ld,\"args\":{\"name\":",
+            first ? "" : ",\n", tid);
+    putString(f, log->name);
+    fprintf(f, "}}");
+    first = false;
+
+    unsigned long i = 0;
+    if (log->count > LOG_SIZE)
+      i = log->count - LOG_SIZE;
+    for (; i < log->count; i++)
+    {
+      const Event& ev = log->events[i & (LOG_SIZE-1)];
+
+      fprintf(f, ",\n{\"ph\":\"X\",\"name\":");
+      putString(f, ev.name);
+      fprintf(f, ",\"pid\":1,\"tid\":%ld,\"ts\":%llu,\"dur\":%u}",
+              tid, ev.start - t0, ev.dur);
+    }
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+
+  printf("Wrote trace to %s\n", traceFile.c_str());
+  return(true);
+}
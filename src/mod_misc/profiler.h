@@ -0,0 +1,140 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#ifndef CRRC_PROFILER_H
+#define CRRC_PROFILER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Measures how long the stages of a frame take.
+ *
+ * Code to be measured is wrapped in a scope with CRRC_PROFILE("name").
+ * Every thread records into a ring buffer of its own, so recording doesn't
+ * need a lock. Unless enabled (command line option -p), a scope costs a
+ * single test of a flag and no buffer is allocated. There are buffers for
+ * a limited number of threads; threads call endThread() before they end,
+ * so a new thread can reuse their buffer.
+ *
+ * When the program ends, the recorded events can be written to a file in
+ * the trace event format of Chrome (load it in chrome://tracing or
+ * ui.perfetto.dev). In addition, the main loop marks the end of each frame
+ * (frameMark()); the time spent in its outermost scopes during the last
+ * frame is available from getLastFrame(), e.g. to draw it.
+ *
+ * Names passed to the scopes have to be string literals (or live until
+ * the end of the program), as only the pointer is recorded.
+ */
+class CRRC_Profiler
+{
+  public:
+    /**
+     * Time spent in one stage of a frame
+     */
+    struct Stage
+    {
+      const char* name;
+      double      ms;
+    };
+
+    /**
+     * Starts recording. The calling thread is named "main". The trace is
+     * written to <code>filename</code> by writeTrace(), if it isn't empty.
+     */
+    static void enable(std::string filename);
+
+    static inline bool isEnabled() { return(fEnabled); };
+
+    /**
+     * Names the calling thread in the trace. Does nothing unless enabled.
+     */
+    static void setThreadName(const char* name);
+
+    /**
+     * Call when a thread which has recorded events ends. Its log may then
+     * be taken over by a new thread once all logs are in use.
+     */
+    static void endThread();
+
+    /**
+     * Call at the end of every frame on the main thread.
+     */
+    static void frameMark();
+
+    /**
+     * Outermost stages recorded on the main thread during the last frame,
+     * in the order they first occurred, and the duration of the frame.
+     */
+    static const std::vector<Stage>& getLastFrame(double& frame_ms);
+
+    /**
+     * Writes the trace to the file given to enable(). The other threads
+     * should have been stopped. Returns false if it couldn't be written.
+     */
+    static bool writeTrace();
+
+    /// @name Used by CRRC_ProfileScope
+    //@{
+    static unsigned long long now();
+    static void record(const char* name, unsigned long long start);
+    static void enter();
+    //@}
+
+  private:
+    static bool fEnabled;
+};
+
+/**
+ * Records the time from its construction to its destruction.
+ */
+class CRRC_ProfileScope
+{
+  public:
+    inline CRRC_ProfileScope(const char* name) : name(NULL)
+    {
+      if (CRRC_Profiler::isEnabled())
+      {
+        this->name = name;
+        CRRC_Profiler::enter();
+        start = CRRC_Profiler::now();
+      }
+    };
+
+    inline ~CRRC_ProfileScope()
+    {
+      if (name != NULL)
+        CRRC_Profiler::record(name, start);
+    };
+
+  private:
+    const char*        name;
+    unsigned long long start;
+};
+
+#define CRRC_PROFILE_CAT2(a, b) a ## b
+#define CRRC_PROFILE_CAT(a, b)  CRRC_PROFILE_CAT2(a, b)
+
+/**
+ * Measures the rest of the enclosing block.
+ */
+#define CRRC_PROFILE(name) \
+  CRRC_ProfileScope CRRC_PROFILE_CAT(crrc_profile_, __LINE__)(name)
+
+#endif
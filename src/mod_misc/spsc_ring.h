@@ -0,0 +1,101 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#ifndef SPSC_RING_H
+# define SPSC_RING_H
+
+# include <cstddef>
+
+# if defined(_MSC_VER)
+#  include <windows.h>
+# endif
+
+/**
+ * A queue of fixed size to pass values from one thread (the producer) to
+ * another one (the consumer) without locking.
+ *
+ * The producer only writes <code>head</code>, the consumer only writes
+ * <code>tail</code>. A slot is filled before <code>head</code> is advanced
+ * past it and read before <code>tail</code> is advanced past it, with a
+ * memory barrier in between, so neither side ever sees a half written
+ * value. If the queue is full, Push() fails; the producer doesn't wait.
+ *
+ * There must be only one producer and one consumer at a time. N has to be
+ * a power of two.
+ */
+template <class T, unsigned int N> class SPSCRing
+{
+  public:
+    SPSCRing() : head(0), tail(0) {};
+
+    /**
+     * Appends a copy of <code>val</code>. Returns false if the queue is
+     * full. Producer only.
+     */
+    bool Push(const T& val)
+    {
+      unsigned int h = head;
+
+      if (h - tail >= N)
+        return(false);
+      slot[h & (N-1)] = val;
+      Barrier();
+      head = h + 1;
+      return(true);
+    };
+
+    /**
+     * The oldest value or NULL if the queue is empty. The value stays
+     * valid until Pop(). Consumer only.
+     */
+    const T* Peek()
+    {
+      unsigned int t = tail;
+
+      if (head == t)
+        return(NULL);
+      Barrier();
+      return(&slot[t & (N-1)]);
+    };
+
+    /**
+     * Removes the oldest value. Consumer only, call after Peek() returned
+     * a value.
+     */
+    void Pop()
+    {
+      Barrier();
+      tail = tail + 1;
+    };
+
+  private:
+    static void Barrier()
+    {
+# if defined(_MSC_VER)
+      MemoryBarrier();
+# else
+      __sync_synchronize();
+# endif
+    };
+
+    T                     slot[N];
+    volatile unsigned int head;
+    volatile unsigned int tail;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#ifndef TRIPLE_BUFFER_H
+# define TRIPLE_BUFFER_H
+
+# if defined(_MSC_VER)
+#  include <windows.h>
+# endif
+
+/**
+ * Hands the latest value of something from one thread (the writer) to
+ * another one (the reader) without locking.
+ *
+ * There are three slots: the writer fills one, the reader reads another one
+ * and the third one holds the latest value which has been published, but
+ * not yet picked up. Publishing and picking up are atomic exchanges of the
+ * slot index, so neither side ever waits for the other one. The reader
+ * always gets the latest complete value; values published in between are
+ * dropped.
+ *
+ * There must be only one writer and one reader at a time.
+ */
+template <class T> class TripleBuffer
+{
+  public:
+    TripleBuffer() : back(0), middle(1), front(2) {};
+
+    /**
+     * The slot the writer fills. It belongs to the writer until Publish().
+     */
+    T& Back() { return(slot[back]); };
+
+    /**
+     * Makes the contents of Back() the latest value. Afterwards, Back()
+     * returns another slot (with old contents).
+     */
+    void Publish()
+    {
+      back = Exchange(&middle, back | FRESH) & INDEX;
+    };
+
+    /**
+     * Picks up the latest value, if a new one has been published since the
+     * last call. Returns true in this case.
+     */
+    bool Update()
+    {
+      if ((middle & FRESH) == 0)
+        return(false);
+      front = Exchange(&middle, front) & INDEX;
+      return(true);
+    };
+
+    /**
+     * The slot the reader reads, valid until the next Update().
+     */
+    const T& Front() { return(slot[front]); };
+
+  private:
+    enum { INDEX = 3, FRESH = 4 };
+
+    static int Exchange(volatile int* dst, int val)
+    {
+# if defined(_MSC_VER)
+      return(InterlockedExchange((volatile LONG*)dst, val));
+# else
+      // __sync_lock_test_and_set() is only an acquire barrier
+      __sync_synchronize();
+      return(__sync_lock_test_and_set(dst, val));
+# endif
+    };
+
+    T            slot[3];
+    int          back;
+    volatile int middle;
+    int          front;
+};
+
+#endif
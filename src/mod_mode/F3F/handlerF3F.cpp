@@ -141,6 +141,10 @@ HandlerF3F::~HandlerF3F()
   {
     Global::soundserver->stopChannel(start_sound_id);
   }
+  if (Global::soundserver != NULL)
+  {
+    Global::soundserver->clearSampleCache();
+  }
   delete pylon_rendering_state;
   delete text_rendering_state;
 }
@@ -663,6 +667,35 @@ void HandlerF3F::reset()
 }
 
 
+/** \brief Set the sound directory.
+ *
+ *  Selects the folder with the F3F callouts and starts
+ *  loading its samples in the background, so that they
+ *  don't have to be read from disk during a run.
+ *
+ *  \param  aDir  sound directory, or "beep" for the console beep
+ */
+void HandlerF3F::set_sound_dir(std::string aDir)
+{
+  if (aDir == f3f_sound_dir)
+    return;
+
+  f3f_sound_dir = aDir;
+  use_beep = (f3f_sound_dir == "beep");
+  if (use_beep)
+    printf("F3F: Using console beep instead of wav sounds\n");
+  else
+    printf ("F3F: Setting sound dir to: %s\n", f3f_sound_dir.c_str());
+
+  if (Global::soundserver != NULL)
+  {
+    Global::soundserver->clearSampleCache();
+    if (!use_beep)
+      Global::soundserver->preloadSamples(f3f_sound_dir);
+  }
+}
+
+
 /** \brief Play a sound file.
  *
  *  This method plays the sound named soundName (which is mapped
@@ -95,15 +95,7 @@ class HandlerF3F : public  T_GameHandler
     inline void set_start_left(int aValue) {start_on_left = aValue;};
     
     /** public set method for the sound directory */
-    inline void set_sound_dir(std::string aDir) 
-    {
-      f3f_sound_dir = aDir;
-      use_beep = (f3f_sound_dir == "beep");
-      if (use_beep)
-        printf("F3F: Using console beep instead of wav sounds\n");
-      else
-        printf ("F3F: Setting sound dir to: %s\n", f3f_sound_dir.c_str());
-    };
+    void set_sound_dir(std::string aDir);
     static void prepareConfigFile(SimpleXMLTransfer *cfgfile);
   
     /**
@@ -0,0 +1,834 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#include "crrclog.h"
+#include "robotfile.h"
+
+#include <math.h>
+#include <string.h>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+
+#ifndef WIN32
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#define FLIGHTLOG_MAGIC        "CRRCLOG2"
+#define FLIGHTLOG_FOOTER_MAGIC "CRRCEND2"
+#define FLIGHTLOG_VERSION      2
+
+/// @name Size of fixed parts of the file [bytes]
+//@{
+#define FILE_HEADER_SIZE   16
+#define CHUNK_HEADER_SIZE  8
+#define FOOTER_SIZE        16
+#define INDEX_HEADER_SIZE  16
+#define INDEX_BLOCK_SIZE   32
+#define INDEX_MARKER_SIZE  16
+#define INDEX_XML_SIZE     16
+//@}
+
+/// @name Chunk types
+//@{
+#define CHUNK_HEADER  1
+#define CHUNK_FRAMES  2
+#define CHUNK_MARKER  3
+#define CHUNK_XML     4
+#define CHUNK_INDEX   5
+//@}
+
+// Everything is stored little-endian, independent of the platform.
+
+static inline uint32_t getU32(const char* p)
+{
+  const unsigned char* u = (const unsigned char*)p;
+  return((uint32_t)u[0] | ((uint32_t)u[1] << 8) | ((uint32_t)u[2] << 16) | ((uint32_t)u[3] << 24));
+}
+
+static inline uint64_t getU64(const char* p)
+{
+  return((uint64_t)getU32(p) | ((uint64_t)getU32(p+4) << 32));
+}
+
+static inline float getF32(const char* p)
+{
+  uint32_t u = getU32(p);
+  float    f;
+  memcpy(&f, &u, 4);
+  return(f);
+}
+
+static inline double getF64(const char* p)
+{
+  uint64_t u = getU64(p);
+  double   d;
+  memcpy(&d, &u, 8);
+  return(d);
+}
+
+static inline void putU32(std::vector<char>& buf, uint32_t u)
+{
+  buf.push_back((char)(u & 0xFF));
+  buf.push_back((char)((u >> 8) & 0xFF));
+  buf.push_back((char)((u >> 16) & 0xFF));
+  buf.push_back((char)((u >> 24) & 0xFF));
+}
+
+static inline void putU64(std::vector<char>& buf, uint64_t u)
+{
+  putU32(buf, (uint32_t)(u & 0xFFFFFFFF));
+  putU32(buf, (uint32_t)(u >> 32));
+}
+
+static inline void putF32(std::vector<char>& buf, float f)
+{
+  uint32_t u;
+  memcpy(&u, &f, 4);
+  putU32(buf, u);
+}
+
+static inline void putF64(std::vector<char>& buf, double d)
+{
+  uint64_t u;
+  memcpy(&u, &d, 8);
+  putU64(buf, u);
+}
+
+static size_t frameSize(unsigned int channels)
+{
+  size_t size = 8 + 3*4 + 4*4;
+
+  if (channels & FLIGHTLOG_CH_VELOCITY)
+    size += 3*4;
+  if (channels & FLIGHTLOG_CH_INPUTS)
+    size += FLIGHTLOG_NUM_INPUTS*4;
+
+  return(size);
+}
+
+static void encodeFrame(std::vector<char>& buf, unsigned int channels, const FlightLogFrame& f)
+{
+  putF64(buf, f.t);
+  for (int n=0; n<3; n++)
+    putF32(buf, f.pos[n]);
+  for (int n=0; n<4; n++)
+    putF32(buf, f.quat[n]);
+  if (channels & FLIGHTLOG_CH_VELOCITY)
+    for (int n=0; n<3; n++)
+      putF32(buf, f.vel[n]);
+  if (channels & FLIGHTLOG_CH_INPUTS)
+    for (int n=0; n<FLIGHTLOG_NUM_INPUTS; n++)
+      putF32(buf, f.inputs[n]);
+}
+
+static void decodeFrame(const char* p, unsigned int channels, FlightLogFrame& f)
+{
+  f.t = getF64(p);
+  p += 8;
+  for (int n=0; n<3; n++, p+=4)
+    f.pos[n] = getF32(p);
+  for (int n=0; n<4; n++, p+=4)
+    f.quat[n] = getF32(p);
+  for (int n=0; n<3; n++)
+    f.vel[n] = 0;
+  if (channels & FLIGHTLOG_CH_VELOCITY)
+    for (int n=0; n<3; n++, p+=4)
+      f.vel[n] = getF32(p);
+  for (int n=0; n<FLIGHTLOG_NUM_INPUTS; n++)
+    f.inputs[n] = 0;
+  if (channels & FLIGHTLOG_CH_INPUTS)
+    for (int n=0; n<FLIGHTLOG_NUM_INPUTS; n++, p+=4)
+      f.inputs[n] = getF32(p);
+}
+
+void flightLogEulerToQuat(double phi, double theta, double psi, float* q)
+{
+  double cr = cos(phi/2);
+  double sr = sin(phi/2);
+  double cp = cos(theta/2);
+  double sp = sin(theta/2);
+  double cy = cos(psi/2);
+  double sy = sin(psi/2);
+
+  q[0] = cr*cp*cy + sr*sp*sy;
+  q[1] = sr*cp*cy - cr*sp*sy;
+  q[2] = cr*sp*cy + sr*cp*sy;
+  q[3] = cr*cp*sy - sr*sp*cy;
+}
+
+CRRCMath::Vector3 flightLogQuatToEuler(const float* q)
+{
+  double w = q[0];
+  double x = q[1];
+  double y = q[2];
+  double z = q[3];
+
+  double s = 2*(w*y - z*x);
+  if (s > 1)
+    s = 1;
+  else if (s < -1)
+    s = -1;
+
+  return(CRRCMath::Vector3(atan2(2*(w*x + y*z), 1 - 2*(x*x + y*y)),
+                           asin(s),
+                           atan2(2*(w*z + x*y), 1 - 2*(y*y + z*z))));
+}
+
+
+FlightLogWriter::FlightLogWriter()
+  : fp(NULL), offset(0), channels(0), t_last(0)
+{
+  current.count = 0;
+}
+
+FlightLogWriter::~FlightLogWriter()
+{
+  Close();
+}
+
+bool FlightLogWriter::Open(std::string filename, SimpleXMLTransfer* header, unsigned int channels)
+{
+  Close();
+
+  fp = fopen(filename.c_str(), "wb");
+  if (fp == NULL)
+    return(false);
+
+  this->channels = channels;
+  offset         = 0;
+  t_last         = 0;
+  current.count  = 0;
+  block.clear();
+  blocks.clear();
+  markers.clear();
+  xmls.clear();
+
+  std::vector<char> buf(FLIGHTLOG_MAGIC, FLIGHTLOG_MAGIC+8);
+  putU32(buf, FLIGHTLOG_VERSION);
+  putU32(buf, channels);
+  fwrite(&buf[0], 1, buf.size(), fp);
+  offset += buf.size();
+
+  std::ostringstream out;
+  header->print(out, 0);
+  std::string text = out.str();
+  WriteChunk(CHUNK_HEADER, std::vector<char>(text.begin(), text.end()));
+
+  return(true);
+}
+
+void FlightLogWriter::Close()
+{
+  if (fp == NULL)
+    return;
+
+  FlushBlock();
+
+  // index
+  uint64_t          index = offset;
+  std::vector<char> buf;
+  putU32(buf, blocks.size());
+  putU32(buf, markers.size());
+  putU32(buf, xmls.size());
+  putU32(buf, 0);
+  for (unsigned int n=0; n<blocks.size(); n++)
+  {
+    putF64(buf, blocks[n].t_first);
+    putF64(buf, blocks[n].t_last);
+    putU64(buf, blocks[n].offset);
+    putU32(buf, blocks[n].count);
+    putU32(buf, 0);
+  }
+  for (unsigned int n=0; n<markers.size(); n++)
+  {
+    putF64(buf, markers[n].t);
+    putU32(buf, (uint32_t)markers[n].id);
+    putU32(buf, 0);
+  }
+  for (unsigned int n=0; n<xmls.size(); n++)
+  {
+    putF64(buf, xmls[n].t);
+    putU64(buf, xmls[n].offset);
+  }
+  WriteChunk(CHUNK_INDEX, buf);
+
+  // footer
+  buf.clear();
+  putU64(buf, index);
+  buf.insert(buf.end(), FLIGHTLOG_FOOTER_MAGIC, FLIGHTLOG_FOOTER_MAGIC+8);
+  fwrite(&buf[0], 1, buf.size(), fp);
+
+  if (fclose(fp) != 0)
+    std::cerr << "error closing logfile\n";
+  fp = NULL;
+
+  block.clear();
+  blocks.clear();
+  markers.clear();
+  xmls.clear();
+}
+
+void FlightLogWriter::AddFrame(const FlightLogFrame& frame)
+{
+  if (fp == NULL)
+    return;
+
+  if (current.count == 0)
+  {
+    block.clear();
+    block.reserve(8 + FRAMES_PER_BLOCK*frameSize(channels));
+    putU32(block, 0); // count, set in FlushBlock()
+    putU32(block, 0);
+    current.t_first = frame.t;
+  }
+  encodeFrame(block, channels, frame);
+  current.t_last = frame.t;
+  current.count++;
+  t_last = frame.t;
+
+  if (current.count >= FRAMES_PER_BLOCK)
+    FlushBlock();
+}
+
+void FlightLogWriter::AddMarker(int id)
+{
+  if (fp == NULL)
+    return;
+
+  FlushBlock();
+
+  FlightLogMarker marker;
+  marker.t  = t_last;
+  marker.id = id;
+  markers.push_back(marker);
+
+  std::vector<char> buf;
+  putF64(buf, marker.t);
+  putU32(buf, (uint32_t)id);
+  WriteChunk(CHUNK_MARKER, buf);
+}
+
+void FlightLogWriter::AddXML(SimpleXMLTransfer* data)
+{
+  if (fp == NULL)
+    return;
+
+  FlushBlock();
+
+  XMLInfo info;
+  info.t      = t_last;
+  info.offset = offset;
+  xmls.push_back(info);
+
+  std::ostringstream out;
+  data->print(out, 0);
+  std::string text = out.str();
+
+  std::vector<char> buf;
+  putF64(buf, info.t);
+  buf.insert(buf.end(), text.begin(), text.end());
+  WriteChunk(CHUNK_XML, buf);
+}
+
+void FlightLogWriter::WriteChunk(uint32_t type, const std::vector<char>& payload)
+{
+  std::vector<char> head;
+  putU32(head, type);
+  putU32(head, payload.size());
+
+  fwrite(&head[0], 1, head.size(), fp);
+  if (payload.size() > 0)
+    fwrite(&payload[0], 1, payload.size(), fp);
+  offset += head.size() + payload.size();
+}
+
+void FlightLogWriter::FlushBlock()
+{
+  if (current.count == 0)
+    return;
+
+  std::vector<char> count;
+  putU32(count, current.count);
+  memcpy(&block[0], &count[0], 4);
+
+  current.offset = offset;
+  WriteChunk(CHUNK_FRAMES, block);
+  blocks.push_back(current);
+
+  block.clear();
+  current.count = 0;
+}
+
+
+FlightLogReader::FlightLogReader(std::string filename)
+  : version(0), channels(0), stride(frameSize(0)), nFrames(0),
+    header(NULL), data(NULL), size(0)
+{
+  if (!MapFile(filename))
+    throw XMLException("error opening " + filename);
+
+  try
+  {
+    if (size >= FILE_HEADER_SIZE && memcmp(data, FLIGHTLOG_MAGIC, 8) == 0)
+    {
+      version  = getU32(data+8);
+      channels = getU32(data+12);
+      stride   = frameSize(channels);
+      if (version != FLIGHTLOG_VERSION)
+        throw XMLException("unsupported version of flight log format");
+
+      // The header is the first chunk.
+      const char* p = data + FILE_HEADER_SIZE;
+      if (size < FILE_HEADER_SIZE + CHUNK_HEADER_SIZE ||
+          getU32(p) != CHUNK_HEADER ||
+          getU32(p+4) > size - FILE_HEADER_SIZE - CHUNK_HEADER_SIZE)
+        throw XMLException("wrong file format");
+
+      std::istringstream in(std::string(p + CHUNK_HEADER_SIZE, getU32(p+4)));
+      header = new SimpleXMLTransfer(in);
+
+      if (!ReadIndex())
+      {
+        std::cerr << "No index in " << filename << ", scanning file\n";
+        ScanChunks();
+      }
+    }
+    else
+    {
+      UnmapFile();
+      version = 1;
+      LoadV1(filename);
+    }
+  }
+  catch (XMLException&)
+  {
+    if (header)
+      delete header;
+    UnmapFile();
+    throw;
+  }
+}
+
+FlightLogReader::~FlightLogReader()
+{
+  if (header)
+    delete header;
+  UnmapFile();
+}
+
+double FlightLogReader::GetStartTime()
+{
+  return(blocks.size() ? blocks.front().t_first : 0);
+}
+
+double FlightLogReader::GetEndTime()
+{
+  return(blocks.size() ? blocks.back().t_last : 0);
+}
+
+void FlightLogReader::GetFrame(size_t n, FlightLogFrame& frame)
+{
+  if (n >= nFrames)
+    n = nFrames - 1;
+
+  // last block starting at or before frame n
+  size_t lo = 0;
+  size_t hi = blocks.size();
+  while (hi - lo > 1)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (blocks[mid].first <= n)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  const Block& b = blocks[lo];
+  decodeFrame(b.data + (n - b.first)*stride, channels, frame);
+}
+
+size_t FlightLogReader::FindFrame(double t)
+{
+  if (nFrames == 0 || t < blocks[0].t_first)
+    return(0);
+
+  // last block starting at or before t
+  size_t lo = 0;
+  size_t hi = blocks.size();
+  while (hi - lo > 1)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (blocks[mid].t_first <= t)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  // last frame in this block at or before t
+  const Block& b = blocks[lo];
+  lo = 0;
+  hi = b.count;
+  while (hi - lo > 1)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (FrameTime(b, mid) <= t)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  return(b.first + lo);
+}
+
+void FlightLogReader::Sample(double t, FlightLogFrame& frame)
+{
+  if (nFrames == 0)
+  {
+    memset(&frame, 0, sizeof(frame));
+    frame.quat[0] = 1;
+    frame.t       = t;
+    return;
+  }
+
+  size_t n = FindFrame(t);
+  GetFrame(n, frame);
+
+  if (n+1 >= nFrames || t <= frame.t)
+    return;
+
+  FlightLogFrame next;
+  GetFrame(n+1, next);
+  if (next.t <= frame.t)
+    return;
+
+  float a = (t - frame.t) / (next.t - frame.t);
+  if (a > 1)
+    a = 1;
+
+  for (int i=0; i<3; i++)
+  {
+    frame.pos[i] += a * (next.pos[i] - frame.pos[i]);
+    frame.vel[i] += a * (next.vel[i] - frame.vel[i]);
+  }
+  for (int i=0; i<FLIGHTLOG_NUM_INPUTS; i++)
+    frame.inputs[i] += a * (next.inputs[i] - frame.inputs[i]);
+
+  // normalized linear interpolation along the shorter arc
+  float dot = 0;
+  for (int i=0; i<4; i++)
+    dot += frame.quat[i] * next.quat[i];
+  float sign = (dot < 0) ? -1 : 1;
+  float len  = 0;
+  for (int i=0; i<4; i++)
+  {
+    frame.quat[i] += a * (sign*next.quat[i] - frame.quat[i]);
+    len += frame.quat[i] * frame.quat[i];
+  }
+  if (len > 0)
+  {
+    len = sqrt(len);
+    for (int i=0; i<4; i++)
+      frame.quat[i] /= len;
+  }
+
+  frame.t = t;
+}
+
+double FlightLogReader::FrameTime(const Block& b, size_t n)
+{
+  return(getF64(b.data + n*stride));
+}
+
+void FlightLogReader::AddBlock(const char* payload, uint32_t len)
+{
+  if (len < 8)
+    return;
+
+  size_t count = getU32(payload);
+  if (count > (len - 8) / stride)
+    count = (len - 8) / stride; // truncated
+  if (count == 0)
+    return;
+
+  Block b;
+  b.data    = payload + 8;
+  b.count   = count;
+  b.first   = nFrames;
+  b.t_first = FrameTime(b, 0);
+  b.t_last  = FrameTime(b, count-1);
+  blocks.push_back(b);
+
+  nFrames += count;
+}
+
+bool FlightLogReader::ReadIndex()
+{
+  if (size < FILE_HEADER_SIZE + FOOTER_SIZE ||
+      memcmp(data + size - 8, FLIGHTLOG_FOOTER_MAGIC, 8) != 0)
+    return(false);
+
+  uint64_t index = getU64(data + size - FOOTER_SIZE);
+  size_t   end   = size - FOOTER_SIZE;
+  if (index < FILE_HEADER_SIZE || index + CHUNK_HEADER_SIZE + INDEX_HEADER_SIZE > end ||
+      getU32(data + index) != CHUNK_INDEX)
+    return(false);
+
+  const char* p   = data + index + CHUNK_HEADER_SIZE;
+  uint64_t    len = getU32(data + index + 4);
+  uint64_t    nB  = getU32(p);
+  uint64_t    nM  = getU32(p+4);
+  uint64_t    nX  = getU32(p+8);
+  if (index + CHUNK_HEADER_SIZE + len > end ||
+      len < INDEX_HEADER_SIZE + nB*INDEX_BLOCK_SIZE + nM*INDEX_MARKER_SIZE + nX*INDEX_XML_SIZE)
+    return(false);
+  p += INDEX_HEADER_SIZE;
+
+  for (uint64_t n=0; n<nB; n++, p+=INDEX_BLOCK_SIZE)
+  {
+    uint64_t offs = getU64(p+16);
+    if (offs + CHUNK_HEADER_SIZE > end || getU32(data + offs) != CHUNK_FRAMES ||
+        offs + CHUNK_HEADER_SIZE + getU32(data + offs + 4) > end)
+    {
+      blocks.clear();
+      nFrames = 0;
+      return(false);
+    }
+    AddBlock(data + offs + CHUNK_HEADER_SIZE, getU32(data + offs + 4));
+  }
+
+  for (uint64_t n=0; n<nM; n++, p+=INDEX_MARKER_SIZE)
+  {
+    FlightLogMarker marker;
+    marker.t  = getF64(p);
+    marker.id = (int32_t)getU32(p+8);
+    markers.push_back(marker);
+  }
+
+  for (uint64_t n=0; n<nX; n++, p+=INDEX_XML_SIZE)
+  {
+    uint64_t offs = getU64(p+8);
+    if (offs + CHUNK_HEADER_SIZE + 8 > end || getU32(data + offs) != CHUNK_XML ||
+        getU32(data + offs + 4) < 8 || offs + CHUNK_HEADER_SIZE + getU32(data + offs + 4) > end)
+      continue;
+
+    FlightLogXML xml;
+    xml.t    = getF64(p);
+    xml.text = std::string(data + offs + CHUNK_HEADER_SIZE + 8, getU32(data + offs + 4) - 8);
+    xmls.push_back(xml);
+  }
+
+  return(true);
+}
+
+void FlightLogReader::ScanChunks()
+{
+  size_t offs = FILE_HEADER_SIZE;
+
+  while (offs + CHUNK_HEADER_SIZE <= size)
+  {
+    uint32_t    type  = getU32(data + offs);
+    size_t      len   = getU32(data + offs + 4);
+    size_t      avail = size - offs - CHUNK_HEADER_SIZE;
+    const char* p     = data + offs + CHUNK_HEADER_SIZE;
+
+    if (len > avail)
+    {
+      // file has been truncated, use what is there
+      if (type == CHUNK_FRAMES)
+        AddBlock(p, avail);
+      break;
+    }
+
+    switch (type)
+    {
+      case CHUNK_FRAMES:
+        AddBlock(p, len);
+        break;
+
+      case CHUNK_MARKER:
+        if (len >= 12)
+        {
+          FlightLogMarker marker;
+          marker.t  = getF64(p);
+          marker.id = (int32_t)getU32(p+8);
+          markers.push_back(marker);
+        }
+        break;
+
+      case CHUNK_XML:
+        if (len >= 8)
+        {
+          FlightLogXML xml;
+          xml.t    = getF64(p);
+          xml.text = std::string(p+8, len-8);
+          xmls.push_back(xml);
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    offs += CHUNK_HEADER_SIZE + len;
+  }
+}
+
+void FlightLogReader::LoadV1(std::string filename)
+{
+  std::ifstream in;
+  char          c;
+  double        t = 0;
+
+  in.open(filename.c_str(), std::ios::binary);
+  if (!in)
+    throw XMLException("error opening " + filename);
+
+  // Read mandatory XML header, skip trailing '\n'
+  header = new SimpleXMLTransfer(in);
+  in.read(&c, 1);
+
+  channels = 0;
+  stride   = frameSize(channels);
+
+  FlightLogFrame frame;
+  memset(&frame, 0, sizeof(frame));
+
+  try
+  {
+    while (in.read(&c, 1))
+    {
+      if (c == 0x00)
+      {
+        // time step, position and attitude
+        double dt     = RobotFile::ReadDouble(in);
+        frame.pos[0]  = RobotFile::ReadFloat(in);
+        frame.pos[1]  = RobotFile::ReadFloat(in);
+        frame.pos[2]  = RobotFile::ReadFloat(in);
+        double phi    = RobotFile::ReadInt16(in) / ROBOT_EULER_TO_INT16;
+        double theta  = RobotFile::ReadInt16(in) / ROBOT_EULER_TO_INT16;
+        double psi    = RobotFile::ReadInt16(in) / ROBOT_EULER_TO_INT16;
+        if (!in)
+          break;
+        t      += dt;
+        frame.t = t;
+        flightLogEulerToQuat(phi, theta, psi, frame.quat);
+        encodeFrame(buffer, channels, frame);
+        nFrames++;
+      }
+      else if (c == 0x02)
+      {
+        FlightLogMarker marker;
+        marker.t  = t;
+        marker.id = RobotFile::ReadInt32(in);
+        if (in)
+          markers.push_back(marker);
+      }
+      else if (c == 0x03)
+      {
+        SimpleXMLTransfer  data(in);
+        std::ostringstream out;
+        data.print(out, 0);
+        // skip trailing '\n'
+        in.read(&c, 1);
+
+        FlightLogXML xml;
+        xml.t    = t;
+        xml.text = out.str();
+        xmls.push_back(xml);
+      }
+      else
+      {
+        std::cerr << "unknown record type: " << (int)c << "\n";
+        break;
+      }
+    }
+  }
+  catch (XMLException& e)
+  {
+    std::cerr << "error reading " << filename << ": " << e.what() << "\n";
+  }
+  in.close();
+
+  if (nFrames > 0)
+  {
+    Block b;
+    b.data    = &buffer[0];
+    b.count   = nFrames;
+    b.first   = 0;
+    b.t_first = FrameTime(b, 0);
+    b.t_last  = FrameTime(b, nFrames-1);
+    blocks.push_back(b);
+  }
+}
+
+bool FlightLogReader::MapFile(std::string filename)
+{
+#ifdef WIN32
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (fp == NULL)
+    return(false);
+
+  char   buf[65536];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+    buffer.insert(buffer.end(), buf, buf+len);
+  fclose(fp);
+
+  if (buffer.size() == 0)
+    return(false);
+  data = &buffer[0];
+  size = buffer.size();
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return(false);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    ::close(fd);
+    return(false);
+  }
+
+  void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return(false);
+
+  data = (const char*)p;
+  size = st.st_size;
+#endif
+
+  return(true);
+}
+
+void FlightLogReader::UnmapFile()
+{
+#ifndef WIN32
+  if (data != NULL)
+    munmap((void*)data, size);
+#endif
+  buffer.clear();
+  data = NULL;
+  size = 0;
+}
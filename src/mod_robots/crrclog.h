@@ -0,0 +1,262 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#ifndef CRRCLOG_H
+# define CRRCLOG_H
+
+# include <stdint.h>
+# include <stdio.h>
+# include <string>
+# include <vector>
+# include "../mod_misc/SimpleXMLTransfer.h"
+# include "../mod_math/vector3.h"
+
+/// @name Optional channels of a flight log
+//@{
+# define FLIGHTLOG_CH_VELOCITY  0x01
+# define FLIGHTLOG_CH_INPUTS    0x02
+//@}
+
+/**
+ * Number of control inputs in a frame (aileron, elevator, rudder,
+ * throttle, flap, spoiler, retract, pitch).
+ */
+# define FLIGHTLOG_NUM_INPUTS   8
+
+/**
+ * State of the airplane at one point in time. vel and inputs are only
+ * valid if the log contains the corresponding channel.
+ */
+struct FlightLogFrame
+{
+  double t;                             ///< time since start of log [s]
+  float  pos[3];                        ///< position [ft]
+  float  quat[4];                       ///< attitude, w x y z
+  float  vel[3];                        ///< velocity w.r.t. earth surface [ft/s]
+  float  inputs[FLIGHTLOG_NUM_INPUTS];  ///< control inputs
+};
+
+struct FlightLogMarker
+{
+  double t;
+  int    id;
+};
+
+struct FlightLogXML
+{
+  double      t;
+  std::string text;
+};
+
+/**
+ * Converts Euler angles (phi, theta, psi; z-y-x sequence) to a
+ * quaternion (w x y z).
+ */
+void flightLogEulerToQuat(double phi, double theta, double psi, float* q);
+
+/**
+ * Converts a quaternion (w x y z) to Euler angles (phi, theta, psi).
+ */
+CRRCMath::Vector3 flightLogQuatToEuler(const float* q);
+
+/**
+ * Writes a flight log in version 2 of the .crrclog format (see
+ * documentation/record_playback/design.txt).
+ *
+ * Frames are collected in memory and written as a block of up to
+ * FRAMES_PER_BLOCK frames. Markers and XML records end the current block,
+ * so the chunks in the file are in chronological order. Close() writes
+ * the index and the footer.
+ */
+class FlightLogWriter
+{
+public:
+  enum { FRAMES_PER_BLOCK = 256 };
+
+  FlightLogWriter();
+
+  ~FlightLogWriter();
+
+  /**
+   * Creates the file and writes the header. Returns false on error.
+   *
+   * \param channels  FLIGHTLOG_CH_* flags
+   */
+  bool Open(std::string filename, SimpleXMLTransfer* header, unsigned int channels);
+
+  /**
+   * Writes everything which is still buffered, the index and the
+   * footer and closes the file.
+   */
+  void Close();
+
+  bool IsOpen() { return(fp != NULL); };
+
+  void AddFrame(const FlightLogFrame& frame);
+
+  /**
+   * Marker at the time of the last frame
+   */
+  void AddMarker(int id);
+
+  /**
+   * XML record at the time of the last frame
+   */
+  void AddXML(SimpleXMLTransfer* data);
+
+private:
+  struct BlockInfo
+  {
+    double   t_first;
+    double   t_last;
+    uint64_t offset;
+    uint32_t count;
+  };
+
+  struct XMLInfo
+  {
+    double   t;
+    uint64_t offset;
+  };
+
+  void WriteChunk(uint32_t type, const std::vector<char>& payload);
+
+  void FlushBlock();
+
+  FILE*        fp;
+  uint64_t     offset;
+  unsigned int channels;
+  double       t_last;
+
+  /// @name Current block
+  //@{
+  std::vector<char> block;
+  BlockInfo         current;
+  //@}
+
+  /// @name Index
+  //@{
+  std::vector<BlockInfo>       blocks;
+  std::vector<FlightLogMarker> markers;
+  std::vector<XMLInfo>         xmls;
+  //@}
+};
+
+/**
+ * Reads a flight log. Files in version 2 of the format are mapped into
+ * memory (read on Windows), frames are decoded when they are accessed.
+ * If the footer is missing (crrcsim didn't close the file), the index is
+ * rebuilt by scanning the chunks. Files in version 1 are converted while
+ * loading.
+ *
+ * Finding the frame for some point in time is a binary search, so a log
+ * can be played from any point in time, also backwards.
+ */
+class FlightLogReader
+{
+public:
+  /**
+   * Throws an XMLException if the file can't be read.
+   */
+  FlightLogReader(std::string filename);
+
+  ~FlightLogReader();
+
+  /**
+   * 1 or 2
+   */
+  int GetVersion() { return(version); };
+
+  bool HasChannel(unsigned int ch) { return((channels & ch) != 0); };
+
+  SimpleXMLTransfer* GetHeader() { return(header); };
+
+  size_t GetFrameCount() { return(nFrames); };
+
+  double GetStartTime();
+
+  double GetEndTime();
+
+  void GetFrame(size_t n, FlightLogFrame& frame);
+
+  /**
+   * Returns the index of the last frame at or before time t (0 if t is
+   * before the first frame).
+   */
+  size_t FindFrame(double t);
+
+  /**
+   * Interpolates the state at time t. Before the first and after the
+   * last frame, that frame is returned.
+   */
+  void Sample(double t, FlightLogFrame& frame);
+
+  /**
+   * All markers, sorted by time
+   */
+  const std::vector<FlightLogMarker>& GetMarkers() { return(markers); };
+
+  /**
+   * All XML records except the header, sorted by time
+   */
+  const std::vector<FlightLogXML>& GetXMLs() { return(xmls); };
+
+private:
+  struct Block
+  {
+    double      t_first;
+    double      t_last;
+    const char* data;
+    size_t      count;
+    size_t      first;      ///< index of the first frame
+  };
+
+  bool MapFile(std::string filename);
+
+  void UnmapFile();
+
+  void LoadV1(std::string filename);
+
+  bool ReadIndex();
+
+  void ScanChunks();
+
+  void AddBlock(const char* payload, uint32_t len);
+
+  double FrameTime(const Block& b, size_t n);
+
+  int          version;
+  unsigned int channels;
+  size_t       stride;
+  size_t       nFrames;
+
+  SimpleXMLTransfer* header;
+
+  std::vector<Block>           blocks;
+  std::vector<FlightLogMarker> markers;
+  std::vector<FlightLogXML>    xmls;
+
+  /// @name The mapped file
+  //@{
+  const char*       data;
+  size_t            size;
+  std::vector<char> buffer;
+  //@}
+};
+
+#endif
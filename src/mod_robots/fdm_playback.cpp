@@ -20,10 +20,8 @@
 
 #include "fdm_playback.h"
 #include "marker.h"
-#include "robotfile.h"
 
 #include <math.h>
-#include <iostream>
 
 
 void CRRC_AirplaneSim_Playback::update(TSimInputs* inputs,
@@ -32,119 +30,101 @@ void CRRC_AirplaneSim_Playback::update(TSimInputs* inputs,
 {
   if (eF3FState != eF3F_WaitForUser)
   {
-    CRRCMath::Vector3 v3PosNew;
-    
-    dDeltaT -= dt * multiloop;
-    
-    while ((dDeltaT < 0 || eF3FState == eF3F_Jump) && !infile.eof() && eF3FState != eF3F_WaitForUser)
-    {
-      int marker;
-      do 
-      {
-        infile.read(buf, 1);
-        switch (buf[0])
-        {
-          case 0x02: // marker            
-            marker = RobotFile::ReadInt32(infile);
-            
-            switch (marker)
-            {
-              case RECMARK_F3F_START:
-                switch (eF3FState)
-                {
-                  case eF3F_Prep:
-                    eF3FState = eF3F_WaitForUser;
-                    break;
-                    
-                  default:
-                    eF3FState = eF3F_Done;
-                    break;
-                }
-                break;
-                
-              default: // ignore
-                break;
-            }
-            break;
-            
-          case 0x03: // xml
-            {
-              SimpleXMLTransfer* data = 0;
-              try
-              {
-                data = new SimpleXMLTransfer(infile);
-              }
-              catch (XMLException e)
-              {
-                data = 0;
-              }
-              // todo: tell someone about this data...
-              if (data)
-                delete data;
-              // skip trailing '\n'
-              infile.read(&(buf[1]), 1);
-            }
-            break;
-            
-          case 0x00:
-            break;
-            
-          default:
-            std::cerr << "unknown record type: " << (int)(buf[0]) << "\n";
-            break;
-        }  
-      }
-      while (buf[0] != 0 && !infile.eof());
+    Advance(dt * multiloop);
+    SetState();
+  }
+}
+
+void CRRC_AirplaneSim_Playback::Advance(double dt)
+{
+  const std::vector<FlightLogMarker>& markers = traj->GetMarkers();
+  
+  switch (eF3FState)
+  {
+    case eF3F_WaitForUser:
+      return;
+      
+    case eF3F_Jump:
+      // fast forward to the next start marker
+      while (nMarker < markers.size() && markers[nMarker].id != RECMARK_F3F_START)
+        nMarker++;
+      if (nMarker < markers.size())
+        dTime = markers[nMarker++].t;
+      eF3FState = eF3F_Done;
+      break;
       
-      if (!infile.eof())
+    default:
       {
-        double timestep = RobotFile::ReadDouble(infile);
-        if (eF3FState != eF3F_Jump)
-          dDeltaT += timestep;
-        v3PosNew.r[0] = RobotFile::ReadFloat(infile);
-        v3PosNew.r[1] = RobotFile::ReadFloat(infile);
-        v3PosNew.r[2] = RobotFile::ReadFloat(infile);
-        v3Euler.r[0] = RobotFile::ReadInt16(infile) / ROBOT_EULER_TO_INT16;
-        v3Euler.r[1] = RobotFile::ReadInt16(infile) / ROBOT_EULER_TO_INT16;
-        v3Euler.r[2] = RobotFile::ReadInt16(infile) / ROBOT_EULER_TO_INT16;
+        double dTimeNew = dTime + dt;
         
-        if (fFirstPos)
+        while (nMarker < markers.size() && markers[nMarker].t <= dTimeNew)
         {
-          v3PosOld = v3PosNew;
-          fFirstPos = false;
+          if (markers[nMarker].id == RECMARK_F3F_START)
+          {
+            if (eF3FState == eF3F_Prep)
+            {
+              // stop at the marker until the user starts
+              eF3FState = eF3F_WaitForUser;
+              dTimeNew  = markers[nMarker++].t;
+              break;
+            }
+            eF3FState = eF3F_Done;
+          }
+          nMarker++;
         }
-        
-        // Interpolate position. v3Euler can't be interpolated; this would 
-        // be possible if a quaternion had been used, but is far too much 
-        // trouble.
-        // v3PosNew is the current position, current time is dDeltaT.
-        // v3PosOld is the position of timestep ago. We need the position
-        // at time=zero.
-        v3Pos = v3PosOld + (v3PosNew - v3PosOld) * ((timestep-dDeltaT)/timestep);
-        v3PosOld = v3PosNew;
+        dTime = dTimeNew;
       }
-    }
+      break;
   }
 }
 
+void CRRC_AirplaneSim_Playback::SetState()
+{
+  float pos[3];
+  float quat[4];
+  float vel[3];
+  
+  traj->Sample(1, &dTime, &nHint, pos, quat, vel);
+  SetState(pos, quat, vel);
+}
+
+void CRRC_AirplaneSim_Playback::SetState(const float* pos, const float* quat, const float* vel)
+{
+  v3Pos   = CRRCMath::Vector3(pos[0], pos[1], pos[2]);
+  v3Euler = flightLogQuatToEuler(quat);
+  v3Vel   = CRRCMath::Vector3(vel[0], vel[1], vel[2]);
+}
+
+void CRRC_AirplaneSim_Playback::Seek(double t)
+{
+  const std::vector<FlightLogMarker>& markers = traj->GetMarkers();
+  
+  dTime = t;
+  
+  // markers before t have been passed
+  nMarker = 0;
+  while (nMarker < markers.size() && markers[nMarker].t < t)
+    nMarker++;
+  
+  SetState();
+}
+
 CRRC_AirplaneSim_Playback::CRRC_AirplaneSim_Playback(const char* filename) : RobotBase()
 {
   header = 0;
-  infile.open(filename, std::ios::binary);
-  if (!infile)
-  {
-    throw XMLException("error opening infile");
-  }
-  // Read mandatory XML header
-  header = new SimpleXMLTransfer(infile);
-  // skip trailing '\n'
-  infile.read(buf, 1);
+  traj   = Trajectory::Get(filename);
   
-  if (header->getName().compare("CRRCSim_record") != 0)
+  if (traj->GetHeader()->getName().compare("CRRCSim_record") != 0)
   {
+    Trajectory::Release(traj);
     throw XMLException("wrong file format");
   }
-  this->filename = filename;
+  header = new SimpleXMLTransfer(traj->GetHeader());
+  
+  dTime     = 0;
+  nHint     = 0;
+  nMarker   = 0;
+  eF3FState = eF3F_Off;
 }
 
 
@@ -152,7 +132,7 @@ CRRC_AirplaneSim_Playback::~CRRC_AirplaneSim_Playback()
 {
   if (header)
     delete header;
-  infile.close();
+  Trajectory::Release(traj);
 }
 
 void CRRC_AirplaneSim_Playback::initAirplaneState(double dRelVel,
@@ -166,22 +146,8 @@ void CRRC_AirplaneSim_Playback::initAirplaneState(double dRelVel,
                                                   double R_Y,
                                                   double R_Z)
 {
-  dDeltaT = 0;
-  if (infile.eof())
-  {
-    infile.close();
-    infile.open(filename.c_str());
-  }
-  else
-    infile.seekg(0);
-  // read XML header
-  SimpleXMLTransfer* dummy = new SimpleXMLTransfer(infile);
-  delete dummy;
-  // skip trailing '\n'
-  infile.read(buf, 1);
-
   eF3FState = eF3F_Off;
-  fFirstPos = true;
+  Seek(0);
 }
 
 void CRRC_AirplaneSim_Playback::ReceiveMarker(int id)
@@ -22,6 +22,7 @@
 # define FDM_PLAYBACK_H
 
 #include "robot.h"
+#include "trajectory.h"
 
 /**
  * This is not really a FDM, but reads position, attitude and more from
@@ -33,9 +34,11 @@
  * It knows about F3F mode in order to sync playback to the user's
  * F3F run in shadow mode.
  * 
- * todo: all binary storage code needs to be reviewed regarding endianess
- * and other portability issues which I do not know about. Recorded files
- * should work on any platform!
+ * The file is decoded into a Trajectory, which is shared by all
+ * playbacks of the same file. The state at any point in time can be found
+ * quickly: playback can be started at any time of the log and move
+ * backwards. Robots plays many files at once by calling Advance() for
+ * every playback, Trajectory::Sample() for all of them and then SetState().
  *
  * @author Jens Wilhelm Wulf
  */
@@ -66,6 +69,44 @@ public:
   
   virtual ~CRRC_AirplaneSim_Playback();
 
+  /**
+   * returns velocity w.r.t. earth surface (if it has been recorded)
+   */
+  virtual CRRCMath::Vector3 getVel() { return(v3Vel); };
+
+  /**
+   * Continue playback at time t [s] (relative to the start of the log).
+   */
+  void Seek(double t);
+
+  /**
+   * Length of the log [s]
+   */
+  double GetDuration() { return(traj->GetEndTime()); };
+  
+  /**
+   * Advances the current time by dt [s], handles markers. This is the
+   * first half of update().
+   */
+  void Advance(double dt);
+  
+  /**
+   * Current time in the log [s]
+   */
+  double GetTime() { return(dTime); };
+  
+  Trajectory* GetTrajectory() { return(traj); };
+  
+  /**
+   * Sets the state as sampled from the trajectory at GetTime(). This is
+   * the second half of update().
+   *
+   * \param pos   position
+   * \param quat  attitude quaternion, w x y z
+   * \param vel   velocity
+   */
+  void SetState(const float* pos, const float* quat, const float* vel);
+
   /**
    *
    */
@@ -75,13 +116,29 @@ private:
   enum enum_F3FState { eF3F_Off, eF3F_Prep, eF3F_WaitForUser, eF3F_Jump, eF3F_Done};
   enum_F3FState eF3FState;
   
-  std::string filename;
-  std::ifstream infile;
-  double dDeltaT;
-  CRRCMath::Vector3 v3PosOld;
-  bool fFirstPos;
+  /**
+   * Samples the trajectory at dTime and sets the state.
+   */
+  void SetState();
+  
+  Trajectory* traj;
+  
+  /**
+   * Frame found by the last call of SetState()
+   */
+  size_t nHint;
+  
+  /**
+   * Current time in the log [s]
+   */
+  double dTime;
+  
+  /**
+   * Index of the next marker to be read
+   */
+  unsigned int nMarker;
   
-  char buf[7*sizeof(double)+1];
+  CRRCMath::Vector3 v3Vel;
 };
 
 #endif
@@ -18,56 +18,28 @@
  *
  */
 #include "robotfile.h"
+#include "crrclog.h"
 
-#include <iostream>
+#include <sstream>
 
 RobotFile::RobotFile(std::string filename)
 {
-  char buf[7*sizeof(double)+1];
-  SimpleXMLTransfer* tmp;
-  std::ifstream infile;
-  
-  infile.open(filename.c_str(), std::ios::binary);
-  
   try
   {
-    // Read mandatory XML header
-    tmp = new SimpleXMLTransfer(infile);
-    xmls.push_back(tmp);
-    // skip trailing '\n'
-    infile.read(buf, 1);
-    
-    do 
+    FlightLogReader log(filename);
+
+    xmls.push_back(new SimpleXMLTransfer(log.GetHeader()));
+
+    const std::vector<FlightLogXML>& records = log.GetXMLs();
+    for (unsigned int n=0; n<records.size(); n++)
     {
-      infile.read(buf, 1);
-      switch (buf[0])
-      {
-        case 0x00:
-          infile.read(&(buf[1]), 8+3*4+3*2);
-          break;
-          
-        case 0x02: // marker
-          RobotFile::ReadInt32(infile);
-          break;
-          
-        case 0x03: // xml
-          tmp = new SimpleXMLTransfer(infile);
-          // skip trailing '\n'
-          infile.read(&(buf[1]), 1);
-          xmls.push_back(tmp);
-          break;
-          
-        default:
-          std::cerr << "unknown record type: " << (int)(buf[0]) << "\n";
-          break;
-      }  
+      std::istringstream in(records[n].text);
+      xmls.push_back(new SimpleXMLTransfer(in));
     }
-    while (!infile.eof());
   }
   catch (XMLException e)
   {
   }
-  infile.close();
 }
 
 RobotFile::~RobotFile()
@@ -87,42 +87,6 @@ public:
     return(dVal);
   }
   
-  /**
-   * store double as double
-   */
-  static inline void WriteDouble(std::ofstream& out, double dVal)
-  {
-    // todo: endianess?
-    out.write((char*)&dVal, 8);
-  }
-  
-  /**
-   * store double as float 
-   */
-  static inline void WriteFloat(std::ofstream& out, double dVal)
-  {
-    float fVal = dVal;
-    // todo: endianess?
-    out.write((char*)&fVal, 4);
-  }
-  
-  /**
-   * 
-   */
-  static inline void WriteInt32(std::ofstream& out, int nVal)
-  {
-    out.write((char*)&nVal, 4);
-  }
-  
-  /**
-   * 
-   */
-  static inline void WriteInt16(std::ofstream& out, double dVal)
-  {
-    int nVal = (int)(dVal+0.5);
-    out.write((char*)&nVal, 2);
-  }
-  
 private:
   std::vector<SimpleXMLTransfer*> xmls;
 };
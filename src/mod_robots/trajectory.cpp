@@ -0,0 +1,190 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#include "trajectory.h"
+
+#include <math.h>
+#include <algorithm>
+
+std::map<std::string, Trajectory*> Trajectory::cache;
+
+
+Trajectory* Trajectory::Get(std::string filename)
+{
+  std::map<std::string, Trajectory*>::iterator it = cache.find(filename);
+  Trajectory* traj;
+
+  if (it != cache.end())
+    traj = it->second;
+  else
+  {
+    traj = new Trajectory(filename);
+    cache[filename] = traj;
+  }
+
+  traj->users++;
+  return(traj);
+}
+
+void Trajectory::Release(Trajectory* traj)
+{
+  if (traj == NULL || --traj->users > 0)
+    return;
+
+  cache.erase(traj->filename);
+  delete traj;
+}
+
+Trajectory::Trajectory(std::string filename)
+  : filename(filename), users(0), header(NULL)
+{
+  FlightLogReader log(filename);
+  size_t          n = log.GetFrameCount();
+
+  header    = new SimpleXMLTransfer(log.GetHeader());
+  markers   = log.GetMarkers();
+  fVelocity = log.HasChannel(FLIGHTLOG_CH_VELOCITY);
+
+  t.resize(n);
+  x.resize(n);
+  y.resize(n);
+  z.resize(n);
+  qw.resize(n);
+  qx.resize(n);
+  qy.resize(n);
+  qz.resize(n);
+  vx.resize(n);
+  vy.resize(n);
+  vz.resize(n);
+
+  FlightLogFrame f;
+  for (size_t i=0; i<n; i++)
+  {
+    log.GetFrame(i, f);
+
+    t[i]  = f.t;
+    x[i]  = f.pos[0];
+    y[i]  = f.pos[1];
+    z[i]  = f.pos[2];
+    vx[i] = f.vel[0];
+    vy[i] = f.vel[1];
+    vz[i] = f.vel[2];
+
+    // q and -q are the same attitude; take the one closer to the last frame
+    float sign = 1;
+    if (i > 0 && qw[i-1]*f.quat[0] + qx[i-1]*f.quat[1] + qy[i-1]*f.quat[2] + qz[i-1]*f.quat[3] < 0)
+      sign = -1;
+    qw[i] = sign*f.quat[0];
+    qx[i] = sign*f.quat[1];
+    qy[i] = sign*f.quat[2];
+    qz[i] = sign*f.quat[3];
+  }
+}
+
+Trajectory::~Trajectory()
+{
+  delete header;
+}
+
+size_t Trajectory::Find(double time, size_t hint)
+{
+  size_t n = t.size();
+
+  if (n == 0 || time < t[0])
+    return(0);
+  if (hint >= n)
+    hint = n-1;
+
+  size_t lo;
+  size_t hi;
+  if (t[hint] <= time)
+  {
+    // usually still in the same frame or in the next one
+    if (hint+1 >= n || time < t[hint+1])
+      return(hint);
+    if (hint+2 >= n || time < t[hint+2])
+      return(hint+1);
+    lo = hint+2;
+    hi = n;
+  }
+  else
+  {
+    lo = 0;
+    hi = hint;
+  }
+
+  return((std::upper_bound(t.begin()+lo, t.begin()+hi, time) - t.begin()) - 1);
+}
+
+void Trajectory::Sample(int n, const double* time, size_t* hint,
+                        float* pos, float* quat, float* vel)
+{
+  size_t nFrames = t.size();
+
+  for (int k=0; k<n; k++)
+  {
+    float* p = pos  + 3*k;
+    float* q = quat + 4*k;
+
+    if (nFrames == 0)
+    {
+      p[0] = p[1] = p[2] = 0;
+      q[0] = 1;
+      q[1] = q[2] = q[3] = 0;
+      if (vel)
+        vel[3*k] = vel[3*k+1] = vel[3*k+2] = 0;
+      continue;
+    }
+
+    size_t i = Find(time[k], hint[k]);
+    size_t j = i;
+    float  a = 0;
+    hint[k]  = i;
+
+    if (i+1 < nFrames && time[k] > t[i])
+    {
+      j = i+1;
+      a = (time[k] - t[i]) / (t[j] - t[i]);
+    }
+    float b = 1 - a;
+
+    p[0] = b*x[i] + a*x[j];
+    p[1] = b*y[i] + a*y[j];
+    p[2] = b*z[i] + a*z[j];
+
+    // normalized linear interpolation
+    float w  = b*qw[i] + a*qw[j];
+    float qa = b*qx[i] + a*qx[j];
+    float qb = b*qy[i] + a*qy[j];
+    float qc = b*qz[i] + a*qz[j];
+    float l  = sqrt(w*w + qa*qa + qb*qb + qc*qc);
+    if (l > 0)
+      l = 1/l;
+    q[0] = w*l;
+    q[1] = qa*l;
+    q[2] = qb*l;
+    q[3] = qc*l;
+
+    if (vel)
+    {
+      vel[3*k]   = b*vx[i] + a*vx[j];
+      vel[3*k+1] = b*vy[i] + a*vy[j];
+      vel[3*k+2] = b*vz[i] + a*vz[j];
+    }
+  }
+}
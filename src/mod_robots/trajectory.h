@@ -0,0 +1,112 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#ifndef TRAJECTORY_H
+# define TRAJECTORY_H
+
+# include <map>
+# include <string>
+# include <vector>
+# include "crrclog.h"
+
+/**
+ * The frames of a flight log, decoded once into one array per component.
+ * All robots playing the same file share one Trajectory: use Get() and
+ * Release() instead of new and delete.
+ *
+ * Sample() interpolates many points in time at once. Every caller keeps a
+ * hint (the frame found last time) per point in time; as playback usually
+ * moves forward by less than a frame, most lookups don't need a search.
+ *
+ * Quaternions are stored with consistent signs (the dot product of
+ * consecutive quaternions is positive), so they can be interpolated
+ * without checking.
+ */
+class Trajectory
+{
+public:
+  /**
+   * Returns the trajectory of a file, loads it if necessary. Throws an
+   * XMLException if the file can't be read.
+   */
+  static Trajectory* Get(std::string filename);
+
+  /**
+   * Call once for every Get().
+   */
+  static void Release(Trajectory* traj);
+
+  SimpleXMLTransfer* GetHeader() { return(header); };
+
+  /**
+   * All markers, sorted by time
+   */
+  const std::vector<FlightLogMarker>& GetMarkers() { return(markers); };
+
+  double GetStartTime() { return(t.size() ? t.front() : 0); };
+
+  double GetEndTime() { return(t.size() ? t.back() : 0); };
+
+  size_t GetFrameCount() { return(t.size()); };
+
+  bool HasVelocity() { return(fVelocity); };
+
+  /**
+   * Interpolates position, attitude and velocity at n points in time.
+   * Before the first and after the last frame, that frame is used.
+   *
+   * \param n     number of points
+   * \param time  points in time [n]
+   * \param hint  frame index found by the last call for this point [n]; updated
+   * \param pos   position [3*n]
+   * \param quat  attitude quaternion, w x y z [4*n]
+   * \param vel   velocity [3*n], may be NULL
+   */
+  void Sample(int n, const double* time, size_t* hint,
+              float* pos, float* quat, float* vel);
+
+private:
+  Trajectory(std::string filename);
+
+  ~Trajectory();
+
+  /**
+   * Index of the last frame at or before time (0 if time is before the
+   * first frame), starting the search at hint.
+   */
+  size_t Find(double time, size_t hint);
+
+  std::string filename;
+  int         users;
+
+  SimpleXMLTransfer*           header;
+  std::vector<FlightLogMarker> markers;
+  bool                         fVelocity;
+
+  /// @name Frames
+  //@{
+  std::vector<double> t;
+  std::vector<float>  x,  y,  z;
+  std::vector<float>  qw, qx, qy, qz;
+  std::vector<float>  vx, vy, vz;
+  //@}
+
+  static std::map<std::string, Trajectory*> cache;
+};
+
+#endif
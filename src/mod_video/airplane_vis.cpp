@@ -26,6 +26,7 @@
 #include "../i18n.h"
 #include "airplane_vis.h"
 #include "crrc_ssgutils.h"
+#include "ssg_loader.h"
 #include "crrc_graphics.h"
 #include "shadow.h"
 #include <list>
@@ -51,6 +52,7 @@ namespace Video
 
   
 std::vector<AirplaneVisualization*> AirplaneVisualization::ListOfVisualizations;
+std::map<std::string, AirplaneVisualization::SharedModel> AirplaneVisualization::SharedModels;
 
 
 #if EXPERIMENTAL_STENCIL_SHADOW == 1
@@ -159,14 +161,47 @@ bool makeShadow(ssgEntity *ent)
 AirplaneVisualization::AirplaneVisualization( std::string const& model_name,
                                               std::string const& texture_path,
                                               CRRCMath::Vector3 const& pCG,
-                                              SimpleXMLTransfer *xml)
+                                              SimpleXMLTransfer *xml,
+                                              bool shared)
  :  initial_trans(NULL), 
     model_trans(NULL), model(NULL),
     shadow(NULL), shadow_trans(NULL)
 {
-  ssgTexturePath(texture_path.c_str());
+  if (shared)
+  {
+    std::ostringstream key;
+    key << model_name << "|" << texture_path << "|"
+        << pCG.r[0] << "," << pCG.r[1] << "," << pCG.r[2];
+    shared_key = key.str();
+    
+    std::map<std::string, SharedModel>::iterator it = SharedModels.find(shared_key);
+    if (it != SharedModels.end())
+    {
+      // use the model which has already been loaded
+      SharedModel& sm = it->second;
+      sm.users++;
+      initial_trans = sm.initial_trans;
+      model         = sm.model;
+      
+      model_trans = new ssgTransform();
+      scene->addKid(model_trans);
+      model_trans->addKid(initial_trans);
+#if (SHADOW_TYPE==SHADOW_VOLUME)
+      shadow = (ssgEntity*)new ShadowVolume(model);
+      scene->addKid(shadow);
+#endif
+#if (SHADOW_TYPE==SHADOW_PROJECTION)
+      shadow = sm.shadow;
+      shadow_trans = new ssgTransform();
+      scene->addKid(shadow_trans);
+      shadow_trans->addKid(shadow);
+#endif
+      return;
+    }
+  }
+  
   // load model
-  model = ssgLoad(model_name.c_str());
+  model = SSGUtil::loadModel(model_name, texture_path);
 
   if (model != NULL)
   {
@@ -199,6 +234,22 @@ AirplaneVisualization::AirplaneVisualization( std::string const& model_name,
     
     /// \todo add animations ("real" model only, without shadow)
     initAnimations(xml, model);
+    
+    if (shared)
+    {
+      // keep the model while it is used by any visualization
+      SharedModel sm;
+      sm.initial_trans = initial_trans;
+      sm.model         = model;
+      sm.shadow        = NULL;
+      sm.users         = 1;
+      initial_trans->ref();
+#if (SHADOW_TYPE==SHADOW_PROJECTION)
+      sm.shadow = shadow;
+      shadow->ref();
+#endif
+      SharedModels[shared_key] = sm;
+    }
   }
   else
   {
@@ -223,6 +274,18 @@ AirplaneVisualization::~AirplaneVisualization()
   parent->removeKid(shadow);
   //parent->removeKid(shadow_draw);
 #endif
+
+  if (shared_key != "")
+  {
+    std::map<std::string, SharedModel>::iterator it = SharedModels.find(shared_key);
+    if (it != SharedModels.end() && --it->second.users == 0)
+    {
+      ssgDeRefDelete(it->second.initial_trans);
+      if (it->second.shadow != NULL)
+        ssgDeRefDelete(it->second.shadow);
+      SharedModels.erase(it);
+    }
+  }
 }
   
 
@@ -290,14 +353,15 @@ void AirplaneVisualization::setPosition(CRRCMath::Vector3 const& pos,
 long new_visualization( std::string const& model_name,
                         std::string const& texture_path,
                         CRRCMath::Vector3 const& pCG,
-                        SimpleXMLTransfer *xml)
+                        SimpleXMLTransfer *xml,
+                        bool shared)
 {
   AirplaneVisualization* vis = NULL;
   long id = INVALID_AIRPLANE_VISUALIZATION;
   
   try
   {
-    vis = new AirplaneVisualization(model_name, texture_path, pCG, xml);
+    vis = new AirplaneVisualization(model_name, texture_path, pCG, xml, shared);
     
     // add the new visualization to the list of all visualizations
     // first search for an empty entry
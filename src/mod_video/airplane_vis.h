@@ -28,6 +28,7 @@
 #define AIRPLANE_VISUALIZATION_H_
 
 #include <plib/ssg.h>
+#include <map>
 #include <string>
 
 #include "../mod_math/vector3.h"
@@ -42,6 +43,11 @@ namespace Video
  *
  * This class encapsulates the visualization of an airplane.
  * 
+ * A shared visualization uses the same model (and projected shadow)
+ * as all other shared visualizations of that model; only its
+ * transformation is its own. The model is loaded once, which makes
+ * lots of robots of the same airplane cheap. Animations are set up
+ * only once, too.
  */
 class AirplaneVisualization
 {
@@ -49,7 +55,8 @@ class AirplaneVisualization
     AirplaneVisualization(std::string const& model_name,
                           std::string const& texture_path,
                           CRRCMath::Vector3 const& pCG,
-                          SimpleXMLTransfer *xml);
+                          SimpleXMLTransfer *xml,
+                          bool shared = false);
   
     ~AirplaneVisualization();
   
@@ -59,7 +66,8 @@ class AirplaneVisualization
     friend long new_visualization(std::string const& model_name,
                                   std::string const& texture_path,
                                   CRRCMath::Vector3 const& pCG,
-                                  SimpleXMLTransfer *xml);
+                                  SimpleXMLTransfer *xml,
+                                  bool shared);
 
     friend  void set_position(long id,
                               CRRCMath::Vector3 const &pos,
@@ -70,13 +78,31 @@ class AirplaneVisualization
     friend  void delete_visualization(long id);
     
   private:
+    /**
+     * A model used by shared visualizations
+     */
+    struct SharedModel
+    {
+      ssgTransform  *initial_trans;
+      ssgEntity     *model;
+      ssgEntity     *shadow;
+      int           users;
+    };
+    
     ssgTransform  *initial_trans;
     ssgTransform  *model_trans;
     ssgEntity     *model;
     ssgEntity     *shadow;
     ssgTransform  *shadow_trans;
 
+    /**
+     * Key into SharedModels, empty if this visualization isn't shared
+     */
+    std::string   shared_key;
+
     static std::vector<AirplaneVisualization*> ListOfVisualizations;
+    
+    static std::map<std::string, SharedModel> SharedModels;
   
 };
 
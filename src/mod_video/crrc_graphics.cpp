@@ -40,6 +40,7 @@
 #include "../mod_inputdev/inputdev_audio/inputdev_audio.h"
 #include "../mod_windfield/windfield.h"
 #include "../crrc_loadair.h"
+#include "../crrc_fdmthread.h"
 #include "../mod_misc/lib_conversions.h"
 #include "../crrc_system.h"
 #include "../defines.h"
@@ -50,6 +51,7 @@
 #include "../zoom.h"
 #include "fonts.h"
 #include "../mod_misc/filesystools.h"
+#include "../mod_misc/profiler.h"
 
 // Debug and error handling settings
 #define DONT_REPEAT_GL_ERRORS  1
@@ -659,6 +661,55 @@ CRRCMath::Vector3 FDM2Graphics(CRRCMath::Vector3 const& v)
 }
 
 
+/**
+ * Shows where the time of the last frame went in a bar above the console:
+ * one segment per stage measured on the main thread. The whole width
+ * of the console is 1/30s.
+ */
+static void updateProfileBar()
+{
+  double frame_ms;
+  const std::vector<CRRC_Profiler::Stage>& stages = CRRC_Profiler::getLastFrame(frame_ms);
+  std::vector<GlConsole::BarSegment>       bar;
+  GlConsole::BarSegment                    seg;
+  double                                   sum = 0;
+
+  for (unsigned int n=0; n<stages.size(); n++)
+  {
+    seg.label = std::string(stages[n].name) + " " + ftoStr(stages[n].ms, 1, 1, false, false);
+    seg.value = stages[n].ms;
+    sum      += stages[n].ms;
+    bar.push_back(seg);
+  }
+  if (frame_ms > sum)
+  {
+    seg.label = "other " + ftoStr(frame_ms - sum, 1, 1, false, false);
+    seg.value = frame_ms - sum;
+    bar.push_back(seg);
+  }
+  console->setBar(bar, 1000.0/30);
+}
+
+
+/**
+ * display() is called without holding the lock of the FDM thread. The
+ * scenery (e.g. HD_SsgLOSTerrain) and the windfield can't be asked by
+ * two threads at once, so the parts of display() which ask them stop
+ * the FDM thread meanwhile. They are short, the FDM doesn't fall behind.
+ */
+static void lockFDM()
+{
+  if (Global::fdmThread != NULL)
+    Global::fdmThread->Lock();
+}
+
+static void unlockFDM()
+{
+  if (Global::fdmThread != NULL)
+    Global::fdmThread->Unlock();
+}
+
+
 /*****************************************************************************/
 /** \brief The per-frame OpenGL display routine
  *
@@ -668,7 +719,11 @@ CRRCMath::Vector3 FDM2Graphics(CRRCMath::Vector3 const& v)
  */
 void display()
 {
-  CRRCMath::Vector3 plane_pos = FDM2Graphics(Global::aircraft->getPos());
+  // The FDM may be running right now, don't touch it.
+  FDMSnapshot aircraft;
+  FDMThread::GetAircraftSnapshot(aircraft);
+
+  CRRCMath::Vector3 plane_pos = FDM2Graphics(aircraft.pos);
 
   // Prepare the current frame buffer and reset
   // the modelview matrix (for non-SSG drawing)
@@ -703,11 +758,18 @@ void display()
     if (Global::aircraft->getModel() != NULL)
     {
       // For SSG rendering, this call does not draw anything,
-      // but calculates the airplane's transformation matrix
+      // but calculates the airplane's transformation matrix.
+      // The shadow asks the scenery for the ground below the airplane,
+      // so the FDM must not be running (see lockFDM()).
       glDisable(GL_TEXTURE_2D);
       glEnable(GL_LIGHTING);
       glEnable(GL_LIGHT0);
-      Global::aircraft->getModel()->draw(Global::aircraft->getFDM());
+      lockFDM();
+      Global::aircraft->getModel()->draw(aircraft.pos,
+                                         aircraft.phi,
+                                         aircraft.theta,
+                                         aircraft.psi);
+      unlockFDM();
     }
   
     // 3D scene: scenery
@@ -721,7 +783,10 @@ void display()
   ssgGetLight(0)->setColour(GL_AMBIENT, lightamb);
 
   // Draw the scenegraph (airplane model, shadow)
-  ssgCullAndDraw(scene);
+  {
+    CRRC_PROFILE("draw");
+    ssgCullAndDraw(scene);
+  }
   context->forceBasicState();
 
   // ssgCullAndDraw() ends up with an identity modelview matrix,
@@ -732,21 +797,26 @@ void display()
             looking_pos.r[0], looking_pos.r[1], looking_pos.r[2],
             0.0, 1.0, 0.0);
 
+  // These ask the windfield and the scenery, too.
+  lockFDM();
+
   // 3D scene: optionally draw thermals
   if (Global::training_mode == TRUE)
   {
-    draw_thermals(Global::aircraft->getPos());
+    draw_thermals(aircraft.pos);
   }
   
   // 3D scene: optionally draw wind vectors
   if (Global::windVectors > 0)
   {
-    Global::scenery->drawWindField(Global::aircraft->getPos(), Global::windVectors);
+    Global::scenery->drawWindField(aircraft.pos, Global::windVectors);
   }
   
   // 3D scene: game-mode-specific stuff (pylons etc.)
   Global::gameHandler->draw();
 
+  unlockFDM();
+
   glPopMatrix();
 
 
@@ -779,7 +849,7 @@ void display()
     int r   = window_ysize >> 5;
     int w   = r >> 1;
     int h   = window_ysize >> 3;
-    int ht  = (int)(Global::aircraft->getFDM()->getBatCapLeft() * h);
+    int ht  = (int)(aircraft.bat_cap_left * h);
                     
 #if 0
     glDisable(GL_LIGHTING);
@@ -811,6 +881,10 @@ void display()
   }
 
   // Overlay: console
+  if (CRRC_Profiler::isEnabled())
+  {
+    updateProfileBar();
+  }
   console->render(window_xsize, window_ysize);
   
   // Overlay: gui
@@ -820,6 +894,7 @@ void display()
   evaluateOpenGLErrors();
 
   // Force pipeline flushing and flip front and back buffer
+  CRRC_PROFILE("swap");
   glFlush();
   SDL_GL_SwapBuffers();
 }
@@ -48,7 +48,7 @@ GlConsole::GlConsole(int xsize, int ysize, int xorig, int yorig)
    stateTimer(0.0), size_x(xsize), size_y(ysize), pos_x(xorig), pos_y(yorig),
    vspace(2), inner_border(5), fadeStarted(0.0), fontRenderer(),
    text_r(1.0), text_g(1.0), text_b(1.0), text_a(1.0),
-   bg_r(0.2), bg_g(0.2), bg_b(0.2), bg_a(1.0)
+   bg_r(0.2), bg_g(0.2), bg_b(0.2), bg_a(1.0), bar_scale(1.0)
 {
   clk.reset();
 
@@ -114,6 +114,67 @@ void GlConsole::render(int window_width, int window_height)
     
     restoreOpenGLState();
   } // state != HIDDEN
+  
+  // the bar doesn't fade with the text
+  if (!bar.empty())
+  {
+    setOpenGLState(window_width, window_height);
+    renderBar();
+    restoreOpenGLState();
+  }
+}
+
+/**
+ * Renders the bar right above the console: the segments side by side,
+ * each one in a color of its own, and their labels in the same colors
+ * above them.
+ */
+void GlConsole::renderBar()
+{
+  static const float colors[][3] = { {0.9, 0.3, 0.3}, {0.3, 0.9, 0.3},
+                                     {0.3, 0.5, 1.0}, {0.9, 0.9, 0.3},
+                                     {0.9, 0.3, 0.9}, {0.3, 0.9, 0.9},
+                                     {1.0, 0.6, 0.2}, {0.7, 0.7, 0.7} };
+  static const int   nColors    = sizeof(colors) / sizeof(colors[0]);
+  
+  int   bar_y    = pos_y + size_y + vspace;
+  int   bar_h    = 10;
+  int   text_y   = bar_y + bar_h + vspace;
+  float x        = pos_x;
+  int   text_x   = pos_x;
+  
+  // the frame of the bar
+  glBegin(GL_QUADS);
+  glColor4f(bg_r, bg_g, bg_b, bg_a);
+  glVertex2i(pos_x,           bar_y);
+  glVertex2i(pos_x + size_x,  bar_y);
+  glVertex2i(pos_x + size_x,  bar_y + bar_h);
+  glVertex2i(pos_x,           bar_y + bar_h);
+  glEnd();
+
+  glDisable(GL_BLEND);
+  for (unsigned int i = 0; i < bar.size(); i++)
+  {
+    const float* c = colors[i % nColors];
+    float        w = bar[i].value / bar_scale * size_x;
+    
+    if (x + w > pos_x + size_x)
+    {
+      w = pos_x + size_x - x;
+    }
+    glColor3f(c[0], c[1], c[2]);
+    glRectf(x, bar_y, x + w, bar_y + bar_h);
+    x += w;
+    
+    // labels: only works for the specified FNT_BITMAP_8_BY_13, like addLine()
+    fontRenderer.begin();
+    glColor3f(c[0], c[1], c[2]);
+    fontRenderer.start2f(text_x, text_y);
+    fontRenderer.puts(bar[i].label.c_str());
+    fontRenderer.end();
+    text_x += (bar[i].label.size() + 1) * 8;
+  }
+  glEnable(GL_BLEND);
 }
     
 /**
@@ -317,6 +378,19 @@ void GlConsole::restoreOpenGLState ( void )
   glPopAttrib    () ;
 }
 
+/**
+ * Show a stacked bar right above the console, e.g. to show where the time
+ * of a frame goes. An empty list of segments removes the bar.
+ *
+ * \param segments    the parts of the bar, left to right
+ * \param full_scale  sum of values which fills the width of the console
+ */
+void GlConsole::setBar(const std::vector<BarSegment>& segments, float full_scale)
+{
+  bar       = segments;
+  bar_scale = full_scale;
+}
+
 /**
  * set the color of the console background 
  *
@@ -34,6 +34,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 #include <plib/ul.h>
 #include <plib/fnt.h>
@@ -54,6 +55,13 @@
 class GlConsole : public EventListener
 {
   public:
+    /** one part of the bar, see setBar() */
+    struct BarSegment
+    {
+      std::string label;
+      float       value;
+    };
+
     /** default constructor */
     GlConsole(int xsize = 400, int ysize = 100, int xorig = 0, int yorig = 0);
     
@@ -84,6 +92,9 @@ class GlConsole : public EventListener
     /** set the color of the console text */
     void setTextColor(float r, float g, float b, float a);
     
+    /** show a stacked bar above the console (empty: no bar) */
+    void setBar(const std::vector<BarSegment>& segments, float full_scale);
+    
     /** interface to the EventDispatcher */
     void operator()(const Event* ev);
     
@@ -127,6 +138,9 @@ class GlConsole : public EventListener
     float   bg_g;                 ///< background color, green component
     float   bg_b;                 ///< background color, blue component
     float   bg_a;                 ///< background color, alpha channel (transparency)
+    
+    std::vector<BarSegment> bar;  ///< segments of the bar above the console
+    float   bar_scale;            ///< sum of values which fills the width of the console
 
  
     /** setup the OpenGL-state for console rendering */
@@ -135,6 +149,9 @@ class GlConsole : public EventListener
     /** restore the original OpenGL state */
     void restoreOpenGLState(void);
     
+    /** render the bar */
+    void renderBar();
+    
     /** record any console activity */
     void recordActivity();
     
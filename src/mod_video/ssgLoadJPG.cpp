@@ -26,16 +26,17 @@ call  	ssgAddTextureFormat ( ".jpg",ssgLoadJPG)  before use
 
 #include <iostream>
 #include <plib/ssg.h>
+#include "ssg_loader.h"
 #define XMD_H	//for not redefine INT32 in jpeglib.h
 extern "C"
 {
 #include <jpeglib.h>
 }
 
-namespace Video
+namespace SSGUtil
 {
 
-bool ssgLoadJPG ( const char *fname, ssgTextureInfo* info )
+GLubyte* decodeJPG(const char* fname, int* width, int* height, int* depth)
 {
   FILE * infile;
   struct jpeg_decompress_struct cinfo;
@@ -47,7 +48,8 @@ bool ssgLoadJPG ( const char *fname, ssgTextureInfo* info )
   if ((infile = fopen(fname, "rb")) == NULL)
   {
     fprintf(stderr, "can't open %s\n", fname);
-    return false ;
+    jpeg_destroy_decompress(&cinfo);
+    return NULL ;
   }
   jpeg_stdio_src(&cinfo, infile);
   jpeg_read_header(&cinfo, TRUE);
@@ -82,7 +84,26 @@ bool ssgLoadJPG ( const char *fname, ssgTextureInfo* info )
   jpeg_finish_decompress(&cinfo);
   jpeg_destroy_decompress(&cinfo);
   fclose(infile);
-  
+
+  *width  = w;
+  *height = h;
+  *depth  = z;
+  return image;
+}
+
+} // end namespace SSGUtil::
+
+namespace Video
+{
+
+bool ssgLoadJPG ( const char *fname, ssgTextureInfo* info )
+{
+  int w, h, z;
+  GLubyte *image = SSGUtil::decodeJPG(fname, &w, &h, &z);
+
+  if (image == NULL)
+    return false ;
+
   if ( info != NULL )
   {
     info -> width = w ;
@@ -0,0 +1,328 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file ssg_loader.cpp
+ *
+ *  Loading PLIB SSG models, see ssg_loader.h
+ */
+
+#include "ssg_loader.h"
+
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+  SDL_mutex*  load_mutex = NULL;
+
+  /**
+   * Made by initModelLoader() on the main thread, see PlaceholderTexture
+   */
+  ssgTexture* placeholder_prototype = NULL;
+
+  /**
+   * A texture which only knows its name and whether it has an alpha
+   * channel, the latter being what PLIB's loaders look at when setting
+   * up a state.
+   *
+   * All constructors of ssgTexture create an OpenGL texture name, which
+   * must not be done without the OpenGL context. The copy constructor
+   * doesn't, so a placeholder is copied from a prototype and then gets
+   * a name of its own and no OpenGL texture at all (a handle of 0 is not
+   * deleted either). It can be created and deleted on any thread.
+   */
+  class PlaceholderTexture : public ssgTexture
+  {
+    public:
+      PlaceholderTexture(const char* fname, bool alpha)
+        : ssgTexture(*placeholder_prototype)
+      {
+        filename  = NULL;
+        handle    = 0;
+        setFilename(fname);
+        has_alpha = alpha;
+      }
+  };
+
+  bool hasExtension(const char* fname, const char* ext)
+  {
+    const char* dot = strrchr(fname, '.');
+
+    return(dot != NULL && strcasecmp(dot + 1, ext) == 0);
+  }
+
+  unsigned int be16(const std::vector<unsigned char>& buf, unsigned int pos)
+  {
+    return((buf[pos] << 8) | buf[pos+1]);
+  }
+
+  unsigned int be32(const std::vector<unsigned char>& buf, unsigned int pos)
+  {
+    return((buf[pos] << 24) | (buf[pos+1] << 16) | (buf[pos+2] << 8) | buf[pos+3]);
+  }
+
+  /**
+   * Decodes an SGI image (8 bit per channel, verbatim or RLE) the same
+   * way PLIB's loader does. Returns NULL if it can't.
+   */
+  GLubyte* decodeSGI(const char* fname, int* width, int* height, int* depth)
+  {
+    std::vector<unsigned char> buf;
+    FILE*                      f = fopen(fname, "rb");
+
+    if (f == NULL)
+      return(NULL);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size > 512)
+    {
+      buf.resize(size);
+      if (fread(&buf[0], 1, size, f) != (size_t)size)
+        buf.clear();
+    }
+    fclose(f);
+
+    if (buf.size() < 512 || be16(buf, 0) != 474 || buf[3] != 1)
+      return(NULL);
+
+    unsigned int rle = buf[2];
+    unsigned int dim = be16(buf, 4);
+    unsigned int xs  = be16(buf, 6);
+    unsigned int ys  = (dim < 2) ? 1 : be16(buf, 8);
+    unsigned int zs  = (dim < 3) ? 1 : be16(buf, 10);
+
+    if (xs == 0 || ys == 0 || zs < 1 || zs > 4)
+      return(NULL);
+    if (rle && 512 + ys*zs*8 > buf.size())
+      return(NULL);
+
+    GLubyte* image = new GLubyte[xs*ys*zs];
+
+    for (unsigned int z = 0; z < zs; z++)
+    {
+      for (unsigned int y = 0; y < ys; y++)
+      {
+        GLubyte* dst = image + y*xs*zs + z;
+
+        if (!rle)
+        {
+          unsigned int src = 512 + (z*ys + y)*xs;
+
+          if (src + xs > buf.size())
+          {
+            delete[] image;
+            return(NULL);
+          }
+          for (unsigned int x = 0; x < xs; x++)
+            dst[x*zs] = buf[src + x];
+        }
+        else
+        {
+          unsigned int src = be32(buf, 512 + (z*ys + y)*4);
+          unsigned int x   = 0;
+
+          while (src < buf.size())
+          {
+            unsigned int pixel = buf[src++];
+            unsigned int count = pixel & 0x7F;
+
+            if (count == 0)
+              break;
+            if (x + count > xs || src + ((pixel & 0x80) ? count : 1) > buf.size())
+            {
+              delete[] image;
+              return(NULL);
+            }
+            if (pixel & 0x80)
+            {
+              while (count--)
+                dst[zs*x++] = buf[src++];
+            }
+            else
+            {
+              pixel = buf[src++];
+              while (count--)
+                dst[zs*x++] = pixel;
+            }
+          }
+        }
+      }
+    }
+
+    *width  = xs;
+    *height = ys;
+    *depth  = zs;
+    return(image);
+  }
+}
+
+
+namespace SSGUtil
+{
+
+void initModelLoader()
+{
+  if (load_mutex == NULL)
+    load_mutex = SDL_CreateMutex();
+  // not referenced, so the copies start without a reference, too
+  if (placeholder_prototype == NULL)
+    placeholder_prototype = new ssgTexture();
+}
+
+ssgEntity* loadModel(std::string file, std::string texture_path,
+                     ssgLoaderOptions* options)
+{
+  ssgEntity* model;
+
+  if (load_mutex != NULL)
+    SDL_mutexP(load_mutex);
+
+  ssgLoaderOptions* current = ssgGetCurrentOptions();
+  if (options == NULL)
+    options = current;
+  options->setTextureDir(texture_path.c_str());
+
+  model = ssgLoad(file.c_str(), options);
+
+  ssgSetCurrentOptions(current);
+
+  if (load_mutex != NULL)
+    SDL_mutexV(load_mutex);
+
+  return(model);
+}
+
+
+DeferredTextures::DeferredTextures()
+{
+}
+
+DeferredTextures::~DeferredTextures()
+{
+  for (unsigned int n = 0; n < pending.size(); n++)
+  {
+    delete[] pending[n].image;
+    ssgDeRefDelete(pending[n].placeholder);
+  }
+}
+
+ssgTexture* DeferredTextures::createTexture(char* tfname, int wrapu,
+                                            int wrapv, int mipmap)
+{
+  char path[1024];
+
+  makeTexturePath(path, tfname);
+
+  for (unsigned int n = 0; n < pending.size(); n++)
+  {
+    if (pending[n].path == path)
+      return(pending[n].placeholder);
+  }
+
+  Pending p;
+
+  p.path    = path;
+  p.texture = NULL;
+  p.wrapu   = wrapu;
+  p.wrapv   = wrapv;
+  p.mipmap  = mipmap;
+  if (hasExtension(path, "jpg") || hasExtension(path, "jpeg"))
+    p.image = decodeJPG(path, &p.width, &p.height, &p.depth);
+  else if (hasExtension(path, "rgb") || hasExtension(path, "rgba") ||
+           hasExtension(path, "int") || hasExtension(path, "inta") ||
+           hasExtension(path, "bw")  || hasExtension(path, "sgi"))
+    p.image = decodeSGI(path, &p.width, &p.height, &p.depth);
+  else
+    p.image = NULL;
+
+  p.placeholder = new PlaceholderTexture(path,
+                                         p.image != NULL && (p.depth == 2 || p.depth == 4));
+  p.placeholder->ref();
+  pending.push_back(p);
+
+  return(p.placeholder);
+}
+
+void DeferredTextures::upload(ssgEntity* root)
+{
+  if (pending.empty())
+    return;
+
+  for (unsigned int n = 0; n < pending.size(); n++)
+  {
+    Pending& p = pending[n];
+
+    if (p.image != NULL)
+    {
+      // takes over the image
+      p.texture = new ssgTexture(p.path.c_str(), p.image,
+                                 p.width, p.height, p.depth,
+                                 p.wrapu, p.wrapv);
+      p.image = NULL;
+    }
+    else
+      p.texture = new ssgTexture(p.path.c_str(), p.wrapu, p.wrapv, p.mipmap);
+    p.texture->ref();
+  }
+
+  if (root != NULL)
+    replace(root);
+
+  for (unsigned int n = 0; n < pending.size(); n++)
+  {
+    ssgDeRefDelete(pending[n].texture);
+    ssgDeRefDelete(pending[n].placeholder);
+  }
+  pending.clear();
+}
+
+void DeferredTextures::replace(ssgEntity* ent)
+{
+  if (ent->isAKindOf(ssgTypeLeaf()))
+  {
+    ssgState* state = ((ssgLeaf*)ent)->getState();
+
+    if (state != NULL && state->isAKindOf(ssgTypeSimpleState()))
+    {
+      ssgSimpleState* st  = (ssgSimpleState*)state;
+      ssgTexture*     tex = st->getTexture();
+
+      for (unsigned int n = 0; tex != NULL && n < pending.size(); n++)
+      {
+        if (pending[n].placeholder == tex)
+        {
+          st->setTexture(pending[n].texture);
+          break;
+        }
+      }
+    }
+  }
+  else if (ent->isAKindOf(ssgTypeBranch()))
+  {
+    ssgBranch* branch = (ssgBranch*)ent;
+
+    for (int i = 0; i < branch->getNumKids(); i++)
+      replace(branch->getKid(i));
+  }
+}
+
+} // end namespace SSGUtil
@@ -0,0 +1,111 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+/** \file ssg_loader.h
+ *
+ *  Loading PLIB SSG models, also on a thread without OpenGL context.
+ */
+
+#ifndef SSG_LOADER_H_
+#define SSG_LOADER_H_
+
+#include <plib/ssg.h>
+#include <string>
+#include <vector>
+
+namespace SSGUtil
+{
+
+/**
+ * Makes loadModel() safe to be called from more than one thread and
+ * prepares DeferredTextures. Call on the main thread, with the OpenGL
+ * context, before starting a thread which loads models.
+ */
+void initModelLoader();
+
+/**
+ * Loads a model with its textures taken from <code>texture_path</code>.
+ *
+ * PLIB's loaders keep their state in global variables, so only one thread
+ * at a time may load a model; this function takes care of that and
+ * restores the current loader options afterwards. All models should be
+ * loaded using it.
+ *
+ * \param file         model file with full path
+ * \param texture_path where to look for textures
+ * \param options      loader options to use, NULL for the current ones
+ * \return the model or NULL on error
+ */
+ssgEntity* loadModel(std::string file, std::string texture_path,
+                     ssgLoaderOptions* options = NULL);
+
+/**
+ * Decodes a JPEG image into a buffer allocated with <code>new[]</code>,
+ * bottom row first. Returns NULL on error. Doesn't need OpenGL.
+ */
+GLubyte* decodeJPG(const char* fname, int* width, int* height, int* depth);
+
+/**
+ * Loader options which don't need OpenGL when loading a model: textures
+ * are read and decoded while loading, but only handed to OpenGL by
+ * upload(), on the thread owning the OpenGL context.
+ *
+ * Until then, the model refers to placeholder textures, which don't
+ * have an OpenGL texture. Images which can't be decoded here (formats
+ * other than SGI and JPEG) are read by upload().
+ */
+class DeferredTextures : public ssgLoaderOptions
+{
+  public:
+    DeferredTextures();
+    ~DeferredTextures();
+
+    ssgTexture* createTexture(char* tfname, int wrapu = TRUE,
+                              int wrapv = TRUE, int mipmap = TRUE);
+
+    /**
+     * Creates the OpenGL textures and puts them in place of the
+     * placeholders in the states of all leaves below <code>root</code>.
+     * Main thread only.
+     */
+    void upload(ssgEntity* root);
+
+  private:
+    struct Pending
+    {
+      std::string path;
+      ssgTexture* placeholder;
+      ssgTexture* texture;   ///< replaces placeholder after upload()
+      int         wrapu;
+      int         wrapv;
+      int         mipmap;
+      GLubyte*    image;     ///< NULL: read it in upload()
+      int         width;
+      int         height;
+      int         depth;
+    };
+
+    std::vector<Pending> pending;
+
+    void replace(ssgEntity* ent);
+};
+
+} // end namespace SSGUtil
+
+#endif // SSG_LOADER_H_
@@ -181,6 +181,34 @@ void ThermikSchalen::init(SimpleXMLTransfer* cfg) /*{{{*/
   }
   
   vRefExp = cfg->attributeAsDouble("vRefExp");
+
+  // velocity table
+  {
+    fExact = (cfg->attributeAsInt("exact", 0) != 0);
+    tab_nx = cfg->attributeAsInt("table_nx", 128);
+    tab_ny = cfg->attributeAsInt("table_ny", 512);
+    if (tab_nx < 1)
+      tab_nx = 1;
+    if (tab_ny < 1)
+      tab_ny = 1;
+    tab_sx = tab_nx / r_max;
+    tab_sy = tab_ny;
+
+    tab.resize(2*(tab_nx+1)*(tab_ny+1));
+    std::vector<flttype>::iterator it = tab.begin();
+    for (int iy=0; iy<=tab_ny; iy++)
+    {
+      for (int ix=0; ix<=tab_nx; ix++)
+      {
+        flttype dx, dy;
+        vectorAtExact(ix/tab_sx, iy/tab_sy, dx, dy, 1);
+        *it++ = dx;
+        *it++ = dy;
+      }
+    }
+    std::cout << "  velocity table: " << tab_nx << "x" << tab_ny
+              << (fExact ? " (not used)\n" : "\n");
+  }
     
   {
     std::string filename = cfg->attribute("fileC", "");
@@ -294,6 +322,45 @@ void ThermikSchalen::init(SimpleXMLTransfer* cfg) /*{{{*/
 void ThermikSchalen::vectorAt(flttype  x,  flttype  y,
                               flttype& dx, flttype& dy,
                               flttype  vRef) /*{{{*/
+{
+  // The table only covers the radius, not the other side of the y-axis.
+  if (fExact || x < 0)
+  {
+    vectorAtExact(x, y, dx, dy, vRef);
+    return;
+  }
+
+  dx = 0;
+  dy = 0;
+
+  if (x < r_max && y > 0 && y < 1)
+  {
+    flttype fx = x * tab_sx;
+    flttype fy = y * tab_sy;
+    int     ix = (int)fx;
+    int     iy = (int)fy;
+
+    if (ix >= tab_nx)
+      ix = tab_nx-1;
+    if (iy >= tab_ny)
+      iy = tab_ny-1;
+    fx -= ix;
+    fy -= iy;
+
+    const flttype* p00 = &tab[2*(iy*(tab_nx+1) + ix)];
+    const flttype* p10 = p00 + 2;
+    const flttype* p01 = p00 + 2*(tab_nx+1);
+    const flttype* p11 = p01 + 2;
+
+    dx = vRef * ((1-fy) * ((1-fx)*p00[0] + fx*p10[0]) + fy * ((1-fx)*p01[0] + fx*p11[0]));
+    dy = vRef * ((1-fy) * ((1-fx)*p00[1] + fx*p10[1]) + fy * ((1-fx)*p01[1] + fx*p11[1]));
+  }
+}
+/*}}}*/
+
+void ThermikSchalen::vectorAtExact(flttype  x,  flttype  y,
+                                   flttype& dx, flttype& dy,
+                                   flttype  vRef) /*{{{*/
 {
   flttype dxs, dys, t;
   
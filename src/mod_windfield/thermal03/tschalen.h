@@ -31,12 +31,21 @@
  * External coordinate system of ThermikSchalen is:
  * y=0 at bottom of thermal, y=1 at top of thermal.
  * It is symmetric about its y-axis at y=0, so x is a radius.
+ *
+ * Solving for the shell a point lies on is expensive, so by default
+ * vectorAt() interpolates in a table of velocities (for vRef=1), which is
+ * calculated once in init(). The attribute <code>exact="1"</code> in the
+ * XML description switches back to solving for every point.
+ * <code>table_nx</code> and <code>table_ny</code> set the number of
+ * table cells in x (0..r_max) and y (0..1).
  * 
  * @author Jens W. Wulf
  */
 class ThermikSchalen
 {
   public:
+   ThermikSchalen() : fExact(true), tab_nx(0), tab_ny(0), tab_sx(0), tab_sy(0) {};
+
    /**
     * Init from XML description
     */
@@ -49,6 +58,18 @@ class ThermikSchalen
    void vectorAt(flttype  x,  flttype  y,
                  flttype& dx, flttype& dy,
                  flttype  vRef);
+
+   /**
+    * Like vectorAt(), but always uses the exact solution.
+    */
+   void vectorAtExact(flttype  x,  flttype  y,
+                      flttype& dx, flttype& dy,
+                      flttype  vRef);
+
+   /**
+    * Use the exact solution in vectorAt() instead of the table?
+    */
+   void setExact(bool fExact) { this->fExact = fExact; };
       
    
    /**
@@ -94,6 +115,29 @@ class ThermikSchalen
    flttype flTransCos;
    flttype flTransReSin;
    flttype flTransReCos;      
+
+   /**
+    * Use vectorAtExact() instead of the table
+    */
+   bool fExact;
+
+   /**
+    * Number of table cells in x and y
+    */
+   int tab_nx;
+   int tab_ny;
+
+   /**
+    * Table cells per unit length in x and y
+    */
+   flttype tab_sx;
+   flttype tab_sy;
+
+   /**
+    * dx and dy for vRef=1 at (tab_nx+1)*(tab_ny+1) points,
+    * x changing fastest.
+    */
+   std::vector<flttype> tab;
 };
 
 #endif
@@ -0,0 +1,113 @@
+/*
+ * CRRCsim - the Charles River Radio Control Club Flight Simulator Project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+#include <math.h>
+
+#include "tschalen.h"
+#include "../../mod_misc/SimpleXMLTransfer.h"
+
+/**
+ * Compares ThermikSchalen::vectorAt() (table) to
+ * ThermikSchalen::vectorAtExact() at random points in the thermal,
+ * using the default thermal description.
+ *
+ * Usage: tschalen_bench [number of points] [table_nx] [table_ny]
+ */
+int main(int argc, char** argv)
+{
+  int nPoints = 200000;
+
+  if (argc > 1)
+    nPoints = atoi(argv[1]);
+
+  ThermikSchalen    th;
+  SimpleXMLTransfer cfg;
+
+  th.createDefaultConfig(&cfg);
+  if (argc > 2)
+    cfg.setAttribute("v3.table_nx", argv[2]);
+  if (argc > 3)
+    cfg.setAttribute("v3.table_ny", argv[3]);
+
+  th.init(cfg.getChild("v3"));
+
+  std::vector<flttype> px(nPoints);
+  std::vector<flttype> py(nPoints);
+  std::vector<flttype> ex(nPoints);
+  std::vector<flttype> ey(nPoints);
+
+  srand(1);
+  for (int n=0; n<nPoints; n++)
+  {
+    px[n] = th.get_r_max() * rand() / (RAND_MAX + 1.0);
+    py[n] = rand() / (RAND_MAX + 1.0);
+  }
+
+  // exact
+  clock_t t0 = clock();
+  for (int n=0; n<nPoints; n++)
+    th.vectorAtExact(px[n], py[n], ex[n], ey[n], 1);
+  double tExact = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  // table
+  double  sum  = 0;
+  flttype dx, dy;
+  t0 = clock();
+  for (int n=0; n<nPoints; n++)
+  {
+    th.vectorAt(px[n], py[n], dx, dy, 1);
+    sum += dx + dy;
+  }
+  double tTable = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+  // error, relative to the largest velocity
+  double vMax   = 0;
+  double errMax = 0;
+  double errSq  = 0;
+  for (int n=0; n<nPoints; n++)
+  {
+    double v = sqrt(ex[n]*ex[n] + ey[n]*ey[n]);
+    if (v > vMax)
+      vMax = v;
+
+    th.vectorAt(px[n], py[n], dx, dy, 1);
+    double err = sqrt((dx-ex[n])*(dx-ex[n]) + (dy-ey[n])*(dy-ey[n]));
+    if (err > errMax)
+      errMax = err;
+    errSq += err*err;
+  }
+  if (vMax <= 0)
+    vMax = 1;
+
+  std::cout << "points:          " << nPoints << "\n";
+  std::cout << "exact:           " << tExact << " s, "
+            << 1.0E9*tExact/nPoints << " ns/point\n";
+  std::cout << "table:           " << tTable << " s, "
+            << 1.0E9*tTable/nPoints << " ns/point (" << sum << ")\n";
+  if (tTable > 0)
+    std::cout << "speedup:         " << tExact/tTable << "\n";
+  std::cout << "max. velocity:   " << vMax << "\n";
+  std::cout << "max. error:      " << 100*errMax/vMax << " %\n";
+  std::cout << "rms error:       " << 100*sqrt(errSq/nPoints)/vMax << " %\n";
+
+  return(0);
+}
@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <plib/ssg.h>   // for ssgSimpleState
 #include "../mod_misc/ls_constants.h"
+#include "../mod_misc/profiler.h"
 //jwtodo #include "../config.h"
 // remaining calls to cfg:
 //    cfg->thermal->density     on init
@@ -72,73 +73,11 @@
 
 #define THERMAL_NEWPOSLOG 1
 
-/**
- * Which version of thermal model to use?
- * Everthing less than 3 results in the 'old' code (which depends on THERMAL_CODE
- * in crrc_config.h), 3 results in version 3.
- */
-unsigned int ThermalVersion;
-
-/**
- * There is some 2D grid. Its area is
- *    (occupancy_grid_size * occupancy_grid_res)^2
- * It is divided into occupancy_grid_size^2 squares.
- */
-#define occupancy_grid_size_exp 7
-#define occupancy_grid_size     (1 << occupancy_grid_size_exp)
-#define occupancy_grid_res      100
-Thermal* thermal_occupancy_grid[occupancy_grid_size][occupancy_grid_size];
-
-#if (THERMAL_NEWPOSLOG != 0)
-unsigned int NewPosLogArray[occupancy_grid_size][occupancy_grid_size];
-unsigned int PosLogArray[occupancy_grid_size][occupancy_grid_size];
-#endif
-
 /**
  * How many grid places should be free next to a thermal?
  */
 const int nGridDistMin = 1;
 
-/**
- * The number of thermals in the above grid is
- *    (occupancy_grid_size * occupancy_grid_res)^2 * cfg->thermal->density
- */
-int num_thermals;
-
-/**
- * The pointer to the first thermal in the linked list.
- */
-Thermal* thermals = NULL;
-
-/**
- * Random normal (gaussian) distribution of thermal radius, strength
- * and lifetime.
- */
-RandGauss rnd_radius;
-RandGauss rnd_strength;
-RandGauss rnd_lifetime;
-
-/**
- * One thermal influences an area of
- *    (nInfluenceDist*occupancy_grid_res)^2
- * or less.
- * Radius of the largest (since init) thermal in lengths of the grid.
- */
-int nInfluenceDist = 5;
-
-/**
- * To draw thermals, one of two methods is used:
- * 1. loop over linked list of thermals and draw every thermal which
- *    is near the aircraft
- * 2. Look at grid around aircraft and draw present thermals. This
- *    method means less effort if the thermal density is high. It also
- *    doesn't draw thermal which are in the list but not in the grid (may
- *    happen when thermal density is high).
- * If the second method is used, this variable represents a distance
- * in grid coordinates.
- */
-int nDrawThermalsFromGrid;
-
 /**
  * Draw thermals with this maximum distance from aircraft.
  * Currently this is not the real distance, but the one in x or y.
@@ -146,9 +85,9 @@ int nDrawThermalsFromGrid;
 const float flThermalDistMax = 1000;
 
 /**
- * Standard thermal according to thermal model version 3.
+ * The windfield crrcsim flies in.
  */
-ThermikSchalen thermalv3;
+static WindField windfield;
 
 #if (THERMAL_CODE == 1)
 /**
@@ -213,7 +152,7 @@ inline float gridToAbsCoor(int gridKoor, float rel=0.5)
  * <code>xcoord</code> and <code>ycoord</code> are the indices into
  * the grid.
  */
-bool isThermalNearby(int xcoord, int ycoord)
+bool WindField::isThermalNearby(int xcoord, int ycoord)
 {
   int xmin = xcoord-nGridDistMin;
   int xmax = xcoord+nGridDistMin;
@@ -250,8 +189,8 @@ bool isThermalNearby(int xcoord, int ycoord)
  *
  * Returns true if no new thermal position could be found.
  */
-bool find_new_thermal_position(float *xpos, float *ypos,
-                               int *xcoord, int *ycoord)
+bool WindField::findNewThermalPosition(float *xpos, float *ypos,
+                                       int *xcoord, int *ycoord)
 {
   // The problem of the old method has been that it heavily relied on random
   // values to find a new position, which needed lots of processing time.
@@ -269,12 +208,12 @@ bool find_new_thermal_position(float *xpos, float *ypos,
       6580, 6934, 7064, 7136, 7372, 7474, 7586, 7592 };
 
   // choose a poly
-  unsigned int uPoly = aPoly[CRRC_Random::rand() % (sizeof(aPoly)/sizeof(unsigned int))];
+  unsigned int uPoly = aPoly[rng.rand() % (sizeof(aPoly)/sizeof(unsigned int))];
     
   // find an initial value
-  unsigned int uCRCVal = CRRC_Random::rand();
+  unsigned int uCRCVal = rng.rand();
   while (uCRCVal == 0)
-    CRRC_Random::rand();
+    uCRCVal = rng.rand();
 
   *xcoord = (uCRCVal >> occupancy_grid_size_exp) & (occupancy_grid_size-1);
   *ycoord = uCRCVal & (occupancy_grid_size-1);
@@ -294,8 +233,8 @@ bool find_new_thermal_position(float *xpos, float *ypos,
     *xcoord = (uCRCVal >> occupancy_grid_size_exp) & (occupancy_grid_size-1);
     *ycoord = uCRCVal & (occupancy_grid_size-1);
   }
-  *xpos = gridToAbsCoor(*xcoord, (float)(CRRC_Random::rand())/CRRC_Random::max());
-  *ypos = gridToAbsCoor(*ycoord, (float)(CRRC_Random::rand())/CRRC_Random::max());
+  *xpos = gridToAbsCoor(*xcoord, (float)(rng.rand())/CRRC_RandomStream::max());
+  *ypos = gridToAbsCoor(*ycoord, (float)(rng.rand())/CRRC_RandomStream::max());
 
   // If no such square could be found, thermal density is set way too high.
   // No visible thermal should be created.
@@ -308,8 +247,61 @@ bool find_new_thermal_position(float *xpos, float *ypos,
     return(false);
 }
 
+WindField* default_wind_field()
+{
+  return(&windfield);
+}
+
+WindField::WindField()
+  : ThermalVersion(THERMAL_CODE), num_thermals(0), thermals(NULL),
+    nInfluenceDist(5), nDrawThermalsFromGrid(0),
+    fOwnWind(false), flWindVel(0), flWindDir(0), flWindTurb(0)
+{
+  rnd_radius.SetStream(&rng);
+  rnd_strength.SetStream(&rng);
+  rnd_lifetime.SetStream(&rng);
+
+  for (int x=0; x<occupancy_grid_size; x++)
+  {
+    for (int y=0; y<occupancy_grid_size; y++)
+    {
+      thermal_occupancy_grid[x][y] = NULL;
+      NewPosLogArray[x][y] = 0;
+      PosLogArray[x][y] = 0;
+    }
+  }
+}
+
+WindField::~WindField()
+{
+  clear();
+}
+
+void WindField::setWind(float velocity, float direction, float turbulence)
+{
+  fOwnWind   = true;
+  flWindVel  = velocity;
+  flWindDir  = direction;
+  flWindTurb = turbulence;
+}
+
+float WindField::getWindVelocity()
+{
+  return(fOwnWind ? flWindVel : cfg->wind->getVelocity());
+}
+
+float WindField::getWindDirection()
+{
+  return(fOwnWind ? flWindDir : cfg->wind->getDirection());
+}
+
+float WindField::getWindTurbulence()
+{
+  return(fOwnWind ? flWindTurb : cfg->wind->getTurbulence());
+}
+
 // Description: see header file
-void clear_wind_field()
+void WindField::clear()
 {
   // remove linked list
   Thermal* tptr0 = thermals;
@@ -324,6 +316,16 @@ void clear_wind_field()
   }
   thermals = NULL;
 
+  for (int x=0; x<occupancy_grid_size; x++)
+    for (int y=0; y<occupancy_grid_size; y++)
+      thermal_occupancy_grid[x][y] = NULL;
+}
+
+// Description: see header file
+void clear_wind_field()
+{
+  windfield.clear();
+
   delete td_state_noblend;
   td_state_noblend = NULL;
   delete td_state_blend;
@@ -333,14 +335,22 @@ void clear_wind_field()
 }
 
 // Description: see header file
-void initialize_wind_field(SimpleXMLTransfer* el)
+void WindField::init(SimpleXMLTransfer* el)
 {
   int loop;
   Thermal *temp_thermal;
   int xloop,yloop;
 
+  // random sequences of this windfield
+  unsigned int uSeed = CRRC_Random::getSeed();
+  rng.seed(uSeed);
+  rnd_radius.Reset();
+  rnd_strength.Reset();
+  rnd_lifetime.Reset();
+  gust.seed(uSeed ^ 0x5BD1E995);
+
   // initialize wind turbulence model
-  initialize_gust();
+  gust.init();
   
   ThermalVersion = THERMAL_CODE;
   // Use version 3?
@@ -387,25 +397,6 @@ void initialize_wind_field(SimpleXMLTransfer* el)
     // whether a thermal has to be drawn or not, so I use an additional factor.
     if (nGridCnt/3 > num_thermals)
       nDrawThermalsFromGrid = 0;
-
-    if (td_state_noblend == NULL)
-    {
-      td_state_noblend = new ssgSimpleState();
-      td_state_noblend->disable(GL_CULL_FACE);
-      td_state_noblend->disable(GL_COLOR_MATERIAL);
-      td_state_noblend->disable(GL_TEXTURE_2D);
-      td_state_noblend->disable(GL_LIGHTING);
-      td_state_noblend->disable(GL_BLEND);
-    }
-    if (td_state_blend == NULL)
-    {
-      td_state_blend = new ssgSimpleState();
-      td_state_blend->disable(GL_CULL_FACE);
-      td_state_blend->disable(GL_COLOR_MATERIAL);
-      td_state_blend->disable(GL_TEXTURE_2D);
-      td_state_blend->disable(GL_LIGHTING);
-      td_state_blend->enable(GL_BLEND);
-    }
   }
 
 #if (THERMAL_CODE == 1)
@@ -435,12 +426,40 @@ void initialize_wind_field(SimpleXMLTransfer* el)
   for (loop=0;loop<num_thermals;loop++)
   {
     //~ temp_thermal=(Thermal *)malloc(sizeof(Thermal));
-    temp_thermal = new Thermal();
+    temp_thermal = new Thermal(this);
 
     temp_thermal->next_thermal = thermals;
     thermals = temp_thermal;
   }
-  
+}
+
+// Description: see header file
+void initialize_wind_field(SimpleXMLTransfer* el)
+{
+  windfield.init(el);
+
+  // OpenGL states for drawing thermals
+  {
+    if (td_state_noblend == NULL)
+    {
+      td_state_noblend = new ssgSimpleState();
+      td_state_noblend->disable(GL_CULL_FACE);
+      td_state_noblend->disable(GL_COLOR_MATERIAL);
+      td_state_noblend->disable(GL_TEXTURE_2D);
+      td_state_noblend->disable(GL_LIGHTING);
+      td_state_noblend->disable(GL_BLEND);
+    }
+    if (td_state_blend == NULL)
+    {
+      td_state_blend = new ssgSimpleState();
+      td_state_blend->disable(GL_CULL_FACE);
+      td_state_blend->disable(GL_COLOR_MATERIAL);
+      td_state_blend->disable(GL_TEXTURE_2D);
+      td_state_blend->disable(GL_LIGHTING);
+      td_state_blend->enable(GL_BLEND);
+    }
+  }
+
   therm_quadric = gluNewQuadric();
 }
 
@@ -480,16 +499,24 @@ SimpleXMLTransfer* GetDefaultConf_Thermal()
 
 // Description: see header file
 void update_thermals(float flDeltaT)
+{
+  CRRC_PROFILE("thermals");
+  windfield.updateThermals(flDeltaT);
+}
+
+// Description: see header file
+void WindField::updateThermals(float flDeltaT)
 {
   Thermal *thermal_ptr;
   float x_motion;   // How much has a thermal moved in X in the last timestep
   float y_motion;   // How much has a thermal moved in Y in the last timestep
   float x_wind_velocity,y_wind_velocity;
-  float flWindVel = cfg->wind->getVelocity();
+  float flVel = getWindVelocity();
+  float flDir = getWindDirection();
 
   // Wind velocity is the same everywhere, so every thermals relative movement is:
-  x_wind_velocity = -1 * flWindVel * cos(M_PI*cfg->wind->getDirection()/180);
-  y_wind_velocity = -1 * flWindVel * sin(M_PI*cfg->wind->getDirection()/180);
+  x_wind_velocity = -1 * flVel * cos(M_PI*flDir/180);
+  y_wind_velocity = -1 * flVel * sin(M_PI*flDir/180);
   x_motion        = flDeltaT * x_wind_velocity;
   y_motion        = flDeltaT * y_wind_velocity;
 
@@ -505,6 +532,13 @@ void update_thermals(float flDeltaT)
 // Description: see header file
 int calculate_wind(double  X_cg,      double  Y_cg,     double  Z_cg,
                    double& Vel_north, double& Vel_east, double& Vel_down)
+{
+  return(windfield.calculateWind(X_cg, Y_cg, Z_cg, Vel_north, Vel_east, Vel_down));
+}
+
+// Description: see header file
+int WindField::calculateWind(double  X_cg,      double  Y_cg,     double  Z_cg,
+                             double& Vel_north, double& Vel_east, double& Vel_down)
 {
   float    x_wind_velocity, y_wind_velocity, z_wind_velocity; //JL
   Thermal* thermal_ptr;
@@ -527,6 +561,7 @@ int calculate_wind(double  X_cg,      double  Y_cg,     double  Z_cg,
 
   // wind from scenery, without thermal effect
   int wind_error = Global::scenery->getWindComponents(X_cg, Y_cg, Z_cg, 
+      getWindVelocity(), getWindDirection(),
       &x_wind_velocity, &y_wind_velocity, &z_wind_velocity);
 
   // reduce wind speed close to ground to simulate wind 
@@ -693,6 +728,13 @@ int calculate_wind(double  X_cg,      double  Y_cg,     double  Z_cg,
 // Description: see header file
 int calculate_wind_grad(double X_cg, double Y_cg, double Z_cg, double delta_space,
                         CRRCMath::Matrix33& m_V_grad)
+{
+  return(windfield.calculateWindGrad(X_cg, Y_cg, Z_cg, delta_space, m_V_grad));
+}
+
+// Description: see header file
+int WindField::calculateWindGrad(double X_cg, double Y_cg, double Z_cg, double delta_space,
+                                 CRRCMath::Matrix33& m_V_grad)
 {
   double V_north_xp, V_east_xp, V_down_xp;
   double V_north_yp, V_east_yp, V_down_yp;
@@ -701,17 +743,17 @@ int calculate_wind_grad(double X_cg, double Y_cg, double Z_cg, double delta_spac
   double V_north_ym, V_east_ym, V_down_ym;
   double V_north_zm, V_east_zm, V_down_zm;
 
-  int err_x = calculate_wind(X_cg+delta_space, Y_cg,             Z_cg,
+  int err_x = calculateWind(X_cg+delta_space, Y_cg,             Z_cg,
                              V_north_xp,       V_east_xp,        V_down_xp) |
-              calculate_wind(X_cg-delta_space, Y_cg,             Z_cg,
+              calculateWind(X_cg-delta_space, Y_cg,             Z_cg,
                              V_north_xm,       V_east_xm,        V_down_xm);
-  int err_y = calculate_wind(X_cg,             Y_cg+delta_space, Z_cg,
+  int err_y = calculateWind(X_cg,             Y_cg+delta_space, Z_cg,
                              V_north_yp,       V_east_yp,        V_down_yp) |
-              calculate_wind(X_cg,             Y_cg-delta_space, Z_cg,
+              calculateWind(X_cg,             Y_cg-delta_space, Z_cg,
                              V_north_ym,       V_east_ym,        V_down_ym);
-  int err_z = calculate_wind(X_cg,             Y_cg,             Z_cg+delta_space,
+  int err_z = calculateWind(X_cg,             Y_cg,             Z_cg+delta_space,
                              V_north_zp,       V_east_zp,        V_down_zp) |
-              calculate_wind(X_cg,             Y_cg,             Z_cg-delta_space,
+              calculateWind(X_cg,             Y_cg,             Z_cg-delta_space,
                              V_north_zm,       V_east_zm,        V_down_zm);
 
   // Gradients are calculated from symmetric pairs to get symmetric behaviour.
@@ -739,6 +781,31 @@ int calculate_wind_grad(double X_cg, double Y_cg, double Z_cg, double delta_spac
 
 // Description: see header file
 void initialize_gust()
+{
+  windfield.initializeGust();
+}
+
+WindGust::WindGust()
+{
+  eta1.SetStream(&rng);
+  eta2.SetStream(&rng);
+  eta3.SetStream(&rng);
+  eta4.SetStream(&rng);
+  init();
+}
+
+// Description: see header file
+void WindGust::seed(unsigned int uSeed)
+{
+  rng.seed(uSeed);
+  eta1.Reset();
+  eta2.Reset();
+  eta3.Reset();
+  eta4.Reset();
+}
+
+// Description: see header file
+void WindGust::init()
 {
   v_V_gust_body_.r[0] = v_V_gust_body_.r[1] = v_V_gust_body_.r[2] = 0.0;
   v_V_gust_body_old_ = v_V_gust_body_;
@@ -753,7 +820,29 @@ void calculate_gust(double dt, double altitude, double V_rel_wind, double b,
                     CRRCMath::Vector3& v_V_gust_body,
                     CRRCMath::Vector3& v_R_omega_gust_body)
 {
-  double intensity = cfg->wind->getTurbulence();
+  windfield.calculateGust(dt, altitude, V_rel_wind, b, v_V_local_airmass, LocalToBody,
+                          v_V_gust_body, v_R_omega_gust_body);
+}
+
+// Description: see header file
+void WindField::calculateGust(double dt, double altitude, double V_rel_wind, double b,
+                              CRRCMath::Vector3 v_V_local_airmass,
+                              CRRCMath::Matrix33 LocalToBody,
+                              CRRCMath::Vector3& v_V_gust_body,
+                              CRRCMath::Vector3& v_R_omega_gust_body)
+{
+  gust.calculate(getWindTurbulence(), dt, altitude, V_rel_wind, b, v_V_local_airmass, LocalToBody,
+                 v_V_gust_body, v_R_omega_gust_body);
+}
+
+// Description: see header file
+void WindGust::calculate(double intensity,
+                         double dt, double altitude, double V_rel_wind, double b,
+                         CRRCMath::Vector3 v_V_local_airmass,
+                         CRRCMath::Matrix33 LocalToBody,
+                         CRRCMath::Vector3& v_V_gust_body,
+                         CRRCMath::Vector3& v_R_omega_gust_body)
+{
   double V_wind = v_V_local_airmass.length();
 
   // no wind turbulence if wind velocity is zero or
@@ -843,6 +932,12 @@ void calculate_gust(double dt, double altitude, double V_rel_wind, double b,
 
 // Description: see header file
 void draw_thermals(CRRCMath::Vector3 pos)
+{
+  windfield.drawThermals(pos);
+}
+
+// Description: see header file
+void WindField::drawThermals(CRRCMath::Vector3 pos)
 {
   Thermal* thermal_ptr;
 
@@ -952,6 +1047,11 @@ void draw_wind(double direction_face)
 # define DEBUG_THERMAL_SCRSHOT_FORMAT 3
 
 void windfield_thermalScreenshot(CRRCMath::Vector3 pos)
+{
+  windfield.thermalScreenshot(pos);
+}
+
+void WindField::thermalScreenshot(CRRCMath::Vector3 pos)
 {
   /**
    * using gnuplot (1):
@@ -1034,7 +1134,7 @@ void windfield_thermalScreenshot(CRRCMath::Vector3 pos)
     {
       double y = pos.r[1] + nY*dStep;
 
-      calculate_wind(x, y, pos.r[2], dVNorth, dVEast, dVDown);
+      calculateWind(x, y, pos.r[2], dVNorth, dVEast, dVDown);
 
 # if (DEBUG_THERMAL_SCRSHOT_FORMAT == 0) || (DEBUG_THERMAL_SCRSHOT_FORMAT == 2) || (DEBUG_THERMAL_SCRSHOT_FORMAT == 3)
       tf_up << -1*dVDown << " ";
@@ -1094,11 +1194,11 @@ void windfield_thermalScreenshot(CRRCMath::Vector3 pos)
  *  The constructor. Creates the object and initializes it
  *  with some random values.
  */
-Thermal::Thermal()
+Thermal::Thermal(WindField* field) : field(field)
 {
   random_init();
   // to have a higher level of initial randomness:
-  lifetime *= rand()/(RAND_MAX+1.0);
+  lifetime *= field->rng.uniform();
 }
 
 /**
@@ -1111,12 +1211,12 @@ void Thermal::random_init()
   int   xco,yco;
 
   // determine position of new thermal
-  fInvisible = find_new_thermal_position(&xpos,&ypos,&xco,&yco);
+  fInvisible = field->findNewThermalPosition(&xpos,&ypos,&xco,&yco);
 
 #if (THERMAL_NEWPOSLOG != 0)
   if (!fInvisible)
   {
-    NewPosLogArray[xco][yco]++;
+    field->NewPosLogArray[xco][yco]++;
   }
 #endif
 
@@ -1136,16 +1236,16 @@ void Thermal::random_init()
   // Put it into the grid. If no valid position was found, this thermal stays invisible during
   // its current lifecycle.
   if (!fInvisible)
-    thermal_occupancy_grid[xco][yco] = this;
+    field->thermal_occupancy_grid[xco][yco] = this;
 
   // Describe thermal
   center_x_position = xpos;
   center_y_position = ypos;
   xcoord = xco;
   ycoord = yco;
-  radius   = rnd_radius.Get();
-  strength = rnd_strength.Get();
-  lifetime = rnd_lifetime.Get();
+  radius   = field->rnd_radius.Get();
+  strength = field->rnd_strength.Get();
+  lifetime = field->rnd_lifetime.Get();
 #if THERMAL_TEST != 0
   radius   = 50;
   strength = 15;
@@ -1158,13 +1258,13 @@ void Thermal::random_init()
   boundary_thickness = radius/5;
 #endif
 
-  switch (ThermalVersion)
+  switch (field->ThermalVersion)
   {
    case 3:
     {
-      int nDist = (int)ceil((radius * thermalv3.get_r_max()/thermalv3.get_r_ref())/occupancy_grid_res);
-      if (nDist > nInfluenceDist)
-        nInfluenceDist = nDist;
+      int nDist = (int)ceil((radius * field->thermalv3.get_r_max()/field->thermalv3.get_r_ref())/occupancy_grid_res);
+      if (nDist > field->nInfluenceDist)
+        field->nInfluenceDist = nDist;
     }
     break;
 
@@ -1172,8 +1272,8 @@ void Thermal::random_init()
 #if (THERMAL_CODE == 1)
     {
       int nDist = (int)ceil((radius/ThermalRadius)/occupancy_grid_res);
-      if (nDist > nInfluenceDist)
-        nInfluenceDist = nDist;
+      if (nDist > field->nInfluenceDist)
+        field->nInfluenceDist = nDist;
     }
 #endif
     break;
@@ -1185,7 +1285,7 @@ void Thermal::random_init()
  */
 void Thermal::remove_from_grid()
 {
-  thermal_occupancy_grid[xcoord][ycoord] = NULL;
+  field->thermal_occupancy_grid[xcoord][ycoord] = NULL;
 }
 
 /**
@@ -1232,7 +1332,7 @@ void Thermal::update(float flDeltaT, float x_motion, float y_motion)
         (new_ycoord != ycoord))
     {
       // Is this place in the grid occupied by another thermal?
-      if (thermal_occupancy_grid[new_xcoord][new_ycoord]!=0)
+      if (field->thermal_occupancy_grid[new_xcoord][new_ycoord]!=0)
       {
         // This should never happen with nGridDistMin>0. If it does,
         // there is work to be done.
@@ -1242,15 +1342,15 @@ void Thermal::update(float flDeltaT, float x_motion, float y_motion)
       else
       {
         // leave the old place in the grid
-        thermal_occupancy_grid[xcoord][ycoord] = NULL;
+        field->thermal_occupancy_grid[xcoord][ycoord] = NULL;
         // enter the new place in the grid
-        thermal_occupancy_grid[new_xcoord][new_ycoord] = this;
+        field->thermal_occupancy_grid[new_xcoord][new_ycoord] = this;
         xcoord = new_xcoord;
         ycoord = new_ycoord;
       }
     }
 #if (THERMAL_NEWPOSLOG != 0)
-    PosLogArray[xcoord][ycoord]++;
+    field->PosLogArray[xcoord][ycoord]++;
 #endif
   }
 }
@@ -32,7 +32,18 @@
 #include "../mod_misc/crrc_rand.h"
 
 
-class ThermikSchalen;
+#include "thermal03/tschalen.h"
+
+/**
+ * There is some 2D grid. Its area is
+ *    (occupancy_grid_size * occupancy_grid_res)^2
+ * It is divided into occupancy_grid_size^2 squares.
+ */
+#define occupancy_grid_size_exp 7
+#define occupancy_grid_size     (1 << occupancy_grid_size_exp)
+#define occupancy_grid_res      100
+
+class WindField;
 
 /** \brief A class that represents a thermal
  *
@@ -45,6 +56,7 @@ class Thermal
     int xcoord;               ///< X coordinate in thermal occupancy grid
     int ycoord;               ///< Y coordinate in thermal occupancy grid
     bool fInvisible;          ///< thermal is not visible in grid
+    WindField* field;         ///< the windfield this thermal lives in
 
   public:
     Thermal *next_thermal;
@@ -57,8 +69,8 @@ class Thermal
     float strength;           ///< Vertical component strength in ft/s
     float lifetime;           ///< remaining lifetime in sec
 
-    /// create a thermal and add its graphical representation to the scene graph
-    Thermal();
+    /// create a thermal in the grid of <code>field</code>
+    Thermal(WindField* field);
 
     /// initialize thermal with some sensible random values
     void random_init();
@@ -88,6 +100,204 @@ class Thermal
 };
 //} Thermal;
 
+/**
+ * State of the wind turbulence model (digital filter form of the
+ * Dryden spectra). Every simulated aircraft needs its own one.
+ */
+class WindGust
+{
+  public:
+    WindGust();
+
+    /**
+     * Initialize gust (a.k.a wind turbulence) linear and rotational
+     * velocities in body axes.
+     */
+    void init();
+
+    /**
+     * Restart the random sequence of this gust model.
+     */
+    void seed(unsigned int uSeed);
+
+    /**
+     * Given the time since last iteration updates gust linear
+     * and rotational velocities in body axes.
+     * <code>intensity</code> is the relative turbulence intensity.
+     */
+    void calculate(double intensity,
+                   double dt, double altitude, double V_rel_wind, double b,
+                   CRRCMath::Vector3 v_V_local_airmass,
+                   CRRCMath::Matrix33 LocalToBody,
+                   CRRCMath::Vector3& v_V_gust_body,
+                   CRRCMath::Vector3& v_R_omega_gust_body);
+
+  private:
+    WindGust(const WindGust&);
+    WindGust& operator=(const WindGust&);
+    CRRC_RandomStream rng;
+    RandGauss eta1, eta2, eta3, eta4;
+    CRRCMath::Vector3 v_V_gust_body_, v_V_gust_body_old_;
+    CRRCMath::Vector3 v_R_omega_gust_body_;
+};
+
+/**
+ * Thermals, wind and turbulence as seen by one simulated aircraft.
+ *
+ * The free functions below (initialize_wind_field(), calculate_wind(), ...)
+ * work on a default instance, which is the one crrcsim flies in and draws.
+ * Additional instances can be used to run independent simulations side by
+ * side, e.g. in a parameter sweep. The scenery is shared by all instances
+ * and only read.
+ *
+ * Thermals and turbulence use random number streams of their own, seeded
+ * in init() (see CRRC_Random::getSeed()). In deterministic mode, two 
+ * instances initialized the same way behave the same.
+ */
+class WindField
+{
+  friend class Thermal;
+
+  public:
+    WindField();
+    ~WindField();
+
+    /**
+     * Initialize thermal positions, strengths, radii, etc.
+     */
+    void init(SimpleXMLTransfer* el);
+
+    /**
+     * removes all thermals
+     */
+    void clear();
+
+    /**
+     * Use this wind instead of the one configured in <code>cfg->wind</code>.
+     * Velocity in ft/s, direction in degrees (where the wind comes from).
+     */
+    void setWind(float velocity, float direction, float turbulence);
+
+    float getWindVelocity();
+    float getWindDirection();
+    float getWindTurbulence();
+
+    /// see update_thermals()
+    void updateThermals(float flDeltaT);
+
+    /// see calculate_wind()
+    int calculateWind(double  X_cg,      double  Y_cg,     double  Z_cg,
+                      double& Vel_north, double& Vel_east, double& Vel_down);
+
+    /// see calculate_wind_grad()
+    int calculateWindGrad(double X_cg, double Y_cg, double Z_cg, double delta_space,
+                          CRRCMath::Matrix33& m_V_grad);
+
+    /// see initialize_gust()
+    void initializeGust() { gust.init(); };
+
+    /// see calculate_gust()
+    void calculateGust(double dt, double altitude, double V_rel_wind, double b,
+                       CRRCMath::Vector3 v_V_local_airmass,
+                       CRRCMath::Matrix33 LocalToBody,
+                       CRRCMath::Vector3& v_V_gust_body,
+                       CRRCMath::Vector3& v_R_omega_gust_body);
+
+    /// see draw_thermals()
+    void drawThermals(CRRCMath::Vector3 pos);
+
+#if DEBUG_THERMAL_SCRSHOT == 1
+    /// see windfield_thermalScreenshot()
+    void thermalScreenshot(CRRCMath::Vector3 pos);
+#endif
+
+  private:
+    bool isThermalNearby(int xcoord, int ycoord);
+    bool findNewThermalPosition(float *xpos, float *ypos,
+                                int *xcoord, int *ycoord);
+
+    /**
+     * Which version of thermal model to use?
+     * Everthing less than 3 results in the 'old' code (which depends on THERMAL_CODE
+     * in crrc_config.h), 3 results in version 3.
+     */
+    unsigned int ThermalVersion;
+
+    Thermal* thermal_occupancy_grid[occupancy_grid_size][occupancy_grid_size];
+
+    unsigned int NewPosLogArray[occupancy_grid_size][occupancy_grid_size];
+    unsigned int PosLogArray[occupancy_grid_size][occupancy_grid_size];
+
+    /**
+     * The number of thermals in the above grid is
+     *    (occupancy_grid_size * occupancy_grid_res)^2 * cfg->thermal->density
+     */
+    int num_thermals;
+
+    /**
+     * The pointer to the first thermal in the linked list.
+     */
+    Thermal* thermals;
+
+    /**
+     * Random numbers for thermals
+     */
+    CRRC_RandomStream rng;
+
+    /**
+     * Random normal (gaussian) distribution of thermal radius, strength
+     * and lifetime.
+     */
+    RandGauss rnd_radius;
+    RandGauss rnd_strength;
+    RandGauss rnd_lifetime;
+
+    /**
+     * One thermal influences an area of
+     *    (nInfluenceDist*occupancy_grid_res)^2
+     * or less.
+     * Radius of the largest (since init) thermal in lengths of the grid.
+     */
+    int nInfluenceDist;
+
+    /**
+     * To draw thermals, one of two methods is used:
+     * 1. loop over linked list of thermals and draw every thermal which
+     *    is near the aircraft
+     * 2. Look at grid around aircraft and draw present thermals. This
+     *    method means less effort if the thermal density is high. It also
+     *    doesn't draw thermal which are in the list but not in the grid (may
+     *    happen when thermal density is high).
+     * If the second method is used, this variable represents a distance
+     * in grid coordinates.
+     */
+    int nDrawThermalsFromGrid;
+
+    /**
+     * Standard thermal according to thermal model version 3.
+     */
+    ThermikSchalen thermalv3;
+
+    /**
+     * Wind turbulence model
+     */
+    WindGust gust;
+
+    /**
+     * If false, wind velocity, direction and turbulence are taken from
+     * <code>cfg->wind</code>. Otherwise the values below are used.
+     */
+    bool  fOwnWind;
+    float flWindVel;
+    float flWindDir;
+    float flWindTurb;
+};
+
+/**
+ * The windfield crrcsim flies in. All free functions below work on it.
+ */
+WindField* default_wind_field();
+
 /**
  * Initialize thermal positions stregths, radii, etc.
  */
@@ -125,13 +335,6 @@ int calculate_wind(double  X_cg,      double  Y_cg,     double  Z_cg,
 int calculate_wind_grad(double X_cg, double Y_cg, double Z_cg, double delta_space,
                         CRRCMath::Matrix33& m_V_grad);
 
-/**
- * Static data for wind turbulence model
- */
-static RandGauss eta1, eta2, eta3, eta4;
-static CRRCMath::Vector3 v_V_gust_body_, v_V_gust_body_old_;
-static CRRCMath::Vector3 v_R_omega_gust_body_;
-
 /**
  * Initialize gust (a.k.a wind turbulence) linear and rotational
  * velocities in body axes.
@@ -22,7 +22,7 @@
 
 #include "mod_misc/filesystools.h"
 #include "mod_misc/lib_conversions.h"
-#include "mod_robots/robotfile.h"
+#include "config.h"
 #include <crrc_config.h>
 
 #include <iostream>
@@ -50,11 +50,17 @@ void FlightRecorder::Start(SimpleXMLTransfer* data)
   num = (num+1) & 0x03;
   //
   filename = "";
-  out.open((outdir + "record" + itoStr(num, '0', 3) + ".crrclog_").c_str(), std::ios::binary);
-  if (!out)
+  
+  unsigned int channels = 0;
+  if (cfgfile->getInt("recording.velocity", 1))
+    channels |= FLIGHTLOG_CH_VELOCITY;
+  if (cfgfile->getInt("recording.inputs", 1))
+    channels |= FLIGHTLOG_CH_INPUTS;
+  
+  if (!out.Open(outdir + "record" + itoStr(num, '0', 3) + ".crrclog_", data, channels))
     std::cerr << "error opening logfile: " << strerror(errno) << "\n";
   
-  data->print(out, 0);
+  dTime = 0;
   state = eRecording;
   descr = "";
 }
@@ -71,7 +77,7 @@ void FlightRecorder::Stop()
     delete data;
     
     // 
-    out.close();
+    out.Close();
     
     // rename?
     if (filename.length() > 0)
@@ -95,38 +101,51 @@ void FlightRecorder::SetFilename(std::string newname)
 void FlightRecorder::InsertMarker(int data)
 {
   if (state == eRecording)
-  {
-    const char rt = 0x02;
-    out.write((char*)&rt, 1);
-    RobotFile::WriteInt32(out, data);
-  }
+    out.AddMarker(data);
 }
 
 void FlightRecorder::InsertXML(SimpleXMLTransfer* data)
 {
   if (state == eRecording)
-  {
-    const char rt = 0x03;
-    out.write((char*)&rt, 1);
-    data->print(out, 0);
-  }
+    out.AddXML(data);
 }
 
-void FlightRecorder::AirplanePosition(double dt, int multiloop, FDMBase* fdm)
+void FlightRecorder::AirplanePosition(double dt, int multiloop, FDMBase* fdm, TSimInputs* inputs)
 {
   if (state == eRecording)
   {
-    const char rt = 0x00;
-    out.write((char*)&rt, 1);
-
-    RobotFile::WriteDouble(out, dt*multiloop);
+    FlightLogFrame frame;
+    
+    dTime  += dt*multiloop;
+    frame.t = dTime;
+    
     CRRCMath::Vector3 pos = fdm->getPos();
-    RobotFile::WriteFloat(out, pos.r[0]);
-    RobotFile::WriteFloat(out, pos.r[1]);
-    RobotFile::WriteFloat(out, pos.r[2]);
-    RobotFile::WriteInt16(out, fdm->getPhi()*ROBOT_EULER_TO_INT16);
-    RobotFile::WriteInt16(out, fdm->getTheta()*ROBOT_EULER_TO_INT16);
-    RobotFile::WriteInt16(out, fdm->getPsi()*ROBOT_EULER_TO_INT16);
+    for (int n=0; n<3; n++)
+      frame.pos[n] = pos.r[n];
+    flightLogEulerToQuat(fdm->getPhi(), fdm->getTheta(), fdm->getPsi(), frame.quat);
+    
+    CRRCMath::Vector3 vel = fdm->getVel();
+    for (int n=0; n<3; n++)
+      frame.vel[n] = vel.r[n];
+    
+    if (inputs)
+    {
+      frame.inputs[0] = inputs->aileron;
+      frame.inputs[1] = inputs->elevator;
+      frame.inputs[2] = inputs->rudder;
+      frame.inputs[3] = inputs->throttle;
+      frame.inputs[4] = inputs->flap;
+      frame.inputs[5] = inputs->spoiler;
+      frame.inputs[6] = inputs->retract;
+      frame.inputs[7] = inputs->pitch;
+    }
+    else
+    {
+      for (int n=0; n<FLIGHTLOG_NUM_INPUTS; n++)
+        frame.inputs[n] = 0;
+    }
+    
+    out.AddFrame(frame);
   }
 }
 
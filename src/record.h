@@ -21,10 +21,10 @@
 #ifndef RECORD_H
 # define RECORD_H
 
-#include <fstream>
 #include <string>
 #include "mod_misc/SimpleXMLTransfer.h"
 #include "mod_fdm/fdm.h"
+#include "mod_robots/crrclog.h"
 
 /**
  * Record airplane position, attitude, control inputs, settings, results, 
@@ -61,9 +61,11 @@ public:
   void Stop();
   
   /**
-   * Write timestep, position and attitude to file.
+   * Write time, position and attitude to file. Velocity and
+   * control inputs are written if these channels are enabled
+   * (recording.velocity, recording.inputs in the configuration).
    */
-  void AirplanePosition(double dt, int multiloop, FDMBase* fdm);
+  void AirplanePosition(double dt, int multiloop, FDMBase* fdm, TSimInputs* inputs = 0);
   
   /**
    * Insert some marker.
@@ -96,9 +98,14 @@ private:
   std::string filename;
   
   /**
-   * ofstream in use
+   * log file in use
    */
-  std::ofstream out;
+  FlightLogWriter out;
+  
+  /**
+   * time since start of log
+   */
+  double dTime;
   
   /**
    * All files are stored to this output directory
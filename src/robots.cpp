@@ -21,7 +21,9 @@
 #include "robots.h"
 #include "mod_misc/filesystools.h"
 #include "mod_fdm/xmlmodelfile.h"
+#include "mod_misc/lib_conversions.h"
 #include "mod_robots/robot.h"
+#include "mod_robots/fdm_playback.h"
 
 
 #include <iostream>
@@ -42,28 +44,89 @@ void Robots::AddRobot(std::string robotfilename)
     SimpleXMLTransfer* header = robot->fi->robot->GetHeader();
     
     std::string filename = FileSysTools::getDataPath(header->getString("airplane.file"));
+    int         nGraphics = header->getInt("airplane.graphics");
+    std::string key = filename + "|" + itoStr(nGraphics, ' ', 1);
     
-    SimpleXMLTransfer* xml = new SimpleXMLTransfer(filename);
-    XMLModelFile::SetGraphics(xml, header->getInt("airplane.graphics"));
+    SimpleXMLTransfer* xml;
+    std::map<std::string, SimpleXMLTransfer*>::iterator it = airplanes.find(key);
+    if (it != airplanes.end())
+      xml = it->second;
+    else
+    {
+      xml = new SimpleXMLTransfer(filename);
+      XMLModelFile::SetGraphics(xml, nGraphics);
+      airplanes[key] = xml;
+    }
     SimpleXMLTransfer* graphics = XMLModelFile::getGraphics(xml);
     
     // 
     robot->vis_id = Video::new_visualization("objects/" + graphics->attribute("model"),
                                              "textures",
                                              CRRCMath::Vector3(), // todo
-                                             xml);
+                                             xml,
+                                             true);
+    
+    robot->playback = dynamic_cast<CRRC_AirplaneSim_Playback*>(robot->fi->robot);
+    if (robot->playback)
+    {
+      Trajectory*  traj = robot->playback->GetTrajectory();
+      unsigned int n    = 0;
+      
+      while (n < batches.size() && batches[n].traj != traj)
+        n++;
+      if (n == batches.size())
+      {
+        batches.push_back(Batch());
+        batches[n].traj = traj;
+      }
+      
+      Batch& b = batches[n];
+      b.robots.push_back(robot);
+      b.time.resize(b.robots.size());
+      b.hint.resize(b.robots.size(), 0);
+      b.pos.resize(3*b.robots.size());
+      b.quat.resize(4*b.robots.size());
+      b.vel.resize(3*b.robots.size());
+    }
   
     list.push_back(robot);
   }
+  else
+  {
+    delete robot->fi;
+    delete robot;
+  }
 }
 
 void Robots::Update(double dt, int multiloop)
 {
   TSimInputs dummy;
+  
   for (unsigned int n=0; n<list.size(); n++)
   {
-    list[n]->fi->update(&dummy, dt, multiloop);
+    if (list[n]->playback == NULL)
+      list[n]->fi->update(&dummy, dt, multiloop);
+  }
+  
+  for (unsigned int n=0; n<batches.size(); n++)
+  {
+    Batch& b = batches[n];
+    int    nRobots = b.robots.size();
     
+    for (int i=0; i<nRobots; i++)
+    {
+      b.robots[i]->playback->Advance(dt * multiloop);
+      b.time[i] = b.robots[i]->playback->GetTime();
+    }
+    
+    b.traj->Sample(nRobots, &b.time[0], &b.hint[0], &b.pos[0], &b.quat[0], &b.vel[0]);
+    
+    for (int i=0; i<nRobots; i++)
+      b.robots[i]->playback->SetState(&b.pos[3*i], &b.quat[4*i], &b.vel[3*i]);
+  }
+  
+  for (unsigned int n=0; n<list.size(); n++)
+  {
     Video::set_position(list[n]->vis_id,
                         list[n]->fi->fdm->getPos(),
                         list[n]->fi->fdm->getPhi(),
@@ -86,8 +149,15 @@ void Robots::RemoveAll()
   {
     Video::delete_visualization(list[n]->vis_id);
     delete list[n]->fi;
+    delete list[n];
   }
   list.clear();
+  batches.clear();
+  
+  std::map<std::string, SimpleXMLTransfer*>::iterator it;
+  for (it = airplanes.begin(); it != airplanes.end(); it++)
+    delete it->second;
+  airplanes.clear();
 }
 
 void Robots::AnnounceMarker(int id)
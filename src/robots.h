@@ -21,10 +21,14 @@
 #ifndef ROBOTS_H
 # define ROBOTS_H
 
+#include <map>
 #include <string>
+#include <vector>
 #include "global_video.h"
 
 class ModRobotInterface;
+class CRRC_AirplaneSim_Playback;
+class Trajectory;
 
 /**
  * data for one robot
@@ -36,6 +40,11 @@ class Robot
 public:
   ModRobotInterface* fi;
   long vis_id;
+  
+  /**
+   * fi->robot if it is a playback, NULL otherwise
+   */
+  CRRC_AirplaneSim_Playback* playback;
 };
 
 /**
@@ -44,6 +53,10 @@ public:
  * 
  * See documentation/record_playback/
  *
+ * Playbacks of the same file share their trajectory and are updated
+ * together (see Batch). Robots flying the same airplane share its
+ * model.
+ *
  * @author Jens W. Wulf
  */
 class Robots
@@ -72,7 +85,31 @@ public:
   void AnnounceMarker(int id);
   
 private:
+  
+  /**
+   * All playbacks of one trajectory and buffers to sample it
+   */
+  class Batch
+  {
+  public:
+    Trajectory*         traj;
+    std::vector<Robot*> robots;
+    std::vector<double> time;
+    std::vector<size_t> hint;
+    std::vector<float>  pos;
+    std::vector<float>  quat;
+    std::vector<float>  vel;
+  };
+  
   std::vector<Robot*> list;
+  
+  std::vector<Batch> batches;
+  
+  /**
+   * Airplane descriptions which have been loaded (file and graphics
+   * variant), so they aren't parsed again for every robot
+   */
+  std::map<std::string, SimpleXMLTransfer*> airplanes;
 };
 
 #endif